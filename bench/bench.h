@@ -0,0 +1,85 @@
+#ifndef BENCH_H
+    #define BENCH_H
+
+    /**
+     * @file bench.h
+     * @brief Funções comuns aos programas de medição (ver "make bench").
+     * @details Geração determinística de CPFs e nomes e medição de tempo.
+     * Os programas rodam em sistemas tipo Unix (clock_gettime, mkdtemp).
+     */
+
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdbool.h>
+    #include <stdint.h>
+    #include <string.h>
+    #include <time.h>
+
+    /**
+     * @brief Instante atual, em milissegundos (relógio monotônico).
+     */
+    static inline double bench_agora_ms(void){
+        struct timespec t;
+        clock_gettime(CLOCK_MONOTONIC, &t);
+        return t.tv_sec * 1000.0 + t.tv_nsec / 1e6;
+    }
+
+    /**
+     * @brief Próximo número pseudoaleatório (xorshift64*); o estado não pode ser 0.
+     */
+    static inline uint64_t bench_aleatorio(uint64_t* estado){
+        uint64_t x = *estado;
+        x ^= x >> 12;
+        x ^= x << 25;
+        x ^= x >> 27;
+        *estado = x;
+        return x * 0x2545F4914F6CDD1DULL;
+    }
+
+    /**
+     * @brief Escreve o CPF válido (com os dois verificadores) de base n.
+     * @details Bases distintas de 0 a 999999999 dão CPFs distintos; as de
+     * dígitos todos iguais, rejeitadas pela validação, são desviadas.
+     */
+    static inline void bench_cpf(uint64_t n, char cpf[12]){
+        n %= 1000000000ULL;
+        if (n % 111111111ULL == 0) n += 1;
+        for (int i = 8; i >= 0; i--){
+            cpf[i] = (char)('0' + n % 10);
+            n /= 10;
+        }
+        int soma1 = 0, soma2 = 0;
+        for (int i = 0; i < 9; i++) soma1 += (cpf[i] - '0') * (10 - i);
+        cpf[9] = (char)('0' + (soma1 * 10) % 11 % 10);
+        for (int i = 0; i < 10; i++) soma2 += (cpf[i] - '0') * (11 - i);
+        cpf[10] = (char)('0' + (soma2 * 10) % 11 % 10);
+        cpf[11] = '\0';
+    }
+
+    /**
+     * @brief Escreve um nome de "Nome Sobrenome Sobrenome", repetitivo como os reais.
+     * @return Tamanho do nome.
+     */
+    static inline size_t bench_nome(uint64_t* estado, char* nome, size_t capacidade){
+        static const char* const prenomes[] = { "Maria", "José", "Ana", "João", "Antônio", "Francisca", "Carlos",
+                                                "Paulo", "Pedro", "Lucas", "Luiz", "Marcos", "Luís", "Gabriel",
+                                                "Rafael", "Juliana", "Márcia", "Fernanda", "Patrícia", "Aline" };
+        static const char* const sobrenomes[] = { "da Silva", "dos Santos", "Oliveira", "Souza", "Rodrigues",
+                                                  "Ferreira", "Alves", "Pereira", "Lima", "Gomes", "Costa",
+                                                  "Ribeiro", "Martins", "Carvalho", "Almeida", "Lopes" };
+        uint64_t r = bench_aleatorio(estado);
+        int n = snprintf(nome, capacidade, "%s %s %s",
+                         prenomes[r % (sizeof(prenomes) / sizeof(prenomes[0]))],
+                         sobrenomes[(r >> 8) % (sizeof(sobrenomes) / sizeof(sobrenomes[0]))],
+                         sobrenomes[(r >> 16) % (sizeof(sobrenomes) / sizeof(sobrenomes[0]))]);
+        return n < 0 ? 0 : (size_t)n < capacidade ? (size_t)n : capacidade - 1;
+    }
+
+    /**
+     * @brief Lê um número de um argumento, com um valor padrão.
+     */
+    static inline uint64_t bench_argumento(int argc, char** argv, int i, uint64_t padrao){
+        return argc > i ? strtoull(argv[i], NULL, 10) : padrao;
+    }
+
+#endif
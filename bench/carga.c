@@ -0,0 +1,204 @@
+/**
+ * @file carga.c
+ * @brief Tempo do LOAD sobre uma base gerada de N pacientes.
+ * @details Gera, em um diretório temporário (ou no indicado), os arquivos de
+ * dados no formato anterior ao versionado: catálogo, lista com os registros
+ * TAMANHO → STRING e fila com 1% dos pacientes. Depois mede:
+ *  - antes: o LOAD anterior ao mapeamento em memória (duas leituras com
+ *    fread() e um calloc() por registro), reproduzido aqui;
+ *  - depois: o LOAD atual, que mapeia os arquivos e interpreta os registros
+ *    no próprio mapeamento.
+ * Cada medição é feita com o cache de páginas dos arquivos descartado
+ * (posix_fadvise(POSIX_FADV_DONTNEED), o mais próximo de uma partida a frio
+ * sem privilégios) e com os arquivos já em cache.
+ *
+ * Uso: ./bench/carga [pacientes] [diretório]
+ */
+
+#include "bench.h"
+#include "../include/IO.h"
+#include "../include/catalogo.h"
+#include "../include/fila.h"
+#include "../include/lista.h"
+#include "../include/paciente.h"
+#include "../include/registro.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define ARQUIVO_CATALOGO "data/catalogo.bin"
+#define ARQUIVO_LISTA "data/lista_itens.bin"
+#define ARQUIVO_FILA "data/fila_itens.bin"
+#define MAX_REGISTRO 4096
+
+static const char* const procedimentos[] = { "Raio-X do tórax", "Hemograma completo", "Tomografia",
+                                             "Sutura", "Eletrocardiograma", "Medicação intravenosa",
+                                             "Ultrassonografia abdominal", "Curativo", "Glicemia capilar" };
+
+/**
+ * @brief Gera os arquivos de dados no formato antigo, com n pacientes.
+ * @return Bytes gravados na lista.
+ */
+static uint64_t gerar(uint64_t n){
+    uint32_t codigos[sizeof(procedimentos) / sizeof(procedimentos[0])];
+    for (size_t i = 0; i < sizeof(codigos) / sizeof(codigos[0]); i++)
+        codigos[i] = catalogo_internar(procedimentos[i]);
+    if (!catalogo_salvar(ARQUIVO_CATALOGO)) return 0;
+    catalogo_apagar();
+
+    FILE* lista = fopen(ARQUIVO_LISTA, "wb");
+    FILE* fila = fopen(ARQUIVO_FILA, "wb");
+    if (lista == NULL || fila == NULL) return 0;
+
+    uint64_t estado = 0x9E3779B97F4A7C15ULL, bytes = 0;
+    char registro[MAX_REGISTRO];
+    for (uint64_t i = 0; i < n; i++){
+        bench_cpf(i * 7919 + 1, registro);
+        int tamanho = 12 + (int)bench_nome(&estado, registro + 12, 256) + 1;
+        int n_codigos = (int)(bench_aleatorio(&estado) % 4);
+        for (int c = 0; c < n_codigos; c++){
+            uint32_t codigo = codigos[bench_aleatorio(&estado) % (sizeof(codigos) / sizeof(codigos[0]))];
+            memcpy(registro + tamanho, &codigo, sizeof(codigo));
+            tamanho += (int)sizeof(codigo);
+        }
+        fwrite(&tamanho, sizeof(int), 1, lista);
+        fwrite(registro, 1, (size_t)tamanho, lista);
+        bytes += sizeof(int) + (uint64_t)tamanho;
+
+        if (i % 100 == 0){
+            int prioridade = (int)(bench_aleatorio(&estado) % 5);
+            fwrite(&prioridade, sizeof(int), 1, fila);
+            fwrite(&tamanho, sizeof(int), 1, fila);
+            fwrite(registro, 1, (size_t)tamanho, fila);
+        }
+    }
+    return fclose(lista) == 0 && fclose(fila) == 0 ? bytes : 0;
+}
+
+/**
+ * @brief LOAD anterior ao mapeamento (commit "Validate CPF check digits", formato com catálogo).
+ */
+static bool carregar_antes(LISTA** lista, FILA** fila){
+    catalogo_carregar(ARQUIVO_CATALOGO);
+
+    FILE* fp_lista = fopen(ARQUIVO_LISTA, "rb");
+    if (fp_lista != NULL){
+        int tamanho_str_paciente;
+        while (fread(&tamanho_str_paciente, sizeof(int), 1, fp_lista) == 1 &&
+               tamanho_str_paciente > 0 && tamanho_str_paciente <= MAX_REGISTRO){
+            char* buffer = calloc(tamanho_str_paciente + 2, sizeof(char));
+            if (!buffer) break;
+            if (fread(buffer, sizeof(char), tamanho_str_paciente, fp_lista) != (size_t)tamanho_str_paciente){
+                free(buffer);
+                break;
+            }
+            PACIENTE* paciente = paciente_de_bytes(buffer, tamanho_str_paciente);
+            if (paciente) lista_inserir(*lista, paciente);
+            free(buffer);
+        }
+        fclose(fp_lista);
+    }
+
+    FILE* fp_fila = fopen(ARQUIVO_FILA, "rb");
+    if (fp_fila != NULL){
+        int prioridade_lida, tamanho_str_paciente;
+        while (fread(&prioridade_lida, sizeof(int), 1, fp_fila) == 1 &&
+               fread(&tamanho_str_paciente, sizeof(int), 1, fp_fila) == 1 &&
+               tamanho_str_paciente >= 11 && tamanho_str_paciente <= MAX_REGISTRO){
+            char* buffer = calloc(tamanho_str_paciente + 1, sizeof(char));
+            if (!buffer) break;
+            if (fread(buffer, sizeof(char), tamanho_str_paciente, fp_fila) != (size_t)tamanho_str_paciente){
+                free(buffer);
+                break;
+            }
+            char cpf_temp[12];
+            memcpy(cpf_temp, buffer, 11);
+            cpf_temp[11] = '\0';
+            PACIENTE* paciente_encontrado = lista_buscar(*lista, cpf_temp);
+            if (paciente_encontrado) fila_inserir(*fila, paciente_encontrado, prioridade_lida);
+            free(buffer);
+        }
+        fclose(fp_fila);
+    }
+    return true;
+}
+
+/**
+ * @brief Tira os arquivos de dados do cache de páginas.
+ */
+static void descartar_cache(void){
+    const char* arquivos[] = { ARQUIVO_CATALOGO, ARQUIVO_LISTA, ARQUIVO_FILA };
+    for (size_t i = 0; i < sizeof(arquivos) / sizeof(arquivos[0]); i++){
+        int fd = open(arquivos[i], O_RDONLY);
+        if (fd < 0) continue;
+        fdatasync(fd);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+}
+
+/**
+ * @brief Mede uma carga, conferindo a quantidade de pacientes e da fila.
+ * @return Tempo em ms, ou um valor negativo se a carga não conferir.
+ */
+static double medir(bool (*carregar)(LISTA**, FILA**), bool frio, uint64_t n){
+    LISTA* lista = lista_criar();
+    FILA* fila = fila_criar();
+    if (frio) descartar_cache();
+
+    double inicio = bench_agora_ms();
+    bool ok = carregar(&lista, &fila);
+    double ms = bench_agora_ms() - inicio;
+
+    if (!ok || registro_quantidade() != n || registro_contar_na_fila() != (n + 99) / 100){
+        fprintf(stderr, "carga incompleta: %u pacientes, %u na fila\n", registro_quantidade(), registro_contar_na_fila());
+        ms = -1;
+    }
+    fila_apagar(&fila);
+    lista_apagar(&lista);
+    registro_apagar();
+    catalogo_apagar();
+    return ms;
+}
+
+int main(int argc, char** argv){
+    uint64_t n = bench_argumento(argc, argv, 1, 1000000);
+    char diretorio[] = "/tmp/ps_carga_XXXXXX";
+    const char* destino = argc > 2 ? argv[2] : mkdtemp(diretorio);
+    if (n == 0 || destino == NULL || (mkdir(destino, 0755) != 0 && access(destino, W_OK) != 0) || chdir(destino) != 0){
+        perror("diretório");
+        return 1;
+    }
+    mkdir("data", 0755);
+
+    double inicio = bench_agora_ms();
+    uint64_t bytes = gerar(n);
+    if (bytes == 0){
+        perror("gerar");
+        return 1;
+    }
+    printf("%llu pacientes, lista de %.1f MB em %s/data (gerada em %.1f s)\n",
+           (unsigned long long)n, bytes / 1e6, destino, (bench_agora_ms() - inicio) / 1e3);
+
+    const struct { const char* nome; bool (*carregar)(LISTA**, FILA**); } cargas[] = {
+        { "antes (fread + calloc por registro)", carregar_antes },
+        { "depois (mmap, registros no lugar)", LOAD },
+    };
+    for (size_t i = 0; i < sizeof(cargas) / sizeof(cargas[0]); i++){
+        double frio = medir(cargas[i].carregar, true, n);
+        double quente = medir(cargas[i].carregar, false, n);
+        if (frio < 0 || quente < 0) return 1;
+        printf("%-38s frio %8.1f ms   em cache %8.1f ms   %5.2f M pacientes/s\n",
+               cargas[i].nome, frio, quente, n / quente / 1e3);
+    }
+
+    if (argc <= 2){
+        unlink(ARQUIVO_CATALOGO);
+        unlink(ARQUIVO_LISTA);
+        unlink(ARQUIVO_FILA);
+        rmdir("data");
+        chdir("/");
+        rmdir(destino);
+    }
+    return 0;
+}
@@ -0,0 +1,121 @@
+/**
+ * @file cpf.c
+ * @brief Vazão de cpf_validar_lote() nos caminhos escalar, SSSE3 e AVX2.
+ * @details Primeiro confere que os três caminhos dão o mesmo resultado
+ * (cpf_validar_lote(), cpf_normalizar() e cpf_validar()) em entradas
+ * aleatórias: CPFs válidos com e sem pontuação, verificadores trocados,
+ * dígitos repetidos, separadores errados e texto qualquer. Depois mede cada
+ * caminho em lotes de 4096 CPFs válidos, metade formatados ("ddd.ddd.ddd-dd").
+ * Termina com código 1 se algum caminho divergir do escalar.
+ *
+ * Uso: ./bench/cpf [cpfs] [rodadas]
+ */
+
+#include "bench.h"
+#include "../include/cpf.h"
+
+#define LOTE 4096
+
+static const char* const nomes_caminhos[] = { "escalar", "SSSE3", "AVX2" };
+
+/**
+ * @brief Escreve uma entrada aleatória de um dos tipos conferidos.
+ */
+static void entrada_aleatoria(uint64_t* estado, char* e){
+    char cpf[12];
+    uint64_t r = bench_aleatorio(estado);
+    bench_cpf(r >> 20, cpf);
+    switch (r % 8){
+    case 0: strcpy(e, cpf); break;
+    case 1: sprintf(e, "%.3s.%.3s.%.3s-%.2s", cpf, cpf + 3, cpf + 6, cpf + 9); break;
+    case 2: cpf[10] = (char)('0' + (cpf[10] - '0' + 1) % 10); strcpy(e, cpf); break;
+    case 3: cpf[9] = (char)('0' + (cpf[9] - '0' + 1) % 10); sprintf(e, "%.3s.%.3s.%.3s-%.2s", cpf, cpf + 3, cpf + 6, cpf + 9); break;
+    case 4: memset(e, '0' + (int)(r >> 8) % 10, 11); e[11] = '\0'; break;
+    case 5: sprintf(e, "%.3s-%.3s.%.3s.%.2s", cpf, cpf + 3, cpf + 6, cpf + 9); break;
+    case 6: sprintf(e, " %.3s %.3s %.3s %.2s", cpf, cpf + 3, cpf + 6, cpf + 9); break;
+    default: {
+        static const char simbolos[] = "0123456789.- /a";
+        int n = (int)(bench_aleatorio(estado) % 18);
+        for (int i = 0; i < n; i++) e[i] = simbolos[bench_aleatorio(estado) % (sizeof(simbolos) - 1)];
+        e[n] = '\0';
+    }
+    }
+}
+
+int main(int argc, char** argv){
+    size_t n = (size_t)bench_argumento(argc, argv, 1, 4000000);
+    int rodadas = (int)bench_argumento(argc, argv, 2, 5);
+    n = (n + LOTE - 1) / LOTE * LOTE;
+    if (n == 0 || rodadas <= 0) return 1;
+
+    char (*textos)[24] = malloc(n * sizeof(*textos));
+    const char** entradas = (const char**)malloc(n * sizeof(char*));
+    uint64_t* esperado = (uint64_t*)malloc(n * sizeof(uint64_t));
+    uint64_t* obtido = (uint64_t*)malloc(n * sizeof(uint64_t));
+    if (textos == NULL || entradas == NULL || esperado == NULL || obtido == NULL) return 1;
+    for (size_t i = 0; i < n; i++) entradas[i] = textos[i];
+
+    // Conferência: os caminhos SIMD contra o escalar
+    uint64_t estado = 0x243F6A8885A308D3ULL;
+    for (size_t i = 0; i < n; i++) entrada_aleatoria(&estado, textos[i]);
+    cpf_definir_caminho(CPF_CAMINHO_ESCALAR);
+    size_t validos_esperados = 0;
+    for (size_t i = 0; i < n; i += LOTE) validos_esperados += cpf_validar_lote(entradas + i, LOTE, esperado + i);
+
+    CPF_CAMINHO melhor_caminho = cpf_definir_caminho(CPF_CAMINHO_AVX2);
+    int divergencias = 0;
+    for (int c = CPF_CAMINHO_SSSE3; c <= (int)melhor_caminho; c++){
+        cpf_definir_caminho((CPF_CAMINHO)c);
+        size_t validos = 0;
+        for (size_t i = 0; i < n; i += LOTE) validos += cpf_validar_lote(entradas + i, LOTE, obtido + i);
+        for (size_t i = 0; i < n; i++){
+            char normalizado[CPF_DIGITOS + 1], normalizado_escalar[CPF_DIGITOS + 1];
+            bool ok = cpf_normalizar(entradas[i], normalizado);
+            bool valido = ok && cpf_validar(normalizado);
+            cpf_definir_caminho(CPF_CAMINHO_ESCALAR);
+            bool ok_escalar = cpf_normalizar(entradas[i], normalizado_escalar);
+            bool valido_escalar = ok_escalar && cpf_validar(normalizado_escalar);
+            cpf_definir_caminho((CPF_CAMINHO)c);
+            if (obtido[i] != esperado[i] || ok != ok_escalar || valido != valido_escalar ||
+                (ok && strcmp(normalizado, normalizado_escalar) != 0)){
+                if (divergencias++ < 10)
+                    fprintf(stderr, "%s diverge do escalar em \"%s\"\n", nomes_caminhos[c], entradas[i]);
+            }
+        }
+        if (validos != validos_esperados) divergencias++;
+    }
+    printf("Conferência: %zu entradas aleatórias, %zu válidas, %d divergência(s) dos caminhos SIMD\n",
+           n, validos_esperados, divergencias);
+
+    // Medição: CPFs válidos, metade com pontuação
+    for (size_t i = 0; i < n; i++){
+        char cpf[12];
+        bench_cpf(bench_aleatorio(&estado), cpf);
+        if (i % 2) sprintf(textos[i], "%.3s.%.3s.%.3s-%.2s", cpf, cpf + 3, cpf + 6, cpf + 9);
+        else strcpy(textos[i], cpf);
+    }
+    double tempo_escalar = 0;
+    for (int c = CPF_CAMINHO_ESCALAR; c <= (int)melhor_caminho; c++){
+        cpf_definir_caminho((CPF_CAMINHO)c);
+        double melhor = 0;
+        for (int rodada = 0; rodada < rodadas; rodada++){
+            double inicio = bench_agora_ms();
+            size_t validos = 0;
+            for (size_t i = 0; i < n; i += LOTE) validos += cpf_validar_lote(entradas + i, LOTE, obtido + i);
+            double ms = bench_agora_ms() - inicio;
+            if (validos != n){
+                fprintf(stderr, "%s: %zu de %zu CPFs válidos\n", nomes_caminhos[c], validos, n);
+                return 1;
+            }
+            if (rodada == 0 || ms < melhor) melhor = ms;
+        }
+        if (c == CPF_CAMINHO_ESCALAR) tempo_escalar = melhor;
+        printf("%-8s %8.1f ms  %7.1f M CPFs/s  %5.2fx\n", nomes_caminhos[c], melhor, n / melhor / 1e3, tempo_escalar / melhor);
+    }
+
+    free(obtido);
+    free(esperado);
+    free(entradas);
+    free(textos);
+    return divergencias == 0 ? 0 : 1;
+}
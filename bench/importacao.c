@@ -0,0 +1,151 @@
+/**
+ * @file importacao.c
+ * @brief Vazão de importacao_carregar() em CSV e JSON Lines.
+ * @details Gera, em um diretório temporário (ou no indicado), um CSV com
+ * cabeçalho e um JSON Lines com os mesmos N pacientes: CPFs válidos, metade
+ * formatados ("ddd.ddd.ddd-dd"), alguns nomes entre aspas no CSV e, no JSON,
+ * um em cada dez CPFs dado como número. Mede, na melhor de várias rodadas, a
+ * importação de cada arquivo para uma lista vazia, conferindo que todos os
+ * pacientes foram cadastrados. Como na opção do menu, o log de operações
+ * fica aberto: o tempo inclui a escrita dos cadastros nele e a confirmação
+ * (wal_confirmar(), com o `fsync()` de PS_WAL_LOTE). Fora do tempo medido, o
+ * log é reaplicado em estruturas novas e precisa recriar todos os pacientes.
+ *
+ * Uso: ./bench/importacao [pacientes] [rodadas] [diretório]
+ */
+
+#include "bench.h"
+#include "../include/catalogo.h"
+#include "../include/fila.h"
+#include "../include/importacao.h"
+#include "../include/lista.h"
+#include "../include/paciente.h"
+#include "../include/registro.h"
+#include "../include/wal.h"
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define ARQUIVO_CSV "pacientes.csv"
+#define ARQUIVO_JSONL "pacientes.jsonl"
+#define ARQUIVO_LOG "wal.bin"
+
+/**
+ * @brief Gera os dois arquivos com n pacientes.
+ * @return false se algum não pôde ser gravado.
+ */
+static bool gerar(uint64_t n){
+    FILE* csv = fopen(ARQUIVO_CSV, "w");
+    FILE* jsonl = fopen(ARQUIVO_JSONL, "w");
+    if (csv == NULL || jsonl == NULL) return false;
+
+    fprintf(csv, "cpf,nome\n");
+    uint64_t estado = 0x9E3779B97F4A7C15ULL;
+    for (uint64_t i = 0; i < n; i++){
+        char cpf[12], texto[16], nome[PACIENTE_TAM_NOME + 1];
+        bench_cpf(i * 7919 + 1, cpf);
+        bench_nome(&estado, nome, sizeof(nome));
+        if (i % 2) snprintf(texto, sizeof(texto), "%.3s.%.3s.%.3s-%.2s", cpf, cpf + 3, cpf + 6, cpf + 9);
+        else strcpy(texto, cpf);
+
+        if (i % 8 == 0) fprintf(csv, "%s,\"%s\"\n", texto, nome);
+        else fprintf(csv, "%s,%s\n", texto, nome);
+        if (i % 10 == 0) fprintf(jsonl, "{\"cpf\": %llu, \"nome\": \"%s\"}\n", strtoull(cpf, NULL, 10), nome);
+        else fprintf(jsonl, "{\"cpf\": \"%s\", \"nome\": \"%s\"}\n", texto, nome);
+    }
+    bool ok = !ferror(csv) && !ferror(jsonl);
+    return (fclose(csv) == 0) & (fclose(jsonl) == 0) && ok;
+}
+
+/**
+ * @brief Apaga as estruturas e o armazém central.
+ */
+static void apagar(LISTA** lista, FILA** fila){
+    fila_apagar(fila);
+    lista_apagar(lista);
+    registro_apagar();
+    catalogo_apagar();
+}
+
+/**
+ * @brief Mede uma importação para uma lista vazia com o log aberto, conferindo o resultado.
+ * @param tamanho_log Recebe o tamanho do log gravado.
+ * @return Tempo em ms, ou um valor negativo se nem todos foram cadastrados.
+ */
+static double medir(const char* caminho, IMPORTACAO_FORMATO formato, uint64_t n, double* tamanho_log){
+    LISTA* lista = lista_criar();
+    FILA* fila = fila_criar();
+    IMPORTACAO_RESULTADO resultado;
+    unlink(ARQUIVO_LOG);
+    if (!wal_abrir(ARQUIVO_LOG)) return -1;
+
+    double inicio = bench_agora_ms();
+    bool ok = importacao_carregar(caminho, formato, lista, &resultado) && wal_confirmar();
+    double ms = bench_agora_ms() - inicio;
+    wal_fechar();
+
+    if (!ok || resultado.importados != n || registro_quantidade() != n){
+        fprintf(stderr, "%s: %llu de %llu importados (%llu malformados, %llu CPFs inválidos)\n", caminho,
+                (unsigned long long)resultado.importados, (unsigned long long)n,
+                (unsigned long long)resultado.malformados, (unsigned long long)resultado.cpf_invalidos);
+        ms = -1;
+    }
+    apagar(&lista, &fila);
+
+    // O log sozinho recria a importação
+    struct stat info;
+    *tamanho_log = stat(ARQUIVO_LOG, &info) == 0 ? (double)info.st_size : 0;
+    lista = lista_criar();
+    fila = fila_criar();
+    if (ms >= 0 && (!wal_abrir(ARQUIVO_LOG) || wal_reaplicar(lista, fila) < 0 || registro_quantidade() != n)){
+        fprintf(stderr, "%s: o log recriou %u de %llu pacientes\n", caminho, registro_quantidade(), (unsigned long long)n);
+        ms = -1;
+    }
+    wal_fechar();
+    apagar(&lista, &fila);
+    return ms;
+}
+
+int main(int argc, char** argv){
+    uint64_t n = bench_argumento(argc, argv, 1, 1000000);
+    int rodadas = (int)bench_argumento(argc, argv, 2, 3);
+    char diretorio[] = "/tmp/ps_importacao_XXXXXX";
+    const char* destino = argc > 3 ? argv[3] : mkdtemp(diretorio);
+    if (n == 0 || rodadas <= 0 || destino == NULL || (mkdir(destino, 0755) != 0 && access(destino, W_OK) != 0) ||
+        chdir(destino) != 0){
+        perror("diretório");
+        return 1;
+    }
+
+    double inicio = bench_agora_ms();
+    if (!gerar(n)){
+        perror("gerar");
+        return 1;
+    }
+    printf("%llu pacientes gerados em %.1f s, em %s\n", (unsigned long long)n, (bench_agora_ms() - inicio) / 1e3, destino);
+
+    const struct { const char* caminho; IMPORTACAO_FORMATO formato; } arquivos[] = {
+        { ARQUIVO_CSV, IMPORTACAO_CSV },
+        { ARQUIVO_JSONL, IMPORTACAO_JSONL },
+    };
+    for (size_t i = 0; i < sizeof(arquivos) / sizeof(arquivos[0]); i++){
+        struct stat info;
+        double tamanho = stat(arquivos[i].caminho, &info) == 0 ? (double)info.st_size : 0;
+        double melhor = 0, log = 0;
+        for (int r = 0; r < rodadas; r++){
+            double ms = medir(arquivos[i].caminho, arquivos[i].formato, n, &log);
+            if (ms < 0) return 1;
+            if (r == 0 || ms < melhor) melhor = ms;
+        }
+        printf("%-16s %7.1f MB  %8.1f ms  %6.2f M pacientes/s  %7.1f MB/s  log de %.1f MB\n", arquivos[i].caminho,
+               tamanho / 1e6, melhor, n / melhor / 1e3, tamanho / melhor / 1e3, log / 1e6);
+    }
+
+    if (argc <= 3){
+        unlink(ARQUIVO_CSV);
+        unlink(ARQUIVO_JSONL);
+        unlink(ARQUIVO_LOG);
+        if (chdir("/") == 0)
+            rmdir(destino);
+    }
+    return 0;
+}
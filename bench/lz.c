@@ -0,0 +1,186 @@
+/**
+ * @file lz.c
+ * @brief Taxa de compressão e vazão de lz_comprimir() e lz_descomprimir().
+ * @details Os dados são os de um arquivo passado na linha de comando (por
+ * exemplo um data/lista_itens.bin gravado sem PS_COMPRESSAO) ou, sem
+ * arquivo, N registros de pacientes gerados como o SAVE os grava em cada
+ * bloco da lista: [TAMANHO (uint32)][CPF empacotado (uint64)][CPF, nome e
+ * códigos do histórico], em ordem crescente de CPF (200000 por padrão).
+ *
+ * Os dados são cortados em trechos de dois tamanhos: o espaço de registros de
+ * um bloco do arquivo (4080 bytes, como em arquivo.c) e
+ * LZ_MAX_ENTRADA. Como em arquivo.c, um trecho que não fica menor é guardado
+ * sem compressão. Para cada tamanho são medidas, na melhor de várias
+ * rodadas, a compressão e a descompressão de todos os trechos, e cada trecho
+ * é conferido byte a byte depois de descomprimido.
+ *
+ * Uso: ./bench/lz [arquivo|-pacientes N] [rodadas]
+ */
+
+#include "bench.h"
+#include "../include/cpf.h"
+#include "../include/historico.h"
+#include "../include/lz.h"
+#include "../include/paciente.h"
+
+#define TAM_REGISTROS_BLOCO 4080 ///< Bytes de registros por bloco (ARQUIVO_CAPACIDADE_BLOCO em arquivo.c)
+
+/**
+ * @brief Lê um arquivo inteiro para a memória.
+ */
+static char* ler_arquivo(const char* caminho, size_t* tamanho){
+    FILE* f = fopen(caminho, "rb");
+    if (f == NULL) return NULL;
+    char* dados = NULL;
+    if (fseek(f, 0, SEEK_END) == 0){
+        long n = ftell(f);
+        if (n > 0 && fseek(f, 0, SEEK_SET) == 0 && (dados = (char*)malloc((size_t)n)) != NULL &&
+            fread(dados, 1, (size_t)n, f) != (size_t)n){
+            free(dados);
+            dados = NULL;
+        }
+        *tamanho = n > 0 ? (size_t)n : 0;
+    }
+    fclose(f);
+    return dados;
+}
+
+/**
+ * @brief Gera n registros de pacientes no formato dos blocos da lista.
+ * @details Os registros ficam um atrás do outro, sem o fim zerado de cada
+ * bloco: arquivo.c comprime só os bytes usados do bloco.
+ */
+static char* gerar_registros(size_t n, size_t* tamanho){
+    const size_t maximo = 12 + 12 + PACIENTE_TAM_NOME + 1 + HISTORICO_MAX * sizeof(uint32_t);
+    size_t capacidade = n * maximo / 4 + 4096, total = 0;
+    char* dados = (char*)malloc(capacidade);
+    if (dados == NULL) return NULL;
+
+    uint64_t estado = 0x9E3779B97F4A7C15ULL;
+    for (size_t i = 0; i < n; i++){
+        if (capacidade - total < maximo){
+            char* maior = (char*)realloc(dados, capacidade *= 2);
+            if (maior == NULL){
+                free(dados);
+                return NULL;
+            }
+            dados = maior;
+        }
+        char* r = dados + total + 12;
+        bench_cpf(i * 7919 + 1, r);
+        uint64_t chave = cpf_empacotar(r);
+        uint32_t tam = 12 + (uint32_t)bench_nome(&estado, r + 12, PACIENTE_TAM_NOME + 1) + 1;
+        int n_codigos = (int)(bench_aleatorio(&estado) % (HISTORICO_MAX + 1));
+        for (int c = 0; c < n_codigos; c++){
+            uint32_t codigo = 1 + (uint32_t)(bench_aleatorio(&estado) % 9);
+            memcpy(r + tam, &codigo, sizeof(codigo));
+            tam += sizeof(codigo);
+        }
+        memcpy(dados + total, &tam, sizeof(uint32_t));
+        memcpy(dados + total + 4, &chave, sizeof(uint64_t));
+        total += 12 + tam;
+    }
+    *tamanho = total;
+    return dados;
+}
+
+int main(int argc, char** argv){
+    size_t tamanho = 0;
+    char* dados;
+    const char* origem;
+    char descricao[64];
+    if (argc > 2 && strcmp(argv[1], "-pacientes") == 0){
+        size_t n = (size_t)strtoull(argv[2], NULL, 10);
+        dados = gerar_registros(n, &tamanho);
+        snprintf(descricao, sizeof(descricao), "%zu pacientes gerados", n);
+        origem = descricao;
+        argv += 2;
+        argc -= 2;
+    } else if (argc > 1){
+        dados = ler_arquivo(argv[1], &tamanho);
+        origem = argv[1];
+        argv++;
+        argc--;
+    } else {
+        dados = gerar_registros(200000, &tamanho);
+        origem = "200000 pacientes gerados";
+    }
+    int rodadas = (int)bench_argumento(argc, argv, 1, 5);
+    if (dados == NULL || tamanho == 0 || rodadas <= 0){
+        fprintf(stderr, "sem dados para comprimir\n");
+        return 1;
+    }
+    printf("%s: %.1f MB\n", origem, tamanho / 1e6);
+
+    const uint32_t trechos[] = { TAM_REGISTROS_BLOCO, LZ_MAX_ENTRADA };
+    size_t n_maximo = tamanho / TAM_REGISTROS_BLOCO + 1;
+    char* comprimidos = (char*)malloc(tamanho + n_maximo);
+    char* volta = (char*)malloc(LZ_MAX_ENTRADA);
+    uint32_t* tamanhos = (uint32_t*)malloc(n_maximo * sizeof(uint32_t));
+    if (comprimidos == NULL || volta == NULL || tamanhos == NULL) return 1;
+
+    printf("trecho (bytes)  taxa   guardados sem compressão   compressão MB/s   descompressão MB/s\n");
+    for (size_t t = 0; t < sizeof(trechos) / sizeof(trechos[0]); t++){
+        uint32_t trecho = trechos[t];
+        size_t n = (tamanho + trecho - 1) / trecho, total = 0, crus = 0;
+        double melhor_c = 0, melhor_d = 0;
+
+        for (int rodada = 0; rodada < rodadas; rodada++){
+            // Compressão: cada trecho em sequência no destino, como os blocos no arquivo
+            double inicio = bench_agora_ms();
+            total = 0;
+            crus = 0;
+            for (size_t i = 0; i < n; i++){
+                uint32_t tam = (uint32_t)(i + 1 < n ? trecho : tamanho - i * trecho);
+                uint32_t c = tam > 1 ? lz_comprimir(dados + i * trecho, tam, comprimidos + total, tam - 1) : 0;
+                if (c == 0){
+                    memcpy(comprimidos + total, dados + i * trecho, tam);
+                    c = tam;
+                    crus++;
+                }
+                tamanhos[i] = c;
+                total += c;
+            }
+            double ms_c = bench_agora_ms() - inicio;
+
+            inicio = bench_agora_ms();
+            size_t pos = 0;
+            for (size_t i = 0; i < n; i++){
+                uint32_t tam = (uint32_t)(i + 1 < n ? trecho : tamanho - i * trecho);
+                if (tamanhos[i] < tam && !lz_descomprimir(comprimidos + pos, tamanhos[i], volta, tam)){
+                    fprintf(stderr, "trecho %zu recusado na descompressão\n", i);
+                    return 1;
+                }
+                pos += tamanhos[i];
+            }
+            double ms_d = bench_agora_ms() - inicio;
+
+            if (rodada == 0 || ms_c < melhor_c) melhor_c = ms_c;
+            if (rodada == 0 || ms_d < melhor_d) melhor_d = ms_d;
+        }
+
+        // Conferência, fora do tempo medido
+        size_t pos = 0;
+        for (size_t i = 0; i < n; i++){
+            uint32_t tam = (uint32_t)(i + 1 < n ? trecho : tamanho - i * trecho);
+            const char* original = dados + i * trecho;
+            bool igual = tamanhos[i] == tam ? memcmp(comprimidos + pos, original, tam) == 0
+                                            : lz_descomprimir(comprimidos + pos, tamanhos[i], volta, tam) &&
+                                              memcmp(volta, original, tam) == 0;
+            if (!igual){
+                fprintf(stderr, "trecho %zu não voltou igual\n", i);
+                return 1;
+            }
+            pos += tamanhos[i];
+        }
+
+        printf("%14u  %5.2fx  %10zu de %-10zu   %15.1f   %18.1f\n", trecho, (double)tamanho / total, crus, n,
+               tamanho / melhor_c / 1e3, tamanho / melhor_d / 1e3);
+    }
+
+    free(tamanhos);
+    free(volta);
+    free(comprimidos);
+    free(dados);
+    return 0;
+}
@@ -0,0 +1,87 @@
+/**
+ * @file paciente.c
+ * @brief Vazão de paciente_de_bytes(): registros interpretados por segundo.
+ * @details Monta em memória N registros serializados (CPF, nome e até
+ * HISTORICO_MAX códigos do catálogo) e mede, em várias rodadas, a
+ * interpretação só do registro (paciente_de_bytes_sem_registro()) e com o
+ * registro no armazém central (paciente_de_bytes()). A liberação dos
+ * pacientes fica fora do tempo medido.
+ *
+ * Uso: ./bench/paciente [registros] [rodadas]
+ */
+
+#include "bench.h"
+#include "../include/catalogo.h"
+#include "../include/paciente.h"
+
+static const char* const procedimentos[] = { "Raio-X do tórax", "Hemograma completo", "Tomografia",
+                                             "Sutura", "Eletrocardiograma", "Medicação intravenosa",
+                                             "Ultrassonografia abdominal", "Curativo", "Glicemia capilar" };
+
+int main(int argc, char** argv){
+    size_t n = (size_t)bench_argumento(argc, argv, 1, 1000000);
+    int rodadas = (int)bench_argumento(argc, argv, 2, 5);
+    if (n == 0 || rodadas <= 0) return 1;
+
+    uint32_t codigos[sizeof(procedimentos) / sizeof(procedimentos[0])];
+    for (size_t i = 0; i < sizeof(procedimentos) / sizeof(procedimentos[0]); i++)
+        codigos[i] = catalogo_internar(procedimentos[i]);
+
+    // Registros: 12 (CPF) + nome + '\0' + códigos, um atrás do outro
+    size_t capacidade = n * (12 + PACIENTE_TAM_NOME + 1 + HISTORICO_MAX * sizeof(uint32_t)) / 4 + 4096;
+    char* dados = (char*)malloc(capacidade);
+    uint32_t* tamanhos = (uint32_t*)malloc(n * sizeof(uint32_t));
+    PACIENTE** pacientes = (PACIENTE**)malloc(n * sizeof(PACIENTE*));
+    if (dados == NULL || tamanhos == NULL || pacientes == NULL) return 1;
+
+    uint64_t estado = 0x9E3779B97F4A7C15ULL;
+    size_t total = 0;
+    for (size_t i = 0; i < n; i++){
+        if (capacidade - total < 12 + PACIENTE_TAM_NOME + 1 + HISTORICO_MAX * sizeof(uint32_t)){
+            capacidade *= 2;
+            if ((dados = (char*)realloc(dados, capacidade)) == NULL) return 1;
+        }
+        char* r = dados + total;
+        bench_cpf(i * 7919 + 1, r);
+        size_t tam_nome = bench_nome(&estado, r + 12, PACIENTE_TAM_NOME + 1);
+        size_t tam = 12 + tam_nome + 1;
+        int n_codigos = (int)(bench_aleatorio(&estado) % (HISTORICO_MAX + 1));
+        for (int c = 0; c < n_codigos; c++){
+            uint32_t codigo = codigos[bench_aleatorio(&estado) % (sizeof(codigos) / sizeof(codigos[0]))];
+            memcpy(r + tam, &codigo, sizeof(codigo));
+            tam += sizeof(codigo);
+        }
+        tamanhos[i] = (uint32_t)tam;
+        total += tam;
+    }
+    printf("%zu registros, %.1f MB\n", n, total / 1e6);
+
+    for (int registrar = 0; registrar <= 1; registrar++){
+        double melhor = 0;
+        for (int rodada = 0; rodada < rodadas; rodada++){
+            const char* r = dados;
+            double inicio = bench_agora_ms();
+            for (size_t i = 0; i < n; i++){
+                pacientes[i] = registrar ? paciente_de_bytes(r, tamanhos[i]) : paciente_de_bytes_sem_registro(r, tamanhos[i]);
+                r += tamanhos[i];
+            }
+            double ms = bench_agora_ms() - inicio;
+            for (size_t i = 0; i < n; i++){
+                if (pacientes[i] == NULL){
+                    fprintf(stderr, "registro %zu rejeitado\n", i);
+                    return 1;
+                }
+                paciente_apagar(&pacientes[i]);
+            }
+            if (rodada == 0 || ms < melhor) melhor = ms;
+        }
+        printf("%-30s %8.1f ms  %6.2f M registros/s  %7.1f MB/s\n",
+               registrar ? "paciente_de_bytes" : "paciente_de_bytes_sem_registro",
+               melhor, n / melhor / 1e3, total / melhor / 1e3);
+    }
+
+    free(pacientes);
+    free(tamanhos);
+    free(dados);
+    return 0;
+}
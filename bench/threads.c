@@ -0,0 +1,160 @@
+/**
+ * @file threads.c
+ * @brief Tempo do LOAD e do SAVE com 1, 2, 4 e 8 threads (PS_THREADS).
+ * @details Monta em memória N pacientes (com até HISTORICO_MAX procedimentos
+ * e 1% deles na fila), grava uma vez os arquivos no formato versionado, em
+ * um diretório temporário (ou no indicado), e então, para cada quantidade de
+ * threads, mede o SAVE das estruturas montadas e o LOAD dos arquivos
+ * gravados em estruturas novas, conferindo as quantidades carregadas. Cada
+ * medida é a melhor de algumas rodadas, com os arquivos em cache.
+ *
+ * tarefas_executar() cria e junta as threads a cada chamada (não há um
+ * conjunto fixo de threads): esse custo está incluído nos tempos, assim como
+ * o `fsync()` de cada arquivo no SAVE.
+ *
+ * Uso: ./bench/threads [pacientes] [rodadas] [diretório]
+ */
+
+#include "bench.h"
+#include "../include/IO.h"
+#include "../include/catalogo.h"
+#include "../include/fila.h"
+#include "../include/historico.h"
+#include "../include/lista.h"
+#include "../include/paciente.h"
+#include "../include/registro.h"
+#include "../include/tarefas.h"
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char* const procedimentos[] = { "Raio-X do tórax", "Hemograma completo", "Tomografia",
+                                             "Sutura", "Eletrocardiograma", "Medicação intravenosa",
+                                             "Ultrassonografia abdominal", "Curativo", "Glicemia capilar" };
+
+static const char* const arquivos[] = { "data/catalogo.bin", "data/lista_itens.bin", "data/fila_itens.bin",
+                                        "data/bloom.bin" };
+
+/**
+ * @brief Monta a lista e a fila com n pacientes.
+ */
+static bool montar(uint64_t n, LISTA* lista, FILA* fila){
+    uint32_t codigos[sizeof(procedimentos) / sizeof(procedimentos[0])];
+    for (size_t i = 0; i < sizeof(codigos) / sizeof(codigos[0]); i++)
+        codigos[i] = catalogo_internar(procedimentos[i]);
+
+    uint64_t estado = 0x9E3779B97F4A7C15ULL;
+    for (uint64_t i = 0; i < n; i++){
+        char cpf[12], nome[PACIENTE_TAM_NOME + 1];
+        bench_cpf(i * 7919 + 1, cpf);
+        bench_nome(&estado, nome, sizeof(nome));
+        PACIENTE* pac = paciente_criar(nome, cpf);
+        if (pac == NULL || !lista_inserir(lista, pac)) return false;
+
+        int n_codigos = (int)(bench_aleatorio(&estado) % (HISTORICO_MAX + 1));
+        for (int c = 0; c < n_codigos; c++)
+            historico_inserir_codigo(paciente_obter_historico(pac),
+                                     codigos[bench_aleatorio(&estado) % (sizeof(codigos) / sizeof(codigos[0]))]);
+        if (i % 100 == 0 && !fila_inserir(fila, pac, (int)(bench_aleatorio(&estado) % 5))) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Mede um LOAD em estruturas novas, conferindo as quantidades carregadas.
+ * @return Tempo em ms, ou um valor negativo se a carga não conferir.
+ */
+static double medir_load(uint64_t n){
+    LISTA* lista = lista_criar();
+    FILA* fila = fila_criar();
+
+    double inicio = bench_agora_ms();
+    bool ok = LOAD(&lista, &fila);
+    double ms = bench_agora_ms() - inicio;
+
+    if (!ok || registro_quantidade() != n || registro_contar_na_fila() != (n + 99) / 100){
+        fprintf(stderr, "carga incompleta: %u pacientes, %u na fila\n", registro_quantidade(), registro_contar_na_fila());
+        ms = -1;
+    }
+    fila_apagar(&fila);
+    lista_apagar(&lista);
+    registro_apagar();
+    catalogo_apagar();
+    return ms;
+}
+
+int main(int argc, char** argv){
+    uint64_t n = bench_argumento(argc, argv, 1, 1000000);
+    int rodadas = (int)bench_argumento(argc, argv, 2, 3);
+    char diretorio[] = "/tmp/ps_threads_XXXXXX";
+    const char* destino = argc > 3 ? argv[3] : mkdtemp(diretorio);
+    if (n == 0 || rodadas <= 0 || destino == NULL || (mkdir(destino, 0755) != 0 && access(destino, W_OK) != 0) ||
+        chdir(destino) != 0){
+        perror("diretório");
+        return 1;
+    }
+    mkdir("data", 0755);
+
+    double inicio = bench_agora_ms();
+    LISTA* lista = lista_criar();
+    FILA* fila = fila_criar();
+    if (!montar(n, lista, fila)){
+        fprintf(stderr, "falha ao montar os pacientes\n");
+        return 1;
+    }
+    printf("%llu pacientes montados em %.1f s, em %s/data; %ld processador(es)\n",
+           (unsigned long long)n, (bench_agora_ms() - inicio) / 1e3, destino, sysconf(_SC_NPROCESSORS_ONLN));
+
+    // Medidas de SAVE com as estruturas montadas; as de LOAD, depois, em estruturas novas
+    static const int quantidades[] = { 1, 2, 4, 8 };
+    const int n_quantidades = (int)(sizeof(quantidades) / sizeof(quantidades[0]));
+    double save[8], load[8];
+    for (int q = 0; q < n_quantidades; q++){
+        char valor[8];
+        snprintf(valor, sizeof(valor), "%d", quantidades[q]);
+        setenv(TAREFAS_VARIAVEL, valor, 1);
+        save[q] = 0;
+        for (int r = 0; r < rodadas; r++){
+            double t = bench_agora_ms();
+            if (!SAVE(&lista, &fila)){
+                fprintf(stderr, "SAVE falhou com %d thread(s)\n", quantidades[q]);
+                return 1;
+            }
+            t = bench_agora_ms() - t;
+            if (r == 0 || t < save[q]) save[q] = t;
+        }
+    }
+    fila_apagar(&fila);
+    lista_apagar(&lista);
+    registro_apagar();
+    catalogo_apagar();
+
+    struct stat info;
+    if (stat("data/lista_itens.bin", &info) == 0)
+        printf("lista de %.1f MB\n", info.st_size / 1e6);
+
+    for (int q = 0; q < n_quantidades; q++){
+        char valor[8];
+        snprintf(valor, sizeof(valor), "%d", quantidades[q]);
+        setenv(TAREFAS_VARIAVEL, valor, 1);
+        load[q] = 0;
+        for (int r = 0; r < rodadas; r++){
+            double t = medir_load(n);
+            if (t < 0) return 1;
+            if (r == 0 || t < load[q]) load[q] = t;
+        }
+    }
+
+    printf("threads      LOAD (ms)  acel.      SAVE (ms)  acel.\n");
+    for (int q = 0; q < n_quantidades; q++)
+        printf("%7d  %13.1f  %5.2fx  %13.1f  %5.2fx\n", quantidades[q],
+               load[q], load[0] / load[q], save[q], save[0] / save[q]);
+
+    if (argc <= 3){
+        for (size_t i = 0; i < sizeof(arquivos) / sizeof(arquivos[0]); i++)
+            unlink(arquivos[i]);
+        rmdir("data");
+        if (chdir("/") == 0)
+            rmdir(destino);
+    }
+    return 0;
+}
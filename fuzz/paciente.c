@@ -0,0 +1,131 @@
+/**
+ * @file paciente.c
+ * @brief Alvo de fuzzing de paciente_de_bytes(ptr, len).
+ * @details Cada entrada é copiada para um buffer do tamanho exato (para que
+ * o AddressSanitizer acuse qualquer leitura além do registro) e interpretada.
+ * Um registro aceito precisa voltar idêntico por paciente_para_string().
+ * Os códigos 1 a 3 do catálogo existem, então registros com histórico também
+ * são exercitados.
+ *
+ * - libFuzzer: "make fuzz" e depois ./fuzz/paciente [diretório do corpus]
+ * - AFL ou reprodução: "make fuzz_main"; ./fuzz/paciente_main lê a entrada de
+ *   cada arquivo passado (ou da entrada padrão), e ./fuzz/paciente_main
+ *   -aleatorio N [semente] aplica N mutações aleatórias a registros válidos.
+ */
+
+#include "../include/catalogo.h"
+#include "../include/paciente.h"
+
+int LLVMFuzzerTestOneInput(const uint8_t* dados, size_t tamanho);
+
+int LLVMFuzzerTestOneInput(const uint8_t* dados, size_t tamanho){
+    static bool iniciado = false;
+    if (!iniciado){
+        catalogo_internar("Raio-X");
+        catalogo_internar("Hemograma");
+        catalogo_internar("Sutura");
+        iniciado = true;
+    }
+
+    char* copia = (char*)malloc(tamanho ? tamanho : 1);
+    if (copia == NULL) return 0;
+    memcpy(copia, dados, tamanho);
+
+    PACIENTE* p = paciente_de_bytes(copia, tamanho);
+    if (p != NULL){
+        int tamanho_volta = 0;
+        char* volta = paciente_para_string(p, &tamanho_volta);
+        if (volta == NULL || (size_t)tamanho_volta != tamanho || memcmp(volta, copia, tamanho) != 0)
+            abort();
+        free(volta);
+        paciente_apagar(&p);
+    }
+
+    free(copia);
+    return 0;
+}
+
+#ifdef FUZZ_MAIN
+
+/**
+ * @brief Executa o alvo sobre o conteúdo de um arquivo.
+ */
+static int fuzz_arquivo(FILE* f){
+    size_t capacidade = 4096, n = 0, lidos;
+    uint8_t* dados = (uint8_t*)malloc(capacidade);
+    if (dados == NULL) return 1;
+    while ((lidos = fread(dados + n, 1, capacidade - n, f)) > 0){
+        n += lidos;
+        if (n == capacidade){
+            uint8_t* maior = (uint8_t*)realloc(dados, capacidade *= 2);
+            if (maior == NULL){
+                free(dados);
+                return 1;
+            }
+            dados = maior;
+        }
+    }
+    LLVMFuzzerTestOneInput(dados, n);
+    free(dados);
+    return 0;
+}
+
+/**
+ * @brief Mutações aleatórias (troca, inserção e remoção de bytes, corte) de registros válidos.
+ */
+static void fuzz_aleatorio(unsigned long n, uint64_t estado){
+    static const uint8_t semente[] = "12345678909\0Maria da Silva\0\1\0\0\0\2\0\0\0";
+    uint8_t dados[512];
+
+    for (unsigned long i = 0; i < n; i++){
+        size_t tamanho = sizeof(semente) - 1;
+        memcpy(dados, semente, tamanho);
+        int mutacoes = 1 + (int)(estado % 8);
+        for (int m = 0; m < mutacoes; m++){
+            estado ^= estado << 13;
+            estado ^= estado >> 7;
+            estado ^= estado << 17;
+            size_t pos = tamanho ? (size_t)(estado >> 8) % tamanho : 0;
+            switch ((estado >> 4) % 5){
+            case 0: if (tamanho) dados[pos] = (uint8_t)(estado >> 32); break;
+            case 1: if (tamanho) dados[pos] ^= (uint8_t)(1u << ((estado >> 40) % 8)); break;
+            case 2:
+                if (tamanho < sizeof(dados)){
+                    memmove(dados + pos + 1, dados + pos, tamanho - pos);
+                    dados[pos] = (uint8_t)(estado >> 24);
+                    tamanho++;
+                }
+                break;
+            case 3:
+                if (tamanho){
+                    memmove(dados + pos, dados + pos + 1, tamanho - pos - 1);
+                    tamanho--;
+                }
+                break;
+            case 4: tamanho = pos; break;
+            }
+        }
+        LLVMFuzzerTestOneInput(dados, tamanho);
+    }
+}
+
+int main(int argc, char** argv){
+    if (argc >= 3 && strcmp(argv[1], "-aleatorio") == 0){
+        fuzz_aleatorio(strtoul(argv[2], NULL, 10), argc >= 4 ? strtoull(argv[3], NULL, 10) | 1 : 0x9E3779B97F4A7C15ULL);
+        return 0;
+    }
+    if (argc < 2)
+        return fuzz_arquivo(stdin);
+    for (int i = 1; i < argc; i++){
+        FILE* f = fopen(argv[i], "rb");
+        if (f == NULL){
+            perror(argv[i]);
+            return 1;
+        }
+        fuzz_arquivo(f);
+        fclose(f);
+    }
+    return 0;
+}
+
+#endif
@@ -7,7 +7,21 @@
     #include <string.h>
     #include <stdbool.h>
 
+    #define IO_VARIAVEL_CACHE "PS_CACHE_PACIENTES" ///< Pacientes em cache no modo sob demanda (ausente = carregar tudo)
+    #define IO_VARIAVEL_COMPRESSAO "PS_COMPRESSAO"  ///< "1" grava os blocos dos arquivos de dados comprimidos
+    #define IO_VARIAVEL_INCREMENTAL "PS_SAVE_INCREMENTAL" ///< "1" regrava só os blocos da lista com pacientes alterados
+
     bool SAVE(LISTA **lista, FILA **fila); 
     bool LOAD(LISTA **lista, FILA **fila); 
+    bool IO_copiar_dados(const char *diretorio);
+    bool IO_carregar_de(const char *diretorio, LISTA **lista, FILA **fila);
+    bool IO_formato_antigo(void);
+    int IO_blocos_corrompidos(void);
+    bool IO_sob_demanda(void);
+    bool IO_abrir_heap(LISTA **lista, FILA **fila);
+    bool IO_heap_em_uso(void);
+    bool IO_travar(LISTA *lista, FILA *fila);
+    void IO_destravar(LISTA *lista, FILA *fila);
+    bool IO_fechar_heap(LISTA *lista, FILA *fila, bool salvo);
 	  
 #endif
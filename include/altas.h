@@ -0,0 +1,48 @@
+#ifndef ALTAS_H
+    #define ALTAS_H
+
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdbool.h>
+    #include <stdint.h>
+
+    #define ALTAS_DIRETORIO "data/altas"                          ///< Arquivo de atendimentos encerrados, uma coluna por arquivo
+    #define ALTAS_PROCEDIMENTOS "data/altas/procedimentos.bin"    ///< Descrições dos códigos da coluna de procedimentos
+    #define ALTAS_ESPERA_DESCONHECIDA UINT32_MAX                  ///< Espera de um paciente sem horário de chegada
+    #define ALTAS_SEM_PROCEDIMENTO 0                              ///< Alta sem procedimento registrado
+
+    /**
+     * @brief Filtro de uma varredura das altas.
+     */
+    typedef struct altas_filtro_ {
+        int64_t de;           ///< Primeira alta considerada (time_t; 0 = desde o início)
+        int64_t ate;          ///< Altas anteriores a este instante (time_t; 0 = até o fim)
+        uint8_t prioridades;  ///< Bit p - 1 ligado = considera a prioridade p (0 = todas)
+    } ALTAS_FILTRO;
+
+    /**
+     * @brief Altas e espera somadas de um mês, por prioridade.
+     */
+    typedef struct altas_mes_ {
+        int ano;                  ///< Ano (ex.: 2026)
+        int mes;                  ///< Mês (1 a 12)
+        uint64_t altas[5];        ///< Altas de cada prioridade
+        uint64_t com_espera[5];   ///< Altas com horário de chegada conhecido
+        uint64_t soma_espera[5];  ///< Soma das esperas conhecidas, em segundos
+    } ALTAS_MES;
+
+    /**
+     * @brief Medições de uma varredura.
+     */
+    typedef struct altas_varredura_ {
+        uint64_t linhas;       ///< Altas percorridas
+        uint64_t selecionadas; ///< Altas que passaram pelo filtro
+        double duracao_ms;     ///< Tempo da varredura
+    } ALTAS_VARREDURA;
+
+    bool altas_registrar(uint64_t cpf, int prioridade, int64_t chegada, int64_t saida, const char* procedimento);
+    void altas_encerrar(void);
+    bool altas_espera_mensal(const ALTAS_FILTRO* filtro, ALTAS_MES** meses, int* quantidade, ALTAS_VARREDURA* medida);
+    void altas_imprimir_espera_mensal(const ALTAS_FILTRO* filtro);
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef ARQUIVO_H
+    #define ARQUIVO_H
+
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdbool.h>
+    #include <stdint.h>
+    #include <string.h>
+    #include "paciente.h"
+
+    #define ARQUIVO_MAGICA "PSHOSPDB"       ///< Assinatura dos 8 primeiros bytes
+    #define ARQUIVO_VERSAO 1                ///< Versão do formato com blocos sem compressão
+    #define ARQUIVO_VERSAO_COMPRIMIDA 2     ///< Versão do formato com ARQUIVO_OPCAO_LZ
+    #define ARQUIVO_ORDEM_BYTES 0x01020304u ///< Lido de volta igual só na mesma ordem de bytes
+    #define ARQUIVO_TAM_BLOCO 4096          ///< Tamanho de cada bloco em disco
+    #define ARQUIVO_MAX_PREFIXO 32          ///< Maior prefixo copiado por registro (ver arquivo_escrever())
+
+    #define ARQUIVO_TIPO_LISTA 1 ///< Pacientes em ordem crescente de CPF
+    #define ARQUIVO_TIPO_FILA 2  ///< Entradas da fila em ordem de atendimento
+
+    #define ARQUIVO_OPCAO_LZ 0x01      ///< Registros de cada bloco comprimidos (ver lz.c)
+    #define ARQUIVO_OPCAO_PAGINAS 0x02 ///< Blocos fora de ordem, com mapa de páginas livres (ver arquivo_atualizar())
+
+    /**
+     * @brief Resultado da abertura de um arquivo de dados.
+     */
+    typedef enum {
+        ARQUIVO_OK,             ///< Cabeçalho e índice válidos
+        ARQUIVO_AUSENTE,        ///< O arquivo não existe
+        ARQUIVO_FORMATO_ANTIGO, ///< Sem assinatura: sequência de registros anterior ao formato versionado
+        ARQUIVO_TRUNCADO,       ///< Índice ausente ou inválido: os blocos são percorridos em sequência
+        ARQUIVO_INCOMPATIVEL,   ///< Versão, tipo ou ordem de bytes diferentes
+        ARQUIVO_CORROMPIDO      ///< Cabeçalho inválido
+    } ARQUIVO_ESTADO;
+
+    typedef struct arquivo_ ARQUIVO;
+    typedef struct arquivo_escritor_ ARQUIVO_ESCRITOR;
+    typedef struct arquivo_lote_ ARQUIVO_LOTE;
+    typedef struct arquivo_atualizacao_ ARQUIVO_ATUALIZACAO;
+
+    ARQUIVO_ESCRITOR* arquivo_criar(const char* caminho, uint16_t tipo, uint32_t opcoes);
+    bool arquivo_escrever(ARQUIVO_ESCRITOR* esc, uint64_t chave, const void* prefixo, uint32_t tam_prefixo,
+                          const SEGMENTO segmentos[], int n);
+    bool arquivo_escrever_copia(ARQUIVO_ESCRITOR* esc, uint64_t chave, const char* bytes, uint32_t tamanho);
+    uint64_t arquivo_escritor_assinatura(ARQUIVO_ESCRITOR* esc);
+    void arquivo_definir_ponto(ARQUIVO_ESCRITOR* esc, uint64_t ponto);
+    bool arquivo_finalizar(ARQUIVO_ESCRITOR** esc);
+
+    ARQUIVO_LOTE* arquivo_lote_criar(uint32_t opcoes);
+    bool arquivo_lote_escrever(ARQUIVO_LOTE* lote, uint64_t chave, const void* prefixo, uint32_t tam_prefixo,
+                               const SEGMENTO segmentos[], int n);
+    bool arquivo_anexar_lote(ARQUIVO_ESCRITOR* esc, ARQUIVO_LOTE* lote);
+    void arquivo_lote_apagar(ARQUIVO_LOTE** lote);
+
+    ARQUIVO_ATUALIZACAO* arquivo_atualizar(const char* caminho, uint16_t tipo);
+    void arquivo_atualizacao_definir_ponto(ARQUIVO_ATUALIZACAO* atu, uint64_t ponto);
+    double arquivo_atualizacao_livre(ARQUIVO_ATUALIZACAO* atu);
+    uint64_t arquivo_atualizacao_localizar(ARQUIVO_ATUALIZACAO* atu, uint64_t chave);
+    bool arquivo_atualizacao_bloco(ARQUIVO_ATUALIZACAO* atu, uint64_t i, const char** dados, uint32_t* tamanho);
+    bool arquivo_substituir_bloco(ARQUIVO_ATUALIZACAO* atu, uint64_t i, ARQUIVO_LOTE* lote);
+    bool arquivo_atualizacao_concluir(ARQUIVO_ATUALIZACAO** atu, uint64_t* assinatura);
+    void arquivo_atualizacao_descartar(ARQUIVO_ATUALIZACAO** atu);
+
+    ARQUIVO* arquivo_abrir(const char* caminho, uint16_t tipo, ARQUIVO_ESTADO* estado);
+    uint64_t arquivo_blocos(ARQUIVO* arq);
+    uint64_t arquivo_registros(ARQUIVO* arq);
+    uint64_t arquivo_assinatura(ARQUIVO* arq);
+    uint64_t arquivo_ponto(ARQUIVO* arq);
+    bool arquivo_bloco(ARQUIVO* arq, uint64_t i, char* area, const char** dados, uint32_t* tamanho);
+    bool arquivo_proximo(const char* dados, uint32_t tamanho, uint32_t* pos,
+                         uint64_t* chave, const char** registro, uint32_t* tam_registro);
+    bool arquivo_buscar(ARQUIVO* arq, uint64_t chave, const char** registro, uint32_t* tam_registro);
+    void arquivo_fechar(ARQUIVO** arq);
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef AUDITORIA_H
+    #define AUDITORIA_H
+
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdbool.h>
+    #include <stdint.h>
+    #include "fila.h"
+    #include "lista.h"
+
+    #define AUDITORIA_VARIAVEL "PS_AUDITORIA"                   ///< "1" guarda todas as operações e pontos de restauração
+    #define AUDITORIA_VARIAVEL_PONTO "PS_AUDITORIA_PONTO"       ///< KB de operações guardadas entre dois pontos de restauração (padrão 1024)
+    #define AUDITORIA_VARIAVEL_INSTANTE "PS_AUDITORIA_INSTANTE" ///< "AAAA-MM-DD HH:MM[:SS]": abre, somente leitura, o estado daquele instante
+    #define AUDITORIA_DIRETORIO "data/auditoria"                ///< Operações guardadas e pontos de restauração
+    #define AUDITORIA_EVENTOS "data/auditoria/eventos.bin"      ///< Todas as operações descartadas do log, em ordem
+    #define AUDITORIA_PONTOS "data/auditoria/pontos.bin"        ///< Índice dos pontos de restauração
+
+    /**
+     * @brief Medições da reconstrução de um instante passado.
+     */
+    typedef struct auditoria_relatorio_ {
+        int ponto;               ///< Ponto de restauração usado (-1 = nenhum anterior ao instante)
+        int64_t instante_ponto;  ///< Instante (time_t) do ponto de restauração
+        uint64_t operacoes;      ///< Operações reaplicadas depois do ponto
+        double duracao_ms;       ///< Tempo da reaplicação das operações
+    } AUDITORIA_RELATORIO;
+
+    bool auditoria_configurar(void);
+    bool auditoria_ativa(void);
+    bool auditoria_consulta(void);
+    int64_t auditoria_instante(void);
+    bool auditoria_ponto(void);
+    bool auditoria_carregar(LISTA** lista, FILA** fila);
+    void auditoria_relatorio(AUDITORIA_RELATORIO* relatorio);
+
+#endif
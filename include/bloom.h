@@ -0,0 +1,47 @@
+#ifndef BLOOM_H
+    #define BLOOM_H
+
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdbool.h>
+    #include <stdint.h>
+    #include <string.h>
+
+    #define BLOOM_ARQUIVO "data/bloom.bin"          ///< Filtro de CPFs gravado pelo SAVE
+    #define BLOOM_VARIAVEL_TAXA "PS_BLOOM_TAXA"    ///< Variável de ambiente: taxa de falsos positivos desejada
+    #define BLOOM_TAXA_PADRAO 0.01                  ///< Taxa usada se a variável estiver ausente ou inválida
+    #define BLOOM_CAPACIDADE_MINIMA 65536           ///< Menor quantidade de CPFs dimensionada
+
+    typedef struct bloom_ BLOOM;
+
+    /**
+     * @brief Medições do filtro.
+     */
+    typedef struct bloom_relatorio_ {
+        uint64_t capacidade;        ///< CPFs para os quais o filtro foi dimensionado
+        uint64_t elementos;         ///< CPFs inseridos
+        uint64_t bytes;             ///< Memória dos bits
+        int funcoes;                ///< Bits ligados por CPF
+        double taxa_configurada;    ///< Taxa de falsos positivos pedida
+        double taxa_estimada;       ///< Taxa estimada pela ocupação atual dos bits
+        uint64_t consultas;         ///< Consultas feitas
+        uint64_t negativas;         ///< Consultas respondidas "não cadastrado" pelo filtro
+        uint64_t falsos_positivos;  ///< Consultas em que o filtro deixou passar um CPF ausente
+    } BLOOM_RELATORIO;
+
+    double bloom_taxa_configurada(void);
+    BLOOM* bloom_criar(uint64_t capacidade, double taxa);
+    void bloom_inserir(BLOOM* b, uint64_t chave);
+    bool bloom_talvez_contem(BLOOM* b, uint64_t chave);
+    void bloom_registrar_falso_positivo(BLOOM* b);
+    uint64_t bloom_elementos(BLOOM* b);
+    void bloom_relatorio(BLOOM* b, BLOOM_RELATORIO* relatorio);
+
+    bool bloom_salvar(BLOOM* b, const char* caminho, uint64_t assinatura);
+    BLOOM* bloom_carregar(const char* caminho, uint64_t assinatura, double taxa);
+    void bloom_persistir(BLOOM* b);
+    BLOOM* bloom_restaurar(void);
+    bool bloom_sincronizar(BLOOM* b);
+    void bloom_apagar(BLOOM** b);
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef CATALOGO_H
+    #define CATALOGO_H
+
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdbool.h>
+    #include <stdint.h>
+    #include <string.h>
+
+    #define CATALOGO_CODIGO_INVALIDO 0          ///< Código reservado para "procedimento inexistente"
+    #define CATALOGO_CODIGO_MAXIMO 0x7FFFFFFFu  ///< Maior código; o bit 31 fica para as descrições próprias (ver historico.c)
+    #define CATALOGO_RECORRENCIA 3              ///< Ocorrências de uma descrição nova até ela ser internada
+
+    uint32_t catalogo_internar(const char* texto);
+    uint32_t catalogo_buscar(const char* texto);
+    uint32_t catalogo_recorrente(const char* texto);
+    const char* catalogo_texto(uint32_t codigo);
+    uint32_t catalogo_tamanho(void);
+    bool catalogo_salvar(const char* caminho);
+    bool catalogo_carregar(const char* caminho);
+    bool catalogo_persistir(void);
+    bool catalogo_sincronizar(void);
+    bool catalogo_restaurar(void);
+    void catalogo_apagar(void);
+
+#endif
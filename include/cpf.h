@@ -0,0 +1,29 @@
+#ifndef CPF_H
+    #define CPF_H
+
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdbool.h>
+    #include <stdint.h>
+    #include <string.h>
+
+    #define CPF_DIGITOS 11        ///< Quantidade de dígitos de um CPF
+    #define CPF_INVALIDO UINT64_MAX ///< Valor empacotado que representa um CPF rejeitado
+
+    /**
+     * @brief Implementações da normalização e validação, da mais simples à mais rápida.
+     */
+    typedef enum {
+        CPF_CAMINHO_ESCALAR, ///< Um dígito por vez
+        CPF_CAMINHO_SSSE3,   ///< Um CPF por registrador de 128 bits
+        CPF_CAMINHO_AVX2     ///< Dois CPFs por registrador de 256 bits (cpf_validar_lote())
+    } CPF_CAMINHO;
+
+    bool cpf_normalizar(const char* entrada, char saida[CPF_DIGITOS + 1]);
+    bool cpf_validar(const char cpf[CPF_DIGITOS + 1]);
+    uint64_t cpf_empacotar(const char cpf[CPF_DIGITOS + 1]);
+    void cpf_desempacotar(uint64_t valor, char saida[CPF_DIGITOS + 1]);
+    size_t cpf_validar_lote(const char* const entradas[], size_t n, uint64_t saida[]);
+    CPF_CAMINHO cpf_definir_caminho(CPF_CAMINHO maximo);
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef CRC32C_H
+    #define CRC32C_H
+
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdbool.h>
+    #include <stdint.h>
+    #include <string.h>
+
+    uint32_t crc32c_calcular(uint32_t crc, const void* dados, size_t tamanho);
+
+#endif
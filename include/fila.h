@@ -1,23 +1,35 @@
-
-#ifndef FILA_H
-	#define FILA_H
-  	#include "paciente.h"
-	#include <stdio.h>
-	#include <stdlib.h>
-	#include <string.h>
-
-	typedef struct fila_ FILA;
-
-	FILA *fila_criar(void);
-	bool fila_inserir(FILA *fila, PACIENTE *paciente, int prioridade);
-	PACIENTE *fila_remover(FILA *fila);
-	PACIENTE *fila_remover_com_prioridade(FILA* fila, int* prioridade);
-	PACIENTE *fila_buscar(FILA *fila, char cpf[]);
-	void fila_apagar(FILA **fila);
-	PACIENTE *fila_frente(FILA *fila);
-	int fila_tamanho(FILA *fila);
-	bool fila_vazia(FILA *fila);
-	bool fila_cheia(FILA *fila);
-	void fila_imprimir(FILA *fila);
-	  
-#endif
+
+#ifndef FILA_H
+	#define FILA_H
+  	#include "paciente.h"
+	#include <stdio.h>
+	#include <stdlib.h>
+	#include <string.h>
+
+	#define FILA_VARIAVEL_MEMORIA "PS_FILA_MEMORIA" ///< Entradas da fila mantidas em memória; as demais vão para um arquivo de excedentes (0 = sem limite)
+
+	typedef struct fila_ FILA;
+
+	/**
+	 * @brief Função de callback para percorrer a fila (recebe a prioridade do paciente).
+	 */
+	typedef void (*AcaoFila)(PACIENTE *paciente, int prioridade, void *contexto);
+
+	FILA *fila_criar(void);
+	bool fila_inserir(FILA *fila, PACIENTE *paciente, int prioridade);
+	PACIENTE *fila_remover(FILA *fila);
+	PACIENTE *fila_remover_com_prioridade(FILA* fila, int* prioridade);
+	PACIENTE *fila_buscar(FILA *fila, char cpf[]);
+	void fila_apagar(FILA **fila);
+	PACIENTE *fila_frente(FILA *fila);
+	int fila_tamanho(FILA *fila);
+	bool fila_vazia(FILA *fila);
+	bool fila_cheia(FILA *fila);
+	int fila_em_disco(FILA *fila);
+	void fila_imprimir(FILA *fila);
+	bool fila_percorrer(FILA *fila, AcaoFila acao, void *contexto);
+	bool fila_persistir(FILA *fila);
+	bool fila_restaurar(FILA *fila);
+	bool fila_sincronizar(FILA *fila);
+	  
+#endif
@@ -0,0 +1,69 @@
+#ifndef HEAP_H
+    #define HEAP_H
+
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdbool.h>
+    #include <stdint.h>
+    #include <string.h>
+
+    #define HEAP_ARQUIVO "data/heap.bin"    ///< Heap persistente com a LISTA, a FILA e os pacientes
+    #define HEAP_VARIAVEL "PS_HEAP"         ///< "1" mantém as estruturas no heap persistente
+    #define HEAP_VARIAVEL_COMPARTILHADO "PS_COMPARTILHADO" ///< "1" abre o heap persistente junto com outros processos
+    #define HEAP_TAM_RAIZ 128               ///< Bytes de cada raiz guardada no cabeçalho
+
+    #define HEAP_RAIZ_REGISTRO 0 ///< Vetores do armazém central (ver registro.c)
+    #define HEAP_RAIZ_LISTA 1    ///< Raiz da árvore de pacientes
+    #define HEAP_RAIZ_FILTRO 2   ///< Filtro de CPFs
+    #define HEAP_RAIZ_FILA 3     ///< Anéis da fila de prioridades
+    #define HEAP_RAIZ_CATALOGO 4 ///< Descrições dos procedimentos
+    #define HEAP_RAIZES 5        ///< Quantidade de raízes
+
+    /**
+     * @brief Resultado da abertura do heap persistente.
+     */
+    typedef enum {
+        HEAP_DESATIVADO, ///< Sem heap: as estruturas usam malloc
+        HEAP_NOVO,       ///< Heap vazio: as estruturas devem ser carregadas dos arquivos de dados
+        HEAP_RESTAURADO, ///< Heap fechado corretamente na última execução: as raízes são válidas
+        HEAP_EM_USO      ///< Heap compartilhado já aberto por outro processo: as raízes são as atuais
+    } HEAP_ESTADO;
+
+    /**
+     * @brief Posição de um objeto dentro do heap (0 = nulo).
+     * @details Sem heap ativo, a origem é 0 e a posição é o próprio endereço.
+     */
+    typedef uint64_t HEAP_REF;
+
+    extern uintptr_t heap_origem; ///< Endereço do início do heap mapeado (0 se desativado)
+
+    /**
+     * @brief Converte uma posição do heap no endereço correspondente.
+     */
+    static inline void* heap_ponteiro(HEAP_REF ref){
+        return ref != 0 ? (void*)(heap_origem + (uintptr_t)ref) : NULL;
+    }
+
+    /**
+     * @brief Converte um endereço dentro do heap na posição correspondente.
+     */
+    static inline HEAP_REF heap_referencia(const void* ponteiro){
+        return ponteiro != NULL ? (HEAP_REF)((uintptr_t)ponteiro - heap_origem) : 0;
+    }
+
+    HEAP_ESTADO heap_abrir(const char* caminho, bool compartilhado);
+    bool heap_ativo(void);
+    bool heap_compartilhado(void);
+    bool heap_travar(void);
+    void heap_destravar(void);
+    bool heap_ultimo(void);
+    void heap_recomecar(void);
+    uint64_t heap_assinatura(void);
+    void* heap_raiz(int raiz);
+    bool heap_fechar(bool consistente, uint64_t assinatura);
+
+    void* heap_alocar(size_t tamanho);
+    void* heap_realocar(void* ponteiro, size_t tamanho);
+    void heap_liberar(void* ponteiro);
+
+#endif
@@ -4,13 +4,25 @@
     #include <stdio.h>
     #include <stdlib.h>
     #include <stdbool.h>
+    #include <stdint.h>
     #include <string.h>
 
+    #define HISTORICO_MAX 10                    ///< Capacidade máxima de procedimentos por paciente
+    #define HISTORICO_TAM_TEXTO 100             ///< Tamanho máximo de uma descrição (incluindo '\0')
+    #define HISTORICO_TEXTO_PROPRIO 0x80000000u ///< Bit de um código que aponta para uma descrição própria do paciente
+
     typedef struct historico_ HISTORICO;
 
     HISTORICO* historico_criar(void);
     bool historico_inserir(HISTORICO* hist, char texto[]);
+    bool historico_inserir_codigo(HISTORICO* hist, uint32_t codigo);
+    bool historico_inserir_proprio(HISTORICO* hist, const char* texto);
     char* historico_remover(HISTORICO* hist);
+    uint32_t historico_obter_codigo(HISTORICO* hist, int i);
+    const char* historico_descricao(HISTORICO* hist, int i);
+    const uint32_t* historico_codigos(HISTORICO* hist);
+    const char* historico_textos(HISTORICO* hist, uint32_t* tamanho);
+    const uint32_t* historico_rodape(HISTORICO* hist);
     bool historico_consultar(HISTORICO* hist, char* texto);
     bool historico_cheio(HISTORICO* hist);
     bool historico_vazio(HISTORICO* hist);
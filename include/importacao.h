@@ -0,0 +1,36 @@
+#ifndef IMPORTACAO_H
+    #define IMPORTACAO_H
+
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdbool.h>
+    #include <stdint.h>
+    #include "lista.h"
+
+    #define IMPORTACAO_BUFFER (1 << 20) ///< Bytes lidos do arquivo de cada vez (e maior linha aceita)
+    #define IMPORTACAO_LOTE 4096        ///< CPFs validados de uma vez (ver cpf_validar_lote())
+
+    /**
+     * @brief Formatos aceitos na importação.
+     */
+    typedef enum {
+        IMPORTACAO_CSV,     ///< Colunas cpf e nome (com cabeçalho) ou CPF e nome nas duas primeiras
+        IMPORTACAO_JSONL    ///< Um objeto com "cpf" e "nome" por linha (JSON Lines)
+    } IMPORTACAO_FORMATO;
+
+    /**
+     * @brief Resultado de uma importação.
+     */
+    typedef struct importacao_resultado_ {
+        uint64_t registros;      ///< Registros lidos (sem linhas vazias e cabeçalho)
+        uint64_t importados;     ///< Pacientes cadastrados
+        uint64_t malformados;    ///< Sem CPF ou nome, nome longo demais ou com caractere de controle, CPF em JSON que não é texto nem inteiro de até 11 dígitos, ou linha maior que IMPORTACAO_BUFFER
+        uint64_t cpf_invalidos;  ///< CPF com tamanho ou dígito verificador errado
+        uint64_t ja_cadastrados; ///< CPF já presente na lista
+        uint64_t repetidos;      ///< CPF repetido no próprio arquivo (vale o primeiro)
+        double duracao_ms;       ///< Tempo total, da leitura à montagem da árvore
+    } IMPORTACAO_RESULTADO;
+
+    bool importacao_carregar(const char* caminho, IMPORTACAO_FORMATO formato, LISTA* lista, IMPORTACAO_RESULTADO* resultado);
+
+#endif
@@ -7,21 +7,47 @@
     #include <string.h>
     #include "paciente.h"
     #include "historico.h"
+    #include "arquivo.h"
+    #include "bloom.h"
 
     #define max(a,b) (a > b ? a : b)
     typedef struct lista_ LISTA;
 
+    /**
+     * @brief Função de callback para percorrer a estrutura.
+     */
+    typedef void (*AcaoPaciente)(PACIENTE* p, void* contexto);
+
+    /**
+     * @brief Função de callback para percorrer registros (paciente em memória ou bytes do arquivo).
+     * @details Os bytes só são válidos durante a chamada.
+     */
+    typedef void (*AcaoRegistro)(PACIENTE* p, uint64_t chave, const char* bytes, uint32_t tamanho, void* contexto);
+
     LISTA* lista_criar();
+    bool lista_vincular_arquivo(LISTA* l, ARQUIVO* arq, size_t limite);
+    void lista_definir_filtro(LISTA* l, BLOOM* filtro);
+    BLOOM* lista_filtro(LISTA* l);
+    bool lista_persistir(LISTA* l);
+    bool lista_restaurar(LISTA* l);
+    bool lista_sincronizar(LISTA* l);
 
     bool lista_inserir(LISTA* l, PACIENTE* p);
+    bool lista_construir(LISTA* l, const PACIENTE_ID* ids, size_t n);
+    bool lista_mesclar(LISTA* l, const PACIENTE_ID* ids, size_t n);
     PACIENTE* lista_remover(LISTA* l, PACIENTE* p);
     PACIENTE* lista_remover_ultimo(LISTA* l);
+    const uint64_t* lista_removidos(LISTA* l, size_t* n);
+    void lista_limpar_removidos(LISTA* l);
     bool lista_vazia(LISTA* l);
     bool lista_cheia(LISTA* l); 
 
     PACIENTE* lista_buscar(LISTA* l, char* cpf);
     
-    void lista_mostrar(LISTA* l);
+    void lista_percorrer(LISTA* l, AcaoPaciente acao, void* contexto);
+    void lista_percorrer_registros(LISTA* l, AcaoRegistro acao, void* contexto);
+    size_t lista_divisores(LISTA* l, uint64_t* chaves, size_t max);
+    void lista_percorrer_intervalo(LISTA* l, uint64_t de, uint64_t ate, AcaoPaciente acao, void* contexto);
     void lista_apagar(LISTA** l);
 
     
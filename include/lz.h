@@ -0,0 +1,15 @@
+#ifndef LZ_H
+    #define LZ_H
+
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdbool.h>
+    #include <stdint.h>
+    #include <string.h>
+
+    #define LZ_MAX_ENTRADA 65535 ///< Maior trecho comprimido de uma vez (distâncias de 16 bits)
+
+    uint32_t lz_comprimir(const char* origem, uint32_t tamanho, char* destino, uint32_t capacidade);
+    bool lz_descomprimir(const char* origem, uint32_t tamanho, char* destino, uint32_t esperado);
+
+#endif
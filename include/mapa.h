@@ -0,0 +1,16 @@
+#ifndef MAPA_H
+    #define MAPA_H
+
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdbool.h>
+    #include <string.h>
+
+    typedef struct mapa_ MAPA;
+
+    MAPA* mapa_abrir(const char* caminho);
+    const char* mapa_dados(MAPA* mapa);
+    size_t mapa_tamanho(MAPA* mapa);
+    void mapa_fechar(MAPA** mapa);
+
+#endif
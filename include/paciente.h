@@ -5,21 +5,42 @@
     #include <stdio.h>
     #include <stdlib.h>
     #include <stdbool.h>
+    #include <stdint.h>
     #include <string.h>
+    #include <time.h>
+
+    #define PACIENTE_MAX_SEGMENTOS 5 ///< CPF, nome, códigos do histórico, descrições próprias e rodapé
+    #define PACIENTE_TAM_NOME 255    ///< Tamanho máximo de um nome (sem o '\0')
+
+    #define PACIENTE_ID_INVALIDO UINT32_MAX ///< Identificador que não aponta para nenhum paciente
 
     typedef struct paciente_ PACIENTE;
+    typedef uint32_t PACIENTE_ID; ///< Índice do paciente no armazém central (ver registro.h)
+
+    /**
+     * @brief Trecho contíguo de memória de um registro serializado (equivalente a struct iovec).
+     */
+    typedef struct segmento_ {
+        const void* base; ///< Início do trecho
+        size_t tamanho;   ///< Quantidade de bytes
+    } SEGMENTO;
 
     PACIENTE* paciente_criar(char nome[], char cpf[]);
     bool paciente_apagar(PACIENTE** paciente);
+    PACIENTE_ID paciente_obter_id(PACIENTE* paciente);
     char* paciente_obter_nome(PACIENTE* paciente);
     char* paciente_obter_cpf(PACIENTE* paciente);    
     void paciente_definir_cpf(PACIENTE* paciente, char cpf[]);    
     HISTORICO* paciente_obter_historico(PACIENTE* paciente);
+    void paciente_marcar_alterado(PACIENTE* paciente);
     void paciente_imprimir(PACIENTE* paciente);
+    int paciente_serializar(PACIENTE* paciente, SEGMENTO segmentos[], int* tamanho);
     char* paciente_para_string(PACIENTE* paciente, int* tamanho);
-    PACIENTE* paciente_de_string(char* buffer);
+    PACIENTE* paciente_de_bytes(const char* dados, size_t tamanho);
+    PACIENTE* paciente_de_bytes_sem_registro(const char* dados, size_t tamanho);
+    bool paciente_registrar(PACIENTE* paciente);
     bool paciente_esta_na_fila(PACIENTE* paciente);
-    void paciente_ir_para_fila(PACIENTE* paciente);
+    void paciente_ir_para_fila(PACIENTE* paciente, int prioridade);
     void paciente_sair_da_fila(PACIENTE* paciente);
 
 #endif
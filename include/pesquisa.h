@@ -0,0 +1,20 @@
+#ifndef PESQUISA_H
+    #define PESQUISA_H
+
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdbool.h>
+    #include <stdint.h>
+    #include "lista.h"
+
+    #define PESQUISA_MAX_TEXTO 256 ///< Maior consulta aceita (em bytes)
+    #define PESQUISA_MAX_NOS 64    ///< Maior quantidade de condições e conectivos de uma consulta
+
+    typedef struct pesquisa_ PESQUISA;
+
+    PESQUISA* pesquisa_compilar(const char* texto, char* erro, size_t tam_erro);
+    bool pesquisa_executar(PESQUISA* pesquisa, LISTA* lista, FILE* saida);
+    void pesquisa_ajuda(void);
+    void pesquisa_apagar(PESQUISA** pesquisa);
+
+#endif
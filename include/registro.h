@@ -0,0 +1,52 @@
+#ifndef REGISTRO_H
+    #define REGISTRO_H
+
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdbool.h>
+    #include <stdint.h>
+    #include <string.h>
+    #include "paciente.h"
+
+    #define REGISTRO_ALTERADO     0x01 ///< Diferente do arquivo de dados: não pode sair do cache
+    #define REGISTRO_EM_CACHE     0x02 ///< Hidratado sob demanda e ocupando uma posição do cache
+    #define REGISTRO_REFERENCIADO 0x04 ///< Acessado desde a última passagem do ponteiro do CLOCK
+
+    /**
+     * @brief Vetores do armazém central, somente leitura, para varreduras (ver pesquisa.c).
+     * @details Válidos até a próxima alteração do armazém.
+     */
+    typedef struct registro_vetores_ {
+        const uint64_t* cpf;        ///< CPF empacotado (CPF_INVALIDO = posição livre)
+        const uint8_t* na_fila;     ///< 1 se o paciente está na fila
+        const uint8_t* prioridade;  ///< Prioridade (0 a 4) da última entrada na fila
+        const int64_t* chegada;     ///< Horário (time_t) da última entrada na fila
+        uint32_t limite;            ///< Posições já usadas (ver registro_limite())
+    } REGISTRO_VETORES;
+
+    PACIENTE_ID registro_alocar(PACIENTE* paciente, uint64_t cpf);
+    bool registro_reservar(uint32_t n);
+    void registro_liberar(PACIENTE_ID id);
+    PACIENTE* registro_paciente(PACIENTE_ID id);
+
+    uint64_t registro_cpf(PACIENTE_ID id);
+    void registro_definir_cpf(PACIENTE_ID id, uint64_t cpf);
+    bool registro_na_fila(PACIENTE_ID id);
+    int registro_prioridade(PACIENTE_ID id);
+    int64_t registro_chegada(PACIENTE_ID id);
+    void registro_entrar_fila(PACIENTE_ID id, int prioridade, int64_t chegada);
+    void registro_sair_fila(PACIENTE_ID id);
+    uint8_t registro_marcas(PACIENTE_ID id);
+    void registro_ligar_marcas(PACIENTE_ID id, uint8_t marcas);
+    void registro_desligar_marcas(PACIENTE_ID id, uint8_t marcas);
+
+    uint32_t registro_limite(void);
+    uint32_t registro_quantidade(void);
+    uint32_t registro_contar_na_fila(void);
+    void registro_vetores(REGISTRO_VETORES* vetores);
+    bool registro_persistir(void);
+    bool registro_restaurar(void);
+    bool registro_sincronizar(void);
+    void registro_apagar(void);
+
+#endif
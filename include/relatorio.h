@@ -0,0 +1,33 @@
+#ifndef RELATORIO_H
+    #define RELATORIO_H
+
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdbool.h>
+    #include <stdint.h>
+    #include "lista.h"
+
+    /**
+     * @brief Formatos do relatório de pacientes.
+     */
+    typedef enum {
+        RELATORIO_TEXTO,    ///< NOME/CPF/ESTADO, um bloco por paciente (o da "Lista Geral")
+        RELATORIO_CSV,      ///< cpf,nome,na_fila com cabeçalho
+        RELATORIO_JSON,     ///< Vetor de objetos {"cpf","nome","na_fila"}
+        RELATORIO_JSONL     ///< Um objeto {"cpf","nome","na_fila"} por linha (JSON Lines)
+    } RELATORIO_FORMATO;
+
+    /**
+     * @brief Medições de um relatório.
+     */
+    typedef struct relatorio_medida_ {
+        uint64_t pacientes;  ///< Pacientes escritos
+        uint64_t bytes;      ///< Bytes escritos
+        int partes;          ///< Intervalos da árvore formatados separadamente
+        int threads;         ///< Threads usadas
+        double duracao_ms;   ///< Tempo total, escrita incluída
+    } RELATORIO_MEDIDA;
+
+    bool relatorio_pacientes(LISTA* lista, RELATORIO_FORMATO formato, FILE* saida, RELATORIO_MEDIDA* medida);
+
+#endif
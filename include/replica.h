@@ -0,0 +1,20 @@
+#ifndef REPLICA_H
+    #define REPLICA_H
+
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdbool.h>
+    #include <stdint.h>
+    #include "fila.h"
+    #include "lista.h"
+
+    #define REPLICA_VARIAVEL "PS_REPLICA" ///< "1" abre o sistema como réplica somente leitura do processo principal
+
+    bool replica_configurar(void);
+    bool replica_ativa(void);
+    bool replica_carregar(LISTA** lista, FILA** fila);
+    int replica_atualizar(LISTA** lista, FILA** fila);
+    uint64_t replica_aplicadas(void);
+    int replica_recargas(void);
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef SNAPSHOT_H
+    #define SNAPSHOT_H
+
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdbool.h>
+    #include "fila.h"
+    #include "lista.h"
+
+    #define SNAPSHOT_VARIAVEL_INTERVALO "PS_SNAPSHOT_INTERVALO" ///< Segundos entre snapshots (0 ou ausente = desativado)
+
+    /**
+     * @brief Medições do último snapshot em segundo plano concluído.
+     */
+    typedef struct snapshot_relatorio_ {
+        bool sucesso;       ///< O processo filho gravou e renomeou todos os arquivos
+        double duracao_ms;  ///< Tempo do SAVE no processo filho
+        double pausa_us;    ///< Tempo em que o atendimento ficou parado (fork)
+    } SNAPSHOT_RELATORIO;
+
+    void snapshot_configurar(void);
+    bool snapshot_ativo(void);
+    bool snapshot_verificar(LISTA* lista, FILA* fila);
+    bool snapshot_iniciar(LISTA* lista, FILA* fila);
+    void snapshot_aguardar(void);
+    bool snapshot_ultimo(SNAPSHOT_RELATORIO* relatorio);
+
+#endif
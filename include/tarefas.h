@@ -0,0 +1,21 @@
+#ifndef TAREFAS_H
+    #define TAREFAS_H
+
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdbool.h>
+
+    #define TAREFAS_VARIAVEL "PS_THREADS" ///< Variável de ambiente: threads do LOAD/SAVE (ausente = processadores)
+    #define TAREFAS_MAX 64                ///< Maior quantidade de threads
+
+    /**
+     * @brief Função executada por uma thread.
+     * @param contexto Parâmetro comum a todas as threads.
+     * @param indice Índice da thread (0 a n - 1).
+     */
+    typedef void (*TAREFA)(void* contexto, int indice);
+
+    int tarefas_quantidade(void);
+    void tarefas_executar(int n, TAREFA tarefa, void* contexto);
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef WAL_H
+    #define WAL_H
+
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdbool.h>
+    #include <stdint.h>
+    #include <string.h>
+    #include "fila.h"
+    #include "lista.h"
+
+    #define WAL_ARQUIVO "data/wal.bin"   ///< Log de operações aplicadas desde o último SAVE
+    #define WAL_VARIAVEL_LOTE "PS_WAL_LOTE" ///< Variável de ambiente: operações por fsync (0 = nunca)
+    #define WAL_SUFIXO_ANTIGO ".old"        ///< Registros de antes do snapshot em andamento
+
+    bool wal_abrir(const char* caminho);
+    void wal_definir_pontos(uint64_t lista, uint64_t fila);
+    uint64_t wal_sequencia(void);
+    int wal_reaplicar(LISTA* lista, FILA* fila);
+    uint64_t wal_reaplicar_ate(const char* dados, size_t tamanho, int64_t ate, LISTA* lista, FILA* fila,
+                               size_t* consumido);
+
+    void wal_registrar_cadastro(const char* cpf, const char* nome);
+    void wal_registrar_importacao(const char* const* cpfs, const char* const* nomes, size_t n);
+    void wal_registrar_remocao(const char* cpf);
+    void wal_registrar_entrada_fila(const char* cpf, int prioridade, int64_t chegada);
+    void wal_registrar_saida_fila(const char* cpf);
+    void wal_registrar_historico_inserir(const char* cpf, const char* procedimento);
+    void wal_registrar_historico_remover(const char* cpf);
+
+    bool wal_confirmar(void);
+    bool wal_truncar(void);
+    bool wal_rotacionar(void);
+    void wal_descartar_antigo(void);
+    bool wal_definir_arquivo_morto(const char* caminho);
+    void wal_fechar(void);
+
+    int wal_acompanhar(const char* caminho, LISTA* lista, FILA* fila);
+    void wal_parar_acompanhamento(void);
+
+#endif
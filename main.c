@@ -13,14 +13,27 @@
  */
 
 #include "include/IO.h"
+#include "include/altas.h"
+#include "include/auditoria.h"
+#include "include/catalogo.h"
+#include "include/cpf.h"
 #include "include/fila.h"
+#include "include/heap.h"
 #include "include/historico.h"
+#include "include/importacao.h"
 #include "include/lista.h"
 #include "include/paciente.h"
+#include "include/pesquisa.h"
+#include "include/registro.h"
+#include "include/relatorio.h"
+#include "include/replica.h"
+#include "include/snapshot.h"
+#include "include/wal.h"
 #include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h> 
+#include <time.h>
 
 // Inclusões para limpar a tela de forma portável (Windows/Linux)
 #ifdef _WIN32
@@ -65,6 +78,23 @@ void imprimir_cabecalho(const char *titulo)
     printf(ANSI_STYLE_BOLD ANSI_COLOR_CYAN "--- %s ---\n\n" ANSI_COLOR_RESET, titulo);
 }
 
+/**
+ * @brief Exibe as medições do filtro de CPFs (taxa configurada em PS_BLOOM_TAXA).
+ * @param lista LISTA cujo filtro é exibido.
+ */
+void imprimir_filtro(LISTA *lista)
+{
+    BLOOM_RELATORIO r;
+    if (lista_filtro(lista) == NULL) return;
+    bloom_relatorio(lista_filtro(lista), &r);
+
+    printf("[INFO] Filtro de CPFs: %llu CPF(s) em %.1f KB, falsos positivos estimados em %.3f%% (configurado: %.3f%%).\n",
+           (unsigned long long)r.elementos, r.bytes / 1024.0, r.taxa_estimada * 100, r.taxa_configurada * 100);
+    if (r.consultas > 0)
+        printf("[INFO] %llu consulta(s) ao filtro: %llu respondida(s) sem busca, %llu falso(s) positivo(s).\n",
+               (unsigned long long)r.consultas, (unsigned long long)r.negativas, (unsigned long long)r.falsos_positivos);
+}
+
 /**
  * @brief Exibe o menu principal do sistema.
  *
@@ -75,6 +105,24 @@ void exibir_menu_principal()
 {
     limpar_tela();
     printf(ANSI_STYLE_BOLD ANSI_COLOR_CYAN "--- Pronto Socorro SUS (V2) ---\n\n" ANSI_COLOR_RESET);
+
+    SNAPSHOT_RELATORIO relatorio;
+    if (snapshot_ultimo(&relatorio)) {
+        if (relatorio.sucesso)
+            printf("Último snapshot: %.1f ms (pausa do atendimento: %.0f us)\n\n", relatorio.duracao_ms, relatorio.pausa_us);
+        else
+            printf(ANSI_COLOR_RED "Último snapshot falhou.\n\n" ANSI_COLOR_RESET);
+    }
+
+    if (replica_ativa()) {
+        printf(ANSI_COLOR_YELLOW "Réplica somente leitura: %llu operação(ões) do log aplicada(s), %d recarga(s).\n\n" ANSI_COLOR_RESET,
+               (unsigned long long)replica_aplicadas(), replica_recargas());
+    }
+
+    if (auditoria_consulta()) {
+        printf(ANSI_COLOR_YELLOW "Auditoria somente leitura: estado em %s.\n\n" ANSI_COLOR_RESET, getenv(AUDITORIA_VARIAVEL_INSTANTE));
+    }
+
     printf("1. Registrar Entrada (Cadastro/Fila)\n");
     printf("2. Remover Paciente (Do Sistema)\n");
     printf("3. Listar Todos os Pacientes\n");
@@ -84,6 +132,10 @@ void exibir_menu_principal()
     printf("7. Sair\n");
     printf("-------------------------------\n");
     printf("8. [Extra] Gerenciar Histórico (Manual)\n"); 
+    printf("9. [Extra] Salvar Dados Agora\n");
+    printf("10. [Extra] Espera Média por Mês (Altas)\n");
+    printf("11. [Extra] Consultar Pacientes (Filtros e Contagens)\n");
+    printf("12. [Extra] Importar/Exportar Pacientes (CSV/JSON Lines)\n");
     printf("\nEscolha uma opção: ");
 }
 
@@ -99,7 +151,11 @@ typedef enum
     MOSTRAR_FILA = 5,
     DAR_ALTA = 6,
     SAIR = 7,
-    EXTRA_HISTORICO = 8
+    EXTRA_HISTORICO = 8,
+    SALVAR_AGORA = 9,
+    RELATORIO_ALTAS = 10,
+    CONSULTAR_PACIENTES = 11,
+    IMPORTAR_EXPORTAR = 12
 } Opcao;
 
 /**
@@ -112,36 +168,32 @@ Opcao escolher_opcao()
     do {
         scanf("%d", &opcao);
         getchar(); // Limpar buffer
-        if (opcao < 1 || opcao > 8) printf("Opção inválida! Tente novamente: ");
-    } while (opcao < 1 || opcao > 8);
+        if (opcao < 1 || opcao > 12) printf("Opção inválida! Tente novamente: ");
+    } while (opcao < 1 || opcao > 12);
     return (Opcao)opcao;
 }
 
 /**
  * @brief Remove caracteres não numéricos do CPF.
  * @param cpf String contendo o CPF digitado.
+ * @return true se restaram exatamente 11 dígitos.
  */
-void formatar_cpf(char cpf[])
+bool formatar_cpf(char cpf[])
 {
-    int tamanho = 0;
-    for (int i = 0; cpf[i] != '\0'; i++) {
-        if (isdigit(cpf[i])) {
-            cpf[tamanho] = cpf[i];
-            tamanho++;
-        }
-    }
-    cpf[tamanho] = '\0';
+    return cpf_normalizar(cpf, cpf);
 }
 
 /**
  * @brief Verifica se um CPF tem comprimento válido (11 dígitos).
- * @param cpf String contendo o CPF.
+ * @details Os dígitos verificadores só são exigidos de um CPF novo (ver
+ * REGISTRAR_ENTRADA): pacientes cadastrados antes dessa verificação, com
+ * dígitos errados, continuam podendo ser buscados, removidos e editados.
+ * @param cpf String contendo o CPF (aceita "12345678909" ou "123.456.789-09").
  * @return true se válido, false caso contrário.
  */
 bool eh_cpf_valido(char cpf[])
 {
-    formatar_cpf(cpf);
-    if (strlen(cpf) != 11) {
+    if (!formatar_cpf(cpf)) {
         printf("CPF inválido! (Tamanho incorreto)\n");
         return false;
     }
@@ -157,7 +209,7 @@ char *cpf_ler()
     char *cpf = calloc(16, sizeof(char));
     if (!cpf) return NULL;
 
-    printf("Digite o CPF (apenas números): ");
+    printf("Digite o CPF: ");
     fgets(cpf, 16, stdin);
     cpf[strcspn(cpf, "\n")] = '\0'; 
 
@@ -192,6 +244,31 @@ int ler_prioridade_interface()
     return p - 1;
 }
 
+/**
+ * @brief Trava a LISTA e a FILA contra os outros processos do heap compartilhado.
+ *
+ * Sem PS_COMPARTILHADO não faz nada. Um PACIENTE* obtido antes da trava não
+ * pode ser usado depois dela: o paciente deve ser buscado de novo pelo CPF.
+ */
+void travar_base(LISTA *lista, FILA *fila)
+{
+    if (!IO_travar(lista, fila))
+        printf(ANSI_COLOR_YELLOW "[AVISO] Outro processo encerrou no meio de uma alteração dos dados compartilhados.\n" ANSI_COLOR_RESET);
+}
+
+/**
+ * @brief Confirma no log as operações feitas e libera a LISTA e a FILA.
+ *
+ * No heap compartilhado o log é confirmado antes de liberar, para que os
+ * registros de todos os processos fiquem na ordem em que foram aplicados.
+ */
+void liberar_base(LISTA *lista, FILA *fila)
+{
+    if (heap_compartilhado())
+        wal_confirmar();
+    IO_destravar(lista, fila);
+}
+
 /**
  * @brief Função principal do sistema de pronto-socorro.
  *
@@ -199,7 +276,7 @@ int ler_prioridade_interface()
  * - Cadastro e remoção de pacientes
  * - Inserção e remoção da fila
  * - Registros em histórico
- * - Persistência dos dados (LOAD/SAVE)
+ * - Persistência dos dados (LOAD/SAVE e log de operações)
  *
  * @return 0 ao finalizar a execução.
  */
@@ -209,12 +286,27 @@ int main()
     LISTA *lista = lista_criar(); 
     FILA *fila = fila_criar();    
 
-    // Carregar dados do disco
-    if (!LOAD(&lista, &fila)) {
+    // Réplica somente leitura do processo principal (PS_REPLICA) ou estado de um
+    // instante passado (PS_AUDITORIA_INSTANTE); com PS_AUDITORIA o log é guardado
+    bool replica = replica_configurar();
+    bool consulta = !replica && auditoria_configurar();
+    bool somente_leitura = replica || consulta;
+
+    // Retomar do heap persistente (PS_HEAP) ou carregar dados do disco; no heap
+    // compartilhado (PS_COMPARTILHADO) a base fica travada até o fim da carga
+    bool retomado = !somente_leitura && IO_abrir_heap(&lista, &fila);
+    if (!retomado && !(consulta  ? auditoria_carregar(&lista, &fila)
+                       : replica ? replica_carregar(&lista, &fila)
+                                 : LOAD(&lista, &fila))) {
         printf(ANSI_COLOR_YELLOW "[AVISO] Base de dados nova ou erro ao carregar. Iniciando vazio.\n" ANSI_COLOR_RESET);
         pausar_para_continuar();
     } else {
-        printf(ANSI_COLOR_GREEN "[SUCESSO] Dados carregados do disco.\n" ANSI_COLOR_RESET);
+        if (IO_heap_em_uso())
+            printf(ANSI_COLOR_GREEN "[SUCESSO] Dados compartilhados com os processos em execução.\n" ANSI_COLOR_RESET);
+        else if (retomado)
+            printf(ANSI_COLOR_GREEN "[SUCESSO] Dados retomados do heap persistente.\n" ANSI_COLOR_RESET);
+        else
+            printf(ANSI_COLOR_GREEN "[SUCESSO] Dados carregados do disco.\n" ANSI_COLOR_RESET);
         #ifdef _WIN32
         Sleep(1000);
         #else
@@ -222,12 +314,90 @@ int main()
         #endif
     }
 
+    // Reaplicar as operações feitas depois do último SAVE (a réplica só lê o log)
+    if (replica) {
+        printf("[INFO] Réplica somente leitura (%s=1): %llu operação(ões) aplicada(s) do log do processo principal.\n",
+               REPLICA_VARIAVEL, (unsigned long long)replica_aplicadas());
+    } else if (consulta) {
+        AUDITORIA_RELATORIO r;
+        auditoria_relatorio(&r);
+        if (r.ponto < 0) {
+            printf(ANSI_COLOR_YELLOW "[AVISO] Nenhum ponto de restauração anterior a %s.\n" ANSI_COLOR_RESET, getenv(AUDITORIA_VARIAVEL_INSTANTE));
+        } else {
+            char quando[32];
+            time_t instante = (time_t)r.instante_ponto;
+            strftime(quando, sizeof(quando), "%Y-%m-%d %H:%M:%S", localtime(&instante));
+            printf("[INFO] Auditoria (%s=%s): ponto de restauração %d (%s) + %llu operação(ões) reaplicada(s) em %.1f ms.\n",
+                   AUDITORIA_VARIAVEL_INSTANTE, getenv(AUDITORIA_VARIAVEL_INSTANTE), r.ponto, quando,
+                   (unsigned long long)r.operacoes, r.duracao_ms);
+        }
+    } else if (!wal_abrir(WAL_ARQUIVO)) {
+        printf(ANSI_COLOR_YELLOW "[AVISO] Não foi possível abrir o log de operações.\n" ANSI_COLOR_RESET);
+    } else if (!IO_heap_em_uso()) {
+        // Com o heap já em uso, o log está aplicado pelos outros processos
+        int recuperadas = wal_reaplicar(lista, fila);
+        if (recuperadas > 0)
+            printf(ANSI_COLOR_GREEN "[SUCESSO] %d operações recuperadas do log.\n" ANSI_COLOR_RESET, recuperadas);
+    }
+
+    if (IO_blocos_corrompidos() > 0) {
+        printf(ANSI_COLOR_YELLOW "[AVISO] %d bloco(s) corrompido(s) descartado(s) ao carregar os dados.\n" ANSI_COLOR_RESET, IO_blocos_corrompidos());
+    }
+
+    if (IO_sob_demanda()) {
+        printf("[INFO] Pacientes carregados sob demanda (%s=%s).\n", IO_VARIAVEL_CACHE, getenv(IO_VARIAVEL_CACHE));
+    }
+
+    if (heap_compartilhado()) {
+        printf("[INFO] Pacientes compartilhados entre processos no heap persistente (%s=1, %s).\n",
+               HEAP_VARIAVEL_COMPARTILHADO, HEAP_ARQUIVO);
+    } else if (heap_ativo()) {
+        printf("[INFO] Pacientes mantidos no heap persistente (%s).\n", HEAP_ARQUIVO);
+    }
+
+    imprimir_filtro(lista);
+
+    if (auditoria_ativa()) {
+        printf("[INFO] Operações guardadas para auditoria (%s=1, %s).\n", AUDITORIA_VARIAVEL, AUDITORIA_DIRETORIO);
+    }
+
+    // Converte arquivos do formato antigo para o formato versionado
+    if (IO_formato_antigo() && !somente_leitura) {
+        if (SAVE(&lista, &fila)) {
+            if (wal_truncar())
+                auditoria_ponto();
+            printf(ANSI_COLOR_GREEN "[SUCESSO] Arquivos convertidos para o formato versionado.\n" ANSI_COLOR_RESET);
+        } else {
+            printf(ANSI_COLOR_RED "[ERRO] Falha ao converter os arquivos de dados.\n" ANSI_COLOR_RESET);
+        }
+    }
+    liberar_base(lista, fila);
+
+    // Snapshots em segundo plano (PS_SNAPSHOT_INTERVALO)
+    if (!somente_leitura)
+        snapshot_configurar();
+
     Opcao opcao;
 
     do {
+        snapshot_verificar(lista, fila);
         exibir_menu_principal();
         opcao = escolher_opcao();
 
+        // A réplica e a auditoria respondem só consultas; a réplica, com as operações do log até agora
+        if (replica)
+            replica_atualizar(&lista, &fila);
+        if (somente_leitura && opcao != LISTAR_PACIENTES && opcao != BUSCAR_PACIENTE && opcao != MOSTRAR_FILA &&
+            opcao != RELATORIO_ALTAS && opcao != CONSULTAR_PACIENTES && opcao != IMPORTAR_EXPORTAR && opcao != SAIR) {
+            imprimir_cabecalho(replica ? "Réplica Somente Leitura" : "Auditoria Somente Leitura");
+            if (replica)
+                printf(ANSI_COLOR_YELLOW "[AVISO] Cadastros, altas e alterações são feitos no processo principal.\n" ANSI_COLOR_RESET);
+            else
+                printf(ANSI_COLOR_YELLOW "[AVISO] O estado de um instante passado não pode ser alterado.\n" ANSI_COLOR_RESET);
+            pausar_para_continuar();
+            continue;
+        }
+
         switch (opcao)
         {
         /**
@@ -238,18 +408,34 @@ int main()
             imprimir_cabecalho("Registrar Entrada / Triagem");
             char *cpf = cpf_ler();
             if (cpf) {
+                travar_base(lista, fila);
                 PACIENTE *pac = lista_buscar(lista, cpf);
 
+                // Um erro de digitação não pode criar um paciente novo
+                if (pac == NULL && !cpf_validar(cpf)) {
+                    liberar_base(lista, fila);
+                    printf("CPF inválido! (Dígito verificador incorreto)\n");
+                    free(cpf);
+                    break;
+                }
+
                 // Cadastro caso não exista
                 if (pac == NULL) {
                     char nome[256];
+                    liberar_base(lista, fila);
                     printf("Paciente não cadastrado. Digite o Nome Completo: ");
                     fgets(nome, 256, stdin);
                     nome[strcspn(nome, "\n")] = '\0';
-
-                    pac = paciente_criar(nome, cpf);
-                    lista_inserir(lista, pac);
-                    printf(ANSI_COLOR_GREEN "[NOVO] Paciente cadastrado no sistema.\n" ANSI_COLOR_RESET);
+                    travar_base(lista, fila);
+
+                    // Outro processo pode ter cadastrado o CPF enquanto o nome era digitado
+                    pac = lista_buscar(lista, cpf);
+                    if (pac == NULL) {
+                        pac = paciente_criar(nome, cpf);
+                        lista_inserir(lista, pac);
+                        wal_registrar_cadastro(cpf, nome);
+                        printf(ANSI_COLOR_GREEN "[NOVO] Paciente cadastrado no sistema.\n" ANSI_COLOR_RESET);
+                    }
                 } else {
                     printf(ANSI_COLOR_CYAN "[ENCONTRADO] Paciente já possui cadastro: %s\n" ANSI_COLOR_RESET, paciente_obter_nome(pac));
                 }
@@ -258,13 +444,19 @@ int main()
                 if (paciente_esta_na_fila(pac)) {
                      printf(ANSI_COLOR_YELLOW "[ALERTA] Paciente já está na fila de espera.\n" ANSI_COLOR_RESET);
                 } else {
+                    liberar_base(lista, fila);
                     int prioridade = ler_prioridade_interface();
-                    if (fila_inserir(fila, pac, prioridade)) {
+                    travar_base(lista, fila);
+
+                    pac = lista_buscar(lista, cpf);
+                    if (pac != NULL && !paciente_esta_na_fila(pac) && fila_inserir(fila, pac, prioridade)) {
+                        wal_registrar_entrada_fila(cpf, prioridade, registro_chegada(paciente_obter_id(pac)));
                         printf(ANSI_COLOR_GREEN "[SUCESSO] Paciente encaminhado para fila.\n" ANSI_COLOR_RESET);
                     } else {
                         printf(ANSI_COLOR_RED "[ERRO] Falha ao inserir na fila.\n" ANSI_COLOR_RESET);
                     }
                 }
+                liberar_base(lista, fila);
                 
                 free(cpf);
             }
@@ -279,17 +471,21 @@ int main()
             imprimir_cabecalho("Remover Paciente do Sistema");
             char *cpf = cpf_ler();
             if (cpf) {
+                travar_base(lista, fila);
                 PACIENTE *pac = lista_buscar(lista, cpf);
                 if (pac) {
                     if (paciente_esta_na_fila(pac)) {
                         printf(ANSI_COLOR_YELLOW "[ALERTA] Paciente está na fila! Não é seguro remover.\n" ANSI_COLOR_RESET);
                     } else {
-                        lista_remover(lista, pac);
+                        PACIENTE *removido = lista_remover(lista, pac);
+                        paciente_apagar(&removido);
+                        wal_registrar_remocao(cpf);
                         printf(ANSI_COLOR_GREEN "[SUCESSO] Paciente removido.\n" ANSI_COLOR_RESET);
                     }
                 } else {
                     printf(ANSI_COLOR_RED "[ERRO] Paciente não encontrado.\n" ANSI_COLOR_RESET);
                 }
+                liberar_base(lista, fila);
                 free(cpf);
             }
             break;
@@ -301,7 +497,39 @@ int main()
         case LISTAR_PACIENTES:
         {
             imprimir_cabecalho("Lista Geral de Pacientes");
-            lista_mostrar(lista); 
+            char linha[256];
+            printf("Formato (1 - Texto, 2 - CSV, 3 - JSON) [1]: ");
+            if (fgets(linha, sizeof(linha), stdin) == NULL) break;
+            RELATORIO_FORMATO formato = linha[0] == '2' ? RELATORIO_CSV : linha[0] == '3' ? RELATORIO_JSON : RELATORIO_TEXTO;
+
+            // CSV e JSON podem ir para um arquivo em vez da tela
+            FILE *destino = stdout;
+            char caminho[256] = "";
+            if (formato != RELATORIO_TEXTO) {
+                printf("Arquivo de destino (vazio = tela): ");
+                if (fgets(caminho, sizeof(caminho), stdin) == NULL) break;
+                caminho[strcspn(caminho, "\n")] = '\0';
+                if (caminho[0] != '\0' && (destino = fopen(caminho, "wb")) == NULL) {
+                    printf(ANSI_COLOR_RED "[ERRO] Não foi possível criar %s.\n" ANSI_COLOR_RESET, caminho);
+                    break;
+                }
+            }
+
+            printf("\n");
+            RELATORIO_MEDIDA medida;
+            travar_base(lista, fila);
+            bool ok = relatorio_pacientes(lista, formato, destino, &medida);
+            liberar_base(lista, fila);
+            if (destino != stdout && fclose(destino) != 0)
+                ok = false;
+
+            if (!ok)
+                printf(ANSI_COLOR_RED "[ERRO] O relatório não foi escrito por completo.\n" ANSI_COLOR_RESET);
+            else if (destino != stdout)
+                printf(ANSI_COLOR_GREEN "[SUCESSO] Relatório gravado em %s.\n" ANSI_COLOR_RESET, caminho);
+            printf("%llu paciente(s), %llu bytes em %.1f ms (%d parte(s), %d thread(s)).\n",
+                   (unsigned long long)medida.pacientes, (unsigned long long)medida.bytes, medida.duracao_ms,
+                   medida.partes, medida.threads);
             break;
         }
 
@@ -313,6 +541,7 @@ int main()
             imprimir_cabecalho("Buscar Paciente");
             char *cpf = cpf_ler();
             if (cpf) {
+                travar_base(lista, fila);
                 PACIENTE *pac = lista_buscar(lista, cpf);
                 if (pac) {
                     printf("Nome: " ANSI_STYLE_BOLD "%s" ANSI_COLOR_RESET "\n", paciente_obter_nome(pac));
@@ -323,14 +552,19 @@ int main()
                     else 
                         printf("Status: " ANSI_COLOR_GREEN "Sem pendências atuais\n" ANSI_COLOR_RESET);
 
+                    liberar_base(lista, fila);
                     printf("\nDeseja visualizar o histórico médico? (s/n): ");
                     char resp = getchar();
-                    if (resp == 's' || resp == 'S')
+                    travar_base(lista, fila);
+
+                    pac = lista_buscar(lista, cpf);
+                    if ((resp == 's' || resp == 'S') && pac)
                         historico_imprimir(paciente_obter_historico(pac));
 
                 } else {
                     printf(ANSI_COLOR_RED "[ERRO] Paciente não encontrado.\n" ANSI_COLOR_RESET);
                 }
+                liberar_base(lista, fila);
                 free(cpf);
             }
             break;
@@ -342,7 +576,9 @@ int main()
         case MOSTRAR_FILA:
         {
             imprimir_cabecalho("Fila de Espera (Prioridades)");
+            travar_base(lista, fila);
             fila_imprimir(fila);
+            liberar_base(lista, fila);
             break;
         }
 
@@ -352,34 +588,60 @@ int main()
         case DAR_ALTA:
         {
             imprimir_cabecalho("Atendimento / Alta");
+            travar_base(lista, fila);
             
             if (fila_vazia(fila)) {
                 printf(ANSI_COLOR_YELLOW "Não há pacientes aguardando atendimento.\n" ANSI_COLOR_RESET);
             } else {
-                PACIENTE *pac = fila_remover(fila);
+                int prioridade;
+                PACIENTE *pac = fila_remover_com_prioridade(fila, &prioridade);
                 
                 if (pac) {
+                    char cpf[16];
+                    strcpy(cpf, paciente_obter_cpf(pac));
+                    int64_t chegada = registro_chegada(paciente_obter_id(pac));
+                    int64_t saida = (int64_t)time(NULL);
+                    wal_registrar_saida_fila(cpf);
                     printf(ANSI_STYLE_BOLD "ATENDENDO PACIENTE: %s\n" ANSI_COLOR_RESET, paciente_obter_nome(pac));
-                    printf("CPF: %s\n\n", paciente_obter_cpf(pac));
+                    printf("CPF: %s\n\n", cpf);
+                    liberar_base(lista, fila);
 
                     printf("Deseja registrar o procedimento? (s/n): ");
                     char op;
                     scanf(" %c", &op);
                     getchar(); 
 
+                    char proc[256];
                     if (op == 's' || op == 'S') {
-                        char proc[256];
                         printf("Descreva o procedimento: ");
                         fgets(proc, 256, stdin);
                         proc[strcspn(proc, "\n")] = '\0';
-                        
-                        historico_inserir(paciente_obter_historico(pac), proc);
-                        printf(ANSI_COLOR_GREEN "[REGISTRADO] Procedimento salvo.\n" ANSI_COLOR_RESET);
                     }
+                    travar_base(lista, fila);
+
+                    if (op == 's' || op == 'S') {
+                        pac = lista_buscar(lista, cpf);
+                        if (pac) {
+                            historico_inserir(paciente_obter_historico(pac), proc);
+                            paciente_marcar_alterado(pac);
+                            wal_registrar_historico_inserir(cpf, proc);
+                            printf(ANSI_COLOR_GREEN "[REGISTRADO] Procedimento salvo.\n" ANSI_COLOR_RESET);
+                        } else {
+                            printf(ANSI_COLOR_RED "[ERRO] Paciente removido por outro processo.\n" ANSI_COLOR_RESET);
+                        }
+                    }
+
+                    // O atendimento encerrado vai para o arquivo de altas (ver altas.c)
+                    if (!altas_registrar(cpf_empacotar(cpf), prioridade + 1, chegada, saida,
+                                         (op == 's' || op == 'S') ? proc : NULL))
+                        printf(ANSI_COLOR_YELLOW "[AVISO] Não foi possível arquivar o atendimento em %s.\n" ANSI_COLOR_RESET, ALTAS_DIRETORIO);
 
                     printf(ANSI_COLOR_GREEN "\n[ALTA] Paciente liberado com sucesso.\n" ANSI_COLOR_RESET);
+                } else {
+                    printf(ANSI_COLOR_RED "[ERRO] Não foi possível ler o próximo paciente do arquivo de excedentes da fila. Tente novamente.\n" ANSI_COLOR_RESET);
                 }
             }
+            liberar_base(lista, fila);
             break;
         }
 
@@ -391,6 +653,7 @@ int main()
             imprimir_cabecalho("Gestão Manual de Histórico");
             char *cpf = cpf_ler();
             if (cpf) {
+                travar_base(lista, fila);
                 PACIENTE *pac = lista_buscar(lista, cpf);
                 if (pac) {
                     printf("Paciente: " ANSI_STYLE_BOLD "%s" ANSI_COLOR_RESET "\n", paciente_obter_nome(pac));
@@ -399,25 +662,38 @@ int main()
                     printf("3. Mostrar Histórico Completo\n");
                     printf("Escolha: ");
                     
+                    liberar_base(lista, fila);
                     int h_op;
                     scanf("%d", &h_op);
                     getchar();
 
-                    HISTORICO *hist = paciente_obter_historico(pac);
-                    
+                    char proc[256];
                     if (h_op == 1) {
-                        char proc[256];
                         printf("Procedimento: ");
                         fgets(proc, 256, stdin);
                         proc[strcspn(proc, "\n")] = '\0';
+                    }
+
+                    travar_base(lista, fila);
+                    pac = lista_buscar(lista, cpf);
+                    HISTORICO *hist = pac ? paciente_obter_historico(pac) : NULL;
+                    
+                    if (pac == NULL) {
+                        printf(ANSI_COLOR_RED "Paciente removido por outro processo.\n" ANSI_COLOR_RESET);
+                    }
+                    else if (h_op == 1) {
                         historico_inserir(hist, proc);
+                        paciente_marcar_alterado(pac);
+                        wal_registrar_historico_inserir(cpf, proc);
                         printf(ANSI_COLOR_GREEN "Adicionado.\n" ANSI_COLOR_RESET);
                     } 
                     else if (h_op == 2) {
                         char *removido = historico_remover(hist);
                         if (removido) {
+                            paciente_marcar_alterado(pac);
+                            wal_registrar_historico_remover(cpf);
+                            // A descrição pertence ao catálogo ou ao histórico: não liberar
                             printf(ANSI_COLOR_YELLOW "Desfeito: %s\n" ANSI_COLOR_RESET, removido);
-                            free(removido);
                         } else {
                             printf(ANSI_COLOR_RED "Histórico vazio.\n" ANSI_COLOR_RESET);
                         }
@@ -432,24 +708,175 @@ int main()
                 } else {
                     printf(ANSI_COLOR_RED "Paciente não encontrado.\n" ANSI_COLOR_RESET);
                 }
+                liberar_base(lista, fila);
                 free(cpf);
             }
             break;
         }
 
+        /**
+         * @brief Grava a LISTA e a FILA sem interromper o atendimento.
+         */
+        case SALVAR_AGORA:
+        {
+            imprimir_cabecalho("Salvar Dados");
+            snapshot_aguardar();
+            travar_base(lista, fila);
+            if (SAVE(&lista, &fila)) {
+                // As operações do log já estão nos arquivos (e, com PS_AUDITORIA, guardadas)
+                if (wal_truncar())
+                    auditoria_ponto();
+                printf(ANSI_COLOR_GREEN "[SUCESSO] Dados salvos em disco.\n" ANSI_COLOR_RESET);
+            } else {
+                printf(ANSI_COLOR_RED "[ERRO] Falha ao salvar os dados.\n" ANSI_COLOR_RESET);
+            }
+            liberar_base(lista, fila);
+            break;
+        }
+
+        /**
+         * @brief Espera média por mês e prioridade dos atendimentos encerrados.
+         */
+        case RELATORIO_ALTAS:
+        {
+            imprimir_cabecalho("Espera Média por Mês");
+            // Na auditoria, só as altas até o instante consultado
+            ALTAS_FILTRO filtro = { 0, consulta ? auditoria_instante() + 1 : 0, 0 };
+            altas_imprimir_espera_mensal(&filtro);
+            break;
+        }
+
+        /**
+         * @brief Contagens, agregados e listas filtradas de pacientes.
+         */
+        case CONSULTAR_PACIENTES:
+        {
+            imprimir_cabecalho("Consultar Pacientes");
+            pesquisa_ajuda();
+            printf("\nConsulta: ");
+            char texto[PESQUISA_MAX_TEXTO];
+            if (fgets(texto, sizeof(texto), stdin) == NULL) break;
+            texto[strcspn(texto, "\n")] = '\0';
+
+            char erro[128];
+            PESQUISA *pesquisa = pesquisa_compilar(texto, erro, sizeof(erro));
+            if (pesquisa == NULL) {
+                printf(ANSI_COLOR_RED "[ERRO] Consulta inválida: %s\n" ANSI_COLOR_RESET, erro);
+                break;
+            }
+
+            printf("\n");
+            travar_base(lista, fila);
+            if (!pesquisa_executar(pesquisa, lista, stdout))
+                printf(ANSI_COLOR_RED "[ERRO] Memória insuficiente para a consulta.\n" ANSI_COLOR_RESET);
+            liberar_base(lista, fila);
+            pesquisa_apagar(&pesquisa);
+            break;
+        }
+
+        /**
+         * @brief Cadastro em massa a partir de um arquivo, ou exportação da lista.
+         */
+        case IMPORTAR_EXPORTAR:
+        {
+            imprimir_cabecalho("Importar/Exportar Pacientes");
+            char linha[16], caminho[256];
+            printf("1 - Importar\n2 - Exportar\nOperação: ");
+            if (fgets(linha, sizeof(linha), stdin) == NULL) break;
+            bool importar = linha[0] == '1';
+            if (!importar && linha[0] != '2') {
+                printf(ANSI_COLOR_RED "[ERRO] Operação inválida.\n" ANSI_COLOR_RESET);
+                break;
+            }
+            // A réplica e a auditoria só exportam
+            if (importar && somente_leitura) {
+                printf(ANSI_COLOR_YELLOW "[AVISO] A importação é feita no processo principal.\n" ANSI_COLOR_RESET);
+                break;
+            }
+
+            printf("Formato (1 - CSV, 2 - JSON Lines): ");
+            if (fgets(linha, sizeof(linha), stdin) == NULL) break;
+            bool jsonl = linha[0] == '2';
+            printf("Arquivo: ");
+            if (fgets(caminho, sizeof(caminho), stdin) == NULL) break;
+            caminho[strcspn(caminho, "\n")] = '\0';
+            if (caminho[0] == '\0') break;
+
+            if (importar) {
+                IMPORTACAO_RESULTADO resultado;
+                travar_base(lista, fila);
+                bool ok = importacao_carregar(caminho, jsonl ? IMPORTACAO_JSONL : IMPORTACAO_CSV, lista, &resultado);
+                liberar_base(lista, fila);
+                if (!ok) {
+                    printf(ANSI_COLOR_RED "[ERRO] Não foi possível importar %s (arquivo ilegível ou memória insuficiente).\n" ANSI_COLOR_RESET, caminho);
+                    break;
+                }
+                printf(ANSI_COLOR_GREEN "[SUCESSO] %llu paciente(s) importado(s) de %llu registro(s) em %.1f ms (%.0f registros/s).\n" ANSI_COLOR_RESET,
+                       (unsigned long long)resultado.importados, (unsigned long long)resultado.registros, resultado.duracao_ms,
+                       resultado.duracao_ms > 0 ? resultado.registros * 1e3 / resultado.duracao_ms : 0.0);
+                printf("Ignorados: %llu CPF(s) inválido(s), %llu já cadastrado(s), %llu repetido(s) no arquivo, %llu linha(s) malformada(s).\n",
+                       (unsigned long long)resultado.cpf_invalidos, (unsigned long long)resultado.ja_cadastrados,
+                       (unsigned long long)resultado.repetidos, (unsigned long long)resultado.malformados);
+            } else {
+                FILE *destino = fopen(caminho, "wb");
+                if (destino == NULL) {
+                    printf(ANSI_COLOR_RED "[ERRO] Não foi possível criar %s.\n" ANSI_COLOR_RESET, caminho);
+                    break;
+                }
+                RELATORIO_MEDIDA medida;
+                travar_base(lista, fila);
+                bool ok = relatorio_pacientes(lista, jsonl ? RELATORIO_JSONL : RELATORIO_CSV, destino, &medida);
+                liberar_base(lista, fila);
+                if (fclose(destino) != 0 || !ok) {
+                    printf(ANSI_COLOR_RED "[ERRO] A exportação não foi escrita por completo.\n" ANSI_COLOR_RESET);
+                    break;
+                }
+                printf(ANSI_COLOR_GREEN "[SUCESSO] %llu paciente(s) exportado(s) para %s em %.1f ms.\n" ANSI_COLOR_RESET,
+                       (unsigned long long)medida.pacientes, caminho, medida.duracao_ms);
+            }
+            break;
+        }
+
         case SAIR:
             imprimir_cabecalho("Encerrando Sistema");
-            printf("Salvando dados em disco...\n");
+            if (!somente_leitura) printf("Salvando dados em disco...\n");
             break;
         }
 
+        // Os registros da operação são confirmados juntos no log
+        wal_confirmar();
+
         if (opcao != SAIR) pausar_para_continuar();
 
     } while (opcao != SAIR);
 
-    SAVE(&lista, &fila);
-    lista_apagar(&lista);
-    fila_apagar(&fila);
+    snapshot_aguardar();
+
+    // Com o SAVE completo, as operações do log já estão nos arquivos; a réplica e a auditoria não gravam.
+    // No heap compartilhado, só o último processo a sair grava o SAVE
+    bool salvo = false;
+    if (!somente_leitura) {
+        if (heap_ultimo()) {
+            travar_base(lista, fila);
+            imprimir_filtro(lista);
+            salvo = SAVE(&lista, &fila);
+            if (salvo && wal_truncar())
+                auditoria_ponto();
+            liberar_base(lista, fila);
+        } else {
+            printf("[INFO] Outros processos continuam com os dados compartilhados: o SAVE fica com o último.\n");
+        }
+        wal_fechar();
+    }
+    altas_encerrar();
+
+    // No heap persistente as estruturas (e o catálogo) ficam no arquivo para a próxima execução
+    if (!IO_fechar_heap(lista, fila, salvo)) {
+        lista_apagar(&lista);
+        fila_apagar(&fila);
+        registro_apagar();
+        catalogo_apagar();
+    }
 
     printf(ANSI_COLOR_GREEN "Sistema encerrado com segurança.\n" ANSI_COLOR_RESET);
     return 0;
@@ -3,40 +3,673 @@
  * @brief Implementa as rotinas de salvar e carregar os dados persistentes
  *        do sistema, incluindo a lista de pacientes e a fila com prioridade.
  *
- * O sistema utiliza dois arquivos binários:
+ * O sistema utiliza três arquivos binários:
+ *  - data/catalogo.bin     → Catálogo de procedimentos (código → descrição)
  *  - data/lista_itens.bin  → Contém todos os pacientes cadastrados
  *  - data/fila_itens.bin   → Contém a fila de espera com prioridade
  *
- * A serialização dos pacientes é feita como STRING, gerada por `paciente_para_string()`.
- * Na fila, cada registro é salvo com PRIORIDADE → TAMANHO → STRING.
+ * A lista e a fila usam o formato versionado de arquivo.c: cabeçalho com
+ * assinatura, versão e marcador de ordem de bytes; blocos de tamanho fixo com
+ * CRC32C; e um índice com o primeiro CPF de cada bloco. Um bloco corrompido é
+ * descartado sem impedir o carregamento dos demais.
+ *
+ * A serialização dos pacientes é descrita em segmentos por `paciente_serializar()`,
+ * que apontam direto para a memória de cada paciente e são gravados sem cópias
+ * intermediárias. O histórico de cada paciente referencia os códigos do catálogo.
+ * Na fila, cada registro é uma referência de tamanho fixo: o CPF (a chave),
+ * a PRIORIDADE e o horário de CHEGADA; os dados do paciente ficam só na lista.
+ *
+ * Com PS_SAVE_INCREMENTAL=1, o SAVE troca no próprio arquivo da lista só os
+ * blocos com pacientes alterados ou removidos (ver salvar_lista_incremental()).
+ *
+ * Com PS_HEAP=1, a LISTA e a FILA vivem no heap persistente (ver heap.c) e
+ * são retomadas dele na inicialização, sem LOAD, quando a execução anterior
+ * terminou com um SAVE completo (ver IO_abrir_heap()). Com PS_COMPARTILHADO=1,
+ * vários processos trabalham ao mesmo tempo sobre o mesmo heap, cada acesso
+ * entre IO_travar() e IO_destravar().
+ *
+ * Os três arquivos podem ser copiados para outro diretório e carregados de
+ * lá (ver IO_copiar_dados() e IO_carregar_de()): são os pontos de
+ * restauração da auditoria (ver auditoria.c).
+ *
+ * Arquivos anteriores ao formato versionado (sequência de registros
+ * TAMANHO → STRING, e, sem data/catalogo.bin, procedimentos em texto) continuam
+ * sendo aceitos pelo LOAD e são convertidos no SAVE seguinte.
  */
 
 #include "../include/IO.h"
+#include "../include/arquivo.h"
+#include "../include/bloom.h"
+#include "../include/catalogo.h"
+#include "../include/cpf.h"
 #include "../include/paciente.h"
 #include "../include/lista.h"
 #include "../include/fila.h" 
+#include "../include/heap.h"
+#include "../include/mapa.h"
+#include "../include/registro.h"
+#include "../include/replica.h"
+#include "../include/tarefas.h"
+#include "../include/wal.h"
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
+#define ARQUIVO_CATALOGO "data/catalogo.bin"
+#define ARQUIVO_LISTA "data/lista_itens.bin"
+#define ARQUIVO_FILA "data/fila_itens.bin"
+#define SUFIXO_TEMPORARIO ".tmp" ///< Arquivos em gravação, renomeados ao final do SAVE
+#define IO_MAX_REGISTRO 4096  ///< Maior registro aceito no formato antigo (inclui o legado em texto)
+#define IO_TAM_ENTRADA_FILA 12        ///< PRIORIDADE (int32) + CHEGADA (int64) em cada registro da fila
+#define IO_BLOCOS_POR_TAREFA 64       ///< Menos blocos que isso por thread não compensam o LOAD paralelo
+#define IO_REGISTROS_POR_LOTE 16384   ///< Pacientes serializados por thread a cada rodada do SAVE paralelo
+#define IO_LIMITE_LIVRE 0.25          ///< Fração de páginas livres a partir da qual o SAVE incremental compacta a lista
+#define IO_TAM_CAMINHO 512            ///< Maior caminho de um arquivo de dados em outro diretório
+
+static bool formato_antigo = false;  ///< O último LOAD leu algum arquivo no formato antigo
+static int blocos_corrompidos = 0;   ///< Blocos descartados no último LOAD
+static bool sob_demanda = false;     ///< O último LOAD deixou a lista no modo sob demanda
+static bool base_incremental = false; ///< O arquivo da lista mais as alterações marcadas reproduzem a lista em memória
+static bool heap_em_uso = false;      ///< A LISTA e a FILA foram retomadas de um heap compartilhado aberto por outro processo
 
 /**
- * @brief Salva a LISTA e a FILA em disco, em formato binário.
+ * @brief Deserializa um paciente no formato antigo, com procedimentos em texto.
+ *
+ * Formato: [11 bytes CPF]\0[Nome]\0[Procedimento1]\0[Procedimento2]\0...
+ * Cada procedimento é internado no catálogo ao ser reinserido no histórico.
  *
- * A função percorre:
+ * @param buffer String de bytes terminada por '\0' extra
+ * @return Novo PACIENTE ou NULL em caso de erro
+ */
+static PACIENTE *paciente_de_string_legado(char *buffer)
+{
+    char *cpf = buffer;
+    buffer += strlen(buffer) + 1;
+
+    char *nome = buffer;
+    buffer += strlen(buffer) + 1;
+
+    PACIENTE *p = paciente_criar(nome, cpf);
+    if (p == NULL) return NULL;
+
+    while (*buffer != '\0')
+    {
+        historico_inserir(paciente_obter_historico(p), buffer);
+        buffer += strlen(buffer) + 1;
+    }
+
+    return p;
+}
+
+/**
+ * @brief Substitui um arquivo pela sua versão temporária recém-gravada.
+ * @param temporario Arquivo gravado
+ * @param destino Arquivo substituído
+ * @return true se a troca foi feita
+ */
+static bool substituir_arquivo(const char *temporario, const char *destino)
+{
+#ifdef _WIN32
+    /* rename() do Windows não sobrescreve um arquivo existente */
+    remove(destino);
+#endif
+    return rename(temporario, destino) == 0;
+}
+
+/**
+ * @brief Caminho de um arquivo de dados dentro de outro diretório.
+ * @param diretorio Diretório dos arquivos (NULL = o próprio caminho)
+ * @param caminho Arquivo de dados (ARQUIVO_*)
+ * @param buffer Área onde o caminho é montado
+ * @return O caminho a usar
+ */
+static const char *caminho_em(const char *diretorio, const char *caminho, char buffer[IO_TAM_CAMINHO])
+{
+    if (diretorio == NULL) return caminho;
+
+    const char *nome = strrchr(caminho, '/');
+    snprintf(buffer, IO_TAM_CAMINHO, "%s/%s", diretorio, nome ? nome + 1 : caminho);
+    return buffer;
+}
+
+/**
+ * @brief Copia um arquivo inteiro, sincronizando a cópia com o disco.
+ * @param origem Arquivo copiado
+ * @param destino Cópia (substituída se existir)
+ * @return true se a cópia foi gravada
+ */
+static bool copiar_arquivo(const char *origem, const char *destino)
+{
+    MAPA *mapa = mapa_abrir(origem);
+    if (mapa == NULL) return false;
+
+    FILE *fp = fopen(destino, "wb");
+    bool ok = fp != NULL && fwrite(mapa_dados(mapa), 1, mapa_tamanho(mapa), fp) == mapa_tamanho(mapa);
+    if (fp != NULL)
+    {
+        ok = fflush(fp) == 0 && ok;
+#ifdef _WIN32
+        ok = ok && _commit(_fileno(fp)) == 0;
+#else
+        ok = ok && fsync(fileno(fp)) == 0;
+#endif
+        ok = fclose(fp) == 0 && ok;
+    }
+
+    mapa_fechar(&mapa);
+    return ok;
+}
+
+/**
+ * @brief Grava um paciente como registro do arquivo.
+ * @return true se o registro foi aceito
+ */
+static bool salvar_paciente(ARQUIVO_ESCRITOR *esc, PACIENTE *paciente)
+{
+    SEGMENTO segmentos[PACIENTE_MAX_SEGMENTOS];
+    int tamanho;
+    int n = paciente_serializar(paciente, segmentos, &tamanho);
+
+    return n > 0 && arquivo_escrever(esc, registro_cpf(paciente_obter_id(paciente)),
+                                     NULL, 0, segmentos, n);
+}
+
+/**
+ * @brief Contexto dos callbacks de gravação.
+ */
+typedef struct gravacao_
+{
+    ARQUIVO_ESCRITOR *esc;
+    BLOOM *filtro;  ///< Filtro reconstruído com os CPFs gravados (só na lista)
+    bool ok;
+} GRAVACAO;
+
+/**
+ * @brief Callback de fila_percorrer(): grava a referência CPF → PRIORIDADE → CHEGADA.
+ */
+static void salvar_item_fila(PACIENTE *paciente, int prioridade, void *contexto)
+{
+    GRAVACAO *g = (GRAVACAO *)contexto;
+    PACIENTE_ID id = paciente_obter_id(paciente);
+    int32_t prioridade32 = prioridade;
+    int64_t chegada = registro_chegada(id);
+
+    char entrada[IO_TAM_ENTRADA_FILA];
+    memcpy(entrada, &prioridade32, sizeof(int32_t));
+    memcpy(entrada + sizeof(int32_t), &chegada, sizeof(int64_t));
+
+    if (!arquivo_escrever(g->esc, registro_cpf(id), entrada, IO_TAM_ENTRADA_FILA, NULL, 0))
+        g->ok = false;
+}
+
+/**
+ * @brief Callback de lista_percorrer_registros(): grava um registro com o paciente.
+ * @details Pacientes que só existem no arquivo anterior (modo sob demanda)
+ * são copiados dele como estão, sem serem reconstruídos (nem recomprimidos
+ * um a um: o bloco de origem já foi descomprimido).
+ */
+static void salvar_item_lista(PACIENTE *paciente, uint64_t chave, const char *bytes, uint32_t tamanho, void *contexto)
+{
+    GRAVACAO *g = (GRAVACAO *)contexto;
+    bool ok;
+
+    if (paciente)
+    {
+        ok = salvar_paciente(g->esc, paciente);
+    }
+    else
+    {
+        ok = arquivo_escrever_copia(g->esc, chave, bytes, tamanho);
+    }
+
+    if (!ok)
+        g->ok = false;
+    bloom_inserir(g->filtro, chave);
+}
+
+/**
+ * @brief Registro da lista à espera de uma rodada do SAVE paralelo.
+ */
+typedef struct item_lista_
+{
+    PACIENTE *paciente;  ///< Paciente em memória (ou NULL)
+    uint64_t chave;
+    size_t copia;        ///< Sem paciente: posição da cópia dos bytes do arquivo anterior
+    uint32_t tamanho;
+} ITEM_LISTA;
+
+/**
+ * @brief Contexto do SAVE paralelo da lista.
+ * @details Os registros são acumulados em ordem de CPF; a cada rodada, a
+ * thread i serializa a i-ésima fatia contígua no seu lote e a thread
+ * principal anexa os lotes em ordem. Os registros saem na mesma ordem do SAVE
+ * sequencial; só o último bloco de cada lote fica incompleto.
+ */
+typedef struct gravacao_paralela_
+{
+    ARQUIVO_ESCRITOR *esc;
+    BLOOM *filtro;
+    int n_tarefas;
+    ITEM_LISTA *itens;
+    size_t n_itens;
+    char *copias;        ///< Bytes dos registros sem paciente (só valem durante o percurso)
+    size_t n_copias;
+    size_t capacidade_copias;
+    ARQUIVO_LOTE *lotes[TAREFAS_MAX];
+    bool erro[TAREFAS_MAX];
+    bool ok;
+} GRAVACAO_PARALELA;
+
+/**
+ * @brief Thread do SAVE paralelo: serializa a sua fatia dos registros acumulados.
+ */
+static void salvar_fatia_lista(void *contexto, int indice)
+{
+    GRAVACAO_PARALELA *g = (GRAVACAO_PARALELA *)contexto;
+    size_t inicio = g->n_itens * indice / g->n_tarefas;
+    size_t fim = g->n_itens * (indice + 1) / g->n_tarefas;
+
+    for (size_t i = inicio; i < fim; i++)
+    {
+        ITEM_LISTA *item = &g->itens[i];
+        SEGMENTO segmentos[PACIENTE_MAX_SEGMENTOS];
+        int n = 1;
+
+        if (item->paciente)
+        {
+            int tamanho;
+            n = paciente_serializar(item->paciente, segmentos, &tamanho);
+        }
+        else
+        {
+            segmentos[0] = (SEGMENTO){ g->copias + item->copia, item->tamanho };
+        }
+
+        if (n <= 0 || !arquivo_lote_escrever(g->lotes[indice], item->chave, NULL, 0, segmentos, n))
+            g->erro[indice] = true;
+    }
+}
+
+/**
+ * @brief Serializa os registros acumulados em paralelo e anexa os lotes em ordem.
+ */
+static void salvar_rodada_lista(GRAVACAO_PARALELA *g)
+{
+    if (g->n_itens == 0) return;
+
+    tarefas_executar(g->n_tarefas, salvar_fatia_lista, g);
+    for (int i = 0; i < g->n_tarefas; i++)
+    {
+        if (!arquivo_anexar_lote(g->esc, g->lotes[i]) || g->erro[i])
+            g->ok = false;
+        g->erro[i] = false;
+    }
+    g->n_itens = 0;
+    g->n_copias = 0;
+}
+
+/**
+ * @brief Callback de lista_percorrer_registros() no SAVE paralelo: acumula o registro.
+ */
+static void acumular_item_lista(PACIENTE *paciente, uint64_t chave, const char *bytes, uint32_t tamanho, void *contexto)
+{
+    GRAVACAO_PARALELA *g = (GRAVACAO_PARALELA *)contexto;
+    size_t copia = g->n_copias;
+
+    if (!paciente)
+    {
+        if (g->capacidade_copias - g->n_copias < tamanho)
+        {
+            size_t nova = g->capacidade_copias ? g->capacidade_copias * 2 : 1 << 20;
+            while (nova - g->n_copias < tamanho)
+                nova *= 2;
+            char *copias = realloc(g->copias, nova);
+            if (!copias)
+            {
+                g->ok = false;
+                return;
+            }
+            g->copias = copias;
+            g->capacidade_copias = nova;
+        }
+        memcpy(g->copias + g->n_copias, bytes, tamanho);
+        g->n_copias += tamanho;
+    }
+
+    g->itens[g->n_itens++] = (ITEM_LISTA){ paciente, chave, copia, tamanho };
+    bloom_inserir(g->filtro, chave);
+
+    if (g->n_itens == (size_t)g->n_tarefas * IO_REGISTROS_POR_LOTE)
+        salvar_rodada_lista(g);
+}
+
+/**
+ * @brief Grava a lista com várias threads (ver GRAVACAO_PARALELA).
+ * @return true se a lista foi percorrida e todos os lotes foram gravados;
+ * false sem escrever nada se faltar memória para os lotes
+ */
+static bool salvar_lista_paralela(ARQUIVO_ESCRITOR *esc, uint32_t opcoes, LISTA *lista, int n_tarefas,
+                                  BLOOM *filtro, bool *ok)
+{
+    GRAVACAO_PARALELA g = { esc, filtro, n_tarefas, NULL, 0, NULL, 0, 0, { NULL }, { false }, true };
+    bool preparado = (g.itens = malloc((size_t)n_tarefas * IO_REGISTROS_POR_LOTE * sizeof(ITEM_LISTA))) != NULL;
+    for (int i = 0; i < n_tarefas && preparado; i++)
+        preparado = (g.lotes[i] = arquivo_lote_criar(opcoes)) != NULL;
+
+    if (preparado)
+    {
+        lista_percorrer_registros(lista, acumular_item_lista, &g);
+        salvar_rodada_lista(&g);
+        *ok = g.ok;
+    }
+
+    for (int i = 0; i < n_tarefas; i++)
+        arquivo_lote_apagar(&g.lotes[i]);
+    free(g.itens);
+    free(g.copias);
+    return preparado;
+}
+
+/**
+ * @brief Lê a opção de compressão dos arquivos de dados (variável PS_COMPRESSAO).
+ * @return uint32_t ARQUIVO_OPCAO_LZ se a variável vale "1"; 0 caso contrário
+ */
+static uint32_t opcoes_arquivo(void)
+{
+    const char *valor = getenv(IO_VARIAVEL_COMPRESSAO);
+    return valor != NULL && strcmp(valor, "1") == 0 ? ARQUIVO_OPCAO_LZ : 0;
+}
+
+/**
+ * @brief Grava um arquivo de dados percorrendo a LISTA ou a FILA.
+ * @param caminho Arquivo de destino
+ * @param tipo ARQUIVO_TIPO_LISTA ou ARQUIVO_TIPO_FILA
+ * @param lista LISTA a percorrer (quando tipo é ARQUIVO_TIPO_LISTA)
+ * @param fila FILA a percorrer (quando tipo é ARQUIVO_TIPO_FILA)
+ * @param filtro Recebe os CPFs gravados (pode ser NULL)
+ * @param ponto Último registro do log coberto (ver arquivo_definir_ponto())
+ * @param assinatura Recebe o resumo das chaves gravadas (pode ser NULL)
+ * @return true se o arquivo foi gravado por inteiro
+ */
+static bool salvar_arquivo(const char *caminho, uint16_t tipo, LISTA *lista, FILA *fila,
+                           BLOOM *filtro, uint64_t ponto, uint64_t *assinatura)
+{
+    uint32_t opcoes = opcoes_arquivo();
+    GRAVACAO g = { arquivo_criar(caminho, tipo, opcoes), filtro, true };
+    if (!g.esc) return false;
+    arquivo_definir_ponto(g.esc, ponto);
+
+    int n_tarefas = tarefas_quantidade();
+    if (tipo == ARQUIVO_TIPO_LISTA)
+    {
+        /* Sem memória para os lotes, grava pelo caminho sequencial */
+        if (n_tarefas < 2 || !salvar_lista_paralela(g.esc, opcoes, lista, n_tarefas, filtro, &g.ok))
+            lista_percorrer_registros(lista, salvar_item_lista, &g);
+    }
+    else
+    {
+        // Uma falha ao ler os excedentes gravaria uma fila truncada
+        if (!fila_percorrer(fila, salvar_item_fila, &g))
+            g.ok = false;
+    }
+
+    if (assinatura)
+        *assinatura = arquivo_escritor_assinatura(g.esc);
+    return arquivo_finalizar(&g.esc) && g.ok;
+}
+
+/**
+ * @brief Alteração da lista desde o último SAVE (ou LOAD).
+ */
+typedef struct alteracao_
+{
+    uint64_t chave;      ///< CPF empacotado
+    PACIENTE *paciente;  ///< Paciente a gravar (NULL = registro removido)
+} ALTERACAO;
+
+/**
+ * @brief Compara alterações pelo CPF; no mesmo CPF, o paciente vem antes da remoção (qsort()).
+ */
+static int comparar_alteracoes(const void *a, const void *b)
+{
+    const ALTERACAO *x = (const ALTERACAO *)a;
+    const ALTERACAO *y = (const ALTERACAO *)b;
+    if (x->chave != y->chave)
+        return (x->chave > y->chave) - (x->chave < y->chave);
+    return (x->paciente == NULL) - (y->paciente == NULL);
+}
+
+/**
+ * @brief Reúne os pacientes marcados como REGISTRO_ALTERADO e os CPFs removidos, em ordem de CPF.
+ * @details Um CPF removido e cadastrado de novo aparece uma vez só, com o paciente.
+ * @return ALTERACAO* Vetor alocado (NULL se faltar memória)
+ */
+static ALTERACAO *reunir_alteracoes(LISTA *lista, size_t *n)
+{
+    size_t n_removidos;
+    const uint64_t *removidos = lista_removidos(lista, &n_removidos);
+
+    size_t capacidade = n_removidos + 64, total = 0;
+    ALTERACAO *alteracoes = malloc(capacidade * sizeof(ALTERACAO));
+    if (!alteracoes) return NULL;
+
+    for (size_t i = 0; i < n_removidos; i++)
+        alteracoes[total++] = (ALTERACAO){ removidos[i], NULL };
+
+    for (PACIENTE_ID id = 0; id < registro_limite(); id++)
+    {
+        PACIENTE *paciente = registro_paciente(id);
+        if (!paciente || !(registro_marcas(id) & REGISTRO_ALTERADO))
+            continue;
+
+        if (total == capacidade)
+        {
+            ALTERACAO *maior = realloc(alteracoes, 2 * capacidade * sizeof(ALTERACAO));
+            if (!maior)
+            {
+                free(alteracoes);
+                return NULL;
+            }
+            alteracoes = maior;
+            capacidade *= 2;
+        }
+        alteracoes[total++] = (ALTERACAO){ registro_cpf(id), paciente };
+    }
+
+    qsort(alteracoes, total, sizeof(ALTERACAO), comparar_alteracoes);
+    size_t m = 0;
+    for (size_t i = 0; i < total; i++)
+    {
+        if (m == 0 || alteracoes[m - 1].chave != alteracoes[i].chave)
+            alteracoes[m++] = alteracoes[i];
+    }
+    *n = m;
+    return alteracoes;
+}
+
+/**
+ * @brief Monta no lote o novo conteúdo de um bloco: os registros atuais com as alterações aplicadas.
+ * @param atu Atualização do arquivo da lista
+ * @param bloco Bloco da versão atual
+ * @param alteracoes Alterações cujos CPFs caem no bloco, em ordem
+ * @param n Quantidade de alterações
+ * @param lote Lote sem compressão (vazio)
+ * @return true se o bloco estava íntegro e todos os registros couberam
+ */
+static bool mesclar_bloco(ARQUIVO_ATUALIZACAO *atu, uint64_t bloco, const ALTERACAO *alteracoes, size_t n,
+                          ARQUIVO_LOTE *lote)
+{
+    const char *dados;
+    uint32_t tamanho, pos = 0;
+    if (!arquivo_atualizacao_bloco(atu, bloco, &dados, &tamanho))
+        return false;
+
+    uint64_t chave;
+    const char *bytes;
+    uint32_t tam_registro;
+    bool tem = arquivo_proximo(dados, tamanho, &pos, &chave, &bytes, &tam_registro);
+    bool ok = true;
+    size_t k = 0;
+
+    while (ok && (tem || k < n))
+    {
+        if (k < n && (!tem || alteracoes[k].chave <= chave))
+        {
+            /* O paciente em memória substitui o registro do arquivo (ou entra novo) */
+            if (alteracoes[k].paciente)
+            {
+                SEGMENTO segmentos[PACIENTE_MAX_SEGMENTOS];
+                int tam;
+                int s = paciente_serializar(alteracoes[k].paciente, segmentos, &tam);
+                ok = s > 0 && arquivo_lote_escrever(lote, alteracoes[k].chave, NULL, 0, segmentos, s);
+            }
+            if (tem && alteracoes[k].chave == chave)
+                tem = arquivo_proximo(dados, tamanho, &pos, &chave, &bytes, &tam_registro);
+            k++;
+        }
+        else
+        {
+            SEGMENTO segmento = { bytes, tam_registro };
+            ok = arquivo_lote_escrever(lote, chave, NULL, 0, &segmento, 1);
+            tem = arquivo_proximo(dados, tamanho, &pos, &chave, &bytes, &tam_registro);
+        }
+    }
+    return ok;
+}
+
+/**
+ * @brief Grava só os blocos da lista que mudaram desde o último SAVE, no próprio arquivo.
+ *
+ * Os pacientes alterados (REGISTRO_ALTERADO: cadastros e históricos
+ * alterados) e os CPFs removidos são agrupados pelo bloco do arquivo em que
+ * caem. Cada bloco afetado é remontado com as alterações e gravado em
+ * páginas livres; os demais blocos não são lidos nem gravados (ver
+ * arquivo_atualizar()). A fila não participa: ela guarda só referências, no
+ * seu próprio arquivo.
+ *
+ * Se as páginas livres passarem de IO_LIMITE_LIVRE do arquivo, nada é
+ * gravado e o SAVE regrava a lista inteira, compactando-a. Com
+ * PS_SNAPSHOT_INTERVALO, essa compactação ocorre no processo filho do
+ * snapshot, em segundo plano.
+ *
+ * @param lista LISTA no modo completo
+ * @param ponto Último registro do log coberto pela nova versão
+ * @param assinatura Recebe o resumo das chaves da nova versão
+ * @return true se a nova versão foi confirmada; false se o arquivo continua
+ *         como estava (o chamador grava a lista inteira)
+ */
+static bool salvar_lista_incremental(LISTA *lista, uint64_t ponto, uint64_t *assinatura)
+{
+    ARQUIVO_ATUALIZACAO *atu = arquivo_atualizar(ARQUIVO_LISTA, ARQUIVO_TIPO_LISTA);
+    if (!atu) return false;
+    arquivo_atualizacao_definir_ponto(atu, ponto);
+
+    size_t n = 0;
+    ALTERACAO *alteracoes = NULL;
+    ARQUIVO_LOTE *lote = NULL;
+    bool ok = arquivo_atualizacao_livre(atu) <= IO_LIMITE_LIVRE &&
+              (alteracoes = reunir_alteracoes(lista, &n)) != NULL &&
+              (lote = arquivo_lote_criar(0)) != NULL;
+
+    for (size_t i = 0; ok && i < n;)
+    {
+        uint64_t bloco = arquivo_atualizacao_localizar(atu, alteracoes[i].chave);
+        size_t j = i + 1;
+        while (j < n && arquivo_atualizacao_localizar(atu, alteracoes[j].chave) == bloco)
+            j++;
+
+        ok = mesclar_bloco(atu, bloco, alteracoes + i, j - i, lote) &&
+             arquivo_substituir_bloco(atu, bloco, lote);
+        i = j;
+    }
+
+    free(alteracoes);
+    arquivo_lote_apagar(&lote);
+    if (!ok)
+    {
+        arquivo_atualizacao_descartar(&atu);
+        return false;
+    }
+    return arquivo_atualizacao_concluir(&atu, assinatura);
+}
+
+/**
+ * @brief Indica se o SAVE pode tentar o caminho incremental (ver salvar_lista_incremental()).
+ */
+static bool pode_salvar_incremental(void)
+{
+    const char *valor = getenv(IO_VARIAVEL_INCREMENTAL);
+    /* No heap compartilhado os CPFs removidos ficam na lista de cada processo */
+    return valor != NULL && strcmp(valor, "1") == 0 && base_incremental && !sob_demanda && opcoes_arquivo() == 0 &&
+           !heap_compartilhado();
+}
+
+/**
+ * @brief Depois de um SAVE completo no modo completo, a lista em memória é igual ao arquivo.
+ */
+static void esquecer_alteracoes(LISTA *lista)
+{
+    if (sob_demanda) return;
+
+    for (PACIENTE_ID id = 0; id < registro_limite(); id++)
+        registro_desligar_marcas(id, REGISTRO_ALTERADO);
+    lista_limpar_removidos(lista);
+    base_incremental = true;
+}
+
+/**
+ * @brief Salva a LISTA e a FILA em disco, em formato binário, sem alterá-las.
+ *
+ * As estruturas são apenas percorridas, então o SAVE pode ser feito a
+ * qualquer momento e o sistema continua atendendo normalmente depois dele.
  * 
  * 1. **Fila:**  
- *    Remove cada paciente (mantendo sua prioridade original), converte para string
- *    e salva no arquivo `data/fila_itens.bin` como:
+ *    Percorre cada prioridade na ordem de chegada (fila_percorrer()) e grava
+ *    em `data/fila_itens.bin` uma referência de tamanho fixo por paciente:
  *    
- *      - prioridade (int)
- *      - tamanho da string (int)
- *      - string do paciente (bytes)
+ *      - CPF empacotado (chave do registro)
+ *      - prioridade (int32)
+ *      - horário de chegada (int64)
  *
  * 2. **Lista:**  
- *    Remove cada paciente e salva apenas:
- *    
- *      - tamanho da string (int)
- *      - string do paciente (bytes)
+ *    Percorre a árvore em ordem de CPF (lista_percorrer_registros()) e grava
+ *    apenas a string do paciente. A ordem crescente permite a busca binária
+ *    pelo índice de blocos. No modo sob demanda, os pacientes nunca
+ *    hidratados são copiados do arquivo anterior. Com mais de uma thread
+ *    (PS_THREADS), fatias consecutivas de CPFs são serializadas em paralelo
+ *    em lotes na memória e anexadas em ordem; as threads são criadas a cada
+ *    rodada de IO_REGISTROS_POR_LOTE registros por thread (ver tarefas.c).
+ *
+ * O catálogo de procedimentos é salvo antes, para que todo código
+ * referenciado pela lista já exista em disco.
  *
- * Depois, ambas as estruturas são apagadas (resetadas).
+ * 3. **Filtro de CPFs:**  
+ *    Reconstruído com os CPFs gravados na lista (descartando os removidos)
+ *    e gravado em `data/bloom.bin` com o resumo das chaves da lista. Uma
+ *    falha aqui não invalida o SAVE: o LOAD reconstrói o filtro.
+ *
+ * Com PS_COMPRESSAO=1, os blocos da lista e da fila são comprimidos (ver
+ * lz.c); o LOAD reconhece os dois formatos pelo cabeçalho.
+ *
+ * Com PS_SAVE_INCREMENTAL=1 e a lista carregada por inteiro de um arquivo
+ * íntegro sem compressão, o passo 2 troca no próprio arquivo só os blocos
+ * com pacientes alterados ou removidos (ver salvar_lista_incremental()); o
+ * catálogo é colocado no lugar antes, e o filtro gravado é o da lista em
+ * memória. Se não for possível, a lista é gravada inteira como acima.
+ *
+ * Cada arquivo é gravado com o sufixo `.tmp`, sincronizado com o disco e só
+ * então renomeado sobre o anterior: uma queda no meio do SAVE mantém o
+ * último SAVE completo.
+ *
+ * A lista e a fila guardam no cabeçalho a sequência do último registro do
+ * log de operações já aplicado (wal_sequencia()): a reaplicação pula os
+ * registros que o arquivo já contém, mesmo que a queda ocorra entre a troca
+ * de um arquivo e a do outro, ou antes de o log ser truncado. No heap
+ * compartilhado cada processo numera o seu log, então nada é gravado (0) e
+ * o log inteiro é reaplicado, como antes.
  *
  * @param lista Ponteiro para o ponteiro da LISTA principal
  * @param fila  Ponteiro para o ponteiro da FILA principal
@@ -47,152 +680,795 @@ bool SAVE(LISTA **lista, FILA **fila)
     if (!lista || !(*lista) || !fila || !*(fila))
         return false;
 
-    PACIENTE *paciente;
-    char *str_paciente;
+    /* Folga para os cadastros até o próximo SAVE */
+    uint64_t cadastrados = bloom_elementos(lista_filtro(*lista));
+    if (cadastrados < registro_quantidade())
+        cadastrados = registro_quantidade();
+    BLOOM *filtro = bloom_criar(2 * cadastrados, bloom_taxa_configurada());
+    uint64_t assinatura = 0;
+    uint64_t ponto = heap_compartilhado() ? 0 : wal_sequencia();
+
+    bool ok = catalogo_salvar(ARQUIVO_CATALOGO SUFIXO_TEMPORARIO);
+    ok = salvar_arquivo(ARQUIVO_FILA SUFIXO_TEMPORARIO, ARQUIVO_TIPO_FILA, NULL, *fila, NULL, ponto, NULL) && ok;
+
+    /* A lista incremental é alterada no próprio arquivo: os códigos que ela
+       referencia precisam estar no catálogo em disco antes */
+    bool catalogo_trocado = ok && pode_salvar_incremental() &&
+                            substituir_arquivo(ARQUIVO_CATALOGO SUFIXO_TEMPORARIO, ARQUIVO_CATALOGO);
+    bool incremental = catalogo_trocado && salvar_lista_incremental(*lista, ponto, &assinatura);
+    if (!incremental)
+        ok = salvar_arquivo(ARQUIVO_LISTA SUFIXO_TEMPORARIO, ARQUIVO_TIPO_LISTA, *lista, NULL, filtro, ponto, &assinatura) && ok;
+
+    BLOOM *gravado = incremental ? lista_filtro(*lista) : filtro;
+    bool filtro_ok = ok && gravado && bloom_salvar(gravado, BLOOM_ARQUIVO SUFIXO_TEMPORARIO, assinatura);
+    bloom_apagar(&filtro);
+    if (!filtro_ok)
+        remove(BLOOM_ARQUIVO SUFIXO_TEMPORARIO);
+
+    /* --- Substituindo os arquivos anteriores --- */
+
+    if (!ok)
+    {
+        remove(ARQUIVO_CATALOGO SUFIXO_TEMPORARIO);
+        remove(ARQUIVO_FILA SUFIXO_TEMPORARIO);
+        remove(ARQUIVO_LISTA SUFIXO_TEMPORARIO);
+        return false;
+    }
+
+    /* O catálogo vem primeiro: seus códigos nunca são reaproveitados, então
+       ele continua válido para a lista anterior se a troca for interrompida */
+    /* O filtro vem depois da lista: se a troca parar entre os dois, o resumo
+       das chaves não confere e o LOAD reconstrói o filtro */
+    ok = (catalogo_trocado || substituir_arquivo(ARQUIVO_CATALOGO SUFIXO_TEMPORARIO, ARQUIVO_CATALOGO)) &&
+         (incremental || substituir_arquivo(ARQUIVO_LISTA SUFIXO_TEMPORARIO, ARQUIVO_LISTA)) &&
+         (!filtro_ok || substituir_arquivo(BLOOM_ARQUIVO SUFIXO_TEMPORARIO, BLOOM_ARQUIVO)) &&
+         substituir_arquivo(ARQUIVO_FILA SUFIXO_TEMPORARIO, ARQUIVO_FILA);
+
+    if (ok)
+        esquecer_alteracoes(*lista);
+    return ok;
+}
+
+/**
+ * @brief Copia os arquivos gravados pelo último SAVE para outro diretório.
+ *
+ * A cópia pode ser lida depois com IO_carregar_de(). O filtro de CPFs não é
+ * copiado: é reconstruído ao carregar.
+ *
+ * @param diretorio Diretório de destino (já existente)
+ * @return true se os três arquivos foram copiados
+ */
+bool IO_copiar_dados(const char *diretorio)
+{
+    if (diretorio == NULL) return false;
+
+    char caminho[IO_TAM_CAMINHO];
+    return copiar_arquivo(ARQUIVO_CATALOGO, caminho_em(diretorio, ARQUIVO_CATALOGO, caminho)) &&
+           copiar_arquivo(ARQUIVO_LISTA, caminho_em(diretorio, ARQUIVO_LISTA, caminho)) &&
+           copiar_arquivo(ARQUIVO_FILA, caminho_em(diretorio, ARQUIVO_FILA, caminho));
+}
+
+/**
+ * @brief Lê o inteiro (cabeçalho) na posição indicada de um arquivo mapeado.
+ * @param dados Início do mapeamento
+ * @param tamanho Tamanho do mapeamento
+ * @param pos Posição do inteiro; avança sizeof(int) se a leitura couber
+ * @param valor Onde o inteiro é armazenado
+ * @return true se havia bytes suficientes
+ */
+static bool mapa_ler_int(const char *dados, size_t tamanho, size_t *pos, int *valor)
+{
+    if (tamanho - *pos < sizeof(int)) return false;
+
+    /* memcpy: os registros não garantem alinhamento do cabeçalho */
+    memcpy(valor, dados + *pos, sizeof(int));
+    *pos += sizeof(int);
+    return true;
+}
+
+/**
+ * @brief Carrega a lista no formato antigo: sequência de TAMANHO → STRING.
+ * @param lista LISTA de destino
+ * @param legado true se os procedimentos estão em texto (sem catálogo)
+ */
+static void carregar_lista_antiga(LISTA *lista, bool legado)
+{
+    MAPA *mapa_lista = mapa_abrir(ARQUIVO_LISTA);
+    if (mapa_lista == NULL) return;
+
+    const char *dados = mapa_dados(mapa_lista);
+    size_t tamanho = mapa_tamanho(mapa_lista);
+    size_t pos = 0;
+    int tamanho_str_paciente;
+
+    /* Um tamanho fora dos limites (ou além do fim do arquivo) indica arquivo corrompido */
+    while (mapa_ler_int(dados, tamanho, &pos, &tamanho_str_paciente) &&
+           tamanho_str_paciente > 0 && tamanho_str_paciente <= IO_MAX_REGISTRO &&
+           (size_t)tamanho_str_paciente <= tamanho - pos)
+    {
+        PACIENTE *paciente;
+
+        if (legado)
+        {
+            /* +2: o formato legado depende de um '\0' extra após o último texto */
+            char *buffer = calloc(tamanho_str_paciente + 2, sizeof(char));
+            if (!buffer) break;
+            memcpy(buffer, dados + pos, tamanho_str_paciente);
+            paciente = paciente_de_string_legado(buffer);
+            free(buffer);
+        }
+        else
+        {
+            paciente = paciente_de_bytes(dados + pos, tamanho_str_paciente);
+        }
+
+        if (paciente)
+            lista_inserir(lista, paciente);
+        pos += tamanho_str_paciente;
+    }
+    mapa_fechar(&mapa_lista);
+}
+
+/**
+ * @brief Carrega a fila no formato antigo: sequência de PRIORIDADE → TAMANHO → STRING.
+ * @param lista LISTA já carregada (onde os pacientes são buscados)
+ * @param fila FILA de destino
+ */
+static void carregar_fila_antiga(LISTA *lista, FILA *fila)
+{
+    MAPA *mapa_fila = mapa_abrir(ARQUIVO_FILA);
+    if (mapa_fila == NULL) return;
+
+    const char *dados = mapa_dados(mapa_fila);
+    size_t tamanho = mapa_tamanho(mapa_fila);
+    size_t pos = 0;
+    int prioridade_lida;
     int tamanho_str_paciente;
-    int prioridade_capturada;
 
-    /* --- Salvando Fila (com prioridade) --- */
+    while (mapa_ler_int(dados, tamanho, &pos, &prioridade_lida) &&
+           mapa_ler_int(dados, tamanho, &pos, &tamanho_str_paciente) &&
+           tamanho_str_paciente >= 11 && tamanho_str_paciente <= IO_MAX_REGISTRO &&
+           (size_t)tamanho_str_paciente <= tamanho - pos)
+    {
+        /* Extrai CPF dos primeiros 11 caracteres */
+        char cpf_temp[12];
+        memcpy(cpf_temp, dados + pos, 11);
+        cpf_temp[11] = '\0';
 
-    FILE *fp_fila = fopen("data/fila_itens.bin", "wb");
-    if (!fp_fila) return false;
+        /* Busca paciente na lista já carregada e reinsere com a prioridade original */
+        PACIENTE *paciente_encontrado = lista_buscar(lista, cpf_temp);
+        if (paciente_encontrado)
+            fila_inserir(fila, paciente_encontrado, prioridade_lida);
 
-    /**
-     * A função fila_remover_com_prioridade() devolve o paciente
-     * e preenche a variavel 'prioridade_capturada'.
-     */
-    while ((paciente = fila_remover_com_prioridade(*fila, &prioridade_capturada)))
+        pos += tamanho_str_paciente;
+    }
+    mapa_fechar(&mapa_fila);
+}
+
+/**
+ * @brief Percorre os blocos íntegros de um arquivo versionado, contando os corrompidos.
+ * @param arq Arquivo aberto
+ * @param estado Estado devolvido por arquivo_abrir()
+ * @param registro Função chamada para cada registro (chave, bytes, tamanho, contexto)
+ * @param contexto Parâmetro repassado à função
+ */
+static void carregar_blocos(ARQUIVO *arq, ARQUIVO_ESTADO estado,
+                            void (*registro)(uint64_t, const char *, uint32_t, void *), void *contexto)
+{
+    for (uint64_t i = 0; i < arquivo_blocos(arq); i++)
     {
-        str_paciente = paciente_para_string(paciente, &tamanho_str_paciente);
+        const char *dados;
+        uint32_t tamanho, pos = 0;
 
-        if (str_paciente) 
+        if (!arquivo_bloco(arq, i, NULL, &dados, &tamanho))
         {
-            /* Salva PRIORIDADE */
-            fwrite(&prioridade_capturada, sizeof(int), 1, fp_fila);
-            /* Salva TAMANHO */
-            fwrite(&tamanho_str_paciente, sizeof(int), 1, fp_fila);
-            /* Salva STRING */
-            fwrite(str_paciente, sizeof(char), tamanho_str_paciente, fp_fila);
-            
-            free(str_paciente);
+            blocos_corrompidos++;
+            continue;
         }
+
+        uint64_t chave;
+        const char *bytes;
+        uint32_t n;
+        while (arquivo_proximo(dados, tamanho, &pos, &chave, &bytes, &n))
+            registro(chave, bytes, n, contexto);
     }
-    fclose(fp_fila);
-    fila_apagar(fila);
 
-    /* --- Salvando Lista de Pacientes --- */
+    /* Índice perdido: o final do arquivo (e talvez blocos) não pôde ser lido */
+    if (estado == ARQUIVO_TRUNCADO)
+        blocos_corrompidos++;
+}
+
+/**
+ * @brief Pacientes reconstruídos por uma thread do LOAD paralelo.
+ */
+typedef struct parte_carga_
+{
+    PACIENTE **pacientes;
+    size_t n;
+    size_t capacidade;
+    int corrompidos;
+} PARTE_CARGA;
 
-    FILE *fp_lista = fopen("data/lista_itens.bin", "wb");
-    if (!fp_lista) return false;
+/**
+ * @brief Contexto do LOAD paralelo da lista.
+ */
+typedef struct carga_lista_
+{
+    ARQUIVO *arq;
+    int n_tarefas;
+    PARTE_CARGA partes[TAREFAS_MAX];
+} CARGA_LISTA;
 
-    while ((paciente = lista_remover_ultimo(*lista)))
+/**
+ * @brief Thread do LOAD paralelo: reconstrói os pacientes de uma faixa contígua de blocos.
+ * @details Os pacientes ainda não são registrados (ver
+ * paciente_de_bytes_sem_registro()): o armazém central e a árvore só são
+ * alterados depois, pela thread principal.
+ */
+static void carregar_fatia_lista(void *contexto, int indice)
+{
+    CARGA_LISTA *carga = (CARGA_LISTA *)contexto;
+    PARTE_CARGA *parte = &carga->partes[indice];
+    uint64_t n_blocos = arquivo_blocos(carga->arq);
+    uint64_t inicio = n_blocos * indice / carga->n_tarefas;
+    uint64_t fim = n_blocos * (indice + 1) / carga->n_tarefas;
+    char area[ARQUIVO_TAM_BLOCO];
+
+    for (uint64_t i = inicio; i < fim; i++)
     {
-        str_paciente = paciente_para_string(paciente, &tamanho_str_paciente);
+        const char *dados;
+        uint32_t tamanho, pos = 0;
+
+        if (!arquivo_bloco(carga->arq, i, area, &dados, &tamanho))
+        {
+            parte->corrompidos++;
+            continue;
+        }
 
-        if (str_paciente)
+        uint64_t chave;
+        const char *bytes;
+        uint32_t n;
+        while (arquivo_proximo(dados, tamanho, &pos, &chave, &bytes, &n))
         {
-            fwrite(&tamanho_str_paciente, sizeof(int), 1, fp_lista);
-            fwrite(str_paciente, sizeof(char), tamanho_str_paciente, fp_lista);
-            paciente_apagar(&paciente);
-            free(str_paciente);
+            PACIENTE *paciente = paciente_de_bytes_sem_registro(bytes, n);
+            if (!paciente) continue;
+
+            if (parte->n == parte->capacidade)
+            {
+                size_t nova = parte->capacidade ? parte->capacidade * 2 : 1024;
+                PACIENTE **pacientes = realloc(parte->pacientes, nova * sizeof(PACIENTE *));
+                if (!pacientes)
+                {
+                    paciente_apagar(&paciente);
+                    continue;
+                }
+                parte->pacientes = pacientes;
+                parte->capacidade = nova;
+            }
+            parte->pacientes[parte->n++] = paciente;
         }
     }
-    fclose(fp_lista);
-    lista_apagar(lista);
+}
 
-    return true;
+/**
+ * @brief Carrega a lista de um arquivo versionado, com várias threads.
+ *
+ * Os blocos são divididos em faixas contíguas, uma por thread, e cada thread
+ * reconstrói os pacientes da sua faixa. Como as faixas estão em ordem de
+ * CPF, a concatenação das partes também está: a thread principal registra
+ * os pacientes (com o armazém central reservado de uma vez) e monta a árvore
+ * em O(n) com lista_construir(). Se a ordem não conferir (arquivo
+ * adulterado), recai nas inserções uma a uma.
+ *
+ * @param arq Arquivo aberto
+ * @param estado Estado devolvido por arquivo_abrir()
+ * @param lista LISTA de destino
+ */
+static void carregar_lista(ARQUIVO *arq, ARQUIVO_ESTADO estado, LISTA *lista)
+{
+    CARGA_LISTA carga = { arq, tarefas_quantidade(), { { NULL, 0, 0, 0 } } };
+    uint64_t maximo = arquivo_blocos(arq) / IO_BLOCOS_POR_TAREFA;
+    if ((uint64_t)carga.n_tarefas > maximo)
+        carga.n_tarefas = maximo > 0 ? (int)maximo : 1;
+
+    if (carga.n_tarefas > 1)
+        tarefas_executar(carga.n_tarefas, carregar_fatia_lista, &carga);
+    else
+        carregar_fatia_lista(&carga, 0);
+
+    size_t total = 0;
+    for (int i = 0; i < carga.n_tarefas; i++)
+    {
+        total += carga.partes[i].n;
+        blocos_corrompidos += carga.partes[i].corrompidos;
+    }
+
+    /* Índice perdido: o final do arquivo (e talvez blocos) não pôde ser lido */
+    if (estado == ARQUIVO_TRUNCADO)
+        blocos_corrompidos++;
+
+    registro_reservar(total <= UINT32_MAX ? (uint32_t)total : UINT32_MAX);
+    PACIENTE_ID *ids = malloc((total ? total : 1) * sizeof(PACIENTE_ID));
+    size_t n_ids = 0;
+
+    for (int i = 0; i < carga.n_tarefas; i++)
+    {
+        PARTE_CARGA *parte = &carga.partes[i];
+        for (size_t j = 0; j < parte->n; j++)
+        {
+            PACIENTE *paciente = parte->pacientes[j];
+            if (!paciente_registrar(paciente))
+            {
+                paciente_apagar(&paciente);
+                continue;
+            }
+
+            /* Igual ao arquivo: só volta a ser gravado pelo SAVE incremental se mudar */
+            registro_desligar_marcas(paciente_obter_id(paciente), REGISTRO_ALTERADO);
+            if (ids)
+                ids[n_ids++] = paciente_obter_id(paciente);
+            else if (!lista_inserir(lista, paciente))
+                paciente_apagar(&paciente);
+        }
+        free(parte->pacientes);
+    }
+
+    if (ids && !lista_construir(lista, ids, n_ids))
+    {
+        for (size_t i = 0; i < n_ids; i++)
+        {
+            PACIENTE *paciente = registro_paciente(ids[i]);
+            if (!lista_inserir(lista, paciente))
+                paciente_apagar(&paciente);
+        }
+    }
+    free(ids);
+}
+
+/**
+ * @brief Registro da lista: só o CPF, para reconstruir o filtro no modo sob demanda.
+ */
+static void carregar_chave_lista(uint64_t chave, const char *bytes, uint32_t tamanho, void *contexto)
+{
+    (void)bytes;
+    (void)tamanho;
+    bloom_inserir((BLOOM *)contexto, chave);
+}
+
+/**
+ * @brief Referência lida do arquivo da fila.
+ */
+typedef struct entrada_fila_
+{
+    uint64_t chave;      ///< CPF empacotado
+    int prioridade;
+    int64_t chegada;     ///< 0 se desconhecida (registros anteriores às referências)
+    PACIENTE *paciente;  ///< Preenchido pela busca em lote
+} ENTRADA_FILA;
+
+/**
+ * @brief Contexto do carregamento da fila: as referências, na ordem do arquivo.
+ */
+typedef struct carga_fila_
+{
+    ENTRADA_FILA *entradas;
+    size_t n;
+    size_t capacidade;
+} CARGA_FILA;
+
+/**
+ * @brief Registro da fila: guarda a referência para a busca em lote.
+ * @details Registros com mais de IO_TAM_ENTRADA_FILA bytes são do formato
+ * anterior (PRIORIDADE seguida do paciente inteiro): só a prioridade é usada.
+ */
+static void carregar_item_fila(uint64_t chave, const char *bytes, uint32_t tamanho, void *contexto)
+{
+    CARGA_FILA *carga = (CARGA_FILA *)contexto;
+    if (tamanho < sizeof(int32_t)) return;
+
+    ENTRADA_FILA entrada = { chave, 0, 0, NULL };
+    int32_t prioridade;
+    memcpy(&prioridade, bytes, sizeof(int32_t));
+    entrada.prioridade = prioridade;
+    if (tamanho == IO_TAM_ENTRADA_FILA)
+        memcpy(&entrada.chegada, bytes + sizeof(int32_t), sizeof(int64_t));
+
+    if (carga->n == carga->capacidade)
+    {
+        size_t nova = carga->capacidade ? carga->capacidade * 2 : 64;
+        ENTRADA_FILA *entradas = realloc(carga->entradas, nova * sizeof(ENTRADA_FILA));
+        if (!entradas) return;
+        carga->entradas = entradas;
+        carga->capacidade = nova;
+    }
+    carga->entradas[carga->n++] = entrada;
+}
+
+/**
+ * @brief Compara referências da fila pelo CPF (qsort()).
+ */
+static int comparar_entradas_fila(const void *a, const void *b)
+{
+    uint64_t x = (*(const ENTRADA_FILA *const *)a)->chave;
+    uint64_t y = (*(const ENTRADA_FILA *const *)b)->chave;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Reconstrói a FILA a partir das referências lidas.
+ *
+ * As buscas são feitas em ordem crescente de CPF, que é a ordem da árvore e
+ * dos blocos da lista: no modo sob demanda, referências vizinhas caem no
+ * mesmo bloco do arquivo. Depois, os pacientes entram na fila na ordem do
+ * arquivo, com a prioridade e o horário de chegada originais.
+ *
+ * @param carga Referências na ordem do arquivo
+ * @param lista LISTA já carregada
+ * @param fila FILA de destino
+ */
+static void carregar_fila(CARGA_FILA *carga, LISTA *lista, FILA *fila)
+{
+    ENTRADA_FILA **ordenadas = malloc((carga->n ? carga->n : 1) * sizeof(ENTRADA_FILA *));
+    for (size_t i = 0; ordenadas && i < carga->n; i++)
+        ordenadas[i] = &carga->entradas[i];
+    if (ordenadas)
+        qsort(ordenadas, carga->n, sizeof(ENTRADA_FILA *), comparar_entradas_fila);
+
+    for (size_t i = 0; i < carga->n; i++)
+    {
+        ENTRADA_FILA *entrada = ordenadas ? ordenadas[i] : &carga->entradas[i];
+        char cpf[CPF_DIGITOS + 1];
+        cpf_desempacotar(entrada->chave, cpf);
+        entrada->paciente = lista_buscar(lista, cpf);
+    }
+    free(ordenadas);
+
+    for (size_t i = 0; i < carga->n; i++)
+    {
+        ENTRADA_FILA *entrada = &carga->entradas[i];
+        if (entrada->paciente && fila_inserir(fila, entrada->paciente, entrada->prioridade) && entrada->chegada != 0)
+            registro_entrar_fila(paciente_obter_id(entrada->paciente), entrada->prioridade, entrada->chegada);
+    }
+}
+
+/**
+ * @brief Lê o tamanho do cache do modo sob demanda (variável PS_CACHE_PACIENTES).
+ * @note Com o heap persistente ativo ou em uma réplica, a variável é ignorada.
+ * @return size_t Pacientes hidratados mantidos em cache (0 = carregar tudo)
+ */
+static size_t limite_cache(void)
+{
+    /* No heap persistente a lista precisa estar inteira em memória; na
+       réplica o arquivo mapeado pode ser trocado pelo processo principal */
+    const char *valor = getenv(IO_VARIAVEL_CACHE);
+    if (valor == NULL || heap_ativo() || replica_ativa()) return 0;
+
+    char *fim;
+    long long limite = strtoll(valor, &fim, 10);
+    if (fim == valor || *fim != '\0' || limite <= 0 || limite > (long long)UINT32_MAX)
+        return 0;
+    return (size_t)limite;
+}
+
+/**
+ * @brief Carrega a LISTA e a FILA dos arquivos de dados de um diretório.
+ * @param diretorio Diretório dos arquivos (NULL = data/)
+ * @param lista Ponteiro para o ponteiro da LISTA já criada
+ * @param fila  Ponteiro para o ponteiro da FILA já criada
+ * @return true se carregou com sucesso, false caso contrário
+ */
+static bool carregar_de(const char *diretorio, LISTA **lista, FILA **fila)
+{
+    if (!lista || !(*lista) || !fila || !(*fila)) return false;
+
+    formato_antigo = false;
+    blocos_corrompidos = 0;
+    sob_demanda = false;
+    base_incremental = false;
+
+    /* --- Carregando Catálogo --- */
+
+    char caminho[IO_TAM_CAMINHO];
+    bool tem_catalogo = catalogo_carregar(caminho_em(diretorio, ARQUIVO_CATALOGO, caminho));
+    bool ok = true;
+
+    /* --- Carregando Lista --- */
+
+    ARQUIVO_ESTADO estado;
+    ARQUIVO *arq = arquivo_abrir(caminho_em(diretorio, ARQUIVO_LISTA, caminho), ARQUIVO_TIPO_LISTA, &estado);
+    uint64_t ponto_lista = arquivo_ponto(arq);
+    /* O filtro gravado só serve se corresponder a este arquivo da lista;
+       senão é reconstruído pelos cadastros (ou, sob demanda, pelas chaves) */
+    double taxa = bloom_taxa_configurada();
+    BLOOM *filtro = bloom_carregar(BLOOM_ARQUIVO, arquivo_assinatura(arq), taxa);
+    bool filtro_gravado = filtro != NULL;
+    if (!filtro_gravado)
+    {
+        filtro = bloom_criar(2 * arquivo_registros(arq), taxa);
+        lista_definir_filtro(*lista, filtro);
+    }
+
+    size_t limite = limite_cache();
+    if (arq && estado == ARQUIVO_OK && limite > 0 && lista_vincular_arquivo(*lista, arq, limite))
+    {
+        sob_demanda = true;
+        if (!filtro_gravado && filtro)
+            carregar_blocos(arq, estado, carregar_chave_lista, filtro);
+    }
+    else if (arq)
+    {
+        carregar_lista(arq, estado, *lista);
+        arquivo_fechar(&arq);
+        /* Com blocos perdidos, a memória não corresponde mais ao arquivo */
+        base_incremental = estado == ARQUIVO_OK && blocos_corrompidos == 0;
+    }
+    else if (estado == ARQUIVO_FORMATO_ANTIGO && diretorio == NULL)
+    {
+        formato_antigo = true;
+        carregar_lista_antiga(*lista, !tem_catalogo);
+    }
+    else if (estado != ARQUIVO_AUSENTE)
+    {
+        ok = false;
+    }
+
+    if (filtro_gravado)
+        lista_definir_filtro(*lista, filtro);
+
+    /* --- Carregando Fila (com prioridade) --- */
+
+    arq = arquivo_abrir(caminho_em(diretorio, ARQUIVO_FILA, caminho), ARQUIVO_TIPO_FILA, &estado);
+    uint64_t ponto_fila = arquivo_ponto(arq);
+    if (arq)
+    {
+        CARGA_FILA carga = { NULL, 0, 0 };
+        carregar_blocos(arq, estado, carregar_item_fila, &carga);
+        arquivo_fechar(&arq);
+        carregar_fila(&carga, *lista, *fila);
+        free(carga.entradas);
+    }
+    else if (estado == ARQUIVO_FORMATO_ANTIGO && diretorio == NULL)
+    {
+        formato_antigo = true;
+        carregar_fila_antiga(*lista, *fila);
+    }
+    else if (estado != ARQUIVO_AUSENTE)
+    {
+        ok = false;
+    }
+
+    /* O log reaplicado sobre estes arquivos pula o que eles já contêm */
+    wal_definir_pontos(ponto_lista, ponto_fila);
+    return ok;
 }
 
 /**
  * @brief Carrega a LISTA e a FILA a partir dos arquivos binários.
  *
+ * Os arquivos são mapeados em memória e os registros são percorridos no
+ * próprio mapeamento, sem uma leitura nem uma alocação por registro.
+ *
  * O carregamento ocorre na ordem:
  * 
+ * 0. **Catálogo:**  
+ *    Restaura os códigos de procedimento.
+ *
  * 1. **Lista:**  
- *    Lê cada registro, reconstrói o paciente usando `paciente_de_string()`  
- *    e reinsere na LISTA.
+ *    Confere o CRC32C de cada bloco e reconstrói os pacientes dos blocos
+ *    íntegros (validando os limites de cada campo). Os blocos são divididos
+ *    entre as threads (PS_THREADS) e a árvore é montada de uma vez no final
+ *    (ver carregar_lista()).
  *
  * 2. **Fila:**  
- *    Lê na ordem:
- *      - prioridade
- *      - tamanho da string
- *      - string do paciente
+ *    Lê as referências (CPF, prioridade, chegada), busca os pacientes na
+ *    lista em ordem de CPF e os reinsere na fila na ordem do arquivo, com a
+ *    prioridade e o horário de chegada originais (ver carregar_fila()).
  *
- *    Recupera o CPF dos primeiros 11 bytes, busca o paciente na lista
- *    e reinsere na fila com a prioridade correta.
+ * O filtro de CPFs (ver bloom.c) é lido de `data/bloom.bin` se corresponder
+ * ao arquivo da lista; senão é reconstruído durante o carregamento.
+ *
+ * Com PS_CACHE_PACIENTES definida, a lista fica no modo sob demanda (ver
+ * lista_vincular_arquivo()): o arquivo continua mapeado, só o índice de
+ * blocos é conferido, e cada paciente é reconstruído no primeiro acesso. Os
+ * pacientes da fila são hidratados já no passo 2. Sem índice válido (arquivo
+ * truncado ou formato antigo) a lista é carregada por inteiro.
+ *
+ * Arquivos no formato antigo são lidos pelo caminho anterior e marcados para
+ * conversão (ver IO_formato_antigo()). Blocos com CRC32C inválido são
+ * descartados e contados (ver IO_blocos_corrompidos()).
  *
  * @param lista Ponteiro para o ponteiro da LISTA já criada
  * @param fila  Ponteiro para o ponteiro da FILA já criada
  * @return true se carregou com sucesso, false caso contrário
  */
 bool LOAD(LISTA **lista, FILA **fila)
+{
+    return carregar_de(NULL, lista, fila);
+}
+
+/**
+ * @brief Carrega a LISTA e a FILA de uma cópia feita por IO_copiar_dados().
+ * @param diretorio Diretório da cópia
+ * @param lista Ponteiro para o ponteiro da LISTA já criada
+ * @param fila  Ponteiro para o ponteiro da FILA já criada
+ * @return true se carregou com sucesso, false caso contrário
+ */
+bool IO_carregar_de(const char *diretorio, LISTA **lista, FILA **fila)
+{
+    return diretorio != NULL && carregar_de(diretorio, lista, fila);
+}
+
+/**
+ * @brief Indica se o último LOAD leu arquivos anteriores ao formato versionado.
+ * @return true se um SAVE deve ser feito para convertê-los
+ */
+bool IO_formato_antigo(void)
+{
+    return formato_antigo;
+}
+
+/**
+ * @brief Quantidade de blocos descartados (CRC32C inválido ou índice perdido) no último LOAD.
+ * @return int Blocos corrompidos
+ */
+int IO_blocos_corrompidos(void)
+{
+    return blocos_corrompidos;
+}
+
+/**
+ * @brief Indica se o último LOAD deixou a lista no modo sob demanda.
+ * @return true se os pacientes são hidratados do arquivo no primeiro acesso
+ */
+bool IO_sob_demanda(void)
+{
+    return sob_demanda;
+}
+
+/**
+ * @brief Abre o heap persistente (PS_HEAP=1) e, se possível, retoma dele a LISTA e a FILA.
+ *
+ * Deve ser chamada antes do LOAD, com a LISTA e a FILA recém-criadas: a
+ * partir daqui, os pacientes e as estruturas são alocados no heap.
+ *
+ * O heap só é retomado se a execução anterior o fechou depois de um SAVE
+ * completo (ver IO_fechar_heap()) e se o arquivo da lista ainda é o gravado
+ * naquele SAVE (mesmo resumo das chaves). Nesse caso nada é lido do disco:
+ * os pacientes e o catálogo são lidos do heap no primeiro acesso. Senão, o
+ * heap é esvaziado e o LOAD o preenche a partir dos arquivos.
+ *
+ * Com PS_COMPARTILHADO=1 o heap é aberto junto com os outros processos que
+ * já o usam; se houver algum, a LISTA e a FILA são as deles, retomadas como
+ * estão (ver IO_heap_em_uso()). Nesse modo a função retorna com as
+ * estruturas travadas, inclusive quando o LOAD ainda precisa ser feito: o
+ * chamador libera com IO_destravar() depois de carregar e reaplicar o log.
+ *
+ * @param lista Ponteiro para o ponteiro da LISTA já criada
+ * @param fila  Ponteiro para o ponteiro da FILA já criada
+ * @return true se a LISTA e a FILA foram retomadas (o LOAD deve ser pulado)
+ */
+bool IO_abrir_heap(LISTA **lista, FILA **fila)
 {
     if (!lista || !(*lista) || !fila || !(*fila)) return false;
 
-    /* --- Carregando Lista --- */
+    const char *valor = getenv(HEAP_VARIAVEL);
+    const char *valor_compartilhado = getenv(HEAP_VARIAVEL_COMPARTILHADO);
+    bool compartilhado = valor_compartilhado != NULL && strcmp(valor_compartilhado, "1") == 0;
+    if (!compartilhado && (valor == NULL || strcmp(valor, "1") != 0)) return false;
 
-    FILE *fp_lista = fopen("data/lista_itens.bin", "rb");
-    if (fp_lista != NULL)
-    {
-        int tamanho_str_paciente;
+    HEAP_ESTADO estado = heap_abrir(HEAP_ARQUIVO, compartilhado);
+    if (estado != HEAP_RESTAURADO && estado != HEAP_EM_USO) return false;
 
-        while (fread(&tamanho_str_paciente, sizeof(int), 1, fp_lista) == 1)
-        {
-            char *buffer = calloc(tamanho_str_paciente + 1, sizeof(char));
-            if (buffer)
-            {
-                fread(buffer, sizeof(char), tamanho_str_paciente, fp_lista);
-                PACIENTE *paciente = paciente_de_string(buffer);
-                lista_inserir(*lista, paciente);
-                free(buffer);
-            }
-        }
-        fclose(fp_lista);
+    /* Sem LOAD, os pontos vêm direto dos arquivos: o log deste processo
+       continua numerado depois do que eles já cobrem */
+    ARQUIVO_ESTADO arq_estado;
+    ARQUIVO *arq = arquivo_abrir(ARQUIVO_FILA, ARQUIVO_TIPO_FILA, &arq_estado);
+    uint64_t ponto_fila = arquivo_ponto(arq);
+    arquivo_fechar(&arq);
+    arq = arquivo_abrir(ARQUIVO_LISTA, ARQUIVO_TIPO_LISTA, &arq_estado);
+    wal_definir_pontos(arquivo_ponto(arq), ponto_fila);
+    bool confere = arq && arq_estado == ARQUIVO_OK && arquivo_assinatura(arq) == heap_assinatura();
+    arquivo_fechar(&arq);
+
+    if (estado == HEAP_RESTAURADO && !confere)
+    {
+        heap_recomecar();
+        return false;
     }
 
-    /* --- Carregando Fila (com prioridade) --- */
+    registro_restaurar();
+    catalogo_restaurar();
+    lista_restaurar(*lista);
+    fila_restaurar(*fila);
 
-    FILE *fp_fila = fopen("data/fila_itens.bin", "rb");
-    if (fp_fila != NULL)
-    {
-        int prioridade_lida;
-        int tamanho_str_paciente;
+    formato_antigo = false;
+    blocos_corrompidos = 0;
+    sob_demanda = false;
+    base_incremental = true;
+    heap_em_uso = estado == HEAP_EM_USO;
+    return true;
+}
 
-        /**
-         * Ordem de leitura:
-         *  1. prioridade
-         *  2. tamanho
-         *  3. string
-         */
-        while (fread(&prioridade_lida, sizeof(int), 1, fp_fila) == 1)
-        {
-            if (fread(&tamanho_str_paciente, sizeof(int), 1, fp_fila) == 1)
-            {
-                char *buffer = calloc(tamanho_str_paciente + 1, sizeof(char));
-                if(buffer)
-                {
-                    fread(buffer, sizeof(char), tamanho_str_paciente, fp_fila);
+/**
+ * @brief Indica se a LISTA e a FILA vieram de um heap compartilhado que outro processo já usava.
+ * @return true se o log de operações já está aplicado nelas (não deve ser reaplicado)
+ */
+bool IO_heap_em_uso(void)
+{
+    return heap_em_uso;
+}
 
-                    /* Extrai CPF dos primeiros 11 caracteres */
-                    char cpf_temp[12];
-                    strncpy(cpf_temp, buffer, 11);
-                    cpf_temp[11] = '\0';
+/**
+ * @brief Trava a LISTA e a FILA contra os outros processos do heap compartilhado.
+ *
+ * As raízes são relidas, pois outro processo pode tê-las mudado desde o
+ * último IO_destravar(): nenhum PACIENTE* obtido antes da trava pode ser
+ * usado depois dela. Sem PS_COMPARTILHADO, não faz nada.
+ *
+ * @param lista LISTA principal
+ * @param fila  FILA principal
+ * @return false se o processo que tinha a trava caiu com ela (as estruturas
+ * podem ter ficado no meio de uma alteração)
+ */
+bool IO_travar(LISTA *lista, FILA *fila)
+{
+    if (!heap_compartilhado()) return true;
 
-                    /* Busca paciente na lista já carregada */
-                    PACIENTE *paciente_encontrado = lista_buscar(*lista, cpf_temp);
+    bool ok = heap_travar();
+    registro_sincronizar();
+    catalogo_sincronizar();
+    lista_sincronizar(lista);
+    fila_sincronizar(fila);
+    return ok;
+}
 
-                    if (paciente_encontrado)
-                    {
-                        /* Insere paciente na fila com a prioridade original */
-                        fila_inserir(*fila, paciente_encontrado, prioridade_lida);
-                    }
+/**
+ * @brief Grava as raízes e libera a LISTA e a FILA para os outros processos.
+ * @param lista LISTA principal
+ * @param fila  FILA principal
+ */
+void IO_destravar(LISTA *lista, FILA *fila)
+{
+    if (!heap_compartilhado()) return;
 
-                    free(buffer);
-                }
-            }
-        }
-        fclose(fp_fila);
+    registro_persistir();
+    catalogo_persistir();
+    lista_persistir(lista);
+    fila_persistir(fila);
+    heap_destravar();
+}
+
+/**
+ * @brief Fecha o heap persistente, guardando as raízes da LISTA e da FILA.
+ *
+ * O heap só é marcado para ser retomado se o SAVE de encerramento foi
+ * concluído: assim os arquivos de dados (e o log, já truncado) descrevem o
+ * mesmo estado do heap. No heap compartilhado, só o último processo a
+ * fechá-lo (ver heap_ultimo()) grava as raízes; os demais apenas o soltam.
+ * Depois desta chamada a LISTA, a FILA e os pacientes não podem mais ser
+ * usados nem apagados.
+ *
+ * @param lista LISTA principal
+ * @param fila  FILA principal
+ * @param salvo O SAVE de encerramento foi concluído
+ * @return true se havia heap ativo (e as estruturas ficaram nele)
+ */
+bool IO_fechar_heap(LISTA *lista, FILA *fila, bool salvo)
+{
+    if (!heap_ativo()) return false;
+
+    uint64_t assinatura = 0;
+    bool consistente = salvo && heap_ultimo() && registro_persistir() && catalogo_persistir() &&
+                       lista_persistir(lista) && fila_persistir(fila);
+    if (consistente)
+    {
+        ARQUIVO_ESTADO estado;
+        ARQUIVO *arq = arquivo_abrir(ARQUIVO_LISTA, ARQUIVO_TIPO_LISTA, &estado);
+        consistente = arq && estado == ARQUIVO_OK;
+        assinatura = arquivo_assinatura(arq);
+        arquivo_fechar(&arq);
     }
 
+    heap_fechar(consistente, assinatura);
     return true;
 }
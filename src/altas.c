@@ -0,0 +1,599 @@
+/**
+ * @file altas.c
+ * @brief Arquivo colunar dos atendimentos encerrados e varredura para estatísticas.
+ * @details Cada "Dar Alta" anexa uma linha ao arquivo em data/altas/, guardado
+ * em colunas: cada campo tem o próprio arquivo, um vetor de valores de largura
+ * fixa na ordem das altas, sem cabeçalho:
+ *
+ * - chegada.bin: entrada na fila (int64, time_t; 0 = desconhecida)
+ * - saida.bin: alta (int64, time_t)
+ * - prioridade.bin: prioridade do atendimento (uint8, 1 a 5)
+ * - espera.bin: saída - chegada, em segundos (uint32; ALTAS_ESPERA_DESCONHECIDA sem chegada)
+ * - cpf.bin: CPF empacotado (uint64, ver cpf_empacotar())
+ * - procedimento.bin: código do procedimento registrado (uint32; ALTAS_SEM_PROCEDIMENTO = nenhum)
+ *
+ * Os códigos de procedimento são do próprio arquivo, e não do catálogo (ver
+ * catalogo.c), para que as altas continuem legíveis sem os dados do sistema:
+ * procedimentos.bin guarda, em ordem de código a partir de 1, TAMANHO (uint32)
+ * → TEXTO (bytes, sem '\0').
+ *
+ * Uma alta grava uma linha em cada coluna; a quantidade de altas é a da
+ * coluna mais curta, então uma linha interrompida no meio é ignorada e
+ * sobrescrita pela alta seguinte. No heap compartilhado (PS_COMPARTILHADO),
+ * a alta é anexada com a base travada, um processo por vez.
+ *
+ * Uma consulta lê só as colunas de que precisa, mapeadas em memória, em
+ * blocos de ALTAS_BLOCO linhas: o filtro vira um vetor de seleção calculado
+ * sem desvios, e os agregados são somas sobre esse vetor, laços que o
+ * compilador vetoriza. Como as altas são anexadas em ordem de horário, quase
+ * todo bloco cai inteiro em um só mês; só os blocos na virada de um mês são
+ * agrupados linha a linha.
+ */
+
+#include "../include/altas.h"
+#include "../include/catalogo.h"
+#include "../include/mapa.h"
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define ALTAS_BLOCO 4096 ///< Linhas filtradas e agregadas de uma vez
+#define ALTAS_PRIORIDADES 5
+
+/**
+ * @brief Colunas do arquivo de altas.
+ */
+enum {
+    COLUNA_CHEGADA,
+    COLUNA_SAIDA,
+    COLUNA_PRIORIDADE,
+    COLUNA_ESPERA,
+    COLUNA_CPF,
+    COLUNA_PROCEDIMENTO,
+    ALTAS_COLUNAS
+};
+
+/**
+ * @brief Arquivo e largura de cada coluna.
+ */
+static const struct {
+    const char* caminho;  /**< Arquivo da coluna. */
+    size_t largura;       /**< Bytes de cada valor. */
+} colunas[ALTAS_COLUNAS] = {
+    { ALTAS_DIRETORIO "/chegada.bin",      sizeof(int64_t)  },
+    { ALTAS_DIRETORIO "/saida.bin",        sizeof(int64_t)  },
+    { ALTAS_DIRETORIO "/prioridade.bin",   sizeof(uint8_t)  },
+    { ALTAS_DIRETORIO "/espera.bin",       sizeof(uint32_t) },
+    { ALTAS_DIRETORIO "/cpf.bin",          sizeof(uint64_t) },
+    { ALTAS_DIRETORIO "/procedimento.bin", sizeof(uint32_t) },
+};
+
+#ifdef _WIN32
+typedef FILE* ALTAS_ARQUIVO;
+#define ALTAS_FECHADO NULL
+#else
+typedef int ALTAS_ARQUIVO;
+#define ALTAS_FECHADO (-1)
+#endif
+
+/**
+ * @struct altas_
+ * @brief Arquivos abertos para anexar altas e códigos de procedimento conhecidos.
+ */
+typedef struct altas_ {
+    bool aberto;                                /**< Arquivos abertos por altas_abrir(). */
+    ALTAS_ARQUIVO arquivos[ALTAS_COLUNAS];      /**< Uma coluna por arquivo. */
+    ALTAS_ARQUIVO procedimentos;                /**< Descrições dos códigos de procedimento. */
+    uint64_t lido;                              /**< Bytes de procedimentos.bin já lidos. */
+    char** textos;                              /**< textos[codigo - 1] é a descrição do código. */
+    uint32_t quantidade;                        /**< Códigos de procedimento conhecidos. */
+    uint32_t capacidade;                        /**< Capacidade do vetor de textos. */
+    uint32_t* por_catalogo;                     /**< Código no arquivo de cada código do catálogo (0 = não visto). */
+    uint32_t tam_por_catalogo;                  /**< Tamanho de por_catalogo. */
+} ALTAS;
+
+static ALTAS altas = { .aberto = false };
+
+/**
+ * @brief Abre (ou cria) um arquivo para leitura e escrita em posições arbitrárias.
+ */
+static ALTAS_ARQUIVO altas_arquivo_abrir(const char* caminho){
+#ifdef _WIN32
+    FILE* fp = fopen(caminho, "r+b");
+    return fp != NULL ? fp : fopen(caminho, "w+b");
+#else
+    return open(caminho, O_RDWR | O_CREAT, 0644);
+#endif
+}
+
+/**
+ * @brief Tamanho atual de um arquivo aberto.
+ */
+static uint64_t altas_arquivo_tamanho(ALTAS_ARQUIVO arq){
+#ifdef _WIN32
+    if (_fseeki64(arq, 0, SEEK_END) != 0) return 0;
+    long long tamanho = _ftelli64(arq);
+    return tamanho > 0 ? (uint64_t)tamanho : 0;
+#else
+    struct stat info;
+    return fstat(arq, &info) == 0 ? (uint64_t)info.st_size : 0;
+#endif
+}
+
+/**
+ * @brief Grava bytes em uma posição do arquivo.
+ */
+static bool altas_arquivo_gravar(ALTAS_ARQUIVO arq, uint64_t posicao, const void* dados, size_t tamanho){
+#ifdef _WIN32
+    return _fseeki64(arq, (long long)posicao, SEEK_SET) == 0 &&
+           fwrite(dados, 1, tamanho, arq) == tamanho && fflush(arq) == 0;
+#else
+    const char* origem = (const char*)dados;
+    while (tamanho > 0){
+        ssize_t escritos = pwrite(arq, origem, tamanho, (off_t)posicao);
+        if (escritos <= 0) return false;
+        origem += escritos;
+        posicao += (uint64_t)escritos;
+        tamanho -= (size_t)escritos;
+    }
+    return true;
+#endif
+}
+
+/**
+ * @brief Lê bytes de uma posição do arquivo.
+ */
+static bool altas_arquivo_ler(ALTAS_ARQUIVO arq, uint64_t posicao, void* dados, size_t tamanho){
+#ifdef _WIN32
+    return _fseeki64(arq, (long long)posicao, SEEK_SET) == 0 && fread(dados, 1, tamanho, arq) == tamanho;
+#else
+    char* destino = (char*)dados;
+    while (tamanho > 0){
+        ssize_t lidos = pread(arq, destino, tamanho, (off_t)posicao);
+        if (lidos <= 0) return false;
+        destino += lidos;
+        posicao += (uint64_t)lidos;
+        tamanho -= (size_t)lidos;
+    }
+    return true;
+#endif
+}
+
+/**
+ * @brief Fecha um arquivo aberto por altas_arquivo_abrir().
+ */
+static void altas_arquivo_fechar(ALTAS_ARQUIVO arq){
+#ifdef _WIN32
+    if (arq != NULL) fclose(arq);
+#else
+    if (arq >= 0) close(arq);
+#endif
+}
+
+/**
+ * @brief Abre as colunas e o dicionário de procedimentos na primeira alta.
+ * @return true se todos os arquivos estão abertos.
+ */
+static bool altas_abrir(void){
+    if (altas.aberto)
+        return true;
+
+#ifdef _WIN32
+    _mkdir(ALTAS_DIRETORIO);
+#else
+    mkdir(ALTAS_DIRETORIO, 0755);
+#endif
+
+    bool ok = (altas.procedimentos = altas_arquivo_abrir(ALTAS_PROCEDIMENTOS)) != ALTAS_FECHADO;
+    for (int c = 0; c < ALTAS_COLUNAS; c++){
+        altas.arquivos[c] = ok ? altas_arquivo_abrir(colunas[c].caminho) : ALTAS_FECHADO;
+        ok = ok && altas.arquivos[c] != ALTAS_FECHADO;
+    }
+
+    if (!ok){
+        altas_arquivo_fechar(altas.procedimentos);
+        for (int c = 0; c < ALTAS_COLUNAS; c++)
+            if (altas.arquivos[c] != ALTAS_FECHADO) altas_arquivo_fechar(altas.arquivos[c]);
+        return false;
+    }
+    altas.aberto = true;
+    return true;
+}
+
+/**
+ * @brief Acrescenta uma descrição ao vetor de textos conhecidos.
+ * @return Código da descrição, ou 0 sem memória.
+ */
+static uint32_t altas_guardar_texto(const char* texto, size_t tamanho){
+    if (altas.quantidade == altas.capacidade){
+        uint32_t nova = altas.capacidade ? altas.capacidade * 2 : 64;
+        char** p = (char**)realloc(altas.textos, nova * sizeof(char*));
+        if (p == NULL) return 0;
+        altas.textos = p;
+        altas.capacidade = nova;
+    }
+
+    char* copia = (char*)malloc(tamanho + 1);
+    if (copia == NULL) return 0;
+    memcpy(copia, texto, tamanho);
+    copia[tamanho] = '\0';
+
+    altas.textos[altas.quantidade++] = copia;
+    return altas.quantidade;
+}
+
+/**
+ * @brief Lê as descrições anexadas a procedimentos.bin desde a última leitura.
+ * @details No heap compartilhado, outros processos também anexam descrições.
+ * Uma descrição interrompida no meio não é lida e é sobrescrita pela próxima.
+ */
+static void altas_ler_procedimentos(void){
+    uint64_t tamanho = altas_arquivo_tamanho(altas.procedimentos);
+    while (altas.lido + sizeof(uint32_t) <= tamanho){
+        uint32_t n;
+        if (!altas_arquivo_ler(altas.procedimentos, altas.lido, &n, sizeof(n)) ||
+            altas.lido + sizeof(n) + n > tamanho)
+            return;
+
+        char* texto = (char*)malloc(n > 0 ? n : 1);
+        bool ok = texto != NULL && altas_arquivo_ler(altas.procedimentos, altas.lido + sizeof(n), texto, n) &&
+                  altas_guardar_texto(texto, n) != 0;
+        free(texto);
+        if (!ok) return;
+        altas.lido += sizeof(n) + n;
+    }
+}
+
+/**
+ * @brief Código do procedimento no arquivo de altas, acrescentando a descrição se for nova.
+ * @details O código é guardado por código do catálogo, então cada descrição
+ * é comparada por texto só na primeira alta em que aparece.
+ * @return Código (a partir de 1), ou 0 se não foi possível gravar a descrição.
+ */
+static uint32_t altas_codigo(const char* texto){
+    uint32_t catalogo = catalogo_buscar(texto);
+    if (catalogo != CATALOGO_CODIGO_INVALIDO && catalogo < altas.tam_por_catalogo && altas.por_catalogo[catalogo] != 0)
+        return altas.por_catalogo[catalogo];
+
+    altas_ler_procedimentos();
+    uint32_t codigo = 0;
+    for (uint32_t i = 0; i < altas.quantidade && codigo == 0; i++)
+        if (strcmp(altas.textos[i], texto) == 0) codigo = i + 1;
+
+    if (codigo == 0){
+        uint32_t n = (uint32_t)strlen(texto);
+        if (!altas_arquivo_gravar(altas.procedimentos, altas.lido, &n, sizeof(n)) ||
+            !altas_arquivo_gravar(altas.procedimentos, altas.lido + sizeof(n), texto, n) ||
+            (codigo = altas_guardar_texto(texto, n)) == 0)
+            return 0;
+        altas.lido += sizeof(n) + n;
+    }
+
+    if (catalogo != CATALOGO_CODIGO_INVALIDO){
+        if (catalogo >= altas.tam_por_catalogo){
+            uint32_t novo = altas.tam_por_catalogo ? altas.tam_por_catalogo : 64;
+            while (novo <= catalogo) novo *= 2;
+            uint32_t* p = (uint32_t*)realloc(altas.por_catalogo, novo * sizeof(uint32_t));
+            if (p == NULL) return codigo;
+            memset(p + altas.tam_por_catalogo, 0, (novo - altas.tam_por_catalogo) * sizeof(uint32_t));
+            altas.por_catalogo = p;
+            altas.tam_por_catalogo = novo;
+        }
+        altas.por_catalogo[catalogo] = codigo;
+    }
+    return codigo;
+}
+
+/**
+ * @brief Anexa um atendimento encerrado ao arquivo de altas.
+ * @param cpf CPF empacotado do paciente.
+ * @param prioridade Prioridade em que foi atendido (1 a 5).
+ * @param chegada Entrada na fila (time_t; 0 = desconhecida).
+ * @param saida Horário da alta (time_t).
+ * @param procedimento Procedimento registrado na alta (NULL ou "" = nenhum).
+ * @return true se a linha foi gravada em todas as colunas.
+ */
+bool altas_registrar(uint64_t cpf, int prioridade, int64_t chegada, int64_t saida, const char* procedimento){
+    if (prioridade < 1 || prioridade > ALTAS_PRIORIDADES || !altas_abrir())
+        return false;
+
+    uint32_t codigo = ALTAS_SEM_PROCEDIMENTO;
+    if (procedimento != NULL && procedimento[0] != '\0' && (codigo = altas_codigo(procedimento)) == 0)
+        return false;
+
+    // A linha nova fica logo depois da última completa
+    uint64_t linhas = UINT64_MAX;
+    for (int c = 0; c < ALTAS_COLUNAS; c++){
+        uint64_t n = altas_arquivo_tamanho(altas.arquivos[c]) / colunas[c].largura;
+        if (n < linhas) linhas = n;
+    }
+
+    uint8_t valor_prioridade = (uint8_t)prioridade;
+    uint32_t espera = (chegada > 0 && saida >= chegada && saida - chegada < ALTAS_ESPERA_DESCONHECIDA)
+                      ? (uint32_t)(saida - chegada) : ALTAS_ESPERA_DESCONHECIDA;
+    const void* valores[ALTAS_COLUNAS] = { &chegada, &saida, &valor_prioridade, &espera, &cpf, &codigo };
+
+    for (int c = 0; c < ALTAS_COLUNAS; c++)
+        if (!altas_arquivo_gravar(altas.arquivos[c], linhas * colunas[c].largura, valores[c], colunas[c].largura))
+            return false;
+    return true;
+}
+
+/**
+ * @brief Fecha os arquivos abertos por altas_registrar() e libera os códigos conhecidos.
+ */
+void altas_encerrar(void){
+    if (altas.aberto){
+        altas_arquivo_fechar(altas.procedimentos);
+        for (int c = 0; c < ALTAS_COLUNAS; c++)
+            altas_arquivo_fechar(altas.arquivos[c]);
+    }
+    for (uint32_t i = 0; i < altas.quantidade; i++)
+        free(altas.textos[i]);
+    free(altas.textos);
+    free(altas.por_catalogo);
+    memset(&altas, 0, sizeof(altas));
+}
+
+/**
+ * @brief Meses encontrados por uma varredura.
+ */
+typedef struct altas_meses_ {
+    ALTAS_MES* itens;     /**< Meses na ordem em que apareceram. */
+    int quantidade;       /**< Meses encontrados. */
+    int capacidade;       /**< Capacidade do vetor. */
+    int atual;            /**< Mês da última linha agrupada (-1 = nenhum). */
+    int64_t inicio;       /**< Início (time_t) do mês atual. */
+    int64_t fim;          /**< Início (time_t) do mês seguinte ao atual. */
+} ALTAS_MESES;
+
+/**
+ * @brief Torna atual o mês (horário local) de um instante, criando-o se ainda não apareceu.
+ * @return false sem memória.
+ */
+static bool altas_mes_de(ALTAS_MESES* meses, int64_t instante){
+    time_t t = (time_t)instante;
+    struct tm* local = localtime(&t);
+    if (local == NULL) return false;
+    int ano = local->tm_year + 1900;
+    int mes = local->tm_mon + 1;
+
+    struct tm limite;
+    memset(&limite, 0, sizeof(limite));
+    limite.tm_year = ano - 1900;
+    limite.tm_mon = mes - 1;
+    limite.tm_mday = 1;
+    limite.tm_isdst = -1;
+    meses->inicio = (int64_t)mktime(&limite);
+    memset(&limite, 0, sizeof(limite));
+    limite.tm_year = ano - 1900;
+    limite.tm_mon = mes;
+    limite.tm_mday = 1;
+    limite.tm_isdst = -1;
+    meses->fim = (int64_t)mktime(&limite);
+
+    for (int i = meses->quantidade - 1; i >= 0; i--){
+        if (meses->itens[i].ano == ano && meses->itens[i].mes == mes){
+            meses->atual = i;
+            return true;
+        }
+    }
+
+    if (meses->quantidade == meses->capacidade){
+        int nova = meses->capacidade ? meses->capacidade * 2 : 16;
+        ALTAS_MES* p = (ALTAS_MES*)realloc(meses->itens, (size_t)nova * sizeof(ALTAS_MES));
+        if (p == NULL) return false;
+        meses->itens = p;
+        meses->capacidade = nova;
+    }
+    ALTAS_MES* novo = &meses->itens[meses->quantidade];
+    memset(novo, 0, sizeof(*novo));
+    novo->ano = ano;
+    novo->mes = mes;
+    meses->atual = meses->quantidade++;
+    return true;
+}
+
+/**
+ * @brief Soma as linhas selecionadas de um bloco inteiro no mesmo mês.
+ * @details Uma passada por prioridade, sem desvios: o compilador vetoriza cada laço.
+ */
+static void altas_somar_bloco(ALTAS_MES* mes, const uint8_t* selecao, const uint8_t* prioridade,
+                              const uint32_t* espera, int n){
+    for (int q = 0; q < ALTAS_PRIORIDADES; q++){
+        uint64_t quantidade = 0, conhecidas = 0, soma = 0;
+        for (int i = 0; i < n; i++){
+            uint32_t m = selecao[i] & (prioridade[i] == q + 1);
+            uint32_t k = m & (espera[i] != ALTAS_ESPERA_DESCONHECIDA);
+            quantidade += m;
+            conhecidas += k;
+            soma += (uint64_t)espera[i] * k;
+        }
+        mes->altas[q] += quantidade;
+        mes->com_espera[q] += conhecidas;
+        mes->soma_espera[q] += soma;
+    }
+}
+
+static int altas_comparar_meses(const void* a, const void* b){
+    const ALTAS_MES* x = (const ALTAS_MES*)a;
+    const ALTAS_MES* y = (const ALTAS_MES*)b;
+    int cx = x->ano * 12 + x->mes, cy = y->ano * 12 + y->mes;
+    return (cx > cy) - (cx < cy);
+}
+
+/**
+ * @brief Altas e espera média por mês e prioridade.
+ *
+ * Lê só as colunas de saída, prioridade e espera.
+ *
+ * @param filtro Altas consideradas (NULL = todas).
+ * @param meses Recebe os meses com alguma alta selecionada, em ordem (liberar com free()).
+ * @param quantidade Recebe a quantidade de meses.
+ * @param medida Recebe as medições da varredura (pode ser NULL).
+ * @return false se as colunas não puderam ser lidas ou faltou memória.
+ */
+bool altas_espera_mensal(const ALTAS_FILTRO* filtro, ALTAS_MES** meses, int* quantidade, ALTAS_VARREDURA* medida){
+    *meses = NULL;
+    *quantidade = 0;
+    if (medida) memset(medida, 0, sizeof(*medida));
+
+#ifndef _WIN32
+    struct timespec inicio_varredura, fim_varredura;
+    clock_gettime(CLOCK_MONOTONIC, &inicio_varredura);
+#else
+    clock_t inicio_varredura = clock();
+#endif
+
+    // Sem nenhuma alta ainda, as colunas não existem
+    struct stat info;
+    if (stat(colunas[COLUNA_SAIDA].caminho, &info) != 0)
+        return true;
+
+    const int usadas[] = { COLUNA_SAIDA, COLUNA_PRIORIDADE, COLUNA_ESPERA };
+    MAPA* mapas[3] = { NULL, NULL, NULL };
+    uint64_t linhas = UINT64_MAX;
+    bool ok = true;
+    for (int u = 0; u < 3 && ok; u++){
+        ok = (mapas[u] = mapa_abrir(colunas[usadas[u]].caminho)) != NULL;
+        if (ok && mapa_tamanho(mapas[u]) / colunas[usadas[u]].largura < linhas)
+            linhas = mapa_tamanho(mapas[u]) / colunas[usadas[u]].largura;
+    }
+
+    ALTAS_MESES agrupados = { NULL, 0, 0, -1, 0, 0 };
+    uint64_t selecionadas = 0;
+
+    if (ok && linhas > 0){
+        const int64_t* saida = (const int64_t*)mapa_dados(mapas[0]);
+        const uint8_t* prioridade = (const uint8_t*)mapa_dados(mapas[1]);
+        const uint32_t* espera = (const uint32_t*)mapa_dados(mapas[2]);
+
+        int64_t de = filtro && filtro->de != 0 ? filtro->de : INT64_MIN;
+        int64_t ate = filtro && filtro->ate != 0 ? filtro->ate : INT64_MAX;
+        uint8_t aceitas = filtro && filtro->prioridades != 0 ? filtro->prioridades : 0x1F;
+
+        // Prioridade gravada → 1 se selecionada (valores fora de 1 a 5 nunca são)
+        uint8_t por_prioridade[256] = { 0 };
+        for (int q = 0; q < ALTAS_PRIORIDADES; q++)
+            por_prioridade[q + 1] = (aceitas >> q) & 1;
+
+        uint8_t selecao[ALTAS_BLOCO];
+        for (uint64_t base = 0; base < linhas && ok; base += ALTAS_BLOCO){
+            int n = linhas - base < ALTAS_BLOCO ? (int)(linhas - base) : ALTAS_BLOCO;
+            const int64_t* s = saida + base;
+            const uint8_t* p = prioridade + base;
+            const uint32_t* e = espera + base;
+
+            // Filtro e limites do bloco, sem desvios
+            int64_t menor = s[0], maior = s[0];
+            uint32_t marcadas = 0;
+            for (int i = 0; i < n; i++){
+                selecao[i] = por_prioridade[p[i]] & (s[i] >= de) & (s[i] < ate);
+                marcadas += selecao[i];
+                menor = s[i] < menor ? s[i] : menor;
+                maior = s[i] > maior ? s[i] : maior;
+            }
+            if (marcadas == 0) continue;
+            selecionadas += marcadas;
+
+            if (agrupados.atual < 0 || menor < agrupados.inicio || menor >= agrupados.fim)
+                ok = altas_mes_de(&agrupados, menor);
+            if (ok && maior < agrupados.fim){
+                altas_somar_bloco(&agrupados.itens[agrupados.atual], selecao, p, e, n);
+                continue;
+            }
+
+            // Bloco na virada de um mês (ou fora de ordem): agrupa linha a linha
+            for (int i = 0; i < n && ok; i++){
+                if (!selecao[i]) continue;
+                if (s[i] < agrupados.inicio || s[i] >= agrupados.fim)
+                    ok = altas_mes_de(&agrupados, s[i]);
+                if (!ok) break;
+                ALTAS_MES* mes = &agrupados.itens[agrupados.atual];
+                mes->altas[p[i] - 1]++;
+                if (e[i] != ALTAS_ESPERA_DESCONHECIDA){
+                    mes->com_espera[p[i] - 1]++;
+                    mes->soma_espera[p[i] - 1] += e[i];
+                }
+            }
+        }
+    }
+
+    for (int u = 0; u < 3; u++)
+        mapa_fechar(&mapas[u]);
+
+    if (!ok){
+        free(agrupados.itens);
+        return false;
+    }
+
+    qsort(agrupados.itens, (size_t)agrupados.quantidade, sizeof(ALTAS_MES), altas_comparar_meses);
+    *meses = agrupados.itens;
+    *quantidade = agrupados.quantidade;
+
+    if (medida){
+        medida->linhas = linhas == UINT64_MAX ? 0 : linhas;
+        medida->selecionadas = selecionadas;
+#ifndef _WIN32
+        clock_gettime(CLOCK_MONOTONIC, &fim_varredura);
+        medida->duracao_ms = (double)(fim_varredura.tv_sec - inicio_varredura.tv_sec) * 1e3 +
+                             (double)(fim_varredura.tv_nsec - inicio_varredura.tv_nsec) / 1e6;
+#else
+        medida->duracao_ms = (double)(clock() - inicio_varredura) * 1e3 / CLOCKS_PER_SEC;
+#endif
+    }
+    return true;
+}
+
+/**
+ * @brief Imprime a espera média por mês e prioridade das altas arquivadas.
+ * @param filtro Altas consideradas (NULL = todas).
+ */
+void altas_imprimir_espera_mensal(const ALTAS_FILTRO* filtro){
+    ALTAS_MES* meses;
+    int quantidade;
+    ALTAS_VARREDURA medida;
+
+    if (!altas_espera_mensal(filtro, &meses, &quantidade, &medida)){
+        printf("Não foi possível ler o arquivo de altas (%s).\n", ALTAS_DIRETORIO);
+        return;
+    }
+    if (quantidade == 0){
+        printf("Nenhuma alta arquivada.\n");
+        free(meses);
+        return;
+    }
+
+    printf("\n=== ESPERA MÉDIA POR MÊS (minutos | altas) ===\n");
+    printf("Mês     ");
+    for (int q = 0; q < ALTAS_PRIORIDADES; q++)
+        printf(" | Prioridade %d    ", q + 1);
+    printf("\n");
+
+    for (int m = 0; m < quantidade; m++){
+        printf("%04d-%02d ", meses[m].ano, meses[m].mes);
+        for (int q = 0; q < ALTAS_PRIORIDADES; q++){
+            if (meses[m].com_espera[q] > 0)
+                printf(" | %7.1f %8llu", (double)meses[m].soma_espera[q] / (double)meses[m].com_espera[q] / 60.0,
+                       (unsigned long long)meses[m].altas[q]);
+            else if (meses[m].altas[q] > 0)
+                printf(" | %7s %8llu", "-", (unsigned long long)meses[m].altas[q]);
+            else
+                printf(" | %16s", "");
+        }
+        printf("\n");
+    }
+
+    printf("==============================================\n");
+    printf("%llu alta(s) selecionada(s) de %llu, percorridas em %.1f ms.\n",
+           (unsigned long long)medida.selecionadas, (unsigned long long)medida.linhas, medida.duracao_ms);
+    free(meses);
+}
@@ -0,0 +1,1524 @@
+/**
+ * @file arquivo.c
+ * @brief Formato versionado dos arquivos de dados: cabeçalho, blocos com CRC32C e índice.
+ * @details Layout do arquivo:
+ *
+ *      - bloco 0: cabeçalho (assinatura, versão, marcador de ordem de bytes,
+ *        tipo, tamanho do bloco, totais, posição do índice, resumo das
+ *        chaves e CRC32C próprio), seguido do complemento (último registro
+ *        do log de operações coberto pelo arquivo, ver wal.c)
+ *      - blocos 1..n: ARQUIVO_TAM_BLOCO bytes cada, com um cabeçalho de bloco
+ *        (CRC32C, quantidade de registros, bytes usados) seguido dos registros
+ *        [TAMANHO (uint32)][CHAVE (uint64)][BYTES]; o resto do bloco é zerado.
+ *        Na versão 2 (ARQUIVO_OPCAO_LZ), os registros de cada bloco são
+ *        comprimidos (ver lz.c) e o bloco ocupa só o cabeçalho e os bytes
+ *        comprimidos
+ *      - índice: para cada bloco, a chave do primeiro registro, a posição, o
+ *        tamanho em disco e a quantidade de registros; termina com o CRC32C
+ *        das entradas
+ *      - mapa de páginas livres: quantidade de extensões, as extensões
+ *        (posição e páginas) e o CRC32C, logo após o índice
+ *
+ * Um registro nunca atravessa blocos, então um bloco corrompido é detectado
+ * (e descartado) sozinho. Na lista, a chave é o CPF empacotado e os registros
+ * estão em ordem crescente, de modo que um paciente pode ser localizado por
+ * busca binária no índice, lendo um único bloco.
+ *
+ * Se o índice estiver ausente ou inválido (arquivo truncado), os blocos
+ * completos ainda podem ser percorridos em sequência.
+ *
+ * Na gravação, os registros de cada bloco são reunidos em segmentos que
+ * apontam direto para a memória dos pacientes e escritos com um único
+ * `writev()` (ou `fwrite()` no Windows). Trechos do arquivo também podem ser
+ * montados em memória por outras threads (ARQUIVO_LOTE) e anexados em ordem.
+ *
+ * Um arquivo da versão 1 também pode ser atualizado sem ser regravado (ver
+ * arquivo_atualizar()): blocos inteiros são trocados por novos, gravados em
+ * páginas livres ou no fim do arquivo, e a nova versão é confirmada pela
+ * segunda cópia do cabeçalho, no meio do bloco 0. Vale a cópia íntegra de
+ * maior geração; a anterior continua descrevendo um arquivo completo até a
+ * confirmação.
+ */
+
+#include "../include/arquivo.h"
+#include "../include/crc32c.h"
+#include "../include/lz.h"
+#include "../include/mapa.h"
+#include <stddef.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#define ARQUIVO_MAX_SEGMENTOS 1020 ///< Segmentos por bloco (+ cabeçalho e preenchimento <= IOV_MAX)
+#define ARQUIVO_TAM_REGISTRO 12    ///< TAMANHO + CHAVE antes dos bytes de cada registro
+#define ARQUIVO_POS_ALTERNATIVO (ARQUIVO_TAM_BLOCO / 2) ///< Segunda cópia do cabeçalho (ver arquivo_atualizar())
+
+/**
+ * @brief Cabeçalho do arquivo (início do bloco 0).
+ */
+typedef struct cabecalho_ {
+    char magica[8];         ///< ARQUIVO_MAGICA
+    uint32_t ordem_bytes;   ///< ARQUIVO_ORDEM_BYTES
+    uint16_t versao;        ///< ARQUIVO_VERSAO
+    uint16_t tipo;          ///< ARQUIVO_TIPO_LISTA ou ARQUIVO_TIPO_FILA
+    uint32_t tamanho_bloco; ///< ARQUIVO_TAM_BLOCO
+    uint32_t opcoes;        ///< ARQUIVO_OPCAO_*
+    uint64_t n_registros;   ///< Total de registros
+    uint64_t n_blocos;      ///< Total de blocos de dados
+    uint64_t pos_indice;    ///< Posição do índice no arquivo
+    uint64_t assinatura;    ///< Resumo das chaves gravadas (0 = desconhecido)
+    uint32_t geracao;       ///< Atualizações desde a criação (escolhe a cópia do cabeçalho)
+    uint32_t crc;           ///< CRC32C dos bytes anteriores do cabeçalho
+} CABECALHO;
+
+/**
+ * @brief Cabeçalho de cada bloco de dados.
+ */
+typedef struct cabecalho_bloco_ {
+    uint32_t crc;           ///< CRC32C do restante do cabeçalho e dos bytes usados
+    uint32_t n_registros;   ///< Registros no bloco
+    uint32_t usados;        ///< Bytes de registros (antes da compressão)
+    uint32_t comprimido;    ///< Bytes comprimidos após o cabeçalho (0 = registros sem compressão)
+} CABECALHO_BLOCO;
+
+/**
+ * @brief Entrada do índice (uma por bloco).
+ */
+typedef struct entrada_ {
+    uint64_t chave;         ///< Chave do primeiro registro do bloco
+    uint64_t posicao;       ///< Posição do bloco no arquivo
+    uint32_t tamanho;       ///< Bytes ocupados em disco
+    uint32_t n_registros;   ///< Registros no bloco
+} ENTRADA;
+
+/**
+ * @brief Trecho de páginas livres (mapa de páginas livres).
+ */
+typedef struct extensao_ {
+    uint64_t posicao;       ///< Posição da primeira página
+    uint64_t paginas;       ///< Quantidade de páginas
+} EXTENSAO;
+
+/**
+ * @brief Complemento gravado logo após cada cópia do cabeçalho.
+ * @details Ocupa bytes do bloco 0 que os arquivos anteriores deixavam
+ * zerados: neles o CRC32C não confere e o ponto lido é 0, então o formato
+ * não muda de versão.
+ */
+typedef struct complemento_ {
+    uint64_t ponto;         ///< Sequência do último registro do log coberto pelo arquivo (0 = nenhum)
+    uint32_t crc_cabecalho; ///< CRC32C da cópia do cabeçalho a que o complemento pertence
+    uint32_t crc;           ///< CRC32C dos bytes anteriores do complemento
+} COMPLEMENTO;
+
+_Static_assert(sizeof(CABECALHO) == 64, "cabeçalho do arquivo deve ter 64 bytes");
+_Static_assert(sizeof(COMPLEMENTO) == 16, "complemento do cabeçalho deve ter 16 bytes");
+_Static_assert(sizeof(CABECALHO_BLOCO) == 16, "cabeçalho do bloco deve ter 16 bytes");
+_Static_assert(sizeof(ENTRADA) == 24, "entrada do índice deve ter 24 bytes");
+
+#define ARQUIVO_CAPACIDADE_BLOCO (ARQUIVO_TAM_BLOCO - sizeof(CABECALHO_BLOCO)) ///< Bytes de registros por bloco
+
+static const char zeros[ARQUIVO_TAM_BLOCO]; ///< Preenchimento dos blocos
+
+/**
+ * @brief Monta uma cópia do cabeçalho (com o CRC32C já calculado) e o seu complemento.
+ * @param inicio Recebe os sizeof(CABECALHO) + sizeof(COMPLEMENTO) bytes a gravar.
+ */
+static void arquivo_montar_inicio(const CABECALHO* cab, uint64_t ponto, char* inicio){
+    COMPLEMENTO comp = { ponto, cab->crc, 0 };
+    comp.crc = crc32c_calcular(0, &comp, offsetof(COMPLEMENTO, crc));
+    memcpy(inicio, cab, sizeof(CABECALHO));
+    memcpy(inicio + sizeof(CABECALHO), &comp, sizeof(COMPLEMENTO));
+}
+
+// --- Escrita ---
+
+/**
+ * @struct arquivo_escritor_
+ * @brief Arquivo em gravação: bloco em montagem e índice acumulado.
+ */
+struct arquivo_escritor_ {
+#ifdef _WIN32
+    FILE* fp;
+#else
+    int fd;
+#endif
+    CABECALHO cab;
+    uint64_t ponto;                                /**< Gravado no complemento do cabeçalho. */
+    uint64_t posicao;                              /**< Posição do próximo bloco. */
+    CABECALHO_BLOCO bloco;                         /**< Cabeçalho do bloco em montagem. */
+    uint64_t primeira_chave;                       /**< Chave do primeiro registro do bloco. */
+    SEGMENTO segmentos[ARQUIVO_MAX_SEGMENTOS];     /**< Segmentos do bloco em montagem. */
+    int n_segmentos;
+    char copias[ARQUIVO_TAM_BLOCO];                /**< Cabeçalhos e prefixos dos registros do bloco. */
+    uint32_t n_copias;
+    char* montado;                                 /**< Bloco comprimido (só com ARQUIVO_OPCAO_LZ). */
+    ENTRADA* indice;
+    uint64_t capacidade_indice;
+    bool erro;
+};
+
+/**
+ * @brief Escreve uma sequência de segmentos no ponto atual do arquivo.
+ * @details `writev()` pode escrever parcialmente: avança pelos segmentos já gravados.
+ */
+static bool arquivo_escrever_segmentos(ARQUIVO_ESCRITOR* esc, SEGMENTO* segmentos, int n){
+#ifdef _WIN32
+    for (int i = 0; i < n; i++){
+        if (fwrite(segmentos[i].base, 1, segmentos[i].tamanho, esc->fp) != segmentos[i].tamanho)
+            return false;
+    }
+    return true;
+#else
+    struct iovec iov[ARQUIVO_MAX_SEGMENTOS + 2];
+    for (int i = 0; i < n; i++){
+        iov[i].iov_base = (void*)segmentos[i].base;
+        iov[i].iov_len = segmentos[i].tamanho;
+    }
+
+    int atual = 0;
+    while (atual < n){
+        ssize_t escritos = writev(esc->fd, iov + atual, n - atual);
+        if (escritos < 0)
+            return false;
+
+        while (atual < n && (size_t)escritos >= iov[atual].iov_len)
+            escritos -= iov[atual++].iov_len;
+
+        if (atual < n){
+            iov[atual].iov_base = (char*)iov[atual].iov_base + escritos;
+            iov[atual].iov_len -= escritos;
+        }
+    }
+    return true;
+#endif
+}
+
+/**
+ * @brief Contribuição de uma chave para o resumo do cabeçalho.
+ * @details Finalizador do splitmix64: qualquer mudança no conjunto de chaves
+ * muda o resumo. As contribuições são somadas, então trechos gravados em
+ * paralelo (ver arquivo_anexar_lote()) podem ter os resumos combinados.
+ */
+static inline uint64_t arquivo_misturar(uint64_t chave){
+    uint64_t h = chave + 0x9E3779B97F4A7C15ull;
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+    return h ^ (h >> 31);
+}
+
+/**
+ * @brief Garante espaço no índice para mais `n` entradas.
+ */
+static bool arquivo_reservar_indice(ARQUIVO_ESCRITOR* esc, uint64_t n){
+    if (esc->cab.n_blocos + n <= esc->capacidade_indice)
+        return true;
+
+    uint64_t nova = esc->capacidade_indice ? esc->capacidade_indice * 2 : 64;
+    while (nova < esc->cab.n_blocos + n)
+        nova *= 2;
+    ENTRADA* indice = realloc(esc->indice, nova * sizeof(ENTRADA));
+    if (indice == NULL){
+        esc->erro = true;
+        return false;
+    }
+    esc->indice = indice;
+    esc->capacidade_indice = nova;
+    return true;
+}
+
+/**
+ * @brief Monta em memória o bloco como ele vai para o disco.
+ * @details Com compressão, o bloco ocupa só o cabeçalho e os bytes
+ * comprimidos (ou os registros como estão, se a compressão não os reduzir);
+ * sem compressão, ocupa ARQUIVO_TAM_BLOCO bytes, com o resto zerado. O CRC32C
+ * cobre os bytes gravados, então um bloco corrompido é descartado antes de
+ * ser descomprimido.
+ * @param comprimir true para comprimir os registros (ARQUIVO_OPCAO_LZ).
+ * @param bloco Cabeçalho do bloco (recebe `comprimido` e `crc`).
+ * @param registros Registros do bloco, contíguos (`bloco->usados` bytes).
+ * @param saida Destino com ARQUIVO_TAM_BLOCO bytes.
+ * @return uint32_t Bytes do bloco em disco.
+ */
+static uint32_t arquivo_montar_bloco(bool comprimir, CABECALHO_BLOCO* bloco, const char* registros, char* saida){
+    char* carga = saida + sizeof(CABECALHO_BLOCO);
+    uint32_t gravados;
+
+    bloco->comprimido = 0;
+    if (comprimir)
+        bloco->comprimido = lz_comprimir(registros, bloco->usados, carga, bloco->usados - 1);
+
+    if (bloco->comprimido > 0){
+        gravados = bloco->comprimido;
+    } else {
+        memcpy(carga, registros, bloco->usados);
+        gravados = bloco->usados;
+        if (!comprimir){
+            memset(carga + gravados, 0, ARQUIVO_CAPACIDADE_BLOCO - gravados);
+            gravados = ARQUIVO_CAPACIDADE_BLOCO;
+        }
+    }
+
+    bloco->crc = crc32c_calcular(0, (const char*)bloco + 4, sizeof(CABECALHO_BLOCO) - 4);
+    bloco->crc = crc32c_calcular(bloco->crc, carga, comprimir ? gravados : bloco->usados);
+    memcpy(saida, bloco, sizeof(CABECALHO_BLOCO));
+    return sizeof(CABECALHO_BLOCO) + gravados;
+}
+
+/**
+ * @brief Grava o bloco em montagem (cabeçalho + registros + preenchimento) e indexa-o.
+ * @details Sem compressão, os segmentos vão direto para o `writev()`; com
+ * compressão, são reunidos e comprimidos antes (ver arquivo_montar_bloco()).
+ */
+static void arquivo_descarregar_bloco(ARQUIVO_ESCRITOR* esc){
+    if (esc->bloco.n_registros == 0)
+        return;
+
+    if (!arquivo_reservar_indice(esc, 1))
+        return;
+
+    uint32_t ocupa = ARQUIVO_TAM_BLOCO;
+    if (esc->montado != NULL){
+        char registros[ARQUIVO_CAPACIDADE_BLOCO];
+        uint32_t pos = 0;
+        for (int i = 0; i < esc->n_segmentos; i++){
+            memcpy(registros + pos, esc->segmentos[i].base, esc->segmentos[i].tamanho);
+            pos += esc->segmentos[i].tamanho;
+        }
+
+        ocupa = arquivo_montar_bloco(true, &esc->bloco, registros, esc->montado);
+        SEGMENTO bloco = { esc->montado, ocupa };
+        if (!arquivo_escrever_segmentos(esc, &bloco, 1))
+            esc->erro = true;
+    } else {
+        uint32_t crc = crc32c_calcular(0, (const char*)&esc->bloco + 4, sizeof(CABECALHO_BLOCO) - 4);
+        for (int i = 0; i < esc->n_segmentos; i++)
+            crc = crc32c_calcular(crc, esc->segmentos[i].base, esc->segmentos[i].tamanho);
+        esc->bloco.crc = crc;
+
+        SEGMENTO todos[ARQUIVO_MAX_SEGMENTOS + 2];
+        int n = 0;
+        todos[n++] = (SEGMENTO){ &esc->bloco, sizeof(CABECALHO_BLOCO) };
+        for (int i = 0; i < esc->n_segmentos; i++)
+            todos[n++] = esc->segmentos[i];
+        if (esc->bloco.usados < ARQUIVO_CAPACIDADE_BLOCO)
+            todos[n++] = (SEGMENTO){ zeros, ARQUIVO_CAPACIDADE_BLOCO - esc->bloco.usados };
+
+        if (!arquivo_escrever_segmentos(esc, todos, n))
+            esc->erro = true;
+    }
+
+    esc->indice[esc->cab.n_blocos++] = (ENTRADA){
+        esc->primeira_chave, esc->posicao, ocupa, esc->bloco.n_registros
+    };
+    esc->cab.n_registros += esc->bloco.n_registros;
+    esc->posicao += ocupa;
+
+    memset(&esc->bloco, 0, sizeof(CABECALHO_BLOCO));
+    esc->n_segmentos = 0;
+    esc->n_copias = 0;
+}
+
+/**
+ * @brief Cria (truncando) um arquivo de dados no formato versionado.
+ * @param caminho Caminho do arquivo.
+ * @param tipo ARQUIVO_TIPO_LISTA ou ARQUIVO_TIPO_FILA.
+ * @param opcoes 0 ou ARQUIVO_OPCAO_LZ (blocos comprimidos, versão 2 do formato).
+ * @return ARQUIVO_ESCRITOR* Escritor ou NULL em caso de erro.
+ */
+ARQUIVO_ESCRITOR* arquivo_criar(const char* caminho, uint16_t tipo, uint32_t opcoes){
+    ARQUIVO_ESCRITOR* esc = calloc(1, sizeof(ARQUIVO_ESCRITOR));
+    if (esc == NULL)
+        return NULL;
+
+    if ((opcoes & ARQUIVO_OPCAO_LZ) && (esc->montado = malloc(ARQUIVO_TAM_BLOCO)) == NULL){
+        free(esc);
+        return NULL;
+    }
+
+#ifdef _WIN32
+    esc->fp = fopen(caminho, "wb");
+    if (esc->fp == NULL)
+#else
+    esc->fd = open(caminho, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (esc->fd < 0)
+#endif
+    {
+        free(esc->montado);
+        free(esc);
+        return NULL;
+    }
+
+    memcpy(esc->cab.magica, ARQUIVO_MAGICA, 8);
+    esc->cab.ordem_bytes = ARQUIVO_ORDEM_BYTES;
+    esc->cab.opcoes = opcoes & ARQUIVO_OPCAO_LZ;
+    esc->cab.versao = esc->cab.opcoes ? ARQUIVO_VERSAO_COMPRIMIDA : ARQUIVO_VERSAO;
+    esc->cab.tipo = tipo;
+    esc->cab.tamanho_bloco = ARQUIVO_TAM_BLOCO;
+
+    // O bloco 0 é reservado para o cabeçalho, gravado ao final
+    SEGMENTO reservado = { zeros, ARQUIVO_TAM_BLOCO };
+    if (!arquivo_escrever_segmentos(esc, &reservado, 1))
+        esc->erro = true;
+    esc->posicao = ARQUIVO_TAM_BLOCO;
+    return esc;
+}
+
+/**
+ * @brief Acrescenta um registro, copiando o prefixo para a área de cópias.
+ * @details A área de cópias sempre comporta o bloco: cada registro ocupa
+ * nela no máximo o que ocupa no bloco.
+ */
+static bool arquivo_acrescentar(ARQUIVO_ESCRITOR* esc, uint64_t chave, const void* prefixo, uint32_t tam_prefixo,
+                                const SEGMENTO segmentos[], int n){
+    if (esc == NULL || n < 0 || n > ARQUIVO_MAX_SEGMENTOS - 2)
+        return false;
+
+    size_t tamanho = tam_prefixo;
+    for (int i = 0; i < n; i++)
+        tamanho += segmentos[i].tamanho;
+    if (ARQUIVO_TAM_REGISTRO + tamanho > ARQUIVO_CAPACIDADE_BLOCO)
+        return false;
+
+    uint32_t ocupa = ARQUIVO_TAM_REGISTRO + (uint32_t)tamanho;
+    if (esc->bloco.usados + ocupa > ARQUIVO_CAPACIDADE_BLOCO ||
+        esc->n_segmentos + 2 + n > ARQUIVO_MAX_SEGMENTOS)
+        arquivo_descarregar_bloco(esc);
+
+    if (esc->bloco.n_registros == 0)
+        esc->primeira_chave = chave;
+
+    // TAMANHO + CHAVE + prefixo vão juntos para a área de cópias
+    char* copia = esc->copias + esc->n_copias;
+    uint32_t tamanho32 = (uint32_t)tamanho;
+    memcpy(copia, &tamanho32, 4);
+    memcpy(copia + 4, &chave, 8);
+    if (tam_prefixo > 0)
+        memcpy(copia + ARQUIVO_TAM_REGISTRO, prefixo, tam_prefixo);
+    esc->segmentos[esc->n_segmentos++] = (SEGMENTO){ copia, ARQUIVO_TAM_REGISTRO + tam_prefixo };
+    esc->n_copias += ARQUIVO_TAM_REGISTRO + tam_prefixo;
+
+    for (int i = 0; i < n; i++)
+        esc->segmentos[esc->n_segmentos++] = segmentos[i];
+
+    esc->bloco.n_registros++;
+    esc->bloco.usados += ocupa;
+
+    esc->cab.assinatura += arquivo_misturar(chave);
+    return true;
+}
+
+/**
+ * @brief Acrescenta um registro ao arquivo.
+ * @details O prefixo (até ARQUIVO_MAX_PREFIXO bytes) é copiado; os segmentos
+ * são apenas referenciados e precisam continuar válidos até
+ * arquivo_finalizar() ou até o bloco ser gravado.
+ * @param esc Escritor.
+ * @param chave Chave do registro (CPF empacotado).
+ * @param prefixo Bytes gravados antes dos segmentos (pode ser NULL).
+ * @param tam_prefixo Tamanho do prefixo.
+ * @param segmentos Trechos do registro.
+ * @param n Quantidade de segmentos.
+ * @return true se o registro foi aceito.
+ */
+bool arquivo_escrever(ARQUIVO_ESCRITOR* esc, uint64_t chave, const void* prefixo, uint32_t tam_prefixo,
+                      const SEGMENTO segmentos[], int n){
+    return tam_prefixo <= ARQUIVO_MAX_PREFIXO && arquivo_acrescentar(esc, chave, prefixo, tam_prefixo, segmentos, n);
+}
+
+/**
+ * @brief Acrescenta um registro já serializado, copiando-o por inteiro.
+ * @details Para bytes que podem mudar antes de o bloco ser gravado, como os
+ * de um bloco descomprimido de outro arquivo (ver arquivo_bloco()).
+ * @param esc Escritor.
+ * @param chave Chave do registro.
+ * @param bytes Registro.
+ * @param tamanho Tamanho do registro.
+ * @return true se o registro foi aceito.
+ */
+bool arquivo_escrever_copia(ARQUIVO_ESCRITOR* esc, uint64_t chave, const char* bytes, uint32_t tamanho){
+    return arquivo_acrescentar(esc, chave, bytes, tamanho, NULL, 0);
+}
+
+/**
+ * @brief Resumo das chaves aceitas até agora (ver arquivo_assinatura()).
+ * @param esc Escritor.
+ * @return uint64_t Resumo que será gravado no cabeçalho.
+ */
+uint64_t arquivo_escritor_assinatura(ARQUIVO_ESCRITOR* esc){
+    return esc != NULL ? esc->cab.assinatura : 0;
+}
+
+/**
+ * @brief Define o último registro do log de operações coberto pelo arquivo.
+ * @details Gravado junto com o cabeçalho; o log não reaplica sobre o arquivo
+ * os registros até ele (ver wal.c).
+ * @param esc Escritor.
+ * @param ponto Sequência do registro (0 = nenhum).
+ */
+void arquivo_definir_ponto(ARQUIVO_ESCRITOR* esc, uint64_t ponto){
+    if (esc != NULL)
+        esc->ponto = ponto;
+}
+
+/**
+ * @brief Grava o último bloco, o índice e o cabeçalho; sincroniza e fecha o arquivo.
+ * @param esc Endereço do escritor (liberado e zerado).
+ * @return true se todas as escritas foram bem-sucedidas.
+ */
+bool arquivo_finalizar(ARQUIVO_ESCRITOR** esc){
+    if (esc == NULL || *esc == NULL)
+        return false;
+
+    ARQUIVO_ESCRITOR* e = *esc;
+    arquivo_descarregar_bloco(e);
+
+    // Índice + CRC32C das entradas + mapa de páginas livres (vazio)
+    e->cab.pos_indice = e->posicao;
+    uint32_t crc_indice = crc32c_calcular(0, e->indice, e->cab.n_blocos * sizeof(ENTRADA));
+    uint64_t n_livres = 0;
+    uint32_t crc_livres = crc32c_calcular(0, &n_livres, sizeof(uint64_t));
+    SEGMENTO indice[4] = {
+        { e->indice, e->cab.n_blocos * sizeof(ENTRADA) },
+        { &crc_indice, sizeof(uint32_t) },
+        { &n_livres, sizeof(uint64_t) },
+        { &crc_livres, sizeof(uint32_t) }
+    };
+    if (!arquivo_escrever_segmentos(e, indice, 4))
+        e->erro = true;
+
+    e->cab.crc = crc32c_calcular(0, &e->cab, offsetof(CABECALHO, crc));
+    char inicio[sizeof(CABECALHO) + sizeof(COMPLEMENTO)];
+    arquivo_montar_inicio(&e->cab, e->ponto, inicio);
+
+#ifdef _WIN32
+    if (fseek(e->fp, 0, SEEK_SET) != 0 || fwrite(inicio, sizeof(inicio), 1, e->fp) != 1)
+        e->erro = true;
+    if (fflush(e->fp) != 0 || _commit(_fileno(e->fp)) != 0) e->erro = true;
+    if (fclose(e->fp) != 0) e->erro = true;
+#else
+    if (pwrite(e->fd, inicio, sizeof(inicio), 0) != (ssize_t)sizeof(inicio))
+        e->erro = true;
+    /* O arquivo só substitui o anterior depois de estar inteiro no disco */
+    if (fsync(e->fd) != 0) e->erro = true;
+    if (close(e->fd) != 0) e->erro = true;
+#endif
+
+    bool ok = !e->erro;
+    free(e->indice);
+    free(e->montado);
+    free(e);
+    *esc = NULL;
+    return ok;
+}
+
+// --- Lotes ---
+
+/**
+ * @struct arquivo_lote_
+ * @brief Blocos montados em memória, para serem anexados a um escritor depois.
+ * @details Permite que várias threads serializem (e comprimam) trechos
+ * disjuntos de um arquivo ao mesmo tempo: cada uma monta o seu lote e a
+ * thread principal os anexa em ordem com arquivo_anexar_lote(). As posições
+ * do índice são relativas ao início do lote até a anexação.
+ */
+struct arquivo_lote_ {
+    bool comprimir;                             /**< Mesmo formato do escritor de origem. */
+    char* dados;                                /**< Blocos prontos, como vão para o disco. */
+    uint64_t bytes;                             /**< Bytes usados em `dados`. */
+    uint64_t capacidade;                        /**< Bytes alocados em `dados`. */
+    ENTRADA* indice;                            /**< Uma entrada por bloco pronto. */
+    uint64_t n_blocos;
+    uint64_t capacidade_indice;
+    CABECALHO_BLOCO bloco;                      /**< Cabeçalho do bloco em montagem. */
+    char registros[ARQUIVO_CAPACIDADE_BLOCO];   /**< Registros do bloco em montagem. */
+    uint64_t primeira_chave;                    /**< Chave do primeiro registro do bloco em montagem. */
+    uint64_t n_registros;
+    uint64_t assinatura;
+    bool erro;
+};
+
+/**
+ * @brief Cria um lote vazio.
+ * @param opcoes Opções do arquivo de destino (as mesmas passadas a arquivo_criar()).
+ * @return ARQUIVO_LOTE* Lote ou NULL se faltar memória.
+ */
+ARQUIVO_LOTE* arquivo_lote_criar(uint32_t opcoes){
+    ARQUIVO_LOTE* lote = calloc(1, sizeof(ARQUIVO_LOTE));
+    if (lote != NULL)
+        lote->comprimir = (opcoes & ARQUIVO_OPCAO_LZ) != 0;
+    return lote;
+}
+
+/**
+ * @brief Esvazia o lote depois de gravado, para ser reaproveitado.
+ */
+static void arquivo_lote_esvaziar(ARQUIVO_LOTE* lote){
+    lote->bytes = 0;
+    lote->n_blocos = 0;
+    lote->n_registros = 0;
+    lote->assinatura = 0;
+    lote->erro = false;
+    memset(&lote->bloco, 0, sizeof(CABECALHO_BLOCO));
+}
+
+/**
+ * @brief Fecha o bloco em montagem do lote: comprime (se for o caso) e indexa-o.
+ */
+static void arquivo_lote_fechar_bloco(ARQUIVO_LOTE* lote){
+    if (lote->bloco.n_registros == 0)
+        return;
+
+    if (lote->capacidade - lote->bytes < ARQUIVO_TAM_BLOCO){
+        uint64_t nova = lote->capacidade ? lote->capacidade * 2 : 16 * ARQUIVO_TAM_BLOCO;
+        char* dados = realloc(lote->dados, nova);
+        if (dados == NULL){
+            lote->erro = true;
+            return;
+        }
+        lote->dados = dados;
+        lote->capacidade = nova;
+    }
+    if (lote->n_blocos == lote->capacidade_indice){
+        uint64_t nova = lote->capacidade_indice ? lote->capacidade_indice * 2 : 16;
+        ENTRADA* indice = realloc(lote->indice, nova * sizeof(ENTRADA));
+        if (indice == NULL){
+            lote->erro = true;
+            return;
+        }
+        lote->indice = indice;
+        lote->capacidade_indice = nova;
+    }
+
+    uint32_t ocupa = arquivo_montar_bloco(lote->comprimir, &lote->bloco, lote->registros, lote->dados + lote->bytes);
+    lote->indice[lote->n_blocos++] = (ENTRADA){
+        lote->primeira_chave, lote->bytes, ocupa, lote->bloco.n_registros
+    };
+    lote->bytes += ocupa;
+    memset(&lote->bloco, 0, sizeof(CABECALHO_BLOCO));
+}
+
+/**
+ * @brief Acrescenta um registro ao lote (mesmas regras de arquivo_escrever()).
+ * @details Ao contrário do escritor, os bytes são copiados para o lote, então
+ * os segmentos só precisam ser válidos durante a chamada.
+ * @param lote Lote.
+ * @param chave Chave do registro.
+ * @param prefixo Bytes gravados antes dos segmentos (pode ser NULL).
+ * @param tam_prefixo Tamanho do prefixo.
+ * @param segmentos Trechos do registro.
+ * @param n Quantidade de segmentos.
+ * @return true se o registro foi aceito.
+ */
+bool arquivo_lote_escrever(ARQUIVO_LOTE* lote, uint64_t chave, const void* prefixo, uint32_t tam_prefixo,
+                           const SEGMENTO segmentos[], int n){
+    if (lote == NULL || lote->erro || tam_prefixo > ARQUIVO_MAX_PREFIXO || n < 0)
+        return false;
+
+    size_t tamanho = tam_prefixo;
+    for (int i = 0; i < n; i++)
+        tamanho += segmentos[i].tamanho;
+    if (ARQUIVO_TAM_REGISTRO + tamanho > ARQUIVO_CAPACIDADE_BLOCO)
+        return false;
+
+    uint32_t ocupa = ARQUIVO_TAM_REGISTRO + (uint32_t)tamanho;
+    if (lote->bloco.usados + ocupa > ARQUIVO_CAPACIDADE_BLOCO){
+        arquivo_lote_fechar_bloco(lote);
+        if (lote->erro)
+            return false;
+    }
+
+    if (lote->bloco.n_registros == 0)
+        lote->primeira_chave = chave;
+
+    char* destino = lote->registros + lote->bloco.usados;
+    uint32_t tamanho32 = (uint32_t)tamanho;
+    memcpy(destino, &tamanho32, 4);
+    memcpy(destino + 4, &chave, 8);
+    destino += ARQUIVO_TAM_REGISTRO;
+    if (tam_prefixo > 0){
+        memcpy(destino, prefixo, tam_prefixo);
+        destino += tam_prefixo;
+    }
+    for (int i = 0; i < n; i++){
+        memcpy(destino, segmentos[i].base, segmentos[i].tamanho);
+        destino += segmentos[i].tamanho;
+    }
+
+    lote->bloco.n_registros++;
+    lote->bloco.usados += ocupa;
+    lote->n_registros++;
+    lote->assinatura += arquivo_misturar(chave);
+    return true;
+}
+
+/**
+ * @brief Grava os blocos do lote no fim do arquivo e esvazia o lote.
+ * @details O bloco em montagem do escritor é gravado antes, mesmo incompleto,
+ * para preservar a ordem dos registros. O lote pode ser reaproveitado.
+ * @param esc Escritor.
+ * @param lote Lote montado com arquivo_lote_escrever().
+ * @return true se o lote estava íntegro e foi gravado.
+ */
+bool arquivo_anexar_lote(ARQUIVO_ESCRITOR* esc, ARQUIVO_LOTE* lote){
+    if (esc == NULL || lote == NULL)
+        return false;
+
+    arquivo_lote_fechar_bloco(lote);
+    arquivo_descarregar_bloco(esc);
+    bool ok = !lote->erro && lote->comprimir == (esc->montado != NULL);
+
+    if (ok && lote->n_blocos > 0 && arquivo_reservar_indice(esc, lote->n_blocos)){
+        SEGMENTO blocos = { lote->dados, lote->bytes };
+        if (!arquivo_escrever_segmentos(esc, &blocos, 1))
+            esc->erro = true;
+
+        for (uint64_t i = 0; i < lote->n_blocos; i++){
+            ENTRADA entrada = lote->indice[i];
+            entrada.posicao += esc->posicao;
+            esc->indice[esc->cab.n_blocos++] = entrada;
+        }
+        esc->posicao += lote->bytes;
+        esc->cab.n_registros += lote->n_registros;
+        esc->cab.assinatura += lote->assinatura;
+    }
+
+    if (!ok)
+        esc->erro = true;
+
+    arquivo_lote_esvaziar(lote);
+    return ok && !esc->erro;
+}
+
+/**
+ * @brief Libera um lote.
+ * @param lote Endereço do lote (zerado).
+ */
+void arquivo_lote_apagar(ARQUIVO_LOTE** lote){
+    if (lote != NULL && *lote != NULL){
+        free((*lote)->dados);
+        free((*lote)->indice);
+        free(*lote);
+        *lote = NULL;
+    }
+}
+
+// --- Leitura ---
+
+/**
+ * @struct arquivo_
+ * @brief Arquivo de dados mapeado em memória.
+ */
+struct arquivo_ {
+    MAPA* mapa;
+    const char* dados;
+    size_t tamanho;
+    CABECALHO cab;
+    uint64_t pos_cabecalho; /**< Cópia do cabeçalho em uso (0 ou ARQUIVO_POS_ALTERNATIVO). */
+    uint64_t ponto;         /**< Complemento da cópia em uso (0 se ausente). */
+    const char* indice;     /**< Entradas do índice no mapeamento (NULL se truncado). */
+    uint64_t* posicoes;     /**< Truncado e comprimido: posições dos blocos encontrados. */
+    uint64_t n_blocos;      /**< Blocos acessíveis. */
+    char area[ARQUIVO_CAPACIDADE_BLOCO]; /**< Bloco descomprimido por arquivo_buscar(). */
+};
+
+/**
+ * @brief Lê a entrada i do índice.
+ */
+static ENTRADA arquivo_entrada(ARQUIVO* arq, uint64_t i){
+    ENTRADA e;
+    memcpy(&e, arq->indice + i * sizeof(ENTRADA), sizeof(ENTRADA));
+    return e;
+}
+
+/**
+ * @brief Bytes de um bloco comprimido em disco, pelo seu cabeçalho.
+ * @return uint32_t Tamanho do bloco, ou 0 se o cabeçalho é inválido.
+ */
+static uint32_t arquivo_tamanho_comprimido(const CABECALHO_BLOCO* bloco){
+    if (bloco->usados > ARQUIVO_CAPACIDADE_BLOCO || bloco->comprimido >= ARQUIVO_CAPACIDADE_BLOCO)
+        return 0;
+    return sizeof(CABECALHO_BLOCO) + (bloco->comprimido ? bloco->comprimido : bloco->usados);
+}
+
+/**
+ * @brief Sem índice, encontra os blocos comprimidos seguindo os cabeçalhos.
+ * @details Os blocos comprimidos têm tamanhos variados, então só podem ser
+ * localizados em sequência. A busca para no primeiro cabeçalho inválido ou
+ * no fim do arquivo; os blocos seguintes ficam inacessíveis.
+ */
+static void arquivo_localizar_blocos(ARQUIVO* arq){
+    arq->n_blocos = 0;
+    uint64_t capacidade = 0;
+    uint64_t posicao = ARQUIVO_TAM_BLOCO;
+
+    while (arq->n_blocos < arq->cab.n_blocos && posicao <= arq->tamanho &&
+           arq->tamanho - posicao >= sizeof(CABECALHO_BLOCO)){
+        CABECALHO_BLOCO bloco;
+        memcpy(&bloco, arq->dados + posicao, sizeof(CABECALHO_BLOCO));
+        uint32_t ocupa = arquivo_tamanho_comprimido(&bloco);
+        if (ocupa == 0 || arq->tamanho - posicao < ocupa)
+            break;
+
+        if (arq->n_blocos == capacidade){
+            uint64_t nova = capacidade ? capacidade * 2 : 64;
+            uint64_t* posicoes = realloc(arq->posicoes, nova * sizeof(uint64_t));
+            if (posicoes == NULL)
+                break;
+            arq->posicoes = posicoes;
+            capacidade = nova;
+        }
+        arq->posicoes[arq->n_blocos++] = posicao;
+        posicao += ocupa;
+    }
+}
+
+/**
+ * @brief Lê uma cópia do cabeçalho e confere a assinatura e o CRC32C.
+ */
+static bool arquivo_ler_cabecalho(const char* dados, size_t tamanho, uint64_t pos, CABECALHO* cab){
+    if (tamanho < pos + sizeof(CABECALHO))
+        return false;
+    memcpy(cab, dados + pos, sizeof(CABECALHO));
+    return memcmp(cab->magica, ARQUIVO_MAGICA, 8) == 0 &&
+           crc32c_calcular(0, cab, offsetof(CABECALHO, crc)) == cab->crc;
+}
+
+/**
+ * @brief Lê o ponto do complemento de uma cópia do cabeçalho já conferida.
+ * @return uint64_t Ponto, ou 0 se o complemento não pertencer a esta cópia.
+ */
+static uint64_t arquivo_ler_ponto(const char* dados, size_t tamanho, uint64_t pos, const CABECALHO* cab){
+    COMPLEMENTO comp;
+    if (tamanho < pos + sizeof(CABECALHO) + sizeof(COMPLEMENTO))
+        return 0;
+    memcpy(&comp, dados + pos + sizeof(CABECALHO), sizeof(COMPLEMENTO));
+    bool valido = comp.crc_cabecalho == cab->crc &&
+                  crc32c_calcular(0, &comp, offsetof(COMPLEMENTO, crc)) == comp.crc;
+    return valido ? comp.ponto : 0;
+}
+
+/**
+ * @brief Abre e valida um arquivo de dados.
+ * @param caminho Caminho do arquivo.
+ * @param tipo Tipo esperado (ARQUIVO_TIPO_LISTA ou ARQUIVO_TIPO_FILA).
+ * @param estado Recebe o resultado da validação (pode ser NULL).
+ * @return ARQUIVO* Arquivo aberto (estados ARQUIVO_OK e ARQUIVO_TRUNCADO) ou NULL.
+ */
+ARQUIVO* arquivo_abrir(const char* caminho, uint16_t tipo, ARQUIVO_ESTADO* estado){
+    ARQUIVO_ESTADO descartado;
+    if (estado == NULL)
+        estado = &descartado;
+
+    MAPA* mapa = mapa_abrir(caminho);
+    if (mapa == NULL){
+        *estado = ARQUIVO_AUSENTE;
+        return NULL;
+    }
+
+    const char* dados = mapa_dados(mapa);
+    size_t tamanho = mapa_tamanho(mapa);
+    CABECALHO cab, alternativo;
+
+    // Vale a cópia íntegra de maior geração (ver arquivo_atualizar())
+    uint64_t pos_cabecalho = 0;
+    bool principal = arquivo_ler_cabecalho(dados, tamanho, 0, &cab);
+    if (arquivo_ler_cabecalho(dados, tamanho, ARQUIVO_POS_ALTERNATIVO, &alternativo) &&
+        (!principal || alternativo.geracao > cab.geracao)){
+        cab = alternativo;
+        pos_cabecalho = ARQUIVO_POS_ALTERNATIVO;
+    } else if (!principal){
+        bool antigo = tamanho < sizeof(CABECALHO) || memcmp(dados, ARQUIVO_MAGICA, 8) != 0;
+        *estado = antigo ? ARQUIVO_FORMATO_ANTIGO : ARQUIVO_CORROMPIDO;
+        mapa_fechar(&mapa);
+        return NULL;
+    }
+
+    bool versao_ok = (cab.versao == ARQUIVO_VERSAO && (cab.opcoes & ~ARQUIVO_OPCAO_PAGINAS) == 0) ||
+                     (cab.versao == ARQUIVO_VERSAO_COMPRIMIDA && (cab.opcoes & ~ARQUIVO_OPCAO_LZ) == 0);
+    if (cab.ordem_bytes != ARQUIVO_ORDEM_BYTES || !versao_ok ||
+        cab.tipo != tipo || cab.tamanho_bloco != ARQUIVO_TAM_BLOCO){
+        *estado = ARQUIVO_INCOMPATIVEL;
+        mapa_fechar(&mapa);
+        return NULL;
+    }
+
+    ARQUIVO* arq = malloc(sizeof(ARQUIVO));
+    if (arq == NULL){
+        *estado = ARQUIVO_CORROMPIDO;
+        mapa_fechar(&mapa);
+        return NULL;
+    }
+    arq->mapa = mapa;
+    arq->dados = dados;
+    arq->tamanho = tamanho;
+    arq->cab = cab;
+    arq->pos_cabecalho = pos_cabecalho;
+    arq->ponto = arquivo_ler_ponto(dados, tamanho, pos_cabecalho, &cab);
+    arq->indice = NULL;
+    arq->posicoes = NULL;
+
+    // O índice precisa caber no arquivo e conferir com o próprio CRC32C
+    uint64_t tam_indice = cab.n_blocos * sizeof(ENTRADA);
+    if (cab.n_blocos <= tamanho / sizeof(ENTRADA) && cab.pos_indice <= tamanho &&
+        tamanho - cab.pos_indice >= tam_indice + sizeof(uint32_t)){
+        uint32_t crc;
+        memcpy(&crc, dados + cab.pos_indice + tam_indice, sizeof(uint32_t));
+        if (crc32c_calcular(0, dados + cab.pos_indice, tam_indice) == crc)
+            arq->indice = dados + cab.pos_indice;
+    }
+
+    if (arq->indice != NULL){
+        arq->n_blocos = cab.n_blocos;
+        *estado = ARQUIVO_OK;
+    } else if (cab.opcoes & ARQUIVO_OPCAO_LZ){
+        arquivo_localizar_blocos(arq);
+        *estado = ARQUIVO_TRUNCADO;
+    } else {
+        // Sem índice: apenas os blocos completos presentes no arquivo. Com
+        // páginas, os blocos podem estar em qualquer uma delas (as livres são
+        // zeradas e descartadas pelo CRC32C)
+        uint64_t presentes = tamanho >= 2 * ARQUIVO_TAM_BLOCO ? tamanho / ARQUIVO_TAM_BLOCO - 1 : 0;
+        arq->n_blocos = presentes < cab.n_blocos || (cab.opcoes & ARQUIVO_OPCAO_PAGINAS) ? presentes : cab.n_blocos;
+        *estado = ARQUIVO_TRUNCADO;
+    }
+    return arq;
+}
+
+/**
+ * @brief Quantidade de blocos de dados acessíveis.
+ */
+uint64_t arquivo_blocos(ARQUIVO* arq){
+    return arq != NULL ? arq->n_blocos : 0;
+}
+
+/**
+ * @brief Quantidade de registros declarada no cabeçalho.
+ */
+uint64_t arquivo_registros(ARQUIVO* arq){
+    return arq != NULL ? arq->cab.n_registros : 0;
+}
+
+/**
+ * @brief Resumo das chaves gravadas (0 se desconhecido).
+ * @details Identifica o conjunto de registros de um SAVE: arquivos auxiliares,
+ * como o filtro de CPFs, guardam o resumo do arquivo a que correspondem.
+ */
+uint64_t arquivo_assinatura(ARQUIVO* arq){
+    return arq != NULL ? arq->cab.assinatura : 0;
+}
+
+/**
+ * @brief Último registro do log de operações coberto pelo arquivo (ver arquivo_definir_ponto()).
+ * @return uint64_t Sequência do registro, ou 0 se o arquivo não a tiver (anterior ao complemento).
+ */
+uint64_t arquivo_ponto(ARQUIVO* arq){
+    return arq != NULL ? arq->ponto : 0;
+}
+
+/**
+ * @brief Obtém os registros de um bloco, conferindo o CRC32C.
+ * @details Blocos sem compressão são lidos direto do mapeamento; os
+ * comprimidos são descomprimidos em `area`. Threads diferentes podem ler
+ * blocos ao mesmo tempo desde que cada uma use a sua área.
+ * @param arq Arquivo aberto.
+ * @param i Índice do bloco (0 a arquivo_blocos() - 1).
+ * @param area ARQUIVO_TAM_BLOCO bytes para o bloco descomprimido (NULL = área
+ * do próprio arquivo, válida até a próxima leitura).
+ * @param dados Recebe o início dos registros.
+ * @param tamanho Recebe a quantidade de bytes de registros.
+ * @return true se o bloco está íntegro.
+ */
+bool arquivo_bloco(ARQUIVO* arq, uint64_t i, char* area, const char** dados, uint32_t* tamanho){
+    if (arq == NULL || i >= arq->n_blocos)
+        return false;
+
+    bool comprimido = (arq->cab.opcoes & ARQUIVO_OPCAO_LZ) != 0;
+    uint64_t posicao;
+    if (arq->indice != NULL)
+        posicao = arquivo_entrada(arq, i).posicao;
+    else if (arq->posicoes != NULL)
+        posicao = arq->posicoes[i];
+    else
+        posicao = (i + 1) * ARQUIVO_TAM_BLOCO;
+
+    if (posicao > arq->tamanho || arq->tamanho - posicao < sizeof(CABECALHO_BLOCO))
+        return false;
+
+    CABECALHO_BLOCO bloco;
+    memcpy(&bloco, arq->dados + posicao, sizeof(CABECALHO_BLOCO));
+    uint32_t ocupa = comprimido ? arquivo_tamanho_comprimido(&bloco) : ARQUIVO_TAM_BLOCO;
+    if (ocupa == 0 || bloco.usados > ARQUIVO_CAPACIDADE_BLOCO || arq->tamanho - posicao < ocupa)
+        return false;
+
+    const char* inicio = arq->dados + posicao;
+    uint32_t gravados = bloco.comprimido && comprimido ? bloco.comprimido : bloco.usados;
+    if (crc32c_calcular(0, inicio + 4, sizeof(CABECALHO_BLOCO) - 4 + gravados) != bloco.crc)
+        return false;
+
+    *dados = inicio + sizeof(CABECALHO_BLOCO);
+    *tamanho = bloco.usados;
+
+    if (comprimido && bloco.comprimido){
+        if (area == NULL)
+            area = arq->area;
+        if (!lz_descomprimir(*dados, bloco.comprimido, area, bloco.usados))
+            return false;
+        *dados = area;
+    }
+    return true;
+}
+
+/**
+ * @brief Avança para o próximo registro de um bloco.
+ * @param dados Registros do bloco (ver arquivo_bloco()).
+ * @param tamanho Bytes de registros do bloco.
+ * @param pos Posição atual; avança para o registro seguinte.
+ * @param chave Recebe a chave do registro.
+ * @param registro Recebe o início dos bytes do registro.
+ * @param tam_registro Recebe o tamanho do registro.
+ * @return true se havia um registro completo na posição.
+ */
+bool arquivo_proximo(const char* dados, uint32_t tamanho, uint32_t* pos,
+                     uint64_t* chave, const char** registro, uint32_t* tam_registro){
+    if (*pos > tamanho || tamanho - *pos < ARQUIVO_TAM_REGISTRO)
+        return false;
+
+    uint32_t n;
+    memcpy(&n, dados + *pos, 4);
+    if (n > tamanho - *pos - ARQUIVO_TAM_REGISTRO)
+        return false;
+
+    memcpy(chave, dados + *pos + 4, 8);
+    *registro = dados + *pos + ARQUIVO_TAM_REGISTRO;
+    *tam_registro = n;
+    *pos += ARQUIVO_TAM_REGISTRO + n;
+    return true;
+}
+
+/**
+ * @brief Localiza um registro da lista pela chave, lendo um único bloco.
+ * @details Busca binária no índice pelo último bloco cuja primeira chave é
+ * menor ou igual à procurada; depois percorre apenas esse bloco.
+ * @param arq Arquivo do tipo ARQUIVO_TIPO_LISTA com índice válido.
+ * @param chave CPF empacotado.
+ * @param registro Recebe o início dos bytes do registro (em arquivos
+ * comprimidos, válido até a próxima leitura de bloco com a área do arquivo).
+ * @param tam_registro Recebe o tamanho do registro.
+ * @return true se o registro foi encontrado em um bloco íntegro.
+ */
+bool arquivo_buscar(ARQUIVO* arq, uint64_t chave, const char** registro, uint32_t* tam_registro){
+    if (arq == NULL || arq->indice == NULL || arq->cab.tipo != ARQUIVO_TIPO_LISTA || arq->n_blocos == 0)
+        return false;
+
+    uint64_t ini = 0, fim = arq->n_blocos;
+    while (fim - ini > 1){
+        uint64_t meio = ini + (fim - ini) / 2;
+        if (arquivo_entrada(arq, meio).chave <= chave)
+            ini = meio;
+        else
+            fim = meio;
+    }
+    if (arquivo_entrada(arq, ini).chave > chave)
+        return false;
+
+    const char* dados;
+    uint32_t tamanho, pos = 0;
+    if (!arquivo_bloco(arq, ini, NULL, &dados, &tamanho))
+        return false;
+
+    uint64_t atual;
+    while (arquivo_proximo(dados, tamanho, &pos, &atual, registro, tam_registro)){
+        if (atual == chave)
+            return true;
+        if (atual > chave)
+            break;
+    }
+    return false;
+}
+
+/**
+ * @brief Desfaz o mapeamento e libera o arquivo.
+ * @param arq Endereço do ponteiro do arquivo (ARQUIVO**).
+ */
+void arquivo_fechar(ARQUIVO** arq){
+    if (arq != NULL && *arq != NULL){
+        mapa_fechar(&(*arq)->mapa);
+        free((*arq)->posicoes);
+        free(*arq);
+        *arq = NULL;
+    }
+}
+
+// --- Atualização ---
+
+/**
+ * @struct arquivo_atualizacao_
+ * @brief Nova versão de um arquivo em montagem sobre a versão atual.
+ * @details Os blocos trocados vão para páginas livres da versão atual (ou
+ * para o fim do arquivo), nunca para páginas que ela ainda usa; as páginas
+ * dos blocos substituídos e do índice anterior só ficam livres depois da
+ * confirmação. Uma queda antes dela mantém a versão atual inteira.
+ */
+struct arquivo_atualizacao_ {
+#ifndef _WIN32
+    int fd;
+#endif
+    ARQUIVO* arq;                   /**< Versão atual, para leitura. */
+    CABECALHO cab;                  /**< Cabeçalho da nova versão. */
+    uint64_t ponto;                 /**< Complemento da nova versão. */
+    uint64_t fim;                   /**< Fim do arquivo, em páginas inteiras. */
+    EXTENSAO* livres;               /**< Páginas livres na versão atual. */
+    size_t n_livres;
+    EXTENSAO* liberadas;            /**< Páginas usadas pela versão atual e livres na nova. */
+    size_t n_liberadas;
+    size_t capacidade_liberadas;
+    ENTRADA* indice;                /**< Índice da nova versão. */
+    uint64_t n_blocos;
+    uint64_t capacidade_indice;
+    uint64_t proximo;               /**< Próximo bloco da versão atual a copiar para o índice. */
+    uint64_t substituidos;          /**< Blocos trocados até agora. */
+    bool erro;
+};
+
+/**
+ * @brief Grava bytes em uma posição do arquivo, repetindo em escritas parciais.
+ */
+#ifndef _WIN32
+static bool arquivo_gravar_em(int fd, const void* bytes, size_t tamanho, uint64_t posicao){
+    const char* p = bytes;
+    while (tamanho > 0){
+        ssize_t escritos = pwrite(fd, p, tamanho, (off_t)posicao);
+        if (escritos <= 0)
+            return false;
+        p += escritos;
+        tamanho -= (size_t)escritos;
+        posicao += (uint64_t)escritos;
+    }
+    return true;
+}
+#endif
+
+/**
+ * @brief Arredonda uma posição para o início da página seguinte.
+ */
+static inline uint64_t arquivo_pagina_seguinte(uint64_t posicao){
+    return (posicao + ARQUIVO_TAM_BLOCO - 1) / ARQUIVO_TAM_BLOCO * ARQUIVO_TAM_BLOCO;
+}
+
+/**
+ * @brief Acrescenta uma extensão a um vetor de extensões.
+ */
+static bool arquivo_guardar_extensao(EXTENSAO** v, size_t* n, size_t* capacidade, uint64_t posicao, uint64_t paginas){
+    if (*n == *capacidade){
+        size_t nova = *capacidade ? *capacidade * 2 : 64;
+        EXTENSAO* p = realloc(*v, nova * sizeof(EXTENSAO));
+        if (p == NULL)
+            return false;
+        *v = p;
+        *capacidade = nova;
+    }
+    (*v)[(*n)++] = (EXTENSAO){ posicao, paginas };
+    return true;
+}
+
+/**
+ * @brief Compara extensões pela posição (qsort()).
+ */
+static int arquivo_comparar_extensoes(const void* a, const void* b){
+    uint64_t x = ((const EXTENSAO*)a)->posicao;
+    uint64_t y = ((const EXTENSAO*)b)->posicao;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Ordena as extensões, junta as vizinhas e descarta as vazias.
+ * @return size_t Quantidade de extensões restantes.
+ */
+static size_t arquivo_juntar_extensoes(EXTENSAO* v, size_t n){
+    qsort(v, n, sizeof(EXTENSAO), arquivo_comparar_extensoes);
+
+    size_t m = 0;
+    for (size_t i = 0; i < n; i++){
+        if (v[i].paginas == 0)
+            continue;
+        if (m > 0 && v[m - 1].posicao + v[m - 1].paginas * ARQUIVO_TAM_BLOCO == v[i].posicao)
+            v[m - 1].paginas += v[i].paginas;
+        else
+            v[m++] = v[i];
+    }
+    return m;
+}
+
+/**
+ * @brief Lê o mapa de páginas livres gravado após o índice.
+ * @details Um mapa ausente ou inválido conta como vazio: as páginas ficam
+ * perdidas até o próximo SAVE completo, mas nenhuma página em uso é reutilizada.
+ * @return uint64_t Fim do mapa no arquivo (fim do índice se o mapa for inválido).
+ */
+static uint64_t arquivo_ler_livres(ARQUIVO_ATUALIZACAO* atu){
+    ARQUIVO* arq = atu->arq;
+    uint64_t pos = arq->cab.pos_indice + arq->cab.n_blocos * sizeof(ENTRADA) + sizeof(uint32_t);
+
+    uint64_t n;
+    if (arq->tamanho - pos < sizeof(uint64_t))
+        return pos;
+    memcpy(&n, arq->dados + pos, sizeof(uint64_t));
+    if (n > (arq->tamanho - pos - sizeof(uint64_t)) / sizeof(EXTENSAO))
+        return pos;
+
+    uint64_t tam_mapa = sizeof(uint64_t) + n * sizeof(EXTENSAO);
+    uint32_t crc;
+    if (arq->tamanho - pos - tam_mapa < sizeof(uint32_t))
+        return pos;
+    memcpy(&crc, arq->dados + pos + tam_mapa, sizeof(uint32_t));
+    if (crc32c_calcular(0, arq->dados + pos, tam_mapa) != crc)
+        return pos;
+
+    if (n > 0 && (atu->livres = malloc(n * sizeof(EXTENSAO))) == NULL)
+        return pos;
+    for (uint64_t i = 0; i < n; i++){
+        EXTENSAO e;
+        memcpy(&e, arq->dados + pos + sizeof(uint64_t) + i * sizeof(EXTENSAO), sizeof(EXTENSAO));
+        // Extensões fora do arquivo ou desalinhadas invalidam o mapa inteiro
+        if (e.posicao < ARQUIVO_TAM_BLOCO || e.posicao % ARQUIVO_TAM_BLOCO != 0 ||
+            e.paginas > (atu->fim - e.posicao) / ARQUIVO_TAM_BLOCO){
+            free(atu->livres);
+            atu->livres = NULL;
+            atu->n_livres = 0;
+            return pos;
+        }
+        atu->livres[atu->n_livres++] = e;
+    }
+    return pos + tam_mapa + sizeof(uint32_t);
+}
+
+/**
+ * @brief Abre um arquivo de dados para trocar blocos sem regravá-lo inteiro.
+ * @details Só arquivos da versão 1 (blocos de tamanho fixo) com índice
+ * válido podem ser atualizados. Os blocos são trocados com
+ * arquivo_substituir_bloco(), em ordem crescente, e a nova versão só passa a
+ * valer em arquivo_atualizacao_concluir(). No Windows, sem `pwrite()`, devolve
+ * sempre NULL (o chamador grava o arquivo inteiro).
+ * @param caminho Caminho do arquivo.
+ * @param tipo Tipo esperado.
+ * @return ARQUIVO_ATUALIZACAO* Atualização em andamento ou NULL.
+ */
+ARQUIVO_ATUALIZACAO* arquivo_atualizar(const char* caminho, uint16_t tipo){
+#ifdef _WIN32
+    (void)caminho;
+    (void)tipo;
+    return NULL;
+#else
+    ARQUIVO_ESTADO estado;
+    ARQUIVO* arq = arquivo_abrir(caminho, tipo, &estado);
+    if (arq == NULL)
+        return NULL;
+    if (estado != ARQUIVO_OK || arq->cab.versao != ARQUIVO_VERSAO || arq->cab.n_blocos == 0){
+        arquivo_fechar(&arq);
+        return NULL;
+    }
+
+    ARQUIVO_ATUALIZACAO* atu = calloc(1, sizeof(ARQUIVO_ATUALIZACAO));
+    if (atu == NULL){
+        arquivo_fechar(&arq);
+        return NULL;
+    }
+    atu->fd = -1;
+    atu->arq = arq;
+    atu->cab = arq->cab;
+    atu->ponto = arq->ponto;
+    atu->fim = arquivo_pagina_seguinte(arq->tamanho);
+
+    // O índice e o mapa atuais ficam livres na nova versão
+    uint64_t fim_mapa = arquivo_ler_livres(atu);
+    uint64_t inicio_indice = arq->cab.pos_indice / ARQUIVO_TAM_BLOCO * ARQUIVO_TAM_BLOCO;
+    uint64_t paginas_indice = (arquivo_pagina_seguinte(fim_mapa) - inicio_indice) / ARQUIVO_TAM_BLOCO;
+
+    atu->capacidade_indice = arq->cab.n_blocos + 16;
+    atu->indice = malloc(atu->capacidade_indice * sizeof(ENTRADA));
+    atu->fd = open(caminho, O_RDWR);
+    if (atu->indice == NULL || atu->fd < 0 ||
+        !arquivo_guardar_extensao(&atu->liberadas, &atu->n_liberadas, &atu->capacidade_liberadas,
+                                  inicio_indice, paginas_indice)){
+        arquivo_atualizacao_descartar(&atu);
+        return NULL;
+    }
+    return atu;
+#endif
+}
+
+/**
+ * @brief Define o ponto gravado com a nova versão (ver arquivo_definir_ponto()).
+ * @param atu Atualização em andamento.
+ * @param ponto Sequência do último registro do log coberto pela nova versão.
+ */
+void arquivo_atualizacao_definir_ponto(ARQUIVO_ATUALIZACAO* atu, uint64_t ponto){
+    if (atu != NULL)
+        atu->ponto = ponto;
+}
+
+/**
+ * @brief Fração das páginas do arquivo que estão livres.
+ * @details Serve para decidir quando compactar (gravar o arquivo inteiro de novo).
+ */
+double arquivo_atualizacao_livre(ARQUIVO_ATUALIZACAO* atu){
+    if (atu == NULL || atu->fim == 0)
+        return 0.0;
+
+    uint64_t livres = 0;
+    for (size_t i = 0; i < atu->n_livres; i++)
+        livres += atu->livres[i].paginas;
+    return (double)livres * ARQUIVO_TAM_BLOCO / (double)atu->fim;
+}
+
+/**
+ * @brief Bloco da versão atual em que uma chave está (ou entraria).
+ * @details O último bloco cuja primeira chave é menor ou igual à procurada;
+ * chaves menores que todas ficam no bloco 0.
+ */
+uint64_t arquivo_atualizacao_localizar(ARQUIVO_ATUALIZACAO* atu, uint64_t chave){
+    uint64_t ini = 0, fim = atu->arq->n_blocos;
+    while (fim - ini > 1){
+        uint64_t meio = ini + (fim - ini) / 2;
+        if (arquivo_entrada(atu->arq, meio).chave <= chave)
+            ini = meio;
+        else
+            fim = meio;
+    }
+    return ini;
+}
+
+/**
+ * @brief Registros de um bloco da versão atual (ver arquivo_bloco()).
+ */
+bool arquivo_atualizacao_bloco(ARQUIVO_ATUALIZACAO* atu, uint64_t i, const char** dados, uint32_t* tamanho){
+    return atu != NULL && arquivo_bloco(atu->arq, i, NULL, dados, tamanho);
+}
+
+/**
+ * @brief Reserva páginas livres, ou no fim do arquivo.
+ * @return uint64_t Posição da primeira página.
+ */
+static uint64_t arquivo_alocar_paginas(ARQUIVO_ATUALIZACAO* atu, uint64_t paginas){
+    for (size_t i = 0; i < atu->n_livres; i++){
+        EXTENSAO* e = &atu->livres[i];
+        if (e->paginas >= paginas){
+            uint64_t posicao = e->posicao;
+            e->posicao += paginas * ARQUIVO_TAM_BLOCO;
+            e->paginas -= paginas;
+            return posicao;
+        }
+    }
+
+    uint64_t posicao = atu->fim;
+    atu->fim += paginas * ARQUIVO_TAM_BLOCO;
+    return posicao;
+}
+
+/**
+ * @brief Garante espaço no novo índice para mais `n` entradas.
+ */
+static bool arquivo_reservar_entradas(ARQUIVO_ATUALIZACAO* atu, uint64_t n){
+    if (atu->n_blocos + n <= atu->capacidade_indice)
+        return true;
+
+    uint64_t nova = atu->capacidade_indice * 2;
+    while (nova < atu->n_blocos + n)
+        nova *= 2;
+    ENTRADA* indice = realloc(atu->indice, nova * sizeof(ENTRADA));
+    if (indice == NULL)
+        return false;
+    atu->indice = indice;
+    atu->capacidade_indice = nova;
+    return true;
+}
+
+/**
+ * @brief Copia para o novo índice as entradas da versão atual até o bloco `ate` (exclusive).
+ */
+static bool arquivo_copiar_entradas(ARQUIVO_ATUALIZACAO* atu, uint64_t ate){
+    uint64_t n = ate - atu->proximo;
+    if (!arquivo_reservar_entradas(atu, n))
+        return false;
+    memcpy(atu->indice + atu->n_blocos, atu->arq->indice + atu->proximo * sizeof(ENTRADA), n * sizeof(ENTRADA));
+    atu->n_blocos += n;
+    atu->proximo = ate;
+    return true;
+}
+
+/**
+ * @brief Troca um bloco da versão atual pelos blocos de um lote.
+ * @details Cada bloco do lote é gravado com `pwrite()` em uma página livre;
+ * um lote vazio apenas remove o bloco. As chaves do lote precisam ficar
+ * entre a primeira chave do bloco e a do bloco seguinte, para o índice
+ * continuar em ordem. O lote é esvaziado e pode ser reaproveitado.
+ * @param atu Atualização em andamento.
+ * @param i Bloco trocado (maior que o da troca anterior).
+ * @param lote Lote sem compressão (arquivo_lote_criar(0)).
+ * @return true se os blocos foram gravados; senão a atualização deve ser descartada.
+ */
+bool arquivo_substituir_bloco(ARQUIVO_ATUALIZACAO* atu, uint64_t i, ARQUIVO_LOTE* lote){
+    if (atu == NULL || lote == NULL)
+        return false;
+
+    arquivo_lote_fechar_bloco(lote);
+    const char* dados;
+    uint32_t tamanho, pos = 0;
+    bool ok = !atu->erro && !lote->erro && !lote->comprimir && i >= atu->proximo && i < atu->arq->n_blocos &&
+              arquivo_bloco(atu->arq, i, NULL, &dados, &tamanho) &&
+              arquivo_copiar_entradas(atu, i) && arquivo_reservar_entradas(atu, lote->n_blocos);
+
+#ifdef _WIN32
+    ok = false;
+#else
+    if (ok){
+        // Sai o bloco atual (registros e contribuições para o resumo)...
+        ENTRADA atual = arquivo_entrada(atu->arq, i);
+        uint64_t chave;
+        const char* registro;
+        uint32_t n;
+        while (arquivo_proximo(dados, tamanho, &pos, &chave, &registro, &n))
+            atu->cab.assinatura -= arquivo_misturar(chave);
+        atu->cab.n_registros -= atual.n_registros;
+
+        // ...e entram os do lote, cada um em uma página
+        for (uint64_t k = 0; k < lote->n_blocos && ok; k++){
+            ENTRADA entrada = lote->indice[k];
+            uint64_t posicao = arquivo_alocar_paginas(atu, 1);
+            ok = arquivo_gravar_em(atu->fd, lote->dados + entrada.posicao, ARQUIVO_TAM_BLOCO, posicao);
+            entrada.posicao = posicao;
+            atu->indice[atu->n_blocos++] = entrada;
+        }
+        atu->cab.n_registros += lote->n_registros;
+        atu->cab.assinatura += lote->assinatura;
+
+        ok = ok && arquivo_guardar_extensao(&atu->liberadas, &atu->n_liberadas, &atu->capacidade_liberadas,
+                                            atual.posicao, 1);
+        atu->proximo = i + 1;
+        atu->substituidos++;
+    }
+#endif
+
+    if (!ok)
+        atu->erro = true;
+    arquivo_lote_esvaziar(lote);
+    return ok;
+}
+
+/**
+ * @brief Grava o novo índice e o mapa de páginas livres e confirma a nova versão.
+ * @details Ordem das escritas: índice e mapa em páginas livres, `fsync()`,
+ * cabeçalho na cópia que não está em uso (com a geração seguinte), `fsync()`.
+ * Uma queda em qualquer ponto deixa válida a versão atual ou a nova. Depois
+ * da confirmação, as páginas dos blocos substituídos são zeradas, para que
+ * uma leitura sem índice (ver arquivo_abrir()) não encontre registros antigos.
+ * Sem blocos trocados, só o cabeçalho é gravado (na outra cópia, com o mesmo
+ * índice), e só se o ponto mudou.
+ * @param atu Endereço da atualização (liberada e zerada).
+ * @param assinatura Recebe o resumo das chaves da nova versão (pode ser NULL).
+ * @return true se a nova versão foi confirmada.
+ */
+bool arquivo_atualizacao_concluir(ARQUIVO_ATUALIZACAO** atu, uint64_t* assinatura){
+    if (atu == NULL || *atu == NULL)
+        return false;
+
+    ARQUIVO_ATUALIZACAO* a = *atu;
+    bool ok = !a->erro;
+
+#ifdef _WIN32
+    ok = false;
+#else
+    if (ok && a->substituidos > 0){
+        ok = arquivo_copiar_entradas(a, a->arq->n_blocos);
+
+        // O mapa gravado descreve a nova versão: o que continua livre mais o
+        // que foi liberado; o espaço é calculado antes de alocar o índice
+        size_t maximo = a->n_livres + a->n_liberadas;
+        uint64_t tam_indice = a->n_blocos * sizeof(ENTRADA);
+        uint64_t tam_total = tam_indice + sizeof(uint32_t) + sizeof(uint64_t) +
+                             maximo * sizeof(EXTENSAO) + sizeof(uint32_t);
+        uint64_t paginas = (tam_total + ARQUIVO_TAM_BLOCO - 1) / ARQUIVO_TAM_BLOCO;
+        char* metadados = ok ? malloc(paginas * ARQUIVO_TAM_BLOCO) : NULL;
+        EXTENSAO* mapa = ok ? malloc((maximo ? maximo : 1) * sizeof(EXTENSAO)) : NULL;
+        ok = metadados != NULL && mapa != NULL;
+
+        if (ok){
+            uint64_t pos_indice = arquivo_alocar_paginas(a, paginas);
+
+            memcpy(mapa, a->livres, a->n_livres * sizeof(EXTENSAO));
+            memcpy(mapa + a->n_livres, a->liberadas, a->n_liberadas * sizeof(EXTENSAO));
+            uint64_t n_mapa = arquivo_juntar_extensoes(mapa, maximo);
+
+            char* p = metadados;
+            memcpy(p, a->indice, tam_indice);
+            uint32_t crc = crc32c_calcular(0, p, tam_indice);
+            memcpy(p + tam_indice, &crc, sizeof(uint32_t));
+            p += tam_indice + sizeof(uint32_t);
+            memcpy(p, &n_mapa, sizeof(uint64_t));
+            memcpy(p + sizeof(uint64_t), mapa, n_mapa * sizeof(EXTENSAO));
+            crc = crc32c_calcular(0, p, sizeof(uint64_t) + n_mapa * sizeof(EXTENSAO));
+            memcpy(p + sizeof(uint64_t) + n_mapa * sizeof(EXTENSAO), &crc, sizeof(uint32_t));
+            size_t usados = (size_t)(p + sizeof(uint64_t) + n_mapa * sizeof(EXTENSAO) + sizeof(uint32_t) - metadados);
+
+            a->cab.n_blocos = a->n_blocos;
+            a->cab.pos_indice = pos_indice;
+            a->cab.opcoes |= ARQUIVO_OPCAO_PAGINAS;
+            a->cab.geracao++;
+            a->cab.crc = crc32c_calcular(0, &a->cab, offsetof(CABECALHO, crc));
+            uint64_t pos_cabecalho = a->arq->pos_cabecalho == 0 ? ARQUIVO_POS_ALTERNATIVO : 0;
+            char inicio[sizeof(CABECALHO) + sizeof(COMPLEMENTO)];
+            arquivo_montar_inicio(&a->cab, a->ponto, inicio);
+
+            ok = arquivo_gravar_em(a->fd, metadados, usados, pos_indice) && fsync(a->fd) == 0 &&
+                 arquivo_gravar_em(a->fd, inicio, sizeof(inicio), pos_cabecalho) && fsync(a->fd) == 0;
+
+            // A primeira extensão liberada é a do índice anterior (não tem blocos)
+            for (size_t i = 1; ok && i < a->n_liberadas; i++)
+                arquivo_gravar_em(a->fd, zeros, ARQUIVO_TAM_BLOCO, a->liberadas[i].posicao);
+        }
+        free(metadados);
+        free(mapa);
+    } else if (ok && a->ponto != a->arq->ponto){
+        // Mesmos blocos e índice: o mapa de páginas livres gravado continua valendo
+        a->cab.geracao++;
+        a->cab.crc = crc32c_calcular(0, &a->cab, offsetof(CABECALHO, crc));
+        char inicio[sizeof(CABECALHO) + sizeof(COMPLEMENTO)];
+        arquivo_montar_inicio(&a->cab, a->ponto, inicio);
+        ok = arquivo_gravar_em(a->fd, inicio, sizeof(inicio), a->arq->pos_cabecalho == 0 ? ARQUIVO_POS_ALTERNATIVO : 0) &&
+             fsync(a->fd) == 0;
+    }
+#endif
+
+    if (ok && assinatura != NULL)
+        *assinatura = a->cab.assinatura;
+    a->erro = !ok;
+    arquivo_atualizacao_descartar(atu);
+    return ok;
+}
+
+/**
+ * @brief Abandona uma atualização, mantendo a versão atual do arquivo.
+ * @details As páginas já gravadas estavam livres e continuam livres.
+ * @param atu Endereço da atualização (liberada e zerada).
+ */
+void arquivo_atualizacao_descartar(ARQUIVO_ATUALIZACAO** atu){
+    if (atu == NULL || *atu == NULL)
+        return;
+
+#ifndef _WIN32
+    if ((*atu)->fd >= 0)
+        close((*atu)->fd);
+#endif
+    arquivo_fechar(&(*atu)->arq);
+    free((*atu)->livres);
+    free((*atu)->liberadas);
+    free((*atu)->indice);
+    free(*atu);
+    *atu = NULL;
+}
@@ -0,0 +1,294 @@
+/**
+ * @file auditoria.c
+ * @brief Histórico completo das operações e reconstrução do estado em qualquer instante.
+ * @details Com PS_AUDITORIA=1, o log de operações (ver wal.c) deixa de ser
+ * descartado: antes de cada truncamento, os registros são anexados a
+ * data/auditoria/eventos.bin, que passa a conter todas as operações, na ordem
+ * em que foram aplicadas, e nunca é reescrito. A cada PS_AUDITORIA_PONTO KB
+ * de operações guardadas, o SAVE seguinte vira um ponto de restauração: os
+ * arquivos de dados são copiados para data/auditoria/ponto-NNNNNN/ e a
+ * posição correspondente em eventos.bin é anexada ao índice pontos.bin.
+ *
+ * Com PS_AUDITORIA_INSTANTE="AAAA-MM-DD HH:MM[:SS]" (horário local), o
+ * programa abre somente leitura, com a LISTA e a FILA daquele instante: o
+ * último ponto de restauração anterior é carregado e as operações seguintes
+ * são reaplicadas em lote, direto de eventos.bin mapeado em memória, até a
+ * primeira posterior ao instante (ver wal_reaplicar_ate()). As operações
+ * ainda no log atual, depois do último SAVE, também são consideradas.
+ *
+ * Formato de cada entrada de pontos.bin: instante do ponto (int64, time_t) e
+ * posição em eventos.bin (uint64). A entrada só é gravada depois da cópia
+ * completa dos arquivos, então um ponto interrompido nunca é usado.
+ */
+
+#include "../include/auditoria.h"
+#include "../include/IO.h"
+#include "../include/mapa.h"
+#include "../include/wal.h"
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#define AUDITORIA_PONTO_PADRAO 1024 ///< KB de operações entre pontos de restauração
+#define AUDITORIA_TAM_CAMINHO 256
+
+/**
+ * @brief Entrada do índice de pontos de restauração.
+ */
+typedef struct auditoria_ponto_ {
+    int64_t instante;   /**< Momento do SAVE copiado (time_t). */
+    uint64_t posicao;   /**< Bytes de eventos.bin já contidos no ponto. */
+} AUDITORIA_PONTO;
+
+/**
+ * @struct auditoria_
+ * @brief Configuração e última reconstrução.
+ */
+typedef struct auditoria_ {
+    bool ativa;                     /**< Guardando operações e pontos (PS_AUDITORIA). */
+    bool consulta;                  /**< Aberto em um instante passado (PS_AUDITORIA_INSTANTE). */
+    uint64_t intervalo;             /**< Bytes de operações entre pontos de restauração. */
+    int64_t instante;               /**< Instante consultado. */
+    AUDITORIA_RELATORIO relatorio;
+} AUDITORIA;
+
+static AUDITORIA auditoria = { .relatorio = { .ponto = -1 } };
+
+/**
+ * @brief Lê um horário local no formato "AAAA-MM-DD HH:MM[:SS]".
+ * @return true se o texto é um horário válido.
+ */
+static bool auditoria_ler_instante(const char* texto, int64_t* instante){
+    struct tm t;
+    memset(&t, 0, sizeof(t));
+    int segundos = 0;
+
+    int n = sscanf(texto, "%d-%d-%d %d:%d:%d", &t.tm_year, &t.tm_mon, &t.tm_mday, &t.tm_hour, &t.tm_min, &segundos);
+    if (n < 5 || t.tm_mon < 1 || t.tm_mon > 12 || t.tm_mday < 1 || t.tm_mday > 31 ||
+        t.tm_hour < 0 || t.tm_hour > 23 || t.tm_min < 0 || t.tm_min > 59 || segundos < 0 || segundos > 60)
+        return false;
+
+    t.tm_year -= 1900;
+    t.tm_mon -= 1;
+    t.tm_sec = segundos;
+    t.tm_isdst = -1;
+
+    time_t valor = mktime(&t);
+    if (valor == (time_t)-1)
+        return false;
+    *instante = (int64_t)valor;
+    return true;
+}
+
+/**
+ * @brief Lê as variáveis PS_AUDITORIA, PS_AUDITORIA_PONTO e PS_AUDITORIA_INSTANTE.
+ * @details Com PS_AUDITORIA=1, cria o diretório da auditoria e passa a
+ * guardar os registros descartados do log em eventos.bin.
+ * @return true se o programa deve abrir o estado de um instante passado.
+ */
+bool auditoria_configurar(void){
+    const char* instante = getenv(AUDITORIA_VARIAVEL_INSTANTE);
+    auditoria.consulta = instante != NULL && auditoria_ler_instante(instante, &auditoria.instante);
+    if (auditoria.consulta)
+        return true;
+
+    const char* valor = getenv(AUDITORIA_VARIAVEL);
+    if (valor == NULL || strcmp(valor, "1") != 0)
+        return false;
+
+    auditoria.intervalo = (uint64_t)AUDITORIA_PONTO_PADRAO * 1024;
+    const char* intervalo = getenv(AUDITORIA_VARIAVEL_PONTO);
+    if (intervalo != NULL){
+        char* fim;
+        long long kb = strtoll(intervalo, &fim, 10);
+        if (fim != intervalo && *fim == '\0' && kb >= 0 && kb <= 1024LL * 1024 * 1024)
+            auditoria.intervalo = (uint64_t)kb * 1024;
+    }
+
+#ifdef _WIN32
+    _mkdir(AUDITORIA_DIRETORIO);
+#else
+    mkdir(AUDITORIA_DIRETORIO, 0755);
+#endif
+    auditoria.ativa = wal_definir_arquivo_morto(AUDITORIA_EVENTOS);
+    return false;
+}
+
+/**
+ * @brief Indica se as operações e os pontos de restauração estão sendo guardados.
+ */
+bool auditoria_ativa(void){
+    return auditoria.ativa;
+}
+
+/**
+ * @brief Indica se o programa abriu o estado de um instante passado (somente leitura).
+ */
+bool auditoria_consulta(void){
+    return auditoria.consulta;
+}
+
+/**
+ * @brief Instante (time_t) consultado com PS_AUDITORIA_INSTANTE.
+ */
+int64_t auditoria_instante(void){
+    return auditoria.instante;
+}
+
+/**
+ * @brief Tamanho atual de um arquivo (0 se ausente).
+ */
+static uint64_t auditoria_tamanho(const char* caminho){
+    struct stat info;
+    return stat(caminho, &info) == 0 ? (uint64_t)info.st_size : 0;
+}
+
+/**
+ * @brief Grava um ponto de restauração, se já houver operações suficientes desde o anterior.
+ * @details Deve ser chamada logo depois de um SAVE cujo wal_truncar() deu
+ * certo: os arquivos de dados contêm então exatamente as operações de
+ * eventos.bin. O índice é relido a cada chamada, pois no heap compartilhado
+ * outros processos também gravam pontos.
+ * @return true se um ponto novo foi gravado.
+ */
+bool auditoria_ponto(void){
+    if (!auditoria.ativa)
+        return false;
+
+    uint64_t posicao = auditoria_tamanho(AUDITORIA_EVENTOS);
+    uint64_t pontos = auditoria_tamanho(AUDITORIA_PONTOS) / sizeof(AUDITORIA_PONTO);
+
+    if (pontos > 0){
+        AUDITORIA_PONTO ultimo;
+        FILE* fp = fopen(AUDITORIA_PONTOS, "rb");
+        bool lido = fp != NULL && fseek(fp, (long)((pontos - 1) * sizeof(AUDITORIA_PONTO)), SEEK_SET) == 0 &&
+                    fread(&ultimo, sizeof(AUDITORIA_PONTO), 1, fp) == 1;
+        if (fp != NULL)
+            fclose(fp);
+        if (lido && (posicao == ultimo.posicao || posicao - ultimo.posicao < auditoria.intervalo))
+            return false;
+    }
+
+    char diretorio[AUDITORIA_TAM_CAMINHO];
+    snprintf(diretorio, sizeof(diretorio), "%s/ponto-%06llu", AUDITORIA_DIRETORIO, (unsigned long long)pontos);
+#ifdef _WIN32
+    _mkdir(diretorio);
+#else
+    mkdir(diretorio, 0755);
+#endif
+    if (!IO_copiar_dados(diretorio))
+        return false;
+
+    /* Uma entrada incompleta deixada por uma queda é sobrescrita */
+    AUDITORIA_PONTO ponto = { (int64_t)time(NULL), posicao };
+    FILE* fp = fopen(AUDITORIA_PONTOS, pontos > 0 ? "r+b" : "wb");
+    bool ok = fp != NULL && fseek(fp, (long)(pontos * sizeof(AUDITORIA_PONTO)), SEEK_SET) == 0 &&
+              fwrite(&ponto, sizeof(AUDITORIA_PONTO), 1, fp) == 1;
+    if (fp != NULL){
+        ok = fflush(fp) == 0 && ok;
+#ifdef _WIN32
+        ok = ok && _commit(_fileno(fp)) == 0;
+#else
+        ok = ok && fsync(fileno(fp)) == 0;
+#endif
+        ok = fclose(fp) == 0 && ok;
+    }
+    return ok;
+}
+
+/**
+ * @brief Reaplica as operações de um arquivo de log até o instante consultado.
+ * @param completo Se falso, nada é aplicado; fica falso se o arquivo não foi aplicado até o fim.
+ */
+static void auditoria_reaplicar(const char* caminho, uint64_t inicio, LISTA* lista, FILA* fila, bool* completo){
+    if (!*completo)
+        return;
+
+    MAPA* mapa = mapa_abrir(caminho);
+    if (mapa == NULL)
+        return;
+
+    size_t tamanho = mapa_tamanho(mapa);
+    size_t consumido = 0;
+    if (inicio <= tamanho)
+        auditoria.relatorio.operacoes += wal_reaplicar_ate(mapa_dados(mapa) + inicio, tamanho - inicio,
+                                                           auditoria.instante, lista, fila, &consumido);
+    *completo = inicio <= tamanho && inicio + consumido == tamanho;
+    mapa_fechar(&mapa);
+}
+
+/**
+ * @brief Reconstrói a LISTA e a FILA no instante de PS_AUDITORIA_INSTANTE.
+ * @details Carrega o último ponto de restauração anterior ao instante e
+ * reaplica as operações seguintes de eventos.bin; se todas couberem, segue
+ * pelo log rotacionado e pelo log atual.
+ * @param lista Ponteiro para o ponteiro da LISTA já criada
+ * @param fila  Ponteiro para o ponteiro da FILA já criada
+ * @return true se havia ponto de restauração e ele foi carregado.
+ */
+bool auditoria_carregar(LISTA** lista, FILA** fila){
+    memset(&auditoria.relatorio, 0, sizeof(AUDITORIA_RELATORIO));
+    auditoria.relatorio.ponto = -1;
+    if (!auditoria.consulta || !lista || !(*lista) || !fila || !(*fila))
+        return false;
+
+    /* Pontos em ordem de gravação: o último anterior ao instante */
+    MAPA* indice = mapa_abrir(AUDITORIA_PONTOS);
+    AUDITORIA_PONTO ponto = { 0, 0 };
+    if (indice != NULL){
+        size_t pontos = mapa_tamanho(indice) / sizeof(AUDITORIA_PONTO);
+        for (size_t i = 0; i < pontos; i++){
+            AUDITORIA_PONTO p;
+            memcpy(&p, mapa_dados(indice) + i * sizeof(AUDITORIA_PONTO), sizeof(AUDITORIA_PONTO));
+            if (p.instante > auditoria.instante)
+                break;
+            ponto = p;
+            auditoria.relatorio.ponto = (int)i;
+        }
+        mapa_fechar(&indice);
+    }
+    if (auditoria.relatorio.ponto < 0)
+        return false;
+
+    char diretorio[AUDITORIA_TAM_CAMINHO];
+    snprintf(diretorio, sizeof(diretorio), "%s/ponto-%06d", AUDITORIA_DIRETORIO, auditoria.relatorio.ponto);
+    auditoria.relatorio.instante_ponto = ponto.instante;
+    if (!IO_carregar_de(diretorio, lista, fila))
+        return false;
+
+#ifndef _WIN32
+    struct timespec inicio, fim;
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+#else
+    clock_t inicio = clock();
+#endif
+
+    bool completo = true;
+    auditoria_reaplicar(AUDITORIA_EVENTOS, ponto.posicao, *lista, *fila, &completo);
+    auditoria_reaplicar(WAL_ARQUIVO WAL_SUFIXO_ANTIGO, 0, *lista, *fila, &completo);
+    auditoria_reaplicar(WAL_ARQUIVO, 0, *lista, *fila, &completo);
+
+#ifndef _WIN32
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+    auditoria.relatorio.duracao_ms = (double)(fim.tv_sec - inicio.tv_sec) * 1e3 +
+                                     (double)(fim.tv_nsec - inicio.tv_nsec) / 1e6;
+#else
+    auditoria.relatorio.duracao_ms = (double)(clock() - inicio) * 1e3 / CLOCKS_PER_SEC;
+#endif
+    return true;
+}
+
+/**
+ * @brief Medições da última reconstrução feita por auditoria_carregar().
+ */
+void auditoria_relatorio(AUDITORIA_RELATORIO* relatorio){
+    if (relatorio != NULL)
+        *relatorio = auditoria.relatorio;
+}
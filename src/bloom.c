@@ -0,0 +1,463 @@
+/**
+ * @file bloom.c
+ * @brief Filtro de Bloom bloqueado sobre os CPFs cadastrados.
+ * @details O filtro responde "com certeza não cadastrado" ou "talvez
+ * cadastrado". Os bits são divididos em blocos de 512 bits (uma linha de
+ * cache): cada CPF escolhe um bloco e liga k bits dentro dele, de modo que
+ * uma consulta lê uma única linha de cache. O bloqueio custa precisão
+ * (alguns blocos recebem mais CPFs que a média), compensada no
+ * dimensionamento com bits a mais por CPF.
+ *
+ * O tamanho vem da capacidade e da taxa de falsos positivos desejada
+ * (PS_BLOOM_TAXA). Bits não podem ser desligados: CPFs removidos continuam
+ * respondendo "talvez" até o filtro ser reconstruído no próximo SAVE.
+ *
+ * O SAVE grava o filtro em data/bloom.bin junto com o resumo das chaves do
+ * arquivo da lista (ver arquivo_assinatura()); o LOAD só o reaproveita se o
+ * resumo conferir, e do contrário o reconstrói a partir dos CPFs.
+ *
+ * Os bits são alocados com heap_alocar(); com o heap persistente (ver
+ * heap.c), o filtro é retomado por bloom_restaurar() sem ler o arquivo.
+ */
+
+#include "../include/bloom.h"
+#include "../include/crc32c.h"
+#include "../include/heap.h"
+#include <math.h>
+#include <stddef.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#define BLOOM_MAGICA "PSBLOOM1"         ///< Assinatura do arquivo do filtro
+#define BLOOM_ORDEM_BYTES 0x01020304u   ///< Lido de volta igual só na mesma ordem de bytes
+#define BLOOM_PALAVRAS_BLOCO 8          ///< Palavras de 64 bits por bloco (512 bits)
+#define BLOOM_TAM_BLOCO (BLOOM_PALAVRAS_BLOCO * sizeof(uint64_t))
+#define BLOOM_MAX_FUNCOES 16            ///< Maior quantidade de bits por CPF
+#define BLOOM_BITS_BLOCO 512            ///< Bits por bloco
+
+/**
+ * @struct bloom_
+ * @brief Bits do filtro e contadores de uso.
+ */
+struct bloom_ {
+    uint64_t* bits;             /**< Blocos alinhados à linha de cache. */
+    void* alocado;              /**< Endereço devolvido pelo heap_alocar() (para o heap_liberar()). */
+    uint64_t n_blocos;          /**< Quantidade de blocos de 512 bits. */
+    int funcoes;                /**< Bits ligados por CPF (k). */
+    uint64_t capacidade;        /**< CPFs para os quais o filtro foi dimensionado. */
+    uint64_t elementos;         /**< CPFs inseridos. */
+    double taxa;                /**< Taxa de falsos positivos pedida. */
+    uint64_t consultas;         /**< Consultas feitas. */
+    uint64_t negativas;         /**< Consultas respondidas pelo filtro. */
+    uint64_t falsos_positivos;  /**< "Talvez" para CPFs ausentes. */
+};
+
+/**
+ * @brief Cabeçalho do arquivo do filtro (64 bytes).
+ */
+typedef struct bloom_cabecalho_ {
+    char magica[8];         ///< BLOOM_MAGICA
+    uint32_t ordem_bytes;   ///< BLOOM_ORDEM_BYTES
+    int32_t funcoes;        ///< Bits por CPF
+    uint64_t n_blocos;      ///< Blocos de 512 bits
+    uint64_t capacidade;    ///< CPFs dimensionados
+    uint64_t elementos;     ///< CPFs inseridos
+    double taxa;            ///< Taxa de falsos positivos pedida
+    uint64_t assinatura;    ///< Resumo das chaves do arquivo da lista correspondente
+    uint32_t crc_bits;      ///< CRC32C dos blocos
+    uint32_t crc;           ///< CRC32C dos bytes anteriores do cabeçalho
+} BLOOM_CABECALHO;
+
+_Static_assert(sizeof(BLOOM_CABECALHO) == 64, "cabeçalho do filtro deve ter 64 bytes");
+
+/**
+ * @brief Filtro guardado no heap persistente (HEAP_RAIZ_FILTRO).
+ */
+typedef struct bloom_raiz_ {
+    HEAP_REF alocado;       ///< Posição dos bits (0 = sem filtro)
+    uint64_t deslocamento;  ///< Bytes até o primeiro bloco alinhado
+    uint64_t n_blocos;      ///< Blocos de 512 bits
+    int32_t funcoes;        ///< Bits por CPF
+    int32_t reservado;      ///< Zero
+    uint64_t capacidade;    ///< CPFs dimensionados
+    uint64_t elementos;     ///< CPFs inseridos
+    double taxa;            ///< Taxa de falsos positivos pedida
+} BLOOM_RAIZ;
+
+_Static_assert(sizeof(BLOOM_RAIZ) <= HEAP_TAM_RAIZ, "raiz do filtro deve caber no cabeçalho do heap");
+
+/**
+ * @brief Lê a taxa de falsos positivos da variável de ambiente PS_BLOOM_TAXA.
+ * @return double Taxa entre 0,000001 e 0,5 (BLOOM_TAXA_PADRAO se ausente ou inválida).
+ */
+double bloom_taxa_configurada(void){
+    const char* valor = getenv(BLOOM_VARIAVEL_TAXA);
+    if (valor != NULL){
+        char* fim;
+        double taxa = strtod(valor, &fim);
+        if (fim != valor && *fim == '\0' && taxa >= 1e-6 && taxa <= 0.5)
+            return taxa;
+    }
+    return BLOOM_TAXA_PADRAO;
+}
+
+/**
+ * @brief Aloca um filtro vazio com a geometria dada.
+ */
+static BLOOM* bloom_alocar(uint64_t n_blocos, int funcoes, uint64_t capacidade, double taxa){
+    BLOOM* b = calloc(1, sizeof(BLOOM));
+    if (b == NULL)
+        return NULL;
+
+    // Um bloco a mais para alinhar o início a 64 bytes
+    b->alocado = heap_alocar((n_blocos + 1) * BLOOM_TAM_BLOCO);
+    if (b->alocado == NULL){
+        free(b);
+        return NULL;
+    }
+    memset(b->alocado, 0, (n_blocos + 1) * BLOOM_TAM_BLOCO);
+    uintptr_t endereco = ((uintptr_t)b->alocado + BLOOM_TAM_BLOCO - 1) & ~(uintptr_t)(BLOOM_TAM_BLOCO - 1);
+    b->bits = (uint64_t*)endereco;
+
+    b->n_blocos = n_blocos;
+    b->funcoes = funcoes;
+    b->capacidade = capacidade;
+    b->taxa = taxa;
+    return b;
+}
+
+/**
+ * @brief Taxa de falsos positivos de um filtro bloqueado.
+ * @details A quantidade de CPFs em cada bloco segue uma distribuição de
+ * Poisson com média igual à carga; para um bloco com j CPFs a taxa é a do
+ * filtro clássico com 512 bits, (1 - (1 - 1/512)^(k·j))^k.
+ * @param carga Média de CPFs por bloco.
+ * @param funcoes Bits ligados por CPF.
+ * @return double Taxa esperada.
+ */
+static double bloom_taxa_bloqueada(double carga, int funcoes){
+    double taxa = 0;
+    double probabilidade = exp(-carga);     // P(j = 0)
+    int limite = (int)(carga + 10 * sqrt(carga) + 20);
+
+    for (int j = 0; j <= limite; j++){
+        double ligado = 1 - pow(1 - 1.0 / BLOOM_BITS_BLOCO, (double)funcoes * j);
+        taxa += probabilidade * pow(ligado, funcoes);
+        probabilidade *= carga / (j + 1);
+    }
+    return taxa;
+}
+
+/**
+ * @brief Cria um filtro vazio dimensionado para uma quantidade de CPFs.
+ * @param capacidade CPFs esperados (no mínimo BLOOM_CAPACIDADE_MINIMA).
+ * @param taxa Taxa de falsos positivos desejada com o filtro cheio.
+ * @return BLOOM* Filtro ou NULL se faltar memória.
+ */
+BLOOM* bloom_criar(uint64_t capacidade, double taxa){
+    if (capacidade < BLOOM_CAPACIDADE_MINIMA)
+        capacidade = BLOOM_CAPACIDADE_MINIMA;
+    if (!(taxa > 0 && taxa < 1))
+        taxa = BLOOM_TAXA_PADRAO;
+
+    // Filtro clássico: m/n = -ln(p) / ln(2)^2 e k = (m/n)·ln(2)
+    double bits_por_cpf = -log(taxa) / (M_LN2 * M_LN2);
+    int funcoes = (int)lround(bits_por_cpf * M_LN2);
+    if (funcoes < 1) funcoes = 1;
+    if (funcoes > BLOOM_MAX_FUNCOES) funcoes = BLOOM_MAX_FUNCOES;
+
+    // Bits a mais até a taxa do filtro bloqueado chegar à pedida
+    while (bloom_taxa_bloqueada(BLOOM_BITS_BLOCO / bits_por_cpf, funcoes) > taxa)
+        bits_por_cpf *= 1.05;
+
+    double bits = bits_por_cpf * (double)capacidade;
+    uint64_t n_blocos = (uint64_t)ceil(bits / (BLOOM_TAM_BLOCO * 8));
+    if (n_blocos == 0) n_blocos = 1;
+
+    return bloom_alocar(n_blocos, funcoes, capacidade, taxa);
+}
+
+/**
+ * @brief Espalha os bits do CPF (finalizador do splitmix64).
+ */
+static inline uint64_t bloom_misturar(uint64_t x){
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief Bloco do CPF: metade alta do hash reduzida sem divisão.
+ */
+static inline uint64_t* bloom_bloco(BLOOM* b, uint64_t h){
+    uint64_t i = ((h >> 32) * b->n_blocos) >> 32;
+    return b->bits + i * BLOOM_PALAVRAS_BLOCO;
+}
+
+/**
+ * @brief Posição do próximo bit do CPF dentro do bloco.
+ * @details Cada posição usa 9 bits próprios de um hash; a cada 7 posições a
+ * semente (que começa no hash que escolheu o bloco) é misturada de novo.
+ * @param semente Estado da sequência de hashes.
+ * @param bits Bits ainda não usados do hash atual.
+ * @param i Índice da posição (0 a k - 1).
+ */
+static inline uint32_t bloom_proximo_bit(uint64_t* semente, uint64_t* bits, int i){
+    if (i % 7 == 0){
+        *semente = bloom_misturar(*semente);
+        *bits = *semente;
+    }
+    uint32_t bit = (uint32_t)(*bits & (BLOOM_BITS_BLOCO - 1));
+    *bits >>= 9;
+    return bit;
+}
+
+/**
+ * @brief Insere um CPF no filtro.
+ * @param b Filtro.
+ * @param chave CPF empacotado.
+ */
+void bloom_inserir(BLOOM* b, uint64_t chave){
+    if (b == NULL)
+        return;
+
+    uint64_t h = bloom_misturar(chave);
+    uint64_t* bloco = bloom_bloco(b, h);
+    uint64_t semente = h, bits = 0;
+
+    for (int i = 0; i < b->funcoes; i++){
+        uint32_t bit = bloom_proximo_bit(&semente, &bits, i);
+        bloco[bit >> 6] |= 1ull << (bit & 63);
+    }
+    b->elementos++;
+}
+
+/**
+ * @brief Consulta um CPF.
+ * @param b Filtro (NULL responde sempre "talvez").
+ * @param chave CPF empacotado.
+ * @return false se o CPF certamente nunca foi inserido; true se talvez tenha sido.
+ */
+bool bloom_talvez_contem(BLOOM* b, uint64_t chave){
+    if (b == NULL)
+        return true;
+
+    uint64_t h = bloom_misturar(chave);
+    const uint64_t* bloco = bloom_bloco(b, h);
+    uint64_t semente = h, bits = 0;
+
+    b->consultas++;
+    for (int i = 0; i < b->funcoes; i++){
+        uint32_t bit = bloom_proximo_bit(&semente, &bits, i);
+        if (!(bloco[bit >> 6] & (1ull << (bit & 63)))){
+            b->negativas++;
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Contabiliza um "talvez" que a busca completa desmentiu.
+ * @param b Filtro.
+ */
+void bloom_registrar_falso_positivo(BLOOM* b){
+    if (b != NULL)
+        b->falsos_positivos++;
+}
+
+/**
+ * @brief Quantidade de CPFs inseridos (inclui os já removidos).
+ * @param b Filtro.
+ * @return uint64_t Inserções.
+ */
+uint64_t bloom_elementos(BLOOM* b){
+    return b != NULL ? b->elementos : 0;
+}
+
+/**
+ * @brief Preenche as medições do filtro.
+ * @details A taxa estimada é a média, sobre os blocos, de (fração de bits
+ * ligados no bloco)^k; ela cresce conforme o filtro passa da capacidade.
+ * @param b Filtro.
+ * @param relatorio Onde as medições são copiadas.
+ */
+void bloom_relatorio(BLOOM* b, BLOOM_RELATORIO* relatorio){
+    if (b == NULL || relatorio == NULL)
+        return;
+
+    // Média, sobre os blocos, da chance de os k bits já estarem ligados
+    double taxa = 0;
+    for (uint64_t i = 0; i < b->n_blocos; i++){
+        int ligados = 0;
+        for (int j = 0; j < BLOOM_PALAVRAS_BLOCO; j++)
+            ligados += __builtin_popcountll(b->bits[i * BLOOM_PALAVRAS_BLOCO + j]);
+        taxa += pow((double)ligados / BLOOM_BITS_BLOCO, b->funcoes);
+    }
+
+    relatorio->capacidade = b->capacidade;
+    relatorio->elementos = b->elementos;
+    relatorio->bytes = b->n_blocos * BLOOM_TAM_BLOCO;
+    relatorio->funcoes = b->funcoes;
+    relatorio->taxa_configurada = b->taxa;
+    relatorio->taxa_estimada = taxa / (double)b->n_blocos;
+    relatorio->consultas = b->consultas;
+    relatorio->negativas = b->negativas;
+    relatorio->falsos_positivos = b->falsos_positivos;
+}
+
+/**
+ * @brief Grava o filtro em arquivo, sincronizado com o disco.
+ * @param b Filtro.
+ * @param caminho Arquivo de destino.
+ * @param assinatura Resumo das chaves do arquivo da lista a que o filtro corresponde.
+ * @return true se o arquivo foi gravado por inteiro.
+ */
+bool bloom_salvar(BLOOM* b, const char* caminho, uint64_t assinatura){
+    if (b == NULL)
+        return false;
+
+    FILE* fp = fopen(caminho, "wb");
+    if (fp == NULL)
+        return false;
+
+    BLOOM_CABECALHO cab;
+    memset(&cab, 0, sizeof(BLOOM_CABECALHO));
+    memcpy(cab.magica, BLOOM_MAGICA, 8);
+    cab.ordem_bytes = BLOOM_ORDEM_BYTES;
+    cab.funcoes = b->funcoes;
+    cab.n_blocos = b->n_blocos;
+    cab.capacidade = b->capacidade;
+    cab.elementos = b->elementos;
+    cab.taxa = b->taxa;
+    cab.assinatura = assinatura;
+    cab.crc_bits = crc32c_calcular(0, b->bits, b->n_blocos * BLOOM_TAM_BLOCO);
+    cab.crc = crc32c_calcular(0, &cab, offsetof(BLOOM_CABECALHO, crc));
+
+    bool ok = fwrite(&cab, sizeof(BLOOM_CABECALHO), 1, fp) == 1 &&
+              fwrite(b->bits, BLOOM_TAM_BLOCO, b->n_blocos, fp) == b->n_blocos;
+
+    ok = fflush(fp) == 0 && ok;
+#ifdef _WIN32
+    ok = ok && _commit(_fileno(fp)) == 0;
+#else
+    ok = ok && fsync(fileno(fp)) == 0;
+#endif
+    return fclose(fp) == 0 && ok;
+}
+
+/**
+ * @brief Carrega um filtro gravado por bloom_salvar().
+ * @param caminho Arquivo de origem.
+ * @param assinatura Resumo das chaves do arquivo da lista carregado (0 = desconhecido).
+ * @param taxa Taxa de falsos positivos configurada.
+ * @return BLOOM* Filtro ou NULL se o arquivo não existir, estiver corrompido,
+ * corresponder a outra lista, tiver sido dimensionado para outra taxa ou já
+ * passar da capacidade (nesses casos o chamador reconstrói o filtro).
+ */
+BLOOM* bloom_carregar(const char* caminho, uint64_t assinatura, double taxa){
+    if (assinatura == 0)
+        return NULL;
+
+    FILE* fp = fopen(caminho, "rb");
+    if (fp == NULL)
+        return NULL;
+
+    BLOOM_CABECALHO cab;
+    BLOOM* b = NULL;
+
+    if (fread(&cab, sizeof(BLOOM_CABECALHO), 1, fp) == 1 &&
+        memcmp(cab.magica, BLOOM_MAGICA, 8) == 0 &&
+        crc32c_calcular(0, &cab, offsetof(BLOOM_CABECALHO, crc)) == cab.crc &&
+        cab.ordem_bytes == BLOOM_ORDEM_BYTES && cab.assinatura == assinatura &&
+        cab.taxa == taxa && cab.funcoes >= 1 && cab.funcoes <= BLOOM_MAX_FUNCOES &&
+        cab.n_blocos > 0 && cab.n_blocos < (1ull << 32) && cab.elementos <= cab.capacidade &&
+        (b = bloom_alocar(cab.n_blocos, cab.funcoes, cab.capacidade, cab.taxa)) != NULL){
+
+        if (fread(b->bits, BLOOM_TAM_BLOCO, b->n_blocos, fp) != b->n_blocos ||
+            crc32c_calcular(0, b->bits, b->n_blocos * BLOOM_TAM_BLOCO) != cab.crc_bits){
+            bloom_apagar(&b);
+        } else {
+            b->elementos = cab.elementos;
+        }
+    }
+
+    fclose(fp);
+    return b;
+}
+
+/**
+ * @brief Guarda a geometria e a posição dos bits no heap persistente.
+ * @param b Filtro (NULL guarda "sem filtro").
+ */
+void bloom_persistir(BLOOM* b){
+    BLOOM_RAIZ* raiz = heap_raiz(HEAP_RAIZ_FILTRO);
+    if (raiz == NULL)
+        return;
+
+    memset(raiz, 0, sizeof(BLOOM_RAIZ));
+    if (b != NULL){
+        raiz->alocado = heap_referencia(b->alocado);
+        raiz->deslocamento = (uint64_t)((char*)b->bits - (char*)b->alocado);
+        raiz->n_blocos = b->n_blocos;
+        raiz->funcoes = b->funcoes;
+        raiz->capacidade = b->capacidade;
+        raiz->elementos = b->elementos;
+        raiz->taxa = b->taxa;
+    }
+}
+
+/**
+ * @brief Retoma o filtro guardado por bloom_persistir(), sem copiar os bits.
+ * @return BLOOM* Filtro ou NULL se não houver.
+ */
+BLOOM* bloom_restaurar(void){
+    BLOOM_RAIZ* raiz = heap_raiz(HEAP_RAIZ_FILTRO);
+    if (raiz == NULL || raiz->alocado == 0)
+        return NULL;
+
+    BLOOM* b = calloc(1, sizeof(BLOOM));
+    if (b != NULL)
+        bloom_sincronizar(b);
+    return b;
+}
+
+/**
+ * @brief Relê os bits e os contadores guardados por bloom_persistir().
+ * @details No heap compartilhado, outro processo pode ter inserido CPFs
+ * desde a última leitura. As estatísticas de consultas são do processo e
+ * são mantidas.
+ * @param b Filtro retomado antes com bloom_restaurar().
+ * @return true se havia um filtro guardado.
+ */
+bool bloom_sincronizar(BLOOM* b){
+    BLOOM_RAIZ* raiz = heap_raiz(HEAP_RAIZ_FILTRO);
+    if (b == NULL || raiz == NULL || raiz->alocado == 0)
+        return false;
+
+    b->alocado = heap_ponteiro(raiz->alocado);
+    b->bits = (uint64_t*)((char*)b->alocado + raiz->deslocamento);
+    b->n_blocos = raiz->n_blocos;
+    b->funcoes = raiz->funcoes;
+    b->capacidade = raiz->capacidade;
+    b->elementos = raiz->elementos;
+    b->taxa = raiz->taxa;
+    return true;
+}
+
+/**
+ * @brief Libera o filtro.
+ * @param b Endereço do ponteiro do filtro (BLOOM**).
+ */
+void bloom_apagar(BLOOM** b){
+    if (b != NULL && *b != NULL){
+        heap_liberar((*b)->alocado);
+        free(*b);
+        *b = NULL;
+    }
+}
@@ -0,0 +1,361 @@
+/**
+ * @file catalogo.c
+ * @brief Catálogo global de procedimentos com descrições internadas.
+ * @details Cada descrição distinta ("Raio-X", "Sutura", ...) é armazenada uma
+ * única vez e recebe um código inteiro de 32 bits. O histórico dos pacientes
+ * guarda apenas esses códigos, de modo que comparações viram comparações de
+ * inteiros e a memória/disco deixam de repetir a mesma string para cada paciente.
+ *
+ * Os códigos são sequenciais a partir de 1 (0 é reservado como inválido) e
+ * nunca são reaproveitados, o que permite persisti-los com segurança.
+ *
+ * Por isso só as descrições recorrentes entram no catálogo: o histórico pede
+ * o código por catalogo_recorrente(), que interna uma descrição nova apenas
+ * na CATALOGO_RECORRENCIA-ésima vez em que ela aparece. Até lá o texto fica
+ * no próprio histórico do paciente, e um texto digitado uma vez só não
+ * ocupa o catálogo, o catalogo.bin nem o heap compartilhado para sempre.
+ * As ocorrências são contadas numa tabela fixa, indexada pelo hash, em que
+ * cada posição guarda o resto do hash da última descrição vista ali: uma
+ * descrição diferente na mesma posição recomeça a contagem, então colisões
+ * no máximo atrasam a internação, e a tabela não cresce.
+ *
+ * Os textos e as tabelas são alocados com heap_alocar(): com o heap
+ * persistente ativo, o catálogo fica junto dos históricos que o referenciam
+ * (ver catalogo_persistir()).
+ */
+
+#include "../include/catalogo.h"
+#include "../include/heap.h"
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+/**
+ * @struct catalogo_
+ * @brief Estado interno do catálogo (tabela de textos + tabela hash).
+ */
+typedef struct catalogo_ {
+    HEAP_REF* textos;     /**< textos[codigo - 1] é a posição da descrição internada. */
+    uint32_t quantidade;  /**< Quantidade de descrições internadas. */
+    uint32_t capacidade;  /**< Capacidade alocada do vetor de textos. */
+    uint32_t* tabela;     /**< Tabela hash (endereçamento aberto) de códigos. */
+    uint32_t tam_tabela;  /**< Tamanho da tabela hash (sempre potência de 2). */
+} CATALOGO;
+
+static CATALOGO catalogo = { NULL, 0, 0, NULL, 0 };
+
+#define CATALOGO_CANDIDATOS 4096 ///< Posições da tabela de ocorrências (potência de 2, maior que CATALOGO_RECORRENCIA)
+
+/// Descrições ainda fora do catálogo: bits altos do hash | ocorrências
+static uint32_t candidatos[CATALOGO_CANDIDATOS];
+
+/**
+ * @brief Catálogo guardado no heap persistente (HEAP_RAIZ_CATALOGO).
+ */
+typedef struct catalogo_raiz_ {
+    HEAP_REF textos;        ///< Posição do vetor de textos
+    HEAP_REF tabela;        ///< Posição da tabela hash
+    uint32_t quantidade;    ///< Descrições internadas
+    uint32_t capacidade;    ///< Capacidade do vetor de textos
+    uint32_t tam_tabela;    ///< Tamanho da tabela hash
+    uint32_t reservado;     ///< Zero
+} CATALOGO_RAIZ;
+
+_Static_assert(sizeof(CATALOGO_RAIZ) <= HEAP_TAM_RAIZ, "raiz do catálogo deve caber no cabeçalho do heap");
+
+/**
+ * @brief Descrição internada com um código já validado.
+ */
+static inline char* catalogo_descricao(uint32_t codigo){
+    return (char*)heap_ponteiro(catalogo.textos[codigo - 1]);
+}
+
+/**
+ * @brief Hash FNV-1a de 32 bits de uma string.
+ * @param texto String terminada em '\0'.
+ * @return uint32_t Valor hash.
+ */
+static uint32_t catalogo_hash(const char* texto){
+    uint32_t h = 2166136261u;
+    while (*texto != '\0'){
+        h ^= (unsigned char)*texto++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/**
+ * @brief Localiza a posição da tabela hash onde o texto está (ou deveria estar).
+ * @param texto String procurada.
+ * @return uint32_t Índice da posição na tabela.
+ */
+static uint32_t catalogo_posicao(const char* texto){
+    uint32_t mascara = catalogo.tam_tabela - 1;
+    uint32_t i = catalogo_hash(texto) & mascara;
+
+    while (catalogo.tabela[i] != CATALOGO_CODIGO_INVALIDO &&
+           strcmp(catalogo_descricao(catalogo.tabela[i]), texto) != 0){
+        i = (i + 1) & mascara;
+    }
+    return i;
+}
+
+/**
+ * @brief Dobra a tabela hash e reinsere todos os códigos.
+ * @return true se a realocação funcionou, false caso contrário.
+ */
+static bool catalogo_crescer_tabela(void){
+    uint32_t novo_tam = catalogo.tam_tabela ? catalogo.tam_tabela * 2 : 64;
+    uint32_t* nova = (uint32_t*)heap_alocar(novo_tam * sizeof(uint32_t));
+    if (nova == NULL)
+        return false;
+    memset(nova, 0, novo_tam * sizeof(uint32_t));
+
+    heap_liberar(catalogo.tabela);
+    catalogo.tabela = nova;
+    catalogo.tam_tabela = novo_tam;
+
+    for (uint32_t codigo = 1; codigo <= catalogo.quantidade; codigo++)
+        catalogo.tabela[catalogo_posicao(catalogo_descricao(codigo))] = codigo;
+
+    return true;
+}
+
+/**
+ * @brief Devolve o código de uma descrição, internando-a se ainda não existir.
+ * @param texto Descrição do procedimento.
+ * @return uint32_t Código da descrição ou CATALOGO_CODIGO_INVALIDO em caso de erro.
+ */
+uint32_t catalogo_internar(const char* texto){
+    if (texto == NULL)
+        return CATALOGO_CODIGO_INVALIDO;
+
+    // Mantém o fator de carga abaixo de 1/2
+    if ((catalogo.quantidade + 1) * 2 > catalogo.tam_tabela && !catalogo_crescer_tabela())
+        return CATALOGO_CODIGO_INVALIDO;
+
+    uint32_t pos = catalogo_posicao(texto);
+    if (catalogo.tabela[pos] != CATALOGO_CODIGO_INVALIDO)
+        return catalogo.tabela[pos];
+
+    if (catalogo.quantidade == CATALOGO_CODIGO_MAXIMO)
+        return CATALOGO_CODIGO_INVALIDO;
+
+    if (catalogo.quantidade == catalogo.capacidade){
+        uint32_t nova_cap = catalogo.capacidade ? catalogo.capacidade * 2 : 32;
+        HEAP_REF* novos = (HEAP_REF*)heap_realocar(catalogo.textos, nova_cap * sizeof(HEAP_REF));
+        if (novos == NULL)
+            return CATALOGO_CODIGO_INVALIDO;
+        catalogo.textos = novos;
+        catalogo.capacidade = nova_cap;
+    }
+
+    char* copia = (char*)heap_alocar(strlen(texto) + 1);
+    if (copia == NULL)
+        return CATALOGO_CODIGO_INVALIDO;
+    strcpy(copia, texto);
+
+    catalogo.textos[catalogo.quantidade++] = heap_referencia(copia);
+    catalogo.tabela[pos] = catalogo.quantidade;
+    return catalogo.quantidade;
+}
+
+/**
+ * @brief Busca o código de uma descrição sem interná-la.
+ * @param texto Descrição do procedimento.
+ * @return uint32_t Código encontrado ou CATALOGO_CODIGO_INVALIDO se não existir.
+ */
+uint32_t catalogo_buscar(const char* texto){
+    if (texto == NULL || catalogo.tam_tabela == 0)
+        return CATALOGO_CODIGO_INVALIDO;
+
+    return catalogo.tabela[catalogo_posicao(texto)];
+}
+
+/**
+ * @brief Código de uma descrição recorrente.
+ * @details Devolve o código se a descrição já estiver no catálogo. Caso
+ * contrário conta mais uma ocorrência dela e só a interna quando a contagem
+ * chega a CATALOGO_RECORRENCIA; antes disso o chamador guarda o texto por
+ * conta própria.
+ * @param texto Descrição do procedimento.
+ * @return uint32_t Código da descrição ou CATALOGO_CODIGO_INVALIDO se ela ainda não é recorrente.
+ */
+uint32_t catalogo_recorrente(const char* texto){
+    if (texto == NULL)
+        return CATALOGO_CODIGO_INVALIDO;
+
+    uint32_t codigo = catalogo_buscar(texto);
+    if (codigo != CATALOGO_CODIGO_INVALIDO)
+        return codigo;
+
+    uint32_t hash = catalogo_hash(texto);
+    uint32_t marca = hash & ~(uint32_t)(CATALOGO_CANDIDATOS - 1);
+    uint32_t* candidato = &candidatos[hash & (CATALOGO_CANDIDATOS - 1)];
+
+    // Outra descrição ocupava a posição: a contagem recomeça com esta
+    if ((*candidato & ~(uint32_t)(CATALOGO_CANDIDATOS - 1)) != marca)
+        *candidato = marca;
+
+    if ((++*candidato & (CATALOGO_CANDIDATOS - 1)) < CATALOGO_RECORRENCIA)
+        return CATALOGO_CODIGO_INVALIDO;
+
+    *candidato = 0;
+    return catalogo_internar(texto);
+}
+
+/**
+ * @brief Obtém a descrição associada a um código.
+ * @param codigo Código do procedimento.
+ * @return const char* Descrição internada ou NULL se o código não existir.
+ */
+const char* catalogo_texto(uint32_t codigo){
+    if (codigo == CATALOGO_CODIGO_INVALIDO || codigo > catalogo.quantidade)
+        return NULL;
+
+    return catalogo_descricao(codigo);
+}
+
+/**
+ * @brief Retorna a quantidade de descrições internadas.
+ * @return uint32_t Quantidade de códigos válidos (1..tamanho).
+ */
+uint32_t catalogo_tamanho(void){
+    return catalogo.quantidade;
+}
+
+/**
+ * @brief Salva o catálogo em disco.
+ * @details Formato: quantidade (int) seguida, para cada código em ordem,
+ * de TAMANHO (int) → TEXTO (bytes, sem '\0').
+ * @param caminho Caminho do arquivo de destino.
+ * @return true se salvou com sucesso, false caso contrário.
+ */
+bool catalogo_salvar(const char* caminho){
+    FILE* fp = fopen(caminho, "wb");
+    if (fp == NULL)
+        return false;
+
+    int quantidade = (int)catalogo.quantidade;
+    fwrite(&quantidade, sizeof(int), 1, fp);
+
+    for (uint32_t i = 0; i < catalogo.quantidade; i++){
+        const char* texto = catalogo_descricao(i + 1);
+        int tamanho = (int)strlen(texto);
+        fwrite(&tamanho, sizeof(int), 1, fp);
+        fwrite(texto, sizeof(char), tamanho, fp);
+    }
+
+    // Garante que o arquivo está no disco antes de o chamador substituir o anterior
+    bool ok = fflush(fp) == 0;
+#ifdef _WIN32
+    ok = ok && _commit(_fileno(fp)) == 0;
+#else
+    ok = ok && fsync(fileno(fp)) == 0;
+#endif
+    return fclose(fp) == 0 && ok;
+}
+
+/**
+ * @brief Carrega o catálogo salvo por catalogo_salvar(), preservando os códigos.
+ * @param caminho Caminho do arquivo de origem.
+ * @return true se o arquivo existia e foi lido, false caso contrário.
+ */
+bool catalogo_carregar(const char* caminho){
+    FILE* fp = fopen(caminho, "rb");
+    if (fp == NULL)
+        return false;
+
+    catalogo_apagar();
+
+    int quantidade;
+    bool ok = fread(&quantidade, sizeof(int), 1, fp) == 1 && quantidade >= 0;
+
+    for (int i = 0; ok && i < quantidade; i++){
+        int tamanho;
+        char* texto = NULL;
+
+        ok = fread(&tamanho, sizeof(int), 1, fp) == 1 && tamanho >= 0 &&
+             (texto = (char*)malloc(tamanho + 1)) != NULL &&
+             fread(texto, sizeof(char), tamanho, fp) == (size_t)tamanho;
+
+        if (ok){
+            texto[tamanho] = '\0';
+            // Os códigos são sequenciais, então internar em ordem preserva a numeração
+            ok = catalogo_internar(texto) == (uint32_t)(i + 1);
+        }
+        free(texto);
+    }
+
+    fclose(fp);
+    return ok;
+}
+
+/**
+ * @brief Libera toda a memória do catálogo, invalidando todos os códigos.
+ */
+void catalogo_apagar(void){
+    for (uint32_t i = 0; i < catalogo.quantidade; i++)
+        heap_liberar(catalogo_descricao(i + 1));
+
+    heap_liberar(catalogo.textos);
+    heap_liberar(catalogo.tabela);
+
+    catalogo.textos = NULL;
+    catalogo.tabela = NULL;
+    catalogo.quantidade = 0;
+    catalogo.capacidade = 0;
+    catalogo.tam_tabela = 0;
+
+    memset(candidatos, 0, sizeof(candidatos));
+}
+
+/**
+ * @brief Guarda a posição das tabelas e os contadores no heap persistente.
+ * @return true se havia heap ativo.
+ */
+bool catalogo_persistir(void){
+    CATALOGO_RAIZ* raiz = heap_raiz(HEAP_RAIZ_CATALOGO);
+    if (raiz == NULL)
+        return false;
+
+    memset(raiz, 0, sizeof(CATALOGO_RAIZ));
+    raiz->textos = heap_referencia(catalogo.textos);
+    raiz->tabela = heap_referencia(catalogo.tabela);
+    raiz->quantidade = catalogo.quantidade;
+    raiz->capacidade = catalogo.capacidade;
+    raiz->tam_tabela = catalogo.tam_tabela;
+    return true;
+}
+
+/**
+ * @brief Relê o catálogo guardado por catalogo_persistir().
+ * @details Usada também no heap compartilhado, depois que outro processo
+ * pode ter internado descrições: nada é liberado, pois as tabelas
+ * anteriores deste processo são as mesmas do heap.
+ * @return true se havia heap ativo.
+ */
+bool catalogo_sincronizar(void){
+    CATALOGO_RAIZ* raiz = heap_raiz(HEAP_RAIZ_CATALOGO);
+    if (raiz == NULL || raiz->quantidade > raiz->capacidade)
+        return false;
+
+    catalogo.textos = heap_ponteiro(raiz->textos);
+    catalogo.tabela = heap_ponteiro(raiz->tabela);
+    catalogo.quantidade = raiz->quantidade;
+    catalogo.capacidade = raiz->capacidade;
+    catalogo.tam_tabela = raiz->tam_tabela;
+    return true;
+}
+
+/**
+ * @brief Retoma o catálogo guardado por catalogo_persistir().
+ * @note O catálogo precisa estar vazio.
+ * @return true se o catálogo foi retomado.
+ */
+bool catalogo_restaurar(void){
+    return catalogo.quantidade == 0 && catalogo.tabela == NULL && catalogo_sincronizar();
+}
@@ -0,0 +1,391 @@
+/**
+ * @file cpf.c
+ * @brief Normalização, validação dos dígitos verificadores e empacotamento de CPFs.
+ * @details Aceita CPFs digitados só com números ("12345678909") ou formatados
+ * ("123.456.789-09"). Além do tamanho, confere os dois dígitos verificadores e
+ * rejeita sequências repetidas ("111.111.111-11"), que passam na conta mas não
+ * são CPFs válidos.
+ *
+ * Em processadores x86 com SSSE3 os dois formatos mais comuns são tratados com
+ * instruções SIMD (um CPF inteiro por registrador de 128 bits): extração dos
+ * dígitos, soma ponderada dos verificadores e conversão para inteiro. Com AVX2,
+ * cpf_validar_lote() trata dois CPFs por registrador de 256 bits, um em cada
+ * metade, com as mesmas operações. Os demais casos (ou processadores sem
+ * SSSE3) usam a implementação escalar, que produz exatamente o mesmo
+ * resultado; cpf_definir_caminho() limita o caminho usado, para comparações.
+ */
+
+#include "../include/cpf.h"
+#include <ctype.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CPF_SIMD_X86
+#include <immintrin.h>
+#endif
+
+// --- Implementação escalar ---
+
+/**
+ * @brief Remove os caracteres não numéricos de uma entrada.
+ * @param entrada String digitada (pode ser a mesma área de saida).
+ * @param saida Destino com espaço para 11 dígitos + '\0'.
+ * @return size_t Quantidade de dígitos encontrados (12 indica "mais de 11").
+ */
+static size_t cpf_normalizar_escalar(const char* entrada, char saida[CPF_DIGITOS + 1]){
+    size_t n = 0;
+    for (; *entrada != '\0'; entrada++){
+        if (isdigit((unsigned char)*entrada)){
+            if (n == CPF_DIGITOS){
+                saida[0] = '\0';
+                return CPF_DIGITOS + 1;
+            }
+            saida[n++] = *entrada;
+        }
+    }
+    saida[n] = '\0';
+    return n;
+}
+
+/**
+ * @brief Confere os dígitos verificadores de um CPF já normalizado.
+ * @param cpf 11 dígitos.
+ * @return true se os dois verificadores conferem e os dígitos não são todos iguais.
+ */
+static bool cpf_validar_escalar(const char cpf[CPF_DIGITOS + 1]){
+    int soma1 = 0, soma2 = 0;
+    bool repetido = true;
+
+    for (int i = 0; i < CPF_DIGITOS; i++){
+        if (cpf[i] < '0' || cpf[i] > '9')
+            return false;
+        if (cpf[i] != cpf[0])
+            repetido = false;
+    }
+
+    for (int i = 0; i < 9; i++)
+        soma1 += (cpf[i] - '0') * (10 - i);
+    for (int i = 0; i < 10; i++)
+        soma2 += (cpf[i] - '0') * (11 - i);
+
+    int dv1 = (soma1 * 10) % 11 % 10;
+    int dv2 = (soma2 * 10) % 11 % 10;
+
+    return !repetido && dv1 == cpf[9] - '0' && dv2 == cpf[10] - '0';
+}
+
+// --- Escolha do caminho ---
+
+static int cpf_caminho_usado = -1; ///< Caminho em uso (-1 = ainda não detectado)
+
+/**
+ * @brief Caminho mais rápido suportado pelo processador.
+ */
+static CPF_CAMINHO cpf_caminho_suportado(void){
+#ifdef CPF_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return CPF_CAMINHO_AVX2;
+    if (__builtin_cpu_supports("ssse3"))
+        return CPF_CAMINHO_SSSE3;
+#endif
+    return CPF_CAMINHO_ESCALAR;
+}
+
+#ifdef CPF_SIMD_X86
+/**
+ * @brief Caminho em uso, detectado na primeira chamada.
+ */
+static CPF_CAMINHO cpf_caminho(void){
+    if (cpf_caminho_usado < 0)
+        cpf_caminho_usado = cpf_caminho_suportado();
+    return (CPF_CAMINHO)cpf_caminho_usado;
+}
+#endif
+
+/**
+ * @brief Limita o caminho usado pelas funções deste módulo.
+ * @details Todos os caminhos dão o mesmo resultado; a escolha serve para
+ * medições e para conferir um contra o outro.
+ * @param maximo Caminho desejado; se o processador não o suportar, fica o melhor suportado abaixo dele.
+ * @return CPF_CAMINHO Caminho efetivamente em uso.
+ */
+CPF_CAMINHO cpf_definir_caminho(CPF_CAMINHO maximo){
+    CPF_CAMINHO suportado = cpf_caminho_suportado();
+    cpf_caminho_usado = maximo < suportado ? maximo : suportado;
+    return (CPF_CAMINHO)cpf_caminho_usado;
+}
+
+// --- Implementação SIMD (SSSE3 e AVX2) ---
+
+#ifdef CPF_SIMD_X86
+
+/**
+ * @brief Normaliza, valida e empacota um CPF com SSSE3.
+ * @details Trata entradas de 11 dígitos ou no formato "ddd.ddd.ddd-dd".
+ * @param entrada String de entrada.
+ * @param tamanho strlen(entrada).
+ * @param saida Destino para os 11 dígitos normalizados + '\0' (pode ser NULL).
+ * @param valor Destino para o CPF empacotado (CPF_INVALIDO se inválido).
+ * @return true se a entrada foi tratada aqui; false se deve cair no caminho escalar.
+ */
+__attribute__((target("ssse3")))
+static bool cpf_processar_ssse3(const char* entrada, size_t tamanho, char saida[CPF_DIGITOS + 1], uint64_t* valor){
+    if (tamanho != CPF_DIGITOS && tamanho != 14)
+        return false;
+
+    // Copia para um bloco de 16 bytes para nunca ler além do fim da entrada
+    char bloco[16] = {0};
+    memcpy(bloco, entrada, tamanho);
+    __m128i v = _mm_loadu_si128((const __m128i*)bloco);
+
+    // x = byte - '0'; é dígito se, sem sinal, x <= 9
+    __m128i x = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+    __m128i eh_digito = _mm_cmpeq_epi8(_mm_min_epu8(x, _mm_set1_epi8(9)), x);
+    int mascara = _mm_movemask_epi8(eh_digito);
+    __m128i d;
+
+    if (tamanho == CPF_DIGITOS){
+        if ((mascara & 0x7FF) != 0x7FF)
+            return false;
+        d = _mm_and_si128(x, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 0, 0, 0, 0));
+    } else {
+        // "ddd.ddd.ddd-dd": dígitos nas posições 0-2, 4-6, 8-10, 12-13
+        if ((mascara & 0x3FFF) != 0x3777 || bloco[3] != '.' || bloco[7] != '.' || bloco[11] != '-')
+            return false;
+        d = _mm_shuffle_epi8(x, _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, -128, -128, -128, -128, -128));
+    }
+
+    *valor = CPF_INVALIDO;
+
+    if (saida != NULL){
+        _mm_storeu_si128((__m128i*)bloco, _mm_add_epi8(d, _mm_set1_epi8('0')));
+        memcpy(saida, bloco, CPF_DIGITOS);
+        saida[CPF_DIGITOS] = '\0';
+    }
+
+    // Sequências repetidas (todos os dígitos iguais ao primeiro)
+    __m128i primeiro = _mm_shuffle_epi8(d, _mm_setzero_si128());
+    if ((_mm_movemask_epi8(_mm_cmpeq_epi8(d, primeiro)) & 0x7FF) == 0x7FF)
+        return true;
+
+    // Somas ponderadas dos dois dígitos verificadores
+    __m128i pesos1 = _mm_setr_epi8(10, 9, 8, 7, 6, 5, 4, 3, 2, 0, 0, 0, 0, 0, 0, 0);
+    __m128i pesos2 = _mm_setr_epi8(11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 0, 0, 0, 0, 0, 0);
+    __m128i pares = _mm_hadd_epi16(_mm_maddubs_epi16(d, pesos1), _mm_maddubs_epi16(d, pesos2));
+    __m128i somas = _mm_madd_epi16(pares, _mm_set1_epi16(1));
+
+    int soma1 = _mm_cvtsi128_si32(somas) + _mm_cvtsi128_si32(_mm_srli_si128(somas, 4));
+    int soma2 = _mm_cvtsi128_si32(_mm_srli_si128(somas, 8)) + _mm_cvtsi128_si32(_mm_srli_si128(somas, 12));
+    int d9 = _mm_extract_epi16(d, 4) >> 8;
+    int d10 = _mm_extract_epi16(d, 5) & 0xFF;
+
+    if ((soma1 * 10) % 11 % 10 != d9 || (soma2 * 10) % 11 % 10 != d10)
+        return true;
+
+    // Empacotamento: 16 dígitos (5 zeros à esquerda) → 2 grupos de 8 dígitos
+    __m128i p = _mm_slli_si128(d, 5);
+    __m128i grupos2 = _mm_maddubs_epi16(p, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1));
+    __m128i grupos4 = _mm_madd_epi16(grupos2, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+    __m128i grupos4_16 = _mm_packs_epi32(grupos4, grupos4);
+    __m128i grupos8 = _mm_madd_epi16(grupos4_16, _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1));
+
+    uint64_t alto = (uint32_t)_mm_cvtsi128_si32(grupos8);
+    uint64_t baixo = (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(grupos8, 4));
+    *valor = alto * 100000000ULL + baixo;
+
+    return true;
+}
+
+/**
+ * @brief Normaliza, valida e empacota dois CPFs de uma vez com AVX2.
+ * @details Cada CPF ocupa uma metade de 128 bits do registrador, e as
+ * operações são as de cpf_processar_ssse3(), que no AVX2 agem em cada metade
+ * separadamente. Só os restos por 11 ficam fora do registrador.
+ * @param entradas Os dois CPFs.
+ * @param tamanhos strlen() de cada um.
+ * @param valores Destino dos dois CPFs empacotados (CPF_INVALIDO se inválido).
+ * @return true se os dois foram tratados aqui; false se algum tem outro
+ * formato e os dois devem seguir por outro caminho.
+ */
+__attribute__((target("avx2")))
+static bool cpf_processar_avx2(const char* const entradas[2], const size_t tamanhos[2], uint64_t valores[2]){
+    char blocos[32] = {0};
+    for (int k = 0; k < 2; k++){
+        if (tamanhos[k] != CPF_DIGITOS && tamanhos[k] != 14)
+            return false;
+        memcpy(blocos + 16 * k, entradas[k], tamanhos[k]);
+    }
+    __m256i v = _mm256_loadu_si256((const __m256i*)blocos);
+
+    __m256i x = _mm256_sub_epi8(v, _mm256_set1_epi8('0'));
+    __m256i eh_digito = _mm256_cmpeq_epi8(_mm256_min_epu8(x, _mm256_set1_epi8(9)), x);
+    uint32_t mascara = (uint32_t)_mm256_movemask_epi8(eh_digito);
+
+    const __m128i seleciona_digitos = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, -128, -128, -128, -128, -128);
+    const __m128i seleciona_formatado = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, -128, -128, -128, -128, -128);
+    __m128i seleciona[2];
+    for (int k = 0; k < 2; k++){
+        const char* bloco = blocos + 16 * k;
+        uint32_t m = (mascara >> (16 * k)) & 0xFFFF;
+        if (tamanhos[k] == CPF_DIGITOS){
+            if ((m & 0x7FF) != 0x7FF)
+                return false;
+            seleciona[k] = seleciona_digitos;
+        } else {
+            if ((m & 0x3FFF) != 0x3777 || bloco[3] != '.' || bloco[7] != '.' || bloco[11] != '-')
+                return false;
+            seleciona[k] = seleciona_formatado;
+        }
+    }
+    __m256i d = _mm256_shuffle_epi8(x, _mm256_inserti128_si256(_mm256_castsi128_si256(seleciona[0]), seleciona[1], 1));
+
+    // Repetidos, somas ponderadas e empacotamento, nas duas metades
+    __m256i primeiro = _mm256_shuffle_epi8(d, _mm256_setzero_si256());
+    uint32_t repetidos = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(d, primeiro));
+
+    __m256i pesos1 = _mm256_broadcastsi128_si256(_mm_setr_epi8(10, 9, 8, 7, 6, 5, 4, 3, 2, 0, 0, 0, 0, 0, 0, 0));
+    __m256i pesos2 = _mm256_broadcastsi128_si256(_mm_setr_epi8(11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 0, 0, 0, 0, 0, 0));
+    __m256i pares = _mm256_hadd_epi16(_mm256_maddubs_epi16(d, pesos1), _mm256_maddubs_epi16(d, pesos2));
+    __m256i somas = _mm256_madd_epi16(pares, _mm256_set1_epi16(1));
+
+    __m256i p = _mm256_slli_si256(d, 5);
+    __m256i grupos2 = _mm256_maddubs_epi16(p, _mm256_set1_epi16(0x010A));
+    __m256i grupos4 = _mm256_madd_epi16(grupos2, _mm256_set1_epi32(0x00010064));
+    __m256i grupos4_16 = _mm256_packs_epi32(grupos4, grupos4);
+    __m256i grupos8 = _mm256_madd_epi16(grupos4_16, _mm256_set1_epi32(0x00012710));
+
+    int32_t s[8], g[8];
+    uint8_t digitos[32];
+    _mm256_storeu_si256((__m256i*)s, somas);
+    _mm256_storeu_si256((__m256i*)g, grupos8);
+    _mm256_storeu_si256((__m256i*)digitos, d);
+
+    for (int k = 0; k < 2; k++){
+        int soma1 = s[4 * k] + s[4 * k + 1];
+        int soma2 = s[4 * k + 2] + s[4 * k + 3];
+        if (((repetidos >> (16 * k)) & 0x7FF) == 0x7FF ||
+            (soma1 * 10) % 11 % 10 != digitos[16 * k + 9] || (soma2 * 10) % 11 % 10 != digitos[16 * k + 10])
+            valores[k] = CPF_INVALIDO;
+        else
+            valores[k] = (uint64_t)(uint32_t)g[4 * k] * 100000000ULL + (uint32_t)g[4 * k + 1];
+    }
+
+    return true;
+}
+
+#endif
+
+// --- Interface pública ---
+
+/**
+ * @brief Remove pontuação e espaços de um CPF digitado.
+ * @param entrada String digitada (pode ser a mesma área de saida).
+ * @param saida Destino com espaço para 11 dígitos + '\0'.
+ * @return true se restaram exatamente 11 dígitos.
+ */
+bool cpf_normalizar(const char* entrada, char saida[CPF_DIGITOS + 1]){
+    if (entrada == NULL || saida == NULL)
+        return false;
+
+#ifdef CPF_SIMD_X86
+    uint64_t valor;
+    if (cpf_caminho() >= CPF_CAMINHO_SSSE3 && cpf_processar_ssse3(entrada, strlen(entrada), saida, &valor))
+        return true;
+#endif
+
+    return cpf_normalizar_escalar(entrada, saida) == CPF_DIGITOS;
+}
+
+/**
+ * @brief Verifica os dígitos verificadores de um CPF normalizado (11 dígitos).
+ * @param cpf String com os 11 dígitos.
+ * @return true se o CPF é válido.
+ */
+bool cpf_validar(const char cpf[CPF_DIGITOS + 1]){
+    if (cpf == NULL || strlen(cpf) != CPF_DIGITOS)
+        return false;
+
+#ifdef CPF_SIMD_X86
+    uint64_t valor;
+    if (cpf_caminho() >= CPF_CAMINHO_SSSE3 && cpf_processar_ssse3(cpf, CPF_DIGITOS, NULL, &valor))
+        return valor != CPF_INVALIDO;
+#endif
+
+    return cpf_validar_escalar(cpf);
+}
+
+/**
+ * @brief Converte um CPF normalizado para inteiro (ex.: "01234567890" → 1234567890).
+ * @details Ordenar CPFs empacotados equivale a ordenar as strings de 11 dígitos.
+ * @param cpf String com os 11 dígitos.
+ * @return uint64_t CPF empacotado ou CPF_INVALIDO se houver caractere não numérico.
+ */
+uint64_t cpf_empacotar(const char cpf[CPF_DIGITOS + 1]){
+    uint64_t valor = 0;
+    for (int i = 0; i < CPF_DIGITOS; i++){
+        if (cpf[i] < '0' || cpf[i] > '9')
+            return CPF_INVALIDO;
+        valor = valor * 10 + (uint64_t)(cpf[i] - '0');
+    }
+    return valor;
+}
+
+/**
+ * @brief Converte um CPF empacotado de volta para 11 dígitos com zeros à esquerda.
+ * @param valor CPF empacotado.
+ * @param saida Destino com espaço para 11 dígitos + '\0'.
+ */
+void cpf_desempacotar(uint64_t valor, char saida[CPF_DIGITOS + 1]){
+    for (int i = CPF_DIGITOS - 1; i >= 0; i--){
+        saida[i] = (char)('0' + valor % 10);
+        valor /= 10;
+    }
+    saida[CPF_DIGITOS] = '\0';
+}
+
+/**
+ * @brief Normaliza, valida e empacota um lote de CPFs digitados.
+ * @details Pensada para importações em massa: cada entrada (com ou sem
+ * pontuação) é resolvida pelo caminho SIMD quando possível, aos pares com AVX2.
+ * @param entradas Vetor de n strings.
+ * @param n Quantidade de entradas.
+ * @param saida Vetor de n posições; recebe o CPF empacotado ou CPF_INVALIDO.
+ * @return size_t Quantidade de CPFs válidos no lote.
+ */
+size_t cpf_validar_lote(const char* const entradas[], size_t n, uint64_t saida[]){
+    size_t validos = 0;
+
+#ifdef CPF_SIMD_X86
+    CPF_CAMINHO caminho = cpf_caminho();
+#endif
+
+    for (size_t i = 0; i < n; i++){
+        saida[i] = CPF_INVALIDO;
+        if (entradas[i] == NULL)
+            continue;
+
+#ifdef CPF_SIMD_X86
+        size_t tamanho = strlen(entradas[i]);
+        if (caminho == CPF_CAMINHO_AVX2 && i + 1 < n && entradas[i + 1] != NULL){
+            size_t tamanhos[2] = { tamanho, strlen(entradas[i + 1]) };
+            if (cpf_processar_avx2(entradas + i, tamanhos, saida + i)){
+                validos += (saida[i] != CPF_INVALIDO) + (saida[i + 1] != CPF_INVALIDO);
+                i++;
+                continue;
+            }
+        }
+        if (caminho >= CPF_CAMINHO_SSSE3 && cpf_processar_ssse3(entradas[i], tamanho, NULL, &saida[i])){
+            validos += saida[i] != CPF_INVALIDO;
+            continue;
+        }
+#endif
+
+        char normalizado[CPF_DIGITOS + 1];
+        if (cpf_normalizar(entradas[i], normalizado) && cpf_validar_escalar(normalizado)){
+            saida[i] = cpf_empacotar(normalizado);
+            validos++;
+        }
+    }
+
+    return validos;
+}
@@ -1,36 +1,109 @@
 #include "../include/fila.h"
+#include "../include/heap.h"
 #include "../include/paciente.h"
+#include "../include/registro.h"
 
-#define TAM_MAX 50 ///< Capacidade máxima total da fila
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#define TAM_MAX 50 ///< Entradas mantidas em memória sem PS_FILA_MEMORIA
 #define NUM_PRIORIDADES 5 ///< Quantidade de níveis de prioridade (1 a 5)
+#define FILA_TRECHO 256 ///< Entradas gravadas de uma vez no arquivo de excedentes
+#define FILA_MODELO_EXCEDENTE "data/fila_excedente.XXXXXX" ///< Arquivo de excedentes (apagado ao ser aberto)
 
-typedef struct no_ NO;
+/**
+ * @brief Fila circular de identificadores de uma única prioridade.
+ *
+ * Cada posição guarda apenas o identificador de 32 bits do paciente no
+ * armazém central (ver registro.c), em um vetor contíguo que cresce sob demanda.
+ */
+typedef struct anel_
+{
+    PACIENTE_ID *itens; ///< Vetor circular de identificadores
+    int inicio;         ///< Posição do primeiro da fila
+    int quantidade;     ///< Quantidade de identificadores armazenados
+    int capacidade;     ///< Tamanho alocado de itens
+} ANEL;
 
 /**
- * @brief Nó da fila encadeada.
- * 
- * Cada nó armazena um ponteiro para um paciente e
- * um ponteiro para o próximo nó da fila da mesma prioridade.
+ * @brief Trecho de identificadores gravado no arquivo de excedentes.
  */
-struct no_
+typedef struct trecho_
 {
-    NO *prox;      ///< Próximo nó na fila
-    PACIENTE *pac; ///< Paciente armazenado no nó
-};
+    uint64_t posicao;        ///< Posição do trecho no arquivo
+    int quantidade;          ///< Identificadores gravados
+    int lidos;               ///< Identificadores já trazidos de volta para a memória
+    struct trecho_ *proximo; ///< Trecho seguinte da mesma prioridade
+} TRECHO;
+
+/**
+ * @brief Cauda de uma prioridade que não coube na memória.
+ *
+ * Os identificadores vão primeiro para `pendentes`; a cada FILA_TRECHO, eles
+ * são gravados juntos como um trecho no fim do arquivo de excedentes.
+ */
+typedef struct excedente_
+{
+    TRECHO *primeiro;                   ///< Trecho mais antigo (próximo a voltar para a memória)
+    TRECHO *ultimo;                     ///< Trecho mais recente
+    PACIENTE_ID pendentes[FILA_TRECHO]; ///< Fim da cauda, ainda não gravado
+    int n_pendentes;                    ///< Identificadores em pendentes
+    int quantidade;                     ///< Identificadores fora do anel (trechos + pendentes)
+} EXCEDENTE;
 
 /**
  * @brief Estrutura da fila de prioridades.
  *
  * Representa 5 filas independentes (uma para cada prioridade),
- * armazenadas em vetores de ponteiros de início e fim.
+ * cada uma armazenada em um vetor circular de identificadores.
+ *
+ * Com mais de `limite` entradas em memória, a cauda de cada prioridade vai
+ * para um arquivo de excedentes, só de acréscimo, e volta para o anel à
+ * medida que a frente é atendida. O anel de uma prioridade nunca fica vazio
+ * enquanto ela tem excedentes, então a frente está sempre em memória e a
+ * ordem de chegada de cada prioridade é mantida.
  */
 struct fila_
 {
-    NO *inicio[NUM_PRIORIDADES]; ///< Vetor de ponteiros para o início de cada fila
-    NO *fim[NUM_PRIORIDADES];    ///< Vetor de ponteiros para o fim de cada fila
-    int tamanho;                 ///< Quantidade total de pacientes na fila
+    ANEL niveis[NUM_PRIORIDADES];           ///< Uma fila circular para cada prioridade
+    EXCEDENTE excedentes[NUM_PRIORIDADES];  ///< Cauda de cada prioridade fora da memória
+    int tamanho;                            ///< Quantidade total de pacientes na fila
+    int em_disco;                           ///< Pacientes fora da memória (excedentes)
+    int limite;                             ///< Entradas mantidas em memória (0 = sem limite)
+#ifdef _WIN32
+    FILE *arquivo;                          ///< Arquivo de excedentes (NULL = ainda não aberto)
+#else
+    int arquivo;                            ///< Arquivo de excedentes (-1 = ainda não aberto)
+#endif
+    uint64_t fim;                           ///< Bytes gravados no arquivo de excedentes
 };
 
+/**
+ * @brief Anel guardado no heap persistente.
+ */
+typedef struct anel_raiz_
+{
+    HEAP_REF itens;     ///< Posição do vetor circular
+    int32_t inicio;     ///< Posição do primeiro da fila
+    int32_t quantidade; ///< Quantidade de identificadores armazenados
+    int32_t capacidade; ///< Tamanho alocado de itens
+    int32_t reservado;  ///< Zero
+} ANEL_RAIZ;
+
+/**
+ * @brief Fila guardada no heap persistente (HEAP_RAIZ_FILA).
+ */
+typedef struct fila_raiz_
+{
+    ANEL_RAIZ niveis[NUM_PRIORIDADES]; ///< Um anel para cada prioridade
+    int32_t tamanho;                   ///< Quantidade total de pacientes na fila
+} FILA_RAIZ;
+
+_Static_assert(sizeof(FILA_RAIZ) <= HEAP_TAM_RAIZ, "raiz da fila deve caber no cabeçalho do heap");
+
 /**
  * @brief Cria uma nova fila de prioridades.
  *
@@ -38,19 +111,199 @@ struct fila_
  */
 FILA *fila_criar()
 {
-    FILA *fila = (FILA *)malloc(sizeof(FILA));
+    FILA *fila = (FILA *)calloc(1, sizeof(FILA));
     if (fila != NULL)
     {
-        for (int i = 0; i < NUM_PRIORIDADES; i++)
+        fila->limite = TAM_MAX;
+        const char *limite = getenv(FILA_VARIAVEL_MEMORIA);
+        if (limite != NULL)
         {
-            fila->inicio[i] = NULL;
-            fila->fim[i] = NULL;
+            char *fim;
+            long valor = strtol(limite, &fim, 10);
+            if (fim != limite && *fim == '\0' && valor >= 0 && valor <= 1000000000L)
+                fila->limite = (int)valor;
         }
-        fila->tamanho = 0;
+#ifdef _WIN32
+        fila->arquivo = NULL;
+#else
+        fila->arquivo = -1;
+#endif
     }
     return fila;
 }
 
+/**
+ * @brief Abre o arquivo de excedentes na primeira vez em que a memória da fila se esgota.
+ *
+ * O arquivo só vale enquanto o processo roda (o SAVE grava a fila inteira):
+ * ele é apagado logo depois de criado e some quando é fechado.
+ *
+ * @return true se o arquivo está aberto.
+ */
+static bool excedente_abrir(FILA *fila)
+{
+#ifdef _WIN32
+    if (fila->arquivo == NULL)
+        fila->arquivo = tmpfile();
+    return fila->arquivo != NULL;
+#else
+    if (fila->arquivo < 0)
+    {
+        char caminho[] = FILA_MODELO_EXCEDENTE;
+        fila->arquivo = mkstemp(caminho);
+        if (fila->arquivo >= 0)
+            unlink(caminho);
+    }
+    return fila->arquivo >= 0;
+#endif
+}
+
+/**
+ * @brief Lê identificadores de uma posição do arquivo de excedentes.
+ * @note pread() não mexe na posição do descritor, que é compartilhada com o
+ * processo filho de um snapshot (ver snapshot.c).
+ */
+static bool excedente_ler(FILA *fila, uint64_t posicao, PACIENTE_ID *ids, int n)
+{
+    size_t tamanho = (size_t)n * sizeof(PACIENTE_ID);
+#ifdef _WIN32
+    return fseek(fila->arquivo, (long)posicao, SEEK_SET) == 0 && fread(ids, 1, tamanho, fila->arquivo) == tamanho;
+#else
+    char *destino = (char *)ids;
+    while (tamanho > 0)
+    {
+        ssize_t lidos = pread(fila->arquivo, destino, tamanho, (off_t)posicao);
+        if (lidos <= 0) return false;
+        destino += lidos;
+        posicao += (uint64_t)lidos;
+        tamanho -= (size_t)lidos;
+    }
+    return true;
+#endif
+}
+
+/**
+ * @brief Grava os pendentes de uma prioridade como um trecho no fim do arquivo de excedentes.
+ * @return true se o trecho foi gravado.
+ */
+static bool excedente_gravar(FILA *fila, EXCEDENTE *exc)
+{
+    TRECHO *trecho = (TRECHO *)malloc(sizeof(TRECHO));
+    if (trecho == NULL || !excedente_abrir(fila))
+    {
+        free(trecho);
+        return false;
+    }
+
+    size_t tamanho = (size_t)exc->n_pendentes * sizeof(PACIENTE_ID);
+#ifdef _WIN32
+    bool ok = fseek(fila->arquivo, (long)fila->fim, SEEK_SET) == 0 &&
+              fwrite(exc->pendentes, 1, tamanho, fila->arquivo) == tamanho;
+#else
+    const char *origem = (const char *)exc->pendentes;
+    uint64_t posicao = fila->fim;
+    size_t restante = tamanho;
+    bool ok = true;
+    while (ok && restante > 0)
+    {
+        ssize_t escritos = pwrite(fila->arquivo, origem, restante, (off_t)posicao);
+        ok = escritos > 0;
+        if (ok)
+        {
+            origem += escritos;
+            posicao += (uint64_t)escritos;
+            restante -= (size_t)escritos;
+        }
+    }
+#endif
+    if (!ok)
+    {
+        free(trecho);
+        return false;
+    }
+
+    trecho->posicao = fila->fim;
+    trecho->quantidade = exc->n_pendentes;
+    trecho->lidos = 0;
+    trecho->proximo = NULL;
+    if (exc->ultimo) exc->ultimo->proximo = trecho;
+    else exc->primeiro = trecho;
+    exc->ultimo = trecho;
+
+    fila->fim += tamanho;
+    exc->n_pendentes = 0;
+    return true;
+}
+
+/**
+ * @brief Anexa um identificador à cauda em disco de uma prioridade.
+ * @return false se não foi possível gravar o trecho cheio.
+ */
+static bool excedente_anexar(FILA *fila, int prioridade, PACIENTE_ID id)
+{
+    EXCEDENTE *exc = &fila->excedentes[prioridade];
+    if (exc->n_pendentes == FILA_TRECHO && !excedente_gravar(fila, exc))
+        return false;
+
+    exc->pendentes[exc->n_pendentes++] = id;
+    exc->quantidade++;
+    fila->em_disco++;
+    return true;
+}
+
+/**
+ * @brief Libera os trechos de todas as prioridades e recomeça o arquivo de excedentes.
+ */
+static void excedente_esvaziar(FILA *fila)
+{
+    for (int i = 0; i < NUM_PRIORIDADES; i++)
+    {
+        EXCEDENTE *exc = &fila->excedentes[i];
+        while (exc->primeiro)
+        {
+            TRECHO *trecho = exc->primeiro;
+            exc->primeiro = trecho->proximo;
+            free(trecho);
+        }
+        exc->ultimo = NULL;
+        exc->n_pendentes = 0;
+        exc->quantidade = 0;
+    }
+    fila->em_disco = 0;
+    fila->fim = 0;
+
+    // Falhar ao encolher o arquivo não é um erro: os trechos são regravados a partir do início
+#ifdef _WIN32
+    if (fila->arquivo && _chsize(_fileno(fila->arquivo), 0) != 0)
+        clearerr(fila->arquivo);
+#else
+    if (fila->arquivo >= 0 && ftruncate(fila->arquivo, 0) != 0)
+        fila->fim = 0;
+#endif
+}
+
+/**
+ * @brief Dobra a capacidade de um vetor circular, preservando a ordem.
+ *
+ * @param anel Fila circular de uma prioridade.
+ * @return true se a realocação funcionou, false caso contrário.
+ */
+static bool anel_crescer(ANEL *anel)
+{
+    int nova = anel->capacidade ? anel->capacidade * 2 : 8;
+    PACIENTE_ID *itens = (PACIENTE_ID *)heap_alocar(nova * sizeof(PACIENTE_ID));
+    if (itens == NULL) return false;
+
+    for (int i = 0; i < anel->quantidade; i++)
+        itens[i] = anel->itens[(anel->inicio + i) % anel->capacidade];
+
+    heap_liberar(anel->itens);
+    anel->itens = itens;
+    anel->inicio = 0;
+    anel->capacidade = nova;
+    return true;
+}
+
 /**
  * @brief Insere um paciente na fila conforme sua prioridade.
  *
@@ -61,11 +314,13 @@ FILA *fila_criar()
  * @return true se inserido com sucesso, false caso contrário.
  *
  * @note A verificação de duplicidade é realizada chamando
- * paciente_esta_na_fila(), conforme requisito do projeto.
+ * paciente_esta_na_fila(), conforme requisito do projeto. Com a memória da
+ * fila cheia, o paciente não é recusado: vai para o arquivo de excedentes.
  */
 bool fila_inserir(FILA *fila, PACIENTE *pac, int prioridade)
 {
-    if (fila == NULL || fila_cheia(fila)) return false;
+    if (fila == NULL || pac == NULL) return false;
+    if (prioridade < 0 || prioridade >= NUM_PRIORIDADES) return false;
 
     // Verificar duplicidade
     if (paciente_esta_na_fila(pac))
@@ -74,30 +329,92 @@ bool fila_inserir(FILA *fila, PACIENTE *pac, int prioridade)
         return false;
     }
 
-    NO *novo = (NO *)malloc(sizeof(NO));
-    if (novo == NULL) return false;
-
-    novo->pac = pac;
-    novo->prox = NULL;
-
-    // Inserção na fila da prioridade
-    if (fila->inicio[prioridade] == NULL)
+    // Atrás de excedentes, ou com a memória cheia, a entrada vai para o disco
+    ANEL *anel = &fila->niveis[prioridade];
+    if (fila->excedentes[prioridade].quantidade > 0 || (anel->quantidade > 0 && fila_cheia(fila)))
     {
-        fila->inicio[prioridade] = novo;
+        if (!excedente_anexar(fila, prioridade, paciente_obter_id(pac))) return false;
     }
     else
     {
-        fila->fim[prioridade]->prox = novo;
-    }
+        if (anel->quantidade == anel->capacidade && !anel_crescer(anel)) return false;
 
-    fila->fim[prioridade] = novo;
+        // Inserção no fim da fila da prioridade
+        anel->itens[(anel->inicio + anel->quantidade) % anel->capacidade] = paciente_obter_id(pac);
+        anel->quantidade++;
+    }
     fila->tamanho++;
 
-    paciente_ir_para_fila(pac);
+    paciente_ir_para_fila(pac, prioridade);
     
     return true;
 }
 
+/**
+ * @brief Traz de volta para o anel a cauda em disco de uma prioridade.
+ *
+ * Lê do trecho mais antigo tantos identificadores quantos cabem no limite de
+ * memória, e ao menos até o anel ter `minimo` entradas. O anel cresce antes
+ * da leitura, então uma falha não perde nenhum identificador: o que não
+ * voltou continua no disco.
+ *
+ * @param fila Ponteiro para a fila.
+ * @param prioridade Prioridade atendida (0 a 4).
+ * @param minimo Entradas que o anel precisa ter ao final, se houver excedentes.
+ * @return false se a leitura do arquivo ou o crescimento do anel falhou.
+ */
+static bool excedente_recarregar(FILA *fila, int prioridade, int minimo)
+{
+    ANEL *anel = &fila->niveis[prioridade];
+    EXCEDENTE *exc = &fila->excedentes[prioridade];
+
+    while (exc->quantidade > 0 && (anel->quantidade < minimo || !fila_cheia(fila)))
+    {
+        int espaco = fila->limite > 0 ? fila->limite - (fila->tamanho - fila->em_disco) : FILA_TRECHO;
+        if (espaco < 1) espaco = 1;
+
+        PACIENTE_ID ids[FILA_TRECHO];
+        TRECHO *trecho = exc->primeiro;
+        int n = trecho ? trecho->quantidade - trecho->lidos : exc->n_pendentes;
+        if (n > espaco) n = espaco;
+        while (anel->capacidade - anel->quantidade < n)
+            if (!anel_crescer(anel)) return false;
+
+        if (trecho)
+        {
+            if (!excedente_ler(fila, trecho->posicao + (uint64_t)trecho->lidos * sizeof(PACIENTE_ID), ids, n))
+                return false;
+            trecho->lidos += n;
+            if (trecho->lidos == trecho->quantidade)
+            {
+                exc->primeiro = trecho->proximo;
+                if (exc->primeiro == NULL) exc->ultimo = NULL;
+                free(trecho);
+            }
+        }
+        else
+        {
+            // Sem trechos gravados: a cauda inteira ainda está nos pendentes
+            memcpy(ids, exc->pendentes, (size_t)n * sizeof(PACIENTE_ID));
+            memmove(exc->pendentes, exc->pendentes + n, (size_t)(exc->n_pendentes - n) * sizeof(PACIENTE_ID));
+            exc->n_pendentes -= n;
+        }
+
+        for (int j = 0; j < n; j++)
+        {
+            anel->itens[(anel->inicio + anel->quantidade) % anel->capacidade] = ids[j];
+            anel->quantidade++;
+        }
+        exc->quantidade -= n;
+        fila->em_disco -= n;
+    }
+
+    // Todas as caudas voltaram: o arquivo recomeça vazio
+    if (fila->em_disco == 0 && fila->fim > 0)
+        excedente_esvaziar(fila);
+    return true;
+}
+
 /**
  * @brief Remove o paciente de maior prioridade (menor índice).
  *
@@ -108,25 +425,50 @@ bool fila_inserir(FILA *fila, PACIENTE *pac, int prioridade)
  * @note Entre pacientes da mesma prioridade, vale a ordem de chegada.
  */
 PACIENTE *fila_remover(FILA *fila)
+{
+    int prioridade;
+    return fila_remover_com_prioridade(fila, &prioridade);
+}
+
+/**
+ * @brief Remove o paciente de maior prioridade, informando a prioridade removida.
+ *
+ * Antes de retirar o último paciente do anel de uma prioridade com
+ * excedentes, o próximo é trazido do disco: se essa leitura falhar, nada é
+ * removido (o anel nunca fica vazio com excedentes) e a remoção pode ser
+ * tentada de novo.
+ *
+ * @param fila Ponteiro para a fila.
+ * @param prioridade Ponteiro onde será armazenada a prioridade removida (0 a 4).
+ *
+ * @return Paciente removido, ou NULL caso a fila esteja vazia ou os
+ * excedentes não possam ser lidos (com fila_vazia() falso).
+ */
+PACIENTE *fila_remover_com_prioridade(FILA *fila, int* prioridade)
 {
     if (fila == NULL || fila_vazia(fila)) return NULL;
 
     for (int i = 0; i < NUM_PRIORIDADES; i++)
     {
-        if (fila->inicio[i] != NULL)
+        ANEL *anel = &fila->niveis[i];
+        if (anel->quantidade > 0)
         {
-            NO *remover = fila->inicio[i];
-            PACIENTE *pac = remover->pac;
+            if (anel->quantidade == 1 && fila->excedentes[i].quantidade > 0 && !excedente_recarregar(fila, i, 2))
+                return NULL;
+
+            PACIENTE *pac = registro_paciente(anel->itens[anel->inicio]);
 
-            fila->inicio[i] = remover->prox;
-            
-            if (fila->inicio[i] == NULL)
-                fila->fim[i] = NULL;
+            *prioridade = i;
 
-            free(remover);
+            anel->inicio = (anel->inicio + 1) % anel->capacidade;
+            anel->quantidade--;
             fila->tamanho--;
             paciente_sair_da_fila(pac);
 
+            // Completa o anel até o limite de memória; uma falha aqui deixa o resto no disco
+            if (fila->excedentes[i].quantidade > 0)
+                excedente_recarregar(fila, i, 1);
+
             return pac;
         }
     }
@@ -134,43 +476,31 @@ PACIENTE *fila_remover(FILA *fila)
 }
 
 /**
- * @brief Remove o paciente de maior prioridade, informando a prioridade removida.
+ * @brief Consulta o paciente de maior prioridade sem removê-lo.
  *
  * @param fila Ponteiro para a fila.
- * @param prioridade Ponteiro onde será armazenada a prioridade removida (0 a 4).
  *
- * @return Paciente removido, ou NULL caso a fila esteja vazia.
+ * @return O próximo paciente a ser atendido, ou NULL se a fila estiver vazia.
  */
-PACIENTE *fila_remover_com_prioridade(FILA *fila, int* prioridade)
+PACIENTE *fila_frente(FILA *fila)
 {
     if (fila == NULL || fila_vazia(fila)) return NULL;
 
     for (int i = 0; i < NUM_PRIORIDADES; i++)
     {
-        if (fila->inicio[i] != NULL)
-        {
-            NO *remover = fila->inicio[i];
-            PACIENTE *pac = remover->pac;
-
-            *prioridade = i;
-
-            fila->inicio[i] = remover->prox;
-
-            if (fila->inicio[i] == NULL)
-                fila->fim[i] = NULL;
-
-            free(remover);
-            fila->tamanho--;
-            paciente_sair_da_fila(pac);
-
-            return pac;
-        }
+        ANEL *anel = &fila->niveis[i];
+        if (anel->quantidade > 0)
+            return registro_paciente(anel->itens[anel->inicio]);
     }
     return NULL;
 }
 
 /**
- * @brief Verifica se a fila está cheia.
+ * @brief Verifica se a memória da fila está cheia.
+ *
+ * Com a memória cheia, as próximas entradas vão para o arquivo de
+ * excedentes. No heap persistente (ver heap.c) a fila fica toda no heap,
+ * que já é um arquivo mapeado, e nunca é considerada cheia.
  *
  * @param fila Ponteiro para a fila.
  * @return true se cheia, false caso contrário.
@@ -178,10 +508,21 @@ PACIENTE *fila_remover_com_prioridade(FILA *fila, int* prioridade)
 bool fila_cheia(FILA *fila)
 {
     if (fila != NULL)
-        return (fila->tamanho >= TAM_MAX);
+        return fila->limite > 0 && !heap_ativo() && fila->tamanho - fila->em_disco >= fila->limite;
     return true;
 }
 
+/**
+ * @brief Quantidade de pacientes da fila guardados no arquivo de excedentes.
+ *
+ * @param fila Ponteiro para a fila.
+ * @return int Pacientes fora da memória.
+ */
+int fila_em_disco(FILA *fila)
+{
+    return fila != NULL ? fila->em_disco : 0;
+}
+
 /**
  * @brief Verifica se a fila está vazia.
  *
@@ -195,6 +536,74 @@ bool fila_vazia(FILA *fila)
     return true;
 }
 
+/**
+ * @brief Guarda os anéis da fila no heap persistente.
+ *
+ * @param fila Ponteiro para a fila.
+ * @return true se havia heap ativo.
+ */
+bool fila_persistir(FILA *fila)
+{
+    FILA_RAIZ *raiz = heap_raiz(HEAP_RAIZ_FILA);
+    if (fila == NULL || raiz == NULL) return false;
+
+    memset(raiz, 0, sizeof(FILA_RAIZ));
+    for (int i = 0; i < NUM_PRIORIDADES; i++)
+    {
+        ANEL *anel = &fila->niveis[i];
+        raiz->niveis[i].itens = heap_referencia(anel->itens);
+        raiz->niveis[i].inicio = anel->inicio;
+        raiz->niveis[i].quantidade = anel->quantidade;
+        raiz->niveis[i].capacidade = anel->capacidade;
+    }
+    raiz->tamanho = fila->tamanho;
+    return true;
+}
+
+/**
+ * @brief Retoma os anéis guardados por fila_persistir().
+ *
+ * @param fila Ponteiro para a fila (vazia).
+ * @return true se a fila foi retomada.
+ */
+bool fila_restaurar(FILA *fila)
+{
+    if (fila == NULL || heap_raiz(HEAP_RAIZ_FILA) == NULL || !fila_vazia(fila)) return false;
+
+    for (int i = 0; i < NUM_PRIORIDADES; i++)
+    {
+        heap_liberar(fila->niveis[i].itens);
+        fila->niveis[i].itens = NULL;
+    }
+    return fila_sincronizar(fila);
+}
+
+/**
+ * @brief Relê os anéis guardados no heap.
+ *
+ * No heap compartilhado, outro processo pode ter alterado a fila desde a
+ * última leitura; os anéis anteriores são os do heap e não são liberados.
+ *
+ * @param fila Ponteiro para a fila.
+ * @return true se havia heap ativo.
+ */
+bool fila_sincronizar(FILA *fila)
+{
+    FILA_RAIZ *raiz = heap_raiz(HEAP_RAIZ_FILA);
+    if (fila == NULL || raiz == NULL) return false;
+
+    for (int i = 0; i < NUM_PRIORIDADES; i++)
+    {
+        ANEL *anel = &fila->niveis[i];
+        anel->itens = heap_ponteiro(raiz->niveis[i].itens);
+        anel->inicio = raiz->niveis[i].inicio;
+        anel->quantidade = raiz->niveis[i].quantidade;
+        anel->capacidade = raiz->niveis[i].capacidade;
+    }
+    fila->tamanho = raiz->tamanho;
+    return true;
+}
+
 /**
  * @brief Libera toda a memória da fila e seus nós.
  *
@@ -207,20 +616,77 @@ void fila_apagar(FILA **fila)
     if (fila == NULL || *fila == NULL) return;
 
     for (int i = 0; i < NUM_PRIORIDADES; i++)
-    {
-        NO *atual = (*fila)->inicio[i];
-        while (atual != NULL)
-        {
-            NO *prox = atual->prox;
-            free(atual);
-            atual = prox;
-        }
-    }
+        heap_liberar((*fila)->niveis[i].itens);
+
+    excedente_esvaziar(*fila);
+#ifdef _WIN32
+    if ((*fila)->arquivo) fclose((*fila)->arquivo);
+#else
+    if ((*fila)->arquivo >= 0) close((*fila)->arquivo);
+#endif
 
     free(*fila);
     *fila = NULL;
 }
 
+/**
+ * @brief Percorre uma prioridade em ordem de chegada: o anel e depois a cauda em disco.
+ *
+ * @param fila Ponteiro para a fila.
+ * @param prioridade Prioridade percorrida (0 a 4).
+ * @param visitar Função chamada com cada identificador.
+ * @param contexto Parâmetro extra repassado à função.
+ * @return false se um trecho da cauda não pôde ser lido (o percurso para nele).
+ */
+static bool nivel_percorrer(FILA *fila, int prioridade, void (*visitar)(PACIENTE_ID, int, void *), void *contexto)
+{
+    ANEL *anel = &fila->niveis[prioridade];
+    for (int j = 0; j < anel->quantidade; j++)
+        visitar(anel->itens[(anel->inicio + j) % anel->capacidade], prioridade, contexto);
+
+    EXCEDENTE *exc = &fila->excedentes[prioridade];
+    PACIENTE_ID ids[FILA_TRECHO];
+    for (TRECHO *trecho = exc->primeiro; trecho; trecho = trecho->proximo)
+    {
+        int n = trecho->quantidade - trecho->lidos;
+        if (!excedente_ler(fila, trecho->posicao + (uint64_t)trecho->lidos * sizeof(PACIENTE_ID), ids, n))
+            return false;
+        for (int j = 0; j < n; j++)
+            visitar(ids[j], prioridade, contexto);
+    }
+    for (int j = 0; j < exc->n_pendentes; j++)
+        visitar(exc->pendentes[j], prioridade, contexto);
+    return true;
+}
+
+/**
+ * @brief Contexto de fila_imprimir().
+ */
+typedef struct impressao_
+{
+    int posicao_global; ///< Posição do próximo paciente na fila inteira
+    int prioridade;     ///< Prioridade do último cabeçalho impresso
+} IMPRESSAO;
+
+/**
+ * @brief Imprime um paciente da fila, com o cabeçalho da prioridade antes do primeiro.
+ */
+static void imprimir_item(PACIENTE_ID id, int prioridade, void *contexto)
+{
+    static const char *descricoes[NUM_PRIORIDADES] = {
+        "Emergência", "Muito Urgente", "Urgente", "Pouco Urgente", "Não Urgência"
+    };
+    IMPRESSAO *impressao = (IMPRESSAO *)contexto;
+
+    if (impressao->prioridade != prioridade)
+    {
+        printf("\n--- Prioridade %d: %s ---\n", prioridade + 1, descricoes[prioridade]);
+        impressao->prioridade = prioridade;
+    }
+    printf("%dº Geral | ", impressao->posicao_global++);
+    paciente_imprimir(registro_paciente(id));
+}
+
 /**
  * @brief Imprime todos os pacientes da fila em formato organizado.
  *
@@ -236,27 +702,52 @@ void fila_imprimir(FILA *fila)
         return;
     }
 
-    const char *descricoes[5] = {
-        "Emergência", "Muito Urgente", "Urgente", "Pouco Urgente", "Não Urgência"
-    };
-
     printf("\n=== FILA DE ESPERA (Por Prioridade) ===\n");
-    int posicao_global = 1;
+    if (fila->em_disco > 0)
+        printf("(%d paciente(s) no arquivo de excedentes)\n", fila->em_disco);
 
+    IMPRESSAO impressao = { 1, -1 };
     for (int i = 0; i < NUM_PRIORIDADES; i++)
-    {
-        if (fila->inicio[i] != NULL)
-        {
-            printf("\n--- Prioridade %d: %s ---\n", i + 1, descricoes[i]);
-            NO *atual = fila->inicio[i];
-            while (atual != NULL)
-            {
-                printf("%dº Geral | ", posicao_global++);
-                paciente_imprimir(atual->pac);
-                atual = atual->prox;
-            }
-        }
-    }
+        if (!nivel_percorrer(fila, i, imprimir_item, &impressao))
+            printf("(falha ao ler o arquivo de excedentes: a prioridade %d está incompleta)\n", i + 1);
 
     printf("=======================================\n");
 }
+
+/**
+ * @brief Contexto de fila_percorrer().
+ */
+typedef struct percurso_
+{
+    AcaoFila acao;  ///< Função do chamador
+    void *contexto; ///< Parâmetro do chamador
+} PERCURSO;
+
+/**
+ * @brief Repassa um identificador da fila, como paciente, à função do chamador.
+ */
+static void percorrer_item(PACIENTE_ID id, int prioridade, void *contexto)
+{
+    PERCURSO *percurso = (PERCURSO *)contexto;
+    percurso->acao(registro_paciente(id), prioridade, percurso->contexto);
+}
+
+/**
+ * @brief Percorre a fila por prioridade e ordem de chegada, sem removê-los.
+ *
+ * @param fila Ponteiro para a fila.
+ * @param acao Função executada para cada paciente.
+ * @param contexto Parâmetro extra repassado à função.
+ * @return false se parte da fila no arquivo de excedentes não pôde ser lida
+ * (o percurso para ali; quem grava a fila não deve considerá-la completa).
+ */
+bool fila_percorrer(FILA *fila, AcaoFila acao, void *contexto)
+{
+    if (fila == NULL || acao == NULL) return false;
+
+    PERCURSO percurso = { acao, contexto };
+    for (int i = 0; i < NUM_PRIORIDADES; i++)
+        if (!nivel_percorrer(fila, i, percorrer_item, &percurso))
+            return false;
+    return true;
+}
@@ -0,0 +1,578 @@
+/**
+ * @file heap.c
+ * @brief Heap persistente: as estruturas em memória vivem em um arquivo mapeado.
+ * @details Com PS_HEAP=1, os nós da LISTA, os pacientes (nome e histórico),
+ * os vetores do armazém central, os anéis da FILA e os bits do filtro de
+ * CPFs são alocados dentro de data/heap.bin, mapeado com `MAP_SHARED`. Ao
+ * encerrar depois de um SAVE completo, o heap é sincronizado com o disco e
+ * marcado como limpo; na próxima inicialização basta mapeá-lo e conferir o
+ * cabeçalho, sem LOAD: o tempo até o primeiro menu não depende da quantidade
+ * de pacientes (as páginas são lidas do disco no primeiro acesso).
+ *
+ * Os objetos dentro do heap se referenciam por posição (HEAP_REF) e não por
+ * endereço, de modo que o arquivo continua válido mapeado em qualquer
+ * endereço. Uma reserva grande de endereços é feita na abertura e o arquivo
+ * cresce dentro dela, então os endereços não mudam durante a execução.
+ *
+ * O alocador usa classes de tamanho (múltiplos de 16 bytes até 256, depois
+ * potências de 2), cada uma com uma lista de blocos livres guardada no
+ * cabeçalho; blocos novos saem do topo da área já usada. Cada bloco leva
+ * 8 bytes de cabeçalho com a classe. Um mutex protege o alocador, usado
+ * também pelas threads do LOAD paralelo (no modo compartilhado, o mutex do
+ * cabeçalho, visto por todos os processos).
+ *
+ * O heap é marcado como "não limpo" logo na abertura: se o processo cair, a
+ * próxima inicialização o descarta e carrega os arquivos de dados (mais o
+ * log de operações), como sem o heap. As raízes (ver heap_raiz()) e o resumo
+ * das chaves do arquivo da lista só valem num heap limpo.
+ *
+ * Com PS_COMPARTILHADO=1, vários processos do mesmo computador abrem o
+ * mesmo heap ao mesmo tempo e trabalham sobre uma única LISTA e FILA. O
+ * primeiro a abrir decide, como acima, entre retomar e recomeçar o heap; os
+ * seguintes o encontram em uso (HEAP_EM_USO). Dois mutexes entre processos
+ * (`PTHREAD_PROCESS_SHARED`, robustos à morte do dono) ficam no cabeçalho:
+ * um protege o alocador e o outro as estruturas (heap_travar()). Quem é o
+ * primeiro e o último processo é decidido por travas de `fcntl()` em dois
+ * bytes do arquivo, liberadas pelo sistema se o processo cair: a "porta"
+ * serializa aberturas e fechamentos, e cada processo com o heap aberto
+ * mantém uma trava compartilhada na "presença". Só o último a fechar pode
+ * marcar o heap como limpo.
+ *
+ * Sem heap ativo (ou no Windows, onde não há `mmap()`), heap_alocar() e
+ * companhia são malloc(), realloc() e free(), e HEAP_REF é o próprio endereço.
+ */
+
+#include "../include/heap.h"
+#include "../include/crc32c.h"
+#include <stddef.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define HEAP_MAGICA "PSHEAP02"              ///< Assinatura do arquivo do heap
+#define HEAP_VERSAO 2                       ///< Versão do layout do heap e das raízes
+#define HEAP_ORDEM_BYTES 0x01020304u        ///< Lido de volta igual só na mesma ordem de bytes
+#define HEAP_INICIO 4096                    ///< Posição do primeiro bloco (depois do cabeçalho)
+#define HEAP_TAM_INICIAL ((uint64_t)64 << 20)   ///< Tamanho do arquivo de um heap novo
+#define HEAP_RESERVA ((uint64_t)1 << 36)    ///< Endereços reservados para o mapeamento (64 GB)
+#define HEAP_CLASSES 48                     ///< Classes de tamanho dos blocos
+#define HEAP_CLASSES_PEQUENAS 16            ///< Classes de 16 em 16 bytes (até 256)
+#define HEAP_MARCA 0x50534842u              ///< Marca de bloco alocado pelo heap
+#define HEAP_BYTE_PORTA 0                   ///< Byte travado por quem está abrindo ou fechando o heap compartilhado
+#define HEAP_BYTE_PRESENCA 1                ///< Byte travado (compartilhado) por todo processo com o heap aberto
+
+/**
+ * @brief Cabeçalho do heap (início do arquivo).
+ */
+typedef struct heap_cabecalho_ {
+    char magica[8];                 ///< HEAP_MAGICA
+    uint32_t ordem_bytes;           ///< HEAP_ORDEM_BYTES
+    uint32_t versao;                ///< HEAP_VERSAO
+    uint64_t tamanho;               ///< Bytes do arquivo
+    uint64_t topo;                  ///< Início da área ainda não alocada
+    uint64_t assinatura;            ///< Resumo das chaves do arquivo da lista correspondente
+    uint32_t limpo;                 ///< 1 se fechado com as raízes consistentes
+    uint32_t reservado;             ///< Zero
+    HEAP_REF livres[HEAP_CLASSES];  ///< Primeiro bloco livre de cada classe
+    unsigned char raizes[HEAP_RAIZES][HEAP_TAM_RAIZ]; ///< Raízes das estruturas (ver heap_raiz())
+    uint32_t crc;                   ///< CRC32C dos bytes anteriores do cabeçalho
+#ifndef _WIN32
+    pthread_mutex_t alocador;       ///< Alocador, entre processos (modo compartilhado)
+    pthread_mutex_t estruturas;     ///< LISTA, FILA e armazém, entre processos (ver heap_travar())
+#endif
+} HEAP_CABECALHO;
+
+_Static_assert(sizeof(HEAP_CABECALHO) <= HEAP_INICIO, "cabeçalho do heap deve caber antes do primeiro bloco");
+
+/**
+ * @brief Cabeçalho de cada bloco; os dados vêm logo depois.
+ * @details Num bloco livre, os primeiros 8 bytes dos dados são a posição do
+ * próximo bloco livre da mesma classe.
+ */
+typedef struct heap_bloco_ {
+    uint32_t classe;    ///< Classe de tamanho
+    uint32_t marca;     ///< HEAP_MARCA
+} HEAP_BLOCO;
+
+uintptr_t heap_origem = 0;
+
+#ifndef _WIN32
+
+/**
+ * @struct heap_
+ * @brief Estado do heap aberto.
+ */
+typedef struct heap_ {
+    int fd;                 /**< Arquivo do heap. */
+    char* base;             /**< Início do mapeamento. */
+    HEAP_CABECALHO* cab;    /**< Cabeçalho, no início do mapeamento. */
+    pthread_mutex_t trava;  /**< Protege o alocador de um único processo. */
+    pthread_mutex_t* alocador; /**< trava, ou o mutex do cabeçalho no modo compartilhado. */
+    bool compartilhado;     /**< Aberto com outros processos (PS_COMPARTILHADO). */
+    bool ultimo;            /**< Porta travada e nenhum outro processo com o heap aberto. */
+} HEAP;
+
+static HEAP heap = { -1, NULL, NULL, PTHREAD_MUTEX_INITIALIZER, NULL, false, false };
+
+/**
+ * @brief Tamanho total (com o cabeçalho) dos blocos de uma classe.
+ */
+static uint64_t heap_tamanho_classe(uint32_t classe){
+    if (classe < HEAP_CLASSES_PEQUENAS)
+        return 16 * (uint64_t)(classe + 1);
+    return (uint64_t)512 << (classe - HEAP_CLASSES_PEQUENAS);
+}
+
+/**
+ * @brief Menor classe cujos blocos comportam `tamanho` bytes de dados.
+ * @return uint32_t Classe, ou HEAP_CLASSES se o tamanho for grande demais.
+ */
+static uint32_t heap_classe(size_t tamanho){
+    uint64_t total = (uint64_t)tamanho + sizeof(HEAP_BLOCO);
+    if (total <= 16 * HEAP_CLASSES_PEQUENAS)
+        return (uint32_t)((total + 15) / 16 - 1);
+
+    uint32_t classe = HEAP_CLASSES_PEQUENAS;
+    while (classe < HEAP_CLASSES && heap_tamanho_classe(classe) < total)
+        classe++;
+    return classe;
+}
+
+/**
+ * @brief CRC32C do cabeçalho (sem o próprio campo).
+ */
+static uint32_t heap_crc(const HEAP_CABECALHO* cab){
+    return crc32c_calcular(0, cab, offsetof(HEAP_CABECALHO, crc));
+}
+
+/**
+ * @brief Confere se o cabeçalho descreve um heap fechado corretamente.
+ * @param tamanho Tamanho atual do arquivo.
+ */
+static bool heap_valido(const HEAP_CABECALHO* cab, uint64_t tamanho){
+    return memcmp(cab->magica, HEAP_MAGICA, sizeof(cab->magica)) == 0 &&
+           cab->ordem_bytes == HEAP_ORDEM_BYTES && cab->versao == HEAP_VERSAO &&
+           cab->limpo == 1 && cab->tamanho == tamanho &&
+           cab->topo >= HEAP_INICIO && cab->topo <= cab->tamanho &&
+           heap_crc(cab) == cab->crc;
+}
+
+/**
+ * @brief Escreve o cabeçalho de um heap vazio (o tamanho do arquivo é mantido).
+ */
+static void heap_iniciar(uint64_t tamanho){
+    // Os mutexes ficam de fora: podem estar travados por este processo
+    memset(heap.cab, 0, offsetof(HEAP_CABECALHO, crc) + sizeof(heap.cab->crc));
+    memcpy(heap.cab->magica, HEAP_MAGICA, sizeof(heap.cab->magica));
+    heap.cab->ordem_bytes = HEAP_ORDEM_BYTES;
+    heap.cab->versao = HEAP_VERSAO;
+    heap.cab->tamanho = tamanho;
+    heap.cab->topo = HEAP_INICIO;
+}
+
+/**
+ * @brief Trava ou libera um byte do arquivo do heap com `fcntl()`.
+ * @param byte HEAP_BYTE_PORTA ou HEAP_BYTE_PRESENCA.
+ * @param tipo F_WRLCK, F_RDLCK ou F_UNLCK.
+ * @param esperar true para esperar a trava ficar disponível.
+ * @return true se a trava foi obtida (ou liberada).
+ */
+static bool heap_travar_byte(int fd, off_t byte, short tipo, bool esperar){
+    struct flock trava;
+    memset(&trava, 0, sizeof(trava));
+    trava.l_type = tipo;
+    trava.l_whence = SEEK_SET;
+    trava.l_start = byte;
+    trava.l_len = 1;
+
+    int r;
+    do {
+        r = fcntl(fd, esperar ? F_SETLKW : F_SETLK, &trava);
+    } while (r != 0 && errno == EINTR);
+    return r == 0;
+}
+
+/**
+ * @brief Inicia um mutex entre processos, robusto à morte do dono.
+ */
+static bool heap_iniciar_mutex(pthread_mutex_t* mutex){
+    pthread_mutexattr_t atributos;
+    if (pthread_mutexattr_init(&atributos) != 0)
+        return false;
+    bool ok = pthread_mutexattr_setpshared(&atributos, PTHREAD_PROCESS_SHARED) == 0 &&
+              pthread_mutexattr_setrobust(&atributos, PTHREAD_MUTEX_ROBUST) == 0 &&
+              pthread_mutex_init(mutex, &atributos) == 0;
+    pthread_mutexattr_destroy(&atributos);
+    return ok;
+}
+
+/**
+ * @brief Trava um mutex do heap.
+ * @return false se o dono anterior morreu com ele travado (a trava é
+ * retomada, mas o que ele protegia pode ter ficado pela metade).
+ */
+static bool heap_travar_mutex(pthread_mutex_t* mutex){
+    int r = pthread_mutex_lock(mutex);
+    if (r == EOWNERDEAD){
+        pthread_mutex_consistent(mutex);
+        return false;
+    }
+    return r == 0;
+}
+
+/**
+ * @brief Abre (ou cria) o heap persistente e o torna a origem das alocações.
+ * @details Um heap limpo é reaproveitado; qualquer outro conteúdo é
+ * descartado. Antes de retornar, o heap é marcado como não limpo no disco.
+ *
+ * No modo compartilhado, só o primeiro processo faz isso; os demais usam o
+ * heap como está. Em ambos os casos a função retorna com as estruturas
+ * travadas (ver heap_travar()), para que ninguém as veja antes de o LOAD ou
+ * a retomada terminar: o chamador libera com heap_destravar().
+ * @param caminho Arquivo do heap.
+ * @param compartilhado true para abrir junto com outros processos (PS_COMPARTILHADO).
+ * @return HEAP_ESTADO HEAP_RESTAURADO se as raízes da última execução
+ * valem, HEAP_NOVO se o heap está vazio, HEAP_EM_USO se outro processo já o
+ * tem aberto (as raízes são as atuais), HEAP_DESATIVADO se não foi possível
+ * abri-lo (as alocações continuam no malloc).
+ */
+HEAP_ESTADO heap_abrir(const char* caminho, bool compartilhado){
+    if (heap.base != NULL || caminho == NULL)
+        return HEAP_DESATIVADO;
+
+    int fd = open(caminho, O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+        return HEAP_DESATIVADO;
+
+    // Nenhum outro processo abre nem fecha o heap até a porta ser liberada
+    bool primeiro = true;
+    if (compartilhado){
+        if (!heap_travar_byte(fd, HEAP_BYTE_PORTA, F_WRLCK, true)){
+            close(fd);
+            return HEAP_DESATIVADO;
+        }
+        primeiro = heap_travar_byte(fd, HEAP_BYTE_PRESENCA, F_WRLCK, false);
+    }
+
+    struct stat st;
+    void* base = MAP_FAILED;
+    if (fstat(fd, &st) == 0)
+        base = mmap(NULL, HEAP_RESERVA, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_NORESERVE, fd, 0);
+    if (base == MAP_FAILED){
+        close(fd); // Libera também as travas de fcntl()
+        return HEAP_DESATIVADO;
+    }
+
+    heap.fd = fd;
+    heap.base = base;
+    heap.cab = (HEAP_CABECALHO*)base;
+    heap.alocador = &heap.trava;
+    heap.compartilhado = compartilhado;
+    heap.ultimo = false;
+
+    HEAP_ESTADO estado = HEAP_RESTAURADO;
+    uint64_t tamanho = (uint64_t)st.st_size;
+    if (!primeiro){
+        estado = HEAP_EM_USO;
+        if (tamanho < HEAP_INICIO || memcmp(heap.cab->magica, HEAP_MAGICA, sizeof(heap.cab->magica)) != 0 ||
+            heap.cab->versao != HEAP_VERSAO)
+            estado = HEAP_DESATIVADO;
+    }
+    else if (tamanho < HEAP_INICIO || !heap_valido(heap.cab, tamanho)){
+        // Zera o conteúdo anterior e deixa o arquivo esparso
+        if (ftruncate(fd, 0) != 0 || ftruncate(fd, (off_t)HEAP_TAM_INICIAL) != 0)
+            estado = HEAP_DESATIVADO;
+        else {
+            heap_iniciar(HEAP_TAM_INICIAL);
+            estado = HEAP_NOVO;
+        }
+    }
+
+    if (estado != HEAP_DESATIVADO && primeiro){
+        heap.cab->limpo = 0;
+        heap.cab->crc = heap_crc(heap.cab);
+        msync(heap.base, HEAP_INICIO, MS_SYNC);
+
+        // Os mutexes de uma execução anterior podem ter ficado travados
+        if (compartilhado && (!heap_iniciar_mutex(&heap.cab->alocador) || !heap_iniciar_mutex(&heap.cab->estruturas)))
+            estado = HEAP_DESATIVADO;
+    }
+
+    if (estado == HEAP_DESATIVADO){
+        munmap(base, HEAP_RESERVA);
+        close(fd);
+        heap.fd = -1;
+        heap.base = NULL;
+        heap.cab = NULL;
+        heap.compartilhado = false;
+        return HEAP_DESATIVADO;
+    }
+
+    heap_origem = (uintptr_t)base;
+    if (compartilhado){
+        heap.alocador = &heap.cab->alocador;
+        heap_travar_mutex(&heap.cab->estruturas);
+        // Converte a presença exclusiva do primeiro em compartilhada
+        heap_travar_byte(fd, HEAP_BYTE_PRESENCA, F_RDLCK, true);
+        heap_travar_byte(fd, HEAP_BYTE_PORTA, F_UNLCK, false);
+    }
+    return estado;
+}
+
+/**
+ * @brief Indica se o heap foi aberto junto com outros processos (PS_COMPARTILHADO).
+ */
+bool heap_compartilhado(void){
+    return heap.base != NULL && heap.compartilhado;
+}
+
+/**
+ * @brief Trava as estruturas do heap compartilhado contra os outros processos.
+ * @details Entre heap_travar() e heap_destravar() o processo pode ler e
+ * alterar a LISTA, a FILA e o armazém; antes, precisa reler as raízes, que
+ * outro processo pode ter mudado. Sem o modo compartilhado, não faz nada.
+ * @return false se o processo que tinha a trava morreu com ela: as
+ * estruturas podem ter ficado no meio de uma alteração.
+ */
+bool heap_travar(void){
+    if (!heap_compartilhado())
+        return true;
+    return heap_travar_mutex(&heap.cab->estruturas);
+}
+
+/**
+ * @brief Libera as estruturas travadas por heap_travar() ou heap_abrir().
+ * @note As raízes precisam ter sido gravadas antes.
+ */
+void heap_destravar(void){
+    if (heap_compartilhado())
+        pthread_mutex_unlock(&heap.cab->estruturas);
+}
+
+/**
+ * @brief Indica se este é o último processo com o heap aberto.
+ * @details No modo compartilhado, trava a porta até heap_fechar(): nenhum
+ * processo abre o heap enquanto o último grava o SAVE de encerramento. Se
+ * outros continuam com o heap aberto, este deixa de contar como presente e
+ * não pode mais alterar as estruturas. Sem o modo compartilhado, é sempre
+ * o último.
+ * @return true se o SAVE de encerramento e heap_fechar() cabem a este processo.
+ */
+bool heap_ultimo(void){
+    if (!heap_compartilhado() || heap.ultimo)
+        return true;
+
+    heap_travar_byte(heap.fd, HEAP_BYTE_PORTA, F_WRLCK, true);
+    heap.ultimo = heap_travar_byte(heap.fd, HEAP_BYTE_PRESENCA, F_WRLCK, false);
+    if (!heap.ultimo){
+        heap_travar_byte(heap.fd, HEAP_BYTE_PRESENCA, F_UNLCK, false);
+        heap_travar_byte(heap.fd, HEAP_BYTE_PORTA, F_UNLCK, false);
+    }
+    return heap.ultimo;
+}
+
+/**
+ * @brief Indica se as alocações estão indo para o heap persistente.
+ */
+bool heap_ativo(void){
+    return heap.base != NULL;
+}
+
+/**
+ * @brief Descarta todo o conteúdo do heap aberto (as raízes deixam de valer).
+ * @details Usada quando o heap restaurado não corresponde aos arquivos de
+ * dados; nada alocado antes pode continuar em uso.
+ */
+void heap_recomecar(void){
+    if (heap.base != NULL)
+        heap_iniciar(heap.cab->tamanho);
+}
+
+/**
+ * @brief Resumo das chaves do arquivo da lista gravado com o heap (ver heap_fechar()).
+ * @return uint64_t Resumo, ou 0 sem heap ativo.
+ */
+uint64_t heap_assinatura(void){
+    return heap.base != NULL ? heap.cab->assinatura : 0;
+}
+
+/**
+ * @brief Área de HEAP_TAM_RAIZ bytes onde uma estrutura guarda sua raiz.
+ * @details Cada módulo grava ali as posições (HEAP_REF) e os contadores
+ * necessários para se reconstruir sem percorrer o heap.
+ * @param raiz HEAP_RAIZ_*.
+ * @return void* Área da raiz, ou NULL sem heap ativo.
+ */
+void* heap_raiz(int raiz){
+    if (heap.base == NULL || raiz < 0 || raiz >= HEAP_RAIZES)
+        return NULL;
+    return heap.cab->raizes[raiz];
+}
+
+/**
+ * @brief Fecha o heap; se consistente, sincroniza tudo e o marca como limpo.
+ * @details O conteúdo é sincronizado antes de o cabeçalho ser marcado, de
+ * modo que uma queda entre os dois passos deixa o heap não limpo. No modo
+ * compartilhado, só o último processo (ver heap_ultimo()) o marca. Depois
+ * desta chamada nenhum objeto do heap pode ser usado.
+ * @param consistente As raízes foram gravadas e os arquivos de dados
+ * correspondem ao heap (SAVE concluído).
+ * @param assinatura Resumo das chaves do arquivo da lista.
+ * @return true se o heap foi marcado como limpo.
+ */
+bool heap_fechar(bool consistente, uint64_t assinatura){
+    if (heap.base == NULL)
+        return false;
+
+    // Com outros processos usando o heap, ele continua não limpo
+    bool limpo = false;
+    if (consistente && heap_ultimo()){
+        heap.cab->assinatura = assinatura;
+        if (msync(heap.base, heap.cab->topo, MS_SYNC) == 0){
+            heap.cab->limpo = 1;
+            heap.cab->crc = heap_crc(heap.cab);
+            limpo = msync(heap.base, HEAP_INICIO, MS_SYNC) == 0;
+        }
+    }
+
+    munmap(heap.base, HEAP_RESERVA);
+    close(heap.fd); // Libera também as travas de fcntl()
+    heap.fd = -1;
+    heap.base = NULL;
+    heap.cab = NULL;
+    heap.alocador = NULL;
+    heap.compartilhado = false;
+    heap.ultimo = false;
+    heap_origem = 0;
+    return limpo;
+}
+
+/**
+ * @brief Cabeçalho do bloco que contém os dados em `ponteiro`, se estiver no heap.
+ */
+static HEAP_BLOCO* heap_bloco(void* ponteiro){
+    char* p = (char*)ponteiro;
+    if (heap.base == NULL || p < heap.base + HEAP_INICIO + sizeof(HEAP_BLOCO) || p >= heap.base + heap.cab->topo)
+        return NULL;
+    return (HEAP_BLOCO*)(p - sizeof(HEAP_BLOCO));
+}
+
+/**
+ * @brief Aloca memória no heap persistente (ou no malloc, sem heap ativo).
+ * @param tamanho Bytes.
+ * @return void* Memória alinhada a 8 bytes, ou NULL se faltar espaço.
+ */
+void* heap_alocar(size_t tamanho){
+    if (heap.base == NULL)
+        return malloc(tamanho);
+
+    uint32_t classe = heap_classe(tamanho);
+    if (classe >= HEAP_CLASSES)
+        return NULL;
+
+    heap_travar_mutex(heap.alocador);
+
+    HEAP_CABECALHO* cab = heap.cab;
+    HEAP_REF ref = cab->livres[classe];
+    if (ref != 0){
+        cab->livres[classe] = *(HEAP_REF*)(heap.base + ref + sizeof(HEAP_BLOCO));
+    } else {
+        uint64_t necessario = cab->topo + heap_tamanho_classe(classe);
+        if (necessario > cab->tamanho){
+            uint64_t novo = cab->tamanho;
+            while (novo < necessario)
+                novo *= 2;
+            if (novo > HEAP_RESERVA)
+                novo = HEAP_RESERVA;
+            if (necessario > novo || ftruncate(heap.fd, (off_t)novo) != 0){
+                pthread_mutex_unlock(heap.alocador);
+                return NULL;
+            }
+            cab->tamanho = novo;
+        }
+        ref = cab->topo;
+        cab->topo = necessario;
+    }
+
+    pthread_mutex_unlock(heap.alocador);
+
+    HEAP_BLOCO* bloco = (HEAP_BLOCO*)(heap.base + ref);
+    bloco->classe = classe;
+    bloco->marca = HEAP_MARCA;
+    return bloco + 1;
+}
+
+/**
+ * @brief Devolve memória obtida com heap_alocar() ou heap_realocar().
+ * @details Memória fora do heap (alocada antes de ele ser aberto) vai para o
+ * free(). Um bloco com cabeçalho inválido é abandonado.
+ * @param ponteiro Memória a liberar (NULL é ignorado).
+ */
+void heap_liberar(void* ponteiro){
+    if (ponteiro == NULL)
+        return;
+
+    HEAP_BLOCO* bloco = heap_bloco(ponteiro);
+    if (bloco == NULL){
+        free(ponteiro);
+        return;
+    }
+    if (bloco->marca != HEAP_MARCA || bloco->classe >= HEAP_CLASSES)
+        return;
+
+    heap_travar_mutex(heap.alocador);
+    bloco->marca = 0;
+    *(HEAP_REF*)ponteiro = heap.cab->livres[bloco->classe];
+    heap.cab->livres[bloco->classe] = (HEAP_REF)((char*)bloco - heap.base);
+    pthread_mutex_unlock(heap.alocador);
+}
+
+/**
+ * @brief Muda o tamanho de memória obtida com heap_alocar(), preservando o conteúdo.
+ * @param ponteiro Memória atual (NULL = nova alocação).
+ * @param tamanho Novo tamanho em bytes.
+ * @return void* Nova memória, ou NULL (a anterior continua válida) se faltar espaço.
+ */
+void* heap_realocar(void* ponteiro, size_t tamanho){
+    if (ponteiro == NULL)
+        return heap_alocar(tamanho);
+
+    HEAP_BLOCO* bloco = heap_bloco(ponteiro);
+    if (bloco == NULL)
+        return realloc(ponteiro, tamanho);
+
+    uint64_t capacidade = heap_tamanho_classe(bloco->classe) - sizeof(HEAP_BLOCO);
+    if (tamanho <= capacidade)
+        return ponteiro;
+
+    void* novo = heap_alocar(tamanho);
+    if (novo != NULL){
+        memcpy(novo, ponteiro, capacidade);
+        heap_liberar(ponteiro);
+    }
+    return novo;
+}
+
+#else
+
+HEAP_ESTADO heap_abrir(const char* caminho, bool compartilhado){ (void)caminho; (void)compartilhado; return HEAP_DESATIVADO; }
+bool heap_ativo(void){ return false; }
+bool heap_compartilhado(void){ return false; }
+bool heap_travar(void){ return true; }
+void heap_destravar(void){}
+bool heap_ultimo(void){ return true; }
+void heap_recomecar(void){}
+uint64_t heap_assinatura(void){ return 0; }
+void* heap_raiz(int raiz){ (void)raiz; return NULL; }
+bool heap_fechar(bool consistente, uint64_t assinatura){ (void)consistente; (void)assinatura; return false; }
+void* heap_alocar(size_t tamanho){ return malloc(tamanho); }
+void* heap_realocar(void* ponteiro, size_t tamanho){ return realloc(ponteiro, tamanho); }
+void heap_liberar(void* ponteiro){ free(ponteiro); }
+
+#endif
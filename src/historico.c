@@ -2,11 +2,22 @@
  * @file historico.c
  * @brief Implementação de um histórico de ações (Log).
  * @details Esta estrutura funciona como uma Pilha (Stack) de capacidade fixa (10 itens).
- * Armazena strings de até 100 caracteres. Quando cheia, não aceita novos itens até que
- * algum seja removido.
+ * Cada item é o código de 32 bits de um procedimento no catálogo global
+ * (ver catalogo.c); a descrição (até 99 caracteres) é internada uma única vez
+ * e compartilhada por todos os pacientes. Quando cheia, não aceita novos itens
+ * até que algum seja removido.
+ *
+ * Descrições que ainda não são recorrentes (ver catalogo_recorrente()) ficam
+ * no próprio histórico: o item é HISTORICO_TEXTO_PROPRIO | posição do texto
+ * num vetor do paciente, onde cada texto ocupa seu tamanho com '\0'
+ * arredondado para múltiplo de 4. Como a pilha só cresce e diminui pelo topo,
+ * os textos ficam na mesma ordem dos itens e remover o topo só recua o fim
+ * do vetor.
  */
 
 #include "../include/historico.h"
+#include "../include/catalogo.h"
+#include "../include/heap.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -16,18 +27,29 @@
  * @brief Estrutura opaca que representa o histórico.
  */
 struct historico_{
-    char hist[10][100]; /**< Matriz estática armazenando até 10 strings de 100 chars. */
-    int tamanho;        /**< Contador de quantos elementos estão atualmente no histórico. */
+    uint32_t hist[HISTORICO_MAX]; /**< Códigos dos procedimentos no catálogo (base → topo). */
+    int tamanho;                  /**< Contador de quantos elementos estão atualmente no histórico. */
+    uint32_t rodape;              /**< HISTORICO_TEXTO_PROPRIO | bytes usados em textos, ou 0 sem descrições próprias. */
+    HEAP_REF textos;              /**< Posição do vetor de descrições próprias (ver heap.h). */
 };
 
+/**
+ * @brief Descrição própria na posição dada do vetor de textos.
+ */
+static inline char* historico_texto_proprio(const HISTORICO* hist, uint32_t posicao){
+    return (char*)heap_ponteiro(hist->textos) + posicao;
+}
+
 /**
  * @brief Cria uma nova instância de histórico.
  * @return HISTORICO* Ponteiro para a estrutura alocada ou NULL se falhar.
  */
 HISTORICO* historico_criar(void){
-    HISTORICO* hist = (HISTORICO*)malloc(sizeof(HISTORICO));
+    HISTORICO* hist = (HISTORICO*)heap_alocar(sizeof(HISTORICO));
     if (hist != NULL){
         hist->tamanho = 0;
+        hist->rodape = 0;
+        hist->textos = 0;
     }
 
     return hist;
@@ -54,7 +76,7 @@ int historico_tamanho(HISTORICO* hist){
  */
 bool historico_cheio(HISTORICO* hist){
     if (hist != NULL){
-        return hist->tamanho == 10;
+        return hist->tamanho == HISTORICO_MAX;
     }
 
     return false;
@@ -74,19 +96,78 @@ bool historico_vazio(HISTORICO* hist){
     return true;
 }
 
+/**
+ * @brief Adiciona um procedimento já catalogado ao topo do histórico.
+ * @param hist Ponteiro para o histórico.
+ * @param codigo Código do procedimento no catálogo.
+ * @return true Se inserido com sucesso.
+ * @return false Se o histórico estiver cheio, inválido ou o código não existir.
+ */
+bool historico_inserir_codigo(HISTORICO* hist, uint32_t codigo){
+    if (hist != NULL && !historico_cheio(hist) && catalogo_texto(codigo) != NULL){
+        hist->hist[hist->tamanho] = codigo;
+        hist->tamanho++;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Adiciona uma descrição própria do paciente ao topo do histórico, fora do catálogo.
+ * @details A descrição é truncada em 99 caracteres e copiada para o vetor de
+ * textos do histórico.
+ * @param hist Ponteiro para o histórico.
+ * @param texto Descrição do procedimento.
+ * @return true Se inserido com sucesso.
+ * @return false Se o histórico estiver cheio, inválido ou faltar memória.
+ */
+bool historico_inserir_proprio(HISTORICO* hist, const char* texto){
+    if (hist == NULL || texto == NULL || historico_cheio(hist)){
+        return false;
+    }
+
+    size_t tamanho = strnlen(texto, HISTORICO_TAM_TEXTO - 1);
+    uint32_t posicao = hist->rodape & ~HISTORICO_TEXTO_PROPRIO;
+    uint32_t ocupado = (uint32_t)(tamanho + 1 + 3) & ~3u;
+
+    char* textos = (char*)heap_realocar(heap_ponteiro(hist->textos), posicao + ocupado);
+    if (textos == NULL){
+        return false;
+    }
+    hist->textos = heap_referencia(textos);
+
+    // O preenchimento até o múltiplo de 4 fica zerado, como vai para o disco
+    memcpy(textos + posicao, texto, tamanho);
+    memset(textos + posicao + tamanho, 0, ocupado - tamanho);
+
+    hist->hist[hist->tamanho] = HISTORICO_TEXTO_PROPRIO | posicao;
+    hist->tamanho++;
+    hist->rodape = HISTORICO_TEXTO_PROPRIO | (posicao + ocupado);
+    return true;
+}
+
 /**
  * @brief Adiciona uma nova string ao topo do histórico.
- * @details Realiza uma cópia da string passada para a matriz interna.
+ * @details A descrição é truncada em 99 caracteres. Se for recorrente (ver
+ * catalogo_recorrente()) o histórico guarda apenas o código do catálogo;
+ * senão, guarda o próprio texto (ver historico_inserir_proprio()).
  * @param hist Ponteiro para o histórico.
- * @param texto String a ser armazenada (deve ter no máx 99 chars + \0).
+ * @param texto String a ser armazenada.
  * @return true Se inserido com sucesso.
  * @return false Se o histórico estiver cheio ou inválido.
  */
 bool historico_inserir(HISTORICO* hist, char texto[]){
-    if (hist != NULL && !historico_cheio(hist)){
-        strcpy(hist->hist[hist->tamanho], texto);
-        hist->tamanho++;
-        return true;
+    if (hist != NULL && texto != NULL && !historico_cheio(hist)){
+        char descricao[HISTORICO_TAM_TEXTO];
+        strncpy(descricao, texto, HISTORICO_TAM_TEXTO - 1);
+        descricao[HISTORICO_TAM_TEXTO - 1] = '\0';
+
+        uint32_t codigo = catalogo_recorrente(descricao);
+        if (codigo == CATALOGO_CODIGO_INVALIDO){
+            return historico_inserir_proprio(hist, descricao);
+        }
+        return historico_inserir_codigo(hist, codigo);
     }
 
     return false;
@@ -94,31 +175,130 @@ bool historico_inserir(HISTORICO* hist, char texto[]){
 
 /**
  * @brief Remove a última entrada adicionada ao histórico (comportamento LIFO).
+ * @details Uma descrição própria não é apagada, só deixa de ser usada: o
+ * texto devolvido continua válido até a próxima inserção.
  * @param hist Ponteiro para o histórico.
- * @return char* Ponteiro para a string que acabou de ser "removida" (ainda reside na memória interna).
+ * @return char* Descrição do procedimento removido (pertence ao catálogo ou ao histórico, não deve ser liberada).
  * @return NULL Se o histórico estiver vazio.
  */
 char* historico_remover(HISTORICO* hist){
     if (hist != NULL && !historico_vazio(hist)){
-        hist->tamanho--;
-        return hist->hist[hist->tamanho];
+        char* descricao = (char*)historico_descricao(hist, hist->tamanho - 1);
+        uint32_t codigo = hist->hist[--hist->tamanho];
+
+        if (codigo & HISTORICO_TEXTO_PROPRIO){
+            uint32_t posicao = codigo & ~HISTORICO_TEXTO_PROPRIO;
+            hist->rodape = posicao > 0 ? HISTORICO_TEXTO_PROPRIO | posicao : 0;
+        }
+        return descricao;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Obtém o código do i-ésimo procedimento (0 = base da pilha) sem removê-lo.
+ * @param hist Ponteiro para o histórico.
+ * @param i Posição do procedimento.
+ * @return uint32_t Código do procedimento ou CATALOGO_CODIGO_INVALIDO se a posição não existir.
+ */
+uint32_t historico_obter_codigo(HISTORICO* hist, int i){
+    if (hist != NULL && i >= 0 && i < hist->tamanho){
+        return hist->hist[i];
+    }
+
+    return CATALOGO_CODIGO_INVALIDO;
+}
+
+/**
+ * @brief Obtém a descrição do i-ésimo procedimento (0 = base da pilha), do catálogo ou própria.
+ * @param hist Ponteiro para o histórico.
+ * @param i Posição do procedimento.
+ * @return const char* Descrição ou NULL se a posição não existir.
+ */
+const char* historico_descricao(HISTORICO* hist, int i){
+    uint32_t codigo = historico_obter_codigo(hist, i);
+    if (codigo & HISTORICO_TEXTO_PROPRIO){
+        return historico_texto_proprio(hist, codigo & ~HISTORICO_TEXTO_PROPRIO);
+    }
+
+    return catalogo_texto(codigo);
+}
+
+/**
+ * @brief Expõe o vetor interno de códigos, da base para o topo, sem copiá-lo.
+ * @details Usado pela serialização em segmentos; o ponteiro só é válido enquanto
+ * o histórico não for modificado ou apagado. Códigos com HISTORICO_TEXTO_PROPRIO
+ * apontam para o vetor de historico_textos().
+ * @param hist Ponteiro para o histórico.
+ * @return const uint32_t* Vetor com historico_tamanho() códigos ou NULL se hist for NULL.
+ */
+const uint32_t* historico_codigos(HISTORICO* hist){
+    if (hist != NULL){
+        return hist->hist;
     }
 
     return NULL;
 }
 
+/**
+ * @brief Expõe o vetor de descrições próprias, sem copiá-lo.
+ * @details Os textos em uso, cada um terminado em '\0' e preenchido com zeros
+ * até múltiplo de 4. Mesmas regras de validade de historico_codigos().
+ * @param hist Ponteiro para o histórico.
+ * @param tamanho Recebe a quantidade de bytes em uso.
+ * @return const char* Vetor de textos ou NULL se não houver descrições próprias.
+ */
+const char* historico_textos(HISTORICO* hist, uint32_t* tamanho){
+    if (hist == NULL || hist->rodape == 0){
+        return NULL;
+    }
+
+    *tamanho = hist->rodape & ~HISTORICO_TEXTO_PROPRIO;
+    return historico_texto_proprio(hist, 0);
+}
+
+/**
+ * @brief Rodapé gravado depois de historico_textos().
+ * @details HISTORICO_TEXTO_PROPRIO | tamanho do vetor de textos. Nenhum código
+ * do catálogo tem esse bit, então o último inteiro de um registro diz se ele
+ * termina em descrições próprias.
+ * @param hist Ponteiro para o histórico.
+ * @return const uint32_t* Rodapé ou NULL se não houver descrições próprias.
+ */
+const uint32_t* historico_rodape(HISTORICO* hist){
+    if (hist == NULL || hist->rodape == 0){
+        return NULL;
+    }
+
+    return &hist->rodape;
+}
+
 /**
  * @brief Verifica se uma determinada string existe no histórico.
- * @details Realiza uma busca linear.
+ * @details A string é truncada em 99 caracteres, como em historico_inserir(),
+ * e seu código é resolvido no catálogo; a busca linear compara apenas inteiros.
+ * As descrições próprias são comparadas por texto, pois podem ter sido
+ * internadas depois de inseridas.
  * @param hist Ponteiro para o histórico.
  * @param texto String a ser buscada.
  * @return true Se a string foi encontrada.
  * @return false Se não encontrada.
  */
 bool historico_consultar(HISTORICO* hist, char* texto){
+    if (texto == NULL){
+        return false;
+    }
+
+    char descricao[HISTORICO_TAM_TEXTO];
+    strncpy(descricao, texto, HISTORICO_TAM_TEXTO - 1);
+    descricao[HISTORICO_TAM_TEXTO - 1] = '\0';
+    uint32_t codigo = catalogo_buscar(descricao);
+
     if (hist != NULL){
         for (int i = 0; i < hist->tamanho; i++){
-            if (strcmp(hist->hist[i], texto) == 0){
+            if (hist->hist[i] & HISTORICO_TEXTO_PROPRIO ? strcmp(historico_descricao(hist, i), descricao) == 0
+                                                          : codigo != CATALOGO_CODIGO_INVALIDO && hist->hist[i] == codigo){
                 return true;
             }
         }
@@ -132,8 +312,8 @@ bool historico_consultar(HISTORICO* hist, char* texto){
  */
 void historico_imprimir(HISTORICO* hist){
     if (hist != NULL){
-        for (int i = hist->tamanho; i >= 0; i--){
-            printf("%s\n", hist->hist[i]);
+        for (int i = hist->tamanho - 1; i >= 0; i--){
+            printf("%s\n", historico_descricao(hist, i));
         }
     }
 }
@@ -144,7 +324,8 @@ void historico_imprimir(HISTORICO* hist){
  */
 void historico_apagar(HISTORICO** hist){
     if (hist != NULL && *hist != NULL){
-        free(*hist);
+        heap_liberar(heap_ponteiro((*hist)->textos));
+        heap_liberar(*hist);
         *hist = NULL;
     }
 }
\ No newline at end of file
@@ -0,0 +1,697 @@
+/**
+ * @file importacao.c
+ * @brief Importação em massa de pacientes a partir de CSV ou JSON Lines.
+ * @details O arquivo é lido em pedaços de IMPORTACAO_BUFFER bytes para um
+ * único buffer de tamanho fixo, e as linhas completas são interpretadas no
+ * próprio buffer (aspas do CSV e escapes do JSON são desfeitos no lugar, sem
+ * cópias). CPF e nome de cada linha vão para um lote de até IMPORTACAO_LOTE
+ * registros, validado de uma vez por cpf_validar_lote(); o lote é
+ * processado antes que o buffer seja reaproveitado, então a memória da
+ * leitura não cresce com o arquivo.
+ *
+ * Os pacientes válidos são criados e registrados no armazém central (ver
+ * registro.c), mas só entram na árvore no fim: os CPFs novos são ordenados
+ * (radix sort estável, que mantém a primeira ocorrência de um CPF repetido)
+ * e intercalados com a árvore existente por lista_mesclar(), que a remonta
+ * em O(n) em vez de uma inserção com rotações por paciente. No modo sob
+ * demanda a árvore não pode ser remontada, e os pacientes são inseridos um
+ * a um.
+ *
+ * Os pacientes criados também vão para o log de operações (ver wal.c), na
+ * ordem do arquivo, para que a importação sobreviva a uma queda antes do
+ * próximo SAVE e chegue às réplicas e à auditoria: os de cada lote em poucos
+ * registros de importação em massa (wal_registrar_importacao()), e não um
+ * registro por paciente. Uma importação desfeita registra as remoções
+ * correspondentes.
+ *
+ * CSV: campos separados por vírgula, opcionalmente entre aspas duplas (com
+ * "" para uma aspa). Se a primeira linha tiver uma coluna "cpf", ela é o
+ * cabeçalho e indica as colunas "cpf" e "nome"; senão, o CPF é a primeira
+ * coluna e o nome a segunda. JSON Lines: um objeto por linha com "cpf" e
+ * "nome"; as outras chaves são ignoradas. O CPF é um texto ou um número
+ * inteiro, completado com zeros à esquerda até CPF_DIGITOS dígitos (o número
+ * 191 é o CPF 000.000.001-91); qualquer outro valor torna a linha
+ * malformada. Linhas "[" e "]" e a vírgula no fim de um objeto são aceitas,
+ * então o relatório em JSON (ver relatorio.c) também pode ser importado.
+ *
+ * Um nome com caractere de controle (byte abaixo de 0x20, como uma quebra de
+ * linha vinda de um escape do JSON ou de um campo do CSV entre aspas) torna
+ * a linha malformada: ele quebraria as listagens e os arquivos exportados.
+ */
+
+#include "../include/importacao.h"
+#include "../include/cpf.h"
+#include "../include/paciente.h"
+#include "../include/registro.h"
+#include "../include/wal.h"
+#include <ctype.h>
+#include <string.h>
+#include <time.h>
+
+#define IMPORTACAO_MAX_COLUNAS 64   ///< Colunas consideradas em uma linha de CSV
+#define IMPORTACAO_BITS 13          ///< Bits por passada da ordenação (3 passadas cobrem os 37 bits de um CPF)
+
+/**
+ * @brief Paciente criado pela importação, ainda fora da árvore.
+ */
+typedef struct importacao_novo_ {
+    uint64_t chave;     /**< CPF empacotado. */
+    PACIENTE_ID id;     /**< Identificador no armazém central. */
+} IMPORTACAO_NOVO;
+
+/**
+ * @brief Estado de uma importação.
+ */
+typedef struct importacao_ {
+    IMPORTACAO_FORMATO formato;
+    LISTA* lista;
+    IMPORTACAO_RESULTADO* resultado;
+    bool cabecalho_visto;               /**< Primeira linha do CSV já examinada. */
+    int coluna_cpf;                     /**< Coluna do CPF no CSV. */
+    int coluna_nome;                    /**< Coluna do nome no CSV. */
+    int n_lote;                         /**< Registros no lote. */
+    const char* cpfs[IMPORTACAO_LOTE];  /**< CPFs do lote, como digitados (apontam para o buffer). */
+    const char* nomes[IMPORTACAO_LOTE]; /**< Nomes do lote (apontam para o buffer). */
+    char numeros[IMPORTACAO_LOTE][CPF_DIGITOS + 1]; /**< CPFs numéricos do JSON, completados com zeros. */
+    char criados[IMPORTACAO_LOTE][CPF_DIGITOS + 1]; /**< CPFs dos pacientes criados no lote, para o log. */
+    uint64_t chaves[IMPORTACAO_LOTE];   /**< CPFs do lote empacotados (CPF_INVALIDO = rejeitado). */
+    IMPORTACAO_NOVO* novos;             /**< Pacientes criados, na ordem do arquivo. */
+    size_t n_novos;
+    size_t cap_novos;
+    bool sem_memoria;                   /**< Faltou memória: a importação é desfeita. */
+} IMPORTACAO;
+
+/* ---------------------------------------------------------------------- */
+/* Linhas                                                                 */
+/* ---------------------------------------------------------------------- */
+
+/**
+ * @brief Separa os campos de uma linha de CSV, no lugar.
+ * @details Cada campo termina em '\0'; as aspas externas são retiradas e ""
+ * vira ". O texto escrito nunca passa do lido, então a linha serve de destino.
+ * @return Quantidade de campos (no máximo max).
+ */
+static int importacao_csv_campos(char* linha, char* campos[], int max){
+    int n = 0;
+    char* r = linha;
+    char* w = linha;
+
+    while (true){
+        char* inicio = w;
+        if (*r == '"'){
+            for (r++; *r != '\0'; ){
+                if (*r == '"'){
+                    if (r[1] != '"'){
+                        r++;
+                        break;
+                    }
+                    r++;
+                }
+                *w++ = *r++;
+            }
+            // O que vier entre a aspa final e a vírgula é descartado
+            while (*r != '\0' && *r != ',')
+                r++;
+        } else {
+            while (*r != '\0' && *r != ',')
+                *w++ = *r++;
+        }
+
+        bool fim = *r == '\0';
+        *w++ = '\0';
+        if (n < max)
+            campos[n++] = inicio;
+        if (fim)
+            return n;
+        r++;
+    }
+}
+
+/**
+ * @brief Tira os espaços do início e do fim de um texto, no lugar.
+ */
+static char* importacao_aparar(char* texto){
+    while (*texto == ' ' || *texto == '\t')
+        texto++;
+    size_t n = strlen(texto);
+    while (n > 0 && (texto[n - 1] == ' ' || texto[n - 1] == '\t'))
+        texto[--n] = '\0';
+    return texto;
+}
+
+/**
+ * @brief Compara um texto com um nome de coluna (em minúsculas), sem diferenciar maiúsculas.
+ */
+static bool importacao_coluna(const char* texto, const char* coluna){
+    for (; *texto != '\0' && *coluna != '\0'; texto++, coluna++)
+        if (tolower((unsigned char)*texto) != *coluna)
+            return false;
+    return *texto == *coluna;
+}
+
+/**
+ * @brief Interpreta uma linha de CSV.
+ * @return 1 com CPF e nome, 0 para linha vazia ou cabeçalho, -1 se malformada.
+ */
+static int importacao_csv(IMPORTACAO* imp, char* linha, char** cpf, char** nome){
+    char* campos[IMPORTACAO_MAX_COLUNAS];
+    int n = importacao_csv_campos(linha, campos, IMPORTACAO_MAX_COLUNAS);
+    if (n == 1 && *importacao_aparar(campos[0]) == '\0')
+        return 0;
+
+    if (!imp->cabecalho_visto){
+        imp->cabecalho_visto = true;
+        int coluna_cpf = -1, coluna_nome = -1;
+        for (int i = 0; i < n; i++){
+            char* c = importacao_aparar(campos[i]);
+            if (coluna_cpf < 0 && importacao_coluna(c, "cpf")) coluna_cpf = i;
+            if (coluna_nome < 0 && importacao_coluna(c, "nome")) coluna_nome = i;
+        }
+        if (coluna_cpf >= 0){
+            imp->coluna_cpf = coluna_cpf;
+            imp->coluna_nome = coluna_nome >= 0 ? coluna_nome : (coluna_cpf == 0 ? 1 : 0);
+            return 0;
+        }
+    }
+
+    if (imp->coluna_cpf >= n || imp->coluna_nome >= n)
+        return -1;
+    *cpf = importacao_aparar(campos[imp->coluna_cpf]);
+    *nome = campos[imp->coluna_nome];
+    return 1;
+}
+
+/**
+ * @brief Pula espaços e tabulações.
+ */
+static char* json_espacos(char* p){
+    while (*p == ' ' || *p == '\t')
+        p++;
+    return p;
+}
+
+/**
+ * @brief Lê os 4 dígitos hexadecimais de um escape \u do JSON.
+ */
+static bool json_hexa(const char* p, uint32_t* valor){
+    *valor = 0;
+    for (int i = 0; i < 4; i++){
+        char c = p[i];
+        int d = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+        if (d < 0)
+            return false;
+        *valor = (*valor << 4) | (uint32_t)d;
+    }
+    return true;
+}
+
+/**
+ * @brief Escreve um ponto de código em UTF-8.
+ */
+static char* json_utf8(char* w, uint32_t c){
+    if (c < 0x80){
+        *w++ = (char)c;
+    } else if (c < 0x800){
+        *w++ = (char)(0xC0 | (c >> 6));
+        *w++ = (char)(0x80 | (c & 0x3F));
+    } else if (c < 0x10000){
+        *w++ = (char)(0xE0 | (c >> 12));
+        *w++ = (char)(0x80 | ((c >> 6) & 0x3F));
+        *w++ = (char)(0x80 | (c & 0x3F));
+    } else {
+        *w++ = (char)(0xF0 | (c >> 18));
+        *w++ = (char)(0x80 | ((c >> 12) & 0x3F));
+        *w++ = (char)(0x80 | ((c >> 6) & 0x3F));
+        *w++ = (char)(0x80 | (c & 0x3F));
+    }
+    return w;
+}
+
+/**
+ * @brief Lê uma string JSON no lugar, desfazendo os escapes.
+ * @param p Aspa inicial.
+ * @param valor Recebe o texto, terminado em '\0' (nunca depois da aspa final).
+ * @return Posição após a aspa final, ou NULL se a string for inválida.
+ */
+static char* json_texto(char* p, char** valor){
+    char* w = ++p;
+    *valor = w;
+
+    while (*p != '"'){
+        if (*p == '\0')
+            return NULL;
+        if (*p != '\\'){
+            *w++ = *p++;
+            continue;
+        }
+
+        p++;
+        switch (*p){
+        case '"': case '\\': case '/': *w++ = *p++; break;
+        case 'b': *w++ = '\b'; p++; break;
+        case 'f': *w++ = '\f'; p++; break;
+        case 'n': *w++ = '\n'; p++; break;
+        case 'r': *w++ = '\r'; p++; break;
+        case 't': *w++ = '\t'; p++; break;
+        case 'u': {
+            uint32_t c, baixo;
+            if (!json_hexa(p + 1, &c))
+                return NULL;
+            p += 5;
+            // Par substituto: os dois \u formam um só caractere
+            if (c >= 0xD800 && c < 0xDC00 && p[0] == '\\' && p[1] == 'u' &&
+                json_hexa(p + 2, &baixo) && baixo >= 0xDC00 && baixo < 0xE000){
+                c = 0x10000 + ((c - 0xD800) << 10) + (baixo - 0xDC00);
+                p += 6;
+            } else if (c >= 0xD800 && c < 0xE000){
+                c = '?';
+            }
+            w = json_utf8(w, c);
+            break;
+        }
+        default:
+            return NULL;
+        }
+    }
+
+    *w = '\0';
+    return p + 1;
+}
+
+/**
+ * @brief Pula um valor JSON qualquer.
+ * @return Posição da vírgula ou do '}' que encerra o valor, ou NULL se a linha acabar antes.
+ */
+static char* json_pular(char* p){
+    int profundidade = 0;
+    while (*p != '\0'){
+        if (*p == '"'){
+            for (p++; *p != '\0' && *p != '"'; p++)
+                if (*p == '\\' && p[1] != '\0') p++;
+            if (*p == '\0')
+                return NULL;
+        } else if (*p == '{' || *p == '['){
+            profundidade++;
+        } else if (*p == '}' || *p == ']'){
+            if (profundidade == 0)
+                return p;
+            profundidade--;
+        } else if (*p == ',' && profundidade == 0){
+            return p;
+        }
+        p++;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Interpreta uma linha de JSON Lines.
+ * @param numero Recebe o CPF dado como número, completado com zeros à esquerda.
+ * @return 1 com CPF e nome, 0 para linha vazia ou "[" / "]", -1 se malformada.
+ */
+static int importacao_jsonl(char* linha, char** cpf, char** nome, char numero[CPF_DIGITOS + 1]){
+    char* p = json_espacos(linha);
+    size_t n = strlen(p);
+    while (n > 0 && (p[n - 1] == ' ' || p[n - 1] == '\t'))
+        n--;
+    if (n > 0 && p[n - 1] == ',')
+        n--;
+    p[n] = '\0';
+    if (n == 0 || strcmp(p, "[") == 0 || strcmp(p, "]") == 0)
+        return 0;
+    if (*p != '{')
+        return -1;
+
+    *cpf = *nome = NULL;
+    p = json_espacos(p + 1);
+    if (*p == '}')
+        return -1;
+
+    while (true){
+        char* chave;
+        p = json_espacos(p);
+        if (*p != '"' || (p = json_texto(p, &chave)) == NULL)
+            return -1;
+        p = json_espacos(p);
+        if (*p != ':')
+            return -1;
+        p = json_espacos(p + 1);
+
+        bool e_cpf = strcmp(chave, "cpf") == 0;
+        bool e_nome = strcmp(chave, "nome") == 0;
+        if ((e_cpf || e_nome) && *p == '"'){
+            char* valor;
+            if ((p = json_texto(p, &valor)) == NULL)
+                return -1;
+            if (e_cpf) *cpf = valor;
+            else *nome = valor;
+        } else if (e_cpf && isdigit((unsigned char)*p)){
+            // CPF numérico: os zeros à esquerda não existem no número
+            char* inicio = p;
+            while (isdigit((unsigned char)*p))
+                p++;
+            size_t n = (size_t)(p - inicio);
+            if (n > CPF_DIGITOS)
+                return -1;
+            memset(numero, '0', CPF_DIGITOS - n);
+            memcpy(numero + CPF_DIGITOS - n, inicio, n);
+            numero[CPF_DIGITOS] = '\0';
+            *cpf = numero;
+        } else if ((p = json_pular(p)) == NULL){
+            return -1;
+        }
+
+        p = json_espacos(p);
+        if (*p == ','){
+            p++;
+            continue;
+        }
+        if (*p == '}')
+            break;
+        return -1;
+    }
+
+    return *cpf != NULL && *nome != NULL ? 1 : -1;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Lotes                                                                  */
+/* ---------------------------------------------------------------------- */
+
+/**
+ * @brief Valida os CPFs do lote de uma vez e cria os pacientes novos.
+ */
+static void importacao_lote(IMPORTACAO* imp){
+    IMPORTACAO_RESULTADO* r = imp->resultado;
+    cpf_validar_lote(imp->cpfs, (size_t)imp->n_lote, imp->chaves);
+
+    // Os criados são reunidos no início de cpfs e nomes (já validados), para o log
+    int n_criados = 0;
+    for (int i = 0; i < imp->n_lote && !imp->sem_memoria; i++){
+        if (imp->chaves[i] == CPF_INVALIDO){
+            r->cpf_invalidos++;
+            continue;
+        }
+
+        char* cpf = imp->criados[n_criados];
+        cpf_desempacotar(imp->chaves[i], cpf);
+        if (lista_buscar(imp->lista, cpf) != NULL){
+            r->ja_cadastrados++;
+            continue;
+        }
+
+        if (imp->n_novos == imp->cap_novos){
+            size_t nova = imp->cap_novos ? imp->cap_novos * 2 : 65536;
+            IMPORTACAO_NOVO* novos = (IMPORTACAO_NOVO*)realloc(imp->novos, nova * sizeof(IMPORTACAO_NOVO));
+            if (novos == NULL){
+                imp->sem_memoria = true;
+                break;
+            }
+            imp->novos = novos;
+            imp->cap_novos = nova;
+        }
+
+        PACIENTE* paciente = paciente_criar((char*)imp->nomes[i], cpf);
+        if (paciente == NULL || paciente_obter_nome(paciente) == NULL){
+            paciente_apagar(&paciente);
+            imp->sem_memoria = true;
+            break;
+        }
+        imp->novos[imp->n_novos].chave = imp->chaves[i];
+        imp->novos[imp->n_novos].id = paciente_obter_id(paciente);
+        imp->n_novos++;
+
+        imp->cpfs[n_criados] = cpf;
+        imp->nomes[n_criados] = imp->nomes[i];
+        n_criados++;
+    }
+
+    // Na ordem do arquivo: ao reaplicar, o primeiro cadastro de um CPF repetido vale, como aqui
+    wal_registrar_importacao(imp->cpfs, imp->nomes, (size_t)n_criados);
+    imp->n_lote = 0;
+}
+
+/**
+ * @brief Indica se um nome tem algum caractere de controle (byte abaixo de 0x20).
+ */
+static bool importacao_controle(const char* nome){
+    for (; *nome != '\0'; nome++)
+        if ((unsigned char)*nome < 0x20)
+            return true;
+    return false;
+}
+
+/**
+ * @brief Interpreta uma linha e a acrescenta ao lote.
+ * @param linha Início da linha no buffer.
+ * @param tamanho Bytes da linha, sem o '\n' (a posição seguinte pode ser sobrescrita).
+ */
+static void importacao_linha(IMPORTACAO* imp, char* linha, size_t tamanho){
+    if (tamanho > 0 && linha[tamanho - 1] == '\r')
+        tamanho--;
+    linha[tamanho] = '\0';
+
+    char *cpf = NULL, *nome = NULL;
+    int lida = imp->formato == IMPORTACAO_CSV ? importacao_csv(imp, linha, &cpf, &nome)
+                                              : importacao_jsonl(linha, &cpf, &nome, imp->numeros[imp->n_lote]);
+    if (lida == 0)
+        return;
+
+    imp->resultado->registros++;
+    if (lida > 0){
+        nome = importacao_aparar(nome);
+        size_t n = strlen(nome);
+        if (n == 0 || n > PACIENTE_TAM_NOME || importacao_controle(nome))
+            lida = -1;
+    }
+    if (lida < 0){
+        imp->resultado->malformados++;
+        return;
+    }
+
+    imp->cpfs[imp->n_lote] = cpf;
+    imp->nomes[imp->n_lote] = nome;
+    if (++imp->n_lote == IMPORTACAO_LOTE)
+        importacao_lote(imp);
+}
+
+/* ---------------------------------------------------------------------- */
+/* Montagem                                                               */
+/* ---------------------------------------------------------------------- */
+
+/**
+ * @brief Ordena os pacientes novos por CPF, mantendo a ordem do arquivo entre CPFs iguais.
+ * @details Radix sort LSD em 3 passadas de IMPORTACAO_BITS bits.
+ * @return false se faltou memória.
+ */
+static bool importacao_ordenar(IMPORTACAO_NOVO* novos, size_t n){
+    IMPORTACAO_NOVO* auxiliar = (IMPORTACAO_NOVO*)malloc((n ? n : 1) * sizeof(IMPORTACAO_NOVO));
+    size_t* contagem = (size_t*)malloc(((size_t)1 << IMPORTACAO_BITS) * sizeof(size_t));
+    if (auxiliar == NULL || contagem == NULL){
+        free(auxiliar);
+        free(contagem);
+        return false;
+    }
+
+    const uint64_t mascara = ((uint64_t)1 << IMPORTACAO_BITS) - 1;
+    IMPORTACAO_NOVO* origem = novos;
+    IMPORTACAO_NOVO* destino = auxiliar;
+    for (int passada = 0; passada < 3; passada++){
+        int deslocamento = passada * IMPORTACAO_BITS;
+        memset(contagem, 0, ((size_t)1 << IMPORTACAO_BITS) * sizeof(size_t));
+        for (size_t i = 0; i < n; i++)
+            contagem[(origem[i].chave >> deslocamento) & mascara]++;
+
+        size_t soma = 0;
+        for (size_t d = 0; d <= mascara; d++){
+            size_t c = contagem[d];
+            contagem[d] = soma;
+            soma += c;
+        }
+
+        for (size_t i = 0; i < n; i++)
+            destino[contagem[(origem[i].chave >> deslocamento) & mascara]++] = origem[i];
+
+        IMPORTACAO_NOVO* troca = origem;
+        origem = destino;
+        destino = troca;
+    }
+
+    // Número ímpar de passadas: o resultado ficou no auxiliar
+    if (origem != novos)
+        memcpy(novos, origem, n * sizeof(IMPORTACAO_NOVO));
+    free(auxiliar);
+    free(contagem);
+    return true;
+}
+
+/**
+ * @brief Apaga os pacientes criados (importação desfeita).
+ */
+static void importacao_desfazer(IMPORTACAO* imp){
+    for (size_t i = 0; i < imp->n_novos; i++){
+        PACIENTE* paciente = registro_paciente(imp->novos[i].id);
+        wal_registrar_remocao(paciente_obter_cpf(paciente));
+        paciente_apagar(&paciente);
+    }
+    imp->n_novos = 0;
+}
+
+/**
+ * @brief Descarta CPFs repetidos e leva os pacientes novos para a árvore de uma vez.
+ * @return false se faltou memória (nada é importado).
+ */
+static bool importacao_montar(IMPORTACAO* imp){
+    if (imp->n_novos == 0)
+        return true;
+    if (!importacao_ordenar(imp->novos, imp->n_novos))
+        return false;
+
+    PACIENTE_ID* ids = (PACIENTE_ID*)malloc(imp->n_novos * sizeof(PACIENTE_ID));
+    if (ids == NULL)
+        return false;
+
+    // Entre CPFs iguais, a ordenação estável deixa primeiro o que veio antes no arquivo
+    size_t n = 0, n_falhas = 0;
+    for (size_t i = 0; i < imp->n_novos; i++){
+        if (n > 0 && imp->novos[i].chave == registro_cpf(ids[n - 1])){
+            PACIENTE* repetido = registro_paciente(imp->novos[i].id);
+            paciente_apagar(&repetido);
+            imp->resultado->repetidos++;
+        } else {
+            ids[n++] = imp->novos[i].id;
+        }
+    }
+    imp->n_novos = 0;
+
+    // No modo sob demanda (ou sem memória para remontar), uma inserção por paciente
+    if (!lista_mesclar(imp->lista, ids, n)){
+        for (size_t i = 0; i < n; i++){
+            PACIENTE* paciente = registro_paciente(ids[i]);
+            if (!lista_inserir(imp->lista, paciente)){
+                wal_registrar_remocao(paciente_obter_cpf(paciente));
+                paciente_apagar(&paciente);
+                n_falhas++;
+            }
+        }
+    }
+
+    imp->resultado->importados = n - n_falhas;
+    free(ids);
+    return true;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Leitura                                                                */
+/* ---------------------------------------------------------------------- */
+
+/**
+ * @brief Importa os pacientes de um arquivo CSV ou JSON Lines.
+ * @details Registros com CPF inválido, já cadastrado ou repetido e linhas
+ * malformadas são contados no resultado e pulados; os demais pacientes são
+ * cadastrados fora da fila.
+ *
+ * @param caminho Arquivo de entrada.
+ * @param formato CSV ou JSON Lines.
+ * @param lista Lista de pacientes de destino.
+ * @param resultado Contagens e tempo da importação.
+ * @return false se o arquivo não pôde ser lido ou faltou memória (nesse caso nada é importado).
+ */
+bool importacao_carregar(const char* caminho, IMPORTACAO_FORMATO formato, LISTA* lista, IMPORTACAO_RESULTADO* resultado){
+    if (caminho == NULL || lista == NULL || resultado == NULL)
+        return false;
+    memset(resultado, 0, sizeof(IMPORTACAO_RESULTADO));
+
+#ifndef _WIN32
+    struct timespec inicio, fim;
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+#else
+    clock_t inicio = clock();
+#endif
+
+    FILE* arquivo = fopen(caminho, "rb");
+    if (arquivo == NULL)
+        return false;
+
+    // Um byte a mais: o '\0' da última linha, quando o arquivo não termina em '\n'
+    char* buffer = (char*)malloc(IMPORTACAO_BUFFER + 1);
+    IMPORTACAO* imp = (IMPORTACAO*)calloc(1, sizeof(IMPORTACAO));
+    if (buffer == NULL || imp == NULL){
+        free(buffer);
+        free(imp);
+        fclose(arquivo);
+        return false;
+    }
+    imp->formato = formato;
+    imp->lista = lista;
+    imp->resultado = resultado;
+    imp->coluna_nome = 1;
+
+    size_t cheio = 0;
+    bool primeiro = true, descartando = false, ok = true;
+    while (true){
+        size_t lidos = fread(buffer + cheio, 1, IMPORTACAO_BUFFER - cheio, arquivo);
+        bool acabou = lidos == 0;
+        if (acabou && ferror(arquivo)){
+            ok = false;
+            break;
+        }
+        cheio += lidos;
+
+        size_t pos = 0;
+        if (primeiro && cheio >= 3 && memcmp(buffer, "\xEF\xBB\xBF", 3) == 0)
+            pos = 3;
+        primeiro = false;
+
+        // Só linhas completas, a não ser a última do arquivo
+        while (pos < cheio && !imp->sem_memoria){
+            char* quebra = (char*)memchr(buffer + pos, '\n', cheio - pos);
+            if (quebra == NULL && !acabou)
+                break;
+            size_t fim_linha = quebra != NULL ? (size_t)(quebra - buffer) : cheio;
+            if (descartando)
+                descartando = false;
+            else
+                importacao_linha(imp, buffer + pos, fim_linha - pos);
+            pos = quebra != NULL ? fim_linha + 1 : cheio;
+        }
+
+        // O lote aponta para o buffer: é processado antes que os bytes mudem de lugar
+        if (imp->n_lote > 0)
+            importacao_lote(imp);
+        if (acabou || imp->sem_memoria)
+            break;
+
+        if (pos == 0 && cheio == IMPORTACAO_BUFFER){
+            // Linha maior que o buffer: descartada até a próxima quebra
+            if (!descartando){
+                resultado->registros++;
+                resultado->malformados++;
+            }
+            descartando = true;
+            cheio = 0;
+        } else {
+            memmove(buffer, buffer + pos, cheio - pos);
+            cheio -= pos;
+        }
+    }
+
+    fclose(arquivo);
+    free(buffer);
+
+    ok = ok && !imp->sem_memoria && importacao_montar(imp);
+    if (!ok){
+        importacao_desfazer(imp);
+        resultado->importados = 0;
+    }
+    free(imp->novos);
+    free(imp);
+
+#ifndef _WIN32
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+    resultado->duracao_ms = (double)(fim.tv_sec - inicio.tv_sec) * 1e3 + (double)(fim.tv_nsec - inicio.tv_nsec) / 1e6;
+#else
+    resultado->duracao_ms = (double)(clock() - inicio) * 1e3 / CLOCKS_PER_SEC;
+#endif
+    return ok;
+}
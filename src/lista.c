@@ -4,9 +4,32 @@
  * @details Embora a interface sugira uma "Lista", a implementação interna utiliza uma 
  * Árvore AVL (Árvore Binária de Busca Balanceada) ordenadada pelo CPF.
  * Isso garante complexidade O(log n) para busca, inserção e remoção.
+ *
+ * Os nós guardam o identificador de 32 bits do paciente no armazém central
+ * (ver registro.c) e comparam CPFs empacotados como inteiros.
+ *
+ * No modo sob demanda (ver lista_vincular_arquivo()) a árvore guarda apenas
+ * os pacientes em uso: o arquivo de dados mapeado é a base, e seu índice de
+ * blocos faz o papel de índice CPF → posição. lista_buscar() hidrata o
+ * paciente do arquivo no primeiro acesso. Os pacientes hidratados e ainda
+ * iguais ao arquivo ocupam um cache limitado com substituição CLOCK; os
+ * alterados (ou na fila) ficam na árvore até o encerramento.
+ *
+ * Um filtro de Bloom opcional (ver bloom.c) sobre todos os CPFs cadastrados
+ * responde a maioria das buscas por CPFs novos sem percorrer a árvore nem
+ * ler o arquivo.
+ *
+ * Os nós são alocados com heap_alocar() e ligam-se por posição (HEAP_REF):
+ * com o heap persistente (ver heap.c), a árvore sobrevive ao encerramento e
+ * é retomada por lista_restaurar().
  */
 
 #include "../include/lista.h"
+#include "../include/cpf.h"
+#include "../include/heap.h"
+#include "../include/registro.h"
+
+#define LISTA_MAX_ALTURA 96 ///< Altura máxima da AVL (1,44·log2 de 2^32 pacientes, com folga)
 
 /**
  * @struct no_
@@ -14,25 +37,52 @@
  */
 typedef struct no_ NO;
 struct no_{
-    NO* esq;        /**< Ponteiro para o filho à esquerda. */
-    NO* dir;        /**< Ponteiro para o filho à direita. */
-    PACIENTE* pac;  /**< Ponteiro para o dado (Paciente). */
+    HEAP_REF esq;   /**< Posição do filho à esquerda (ver heap.h). */
+    HEAP_REF dir;   /**< Posição do filho à direita (ver heap.h). */
+    PACIENTE_ID id; /**< Identificador do paciente no armazém central. */
     int altura;     /**< Altura do nó para cálculo do fator de balanceamento. */
 };
 
+/**
+ * @brief Filho à esquerda de um nó.
+ */
+static inline NO* no_esq(const NO* no){
+    return (NO*)heap_ponteiro(no->esq);
+}
+
+/**
+ * @brief Filho à direita de um nó.
+ */
+static inline NO* no_dir(const NO* no){
+    return (NO*)heap_ponteiro(no->dir);
+}
+
+/**
+ * @brief Raiz da lista guardada no heap persistente (HEAP_RAIZ_LISTA).
+ */
+typedef struct lista_raiz_ {
+    HEAP_REF raiz;  ///< Posição do nó raiz
+} LISTA_RAIZ;
+
+_Static_assert(sizeof(LISTA_RAIZ) <= HEAP_TAM_RAIZ, "raiz da lista deve caber no cabeçalho do heap");
+
 /**
  * @struct lista_
  * @brief Estrutura wrapper que contém a raiz da árvore.
  */
 struct lista_{
-    NO* raiz;       /**< Nó raiz da árvore AVL. */
+    NO* raiz;               /**< Nó raiz da árvore AVL. */
+    ARQUIVO* arquivo;       /**< Base em disco no modo sob demanda (NULL no modo completo). */
+    uint64_t* removidos;    /**< CPFs removidos (do arquivo, ou desde o último SAVE no modo completo), em ordem crescente. */
+    size_t n_removidos;     /**< Quantidade de CPFs removidos. */
+    size_t cap_removidos;   /**< Capacidade do vetor de removidos. */
+    PACIENTE_ID* relogio;   /**< Posições do cache CLOCK (pacientes hidratados). */
+    size_t limite;          /**< Capacidade do cache. */
+    size_t n_relogio;       /**< Posições do cache ocupadas. */
+    size_t ponteiro;        /**< Posição do ponteiro do CLOCK. */
+    BLOOM* filtro;          /**< Filtro dos CPFs cadastrados (NULL = sem filtro). */
 };
 
-/**
- * @brief Definição do tipo de função de callback para percorrer a estrutura.
- */
-typedef void (*AcaoPaciente)(PACIENTE* p, void* contexto);
-
 /**
  * @brief Cria e inicializa uma nova lista (árvore) vazia.
  * @return LISTA* Ponteiro para a estrutura alocada ou NULL se falhar.
@@ -40,23 +90,23 @@ typedef void (*AcaoPaciente)(PACIENTE* p, void* contexto);
 LISTA* lista_criar(void){
     LISTA* lista = (LISTA*)malloc(sizeof(LISTA));
     if (lista != NULL){
-        lista->raiz = NULL;
+        memset(lista, 0, sizeof(LISTA));
     }
     return lista;
 }
 
 /**
  * @brief Função auxiliar para criar um novo nó contendo um paciente.
- * @param p Ponteiro para o paciente a ser armazenado.
+ * @param id Identificador do paciente a ser armazenado.
  * @return NO* Ponteiro para o novo nó ou NULL se falhar a alocação.
  */
-NO* lista_cria_no(PACIENTE* p){
-    NO* novo = (NO*)malloc(sizeof(NO));
+NO* lista_cria_no(PACIENTE_ID id){
+    NO* novo = (NO*)heap_alocar(sizeof(NO));
     if (novo != NULL){
         novo->altura = 0;
-        novo->dir = NULL;
-        novo->esq = NULL;
-        novo->pac = p;
+        novo->dir = 0;
+        novo->esq = 0;
+        novo->id = id;
     }
     return novo;
 }
@@ -83,12 +133,12 @@ int lista_altura_no(NO* raiz){
  */
 NO* rodar_direita(NO* a){
     
-    NO* b = a->esq;
+    NO* b = no_esq(a);
     a->esq = b->dir;
-    b->dir = a;
+    b->dir = heap_referencia(a);
 
-    a->altura = max(lista_altura_no(a->esq), lista_altura_no(a->dir)) + 1;
-    b->altura = max(lista_altura_no(b->esq), lista_altura_no(b->dir)) + 1;
+    a->altura = max(lista_altura_no(no_esq(a)), lista_altura_no(no_dir(a))) + 1;
+    b->altura = max(lista_altura_no(no_esq(b)), lista_altura_no(no_dir(b))) + 1;
 
     return b;
 }
@@ -100,12 +150,12 @@ NO* rodar_direita(NO* a){
  * @return NO* A nova raiz da subárvore após a rotação.
  */
 NO* rodar_esquerda(NO* a){
-    NO* b = a->dir;
+    NO* b = no_dir(a);
     a->dir = b->esq;
-    b->esq = a;
+    b->esq = heap_referencia(a);
 
-    a->altura = max(lista_altura_no(a->esq), lista_altura_no(a->dir)) + 1;
-    b->altura = max(lista_altura_no(b->esq), lista_altura_no(b->dir)) + 1;
+    a->altura = max(lista_altura_no(no_esq(a)), lista_altura_no(no_dir(a))) + 1;
+    b->altura = max(lista_altura_no(no_esq(b)), lista_altura_no(no_dir(b))) + 1;
 
     return b;
 }
@@ -117,8 +167,7 @@ NO* rodar_esquerda(NO* a){
  * @return NO* A nova raiz da subárvore.
  */
 NO* rodar_direita_esquerda(NO* a){
-    NO* b = a->dir;
-    b = rodar_direita(b);
+    a->dir = heap_referencia(rodar_direita(no_dir(a)));
     return rodar_esquerda(a);
 }
 
@@ -129,8 +178,7 @@ NO* rodar_direita_esquerda(NO* a){
  * @return NO* A nova raiz da subárvore.
  */
 NO* rodar_esquerda_direita(NO* a){
-    NO* b = a->esq;
-    b = rodar_esquerda(b);
+    a->esq = heap_referencia(rodar_esquerda(no_esq(a)));
     return rodar_direita(a);
 }
 
@@ -139,33 +187,33 @@ NO* rodar_esquerda_direita(NO* a){
 /**
  * @brief Função recursiva interna para inserir um nó e rebalancear a árvore.
  * @param raiz Raiz da subárvore atual.
- * @param p Paciente a ser inserido.
+ * @param id Identificador do paciente a ser inserido.
+ * @param chave CPF empacotado do paciente.
  * @return NO* Nova raiz da subárvore (pode mudar devido a rotações).
  */
-NO* lista_inserir_no(NO* raiz, PACIENTE* p){
+NO* lista_inserir_no(NO* raiz, PACIENTE_ID id, uint64_t chave){
     if (raiz == NULL)
-        raiz = lista_cria_no(p);
-    
+        return lista_cria_no(id);
 
-    int cmp = strcmp(paciente_obter_cpf(p), paciente_obter_cpf(raiz->pac));
+    uint64_t atual = registro_cpf(raiz->id);
 
-    if (cmp < 0){
-        raiz->esq = lista_inserir_no(raiz->esq, p);
-    } else if (cmp > 0){
-        raiz->dir = lista_inserir_no(raiz->dir, p);
+    if (chave < atual){
+        raiz->esq = heap_referencia(lista_inserir_no(no_esq(raiz), id, chave));
+    } else if (chave > atual){
+        raiz->dir = heap_referencia(lista_inserir_no(no_dir(raiz), id, chave));
     }
     // Se cmp == 0, CPF é igual, não insere duplicado (ou atualiza, dependendo da lógica desejada)
 
-    raiz->altura = max(lista_altura_no(raiz->esq), lista_altura_no(raiz->dir)) + 1;
-    int FB = lista_altura_no(raiz->esq) - lista_altura_no(raiz->dir);
+    raiz->altura = max(lista_altura_no(no_esq(raiz)), lista_altura_no(no_dir(raiz))) + 1;
+    int FB = lista_altura_no(no_esq(raiz)) - lista_altura_no(no_dir(raiz));
 
     if (FB == -2){
-        if (lista_altura_no(raiz->dir->esq) - lista_altura_no(raiz->dir->dir) <= 0)
+        if (lista_altura_no(no_esq(no_dir(raiz))) - lista_altura_no(no_dir(no_dir(raiz))) <= 0)
             raiz = rodar_esquerda(raiz);
         else
             raiz = rodar_direita_esquerda(raiz);
     } else if (FB == 2){
-        if (lista_altura_no(raiz->esq->esq) - lista_altura_no(raiz->esq->dir) >= 0)
+        if (lista_altura_no(no_esq(no_esq(raiz))) - lista_altura_no(no_dir(no_esq(raiz))) >= 0)
             raiz = rodar_direita(raiz);
         else
             raiz = rodar_esquerda_direita(raiz);
@@ -184,12 +232,231 @@ NO* lista_inserir_no(NO* raiz, PACIENTE* p){
 bool lista_inserir(LISTA* l, PACIENTE* p){
     if (l != NULL){
         // Verifica se a raiz mudou (pode ter rotacionado ou sido criada)
-        l->raiz = lista_inserir_no(l->raiz, p);
+        PACIENTE_ID id = paciente_obter_id(p);
+        l->raiz = lista_inserir_no(l->raiz, id, registro_cpf(id));
+        bloom_inserir(l->filtro, registro_cpf(id));
         return (l->raiz != NULL); 
     }
     return false;
 }
 
+// --- Construção em bloco ---
+
+/**
+ * @brief Monta uma subárvore perfeitamente balanceada a partir de ids em ordem.
+ * @param ids Identificadores em ordem crescente de CPF.
+ * @param ini Primeira posição (inclusive).
+ * @param fim Última posição (exclusive).
+ * @param ok Recebe false se faltar memória.
+ * @return NO* Raiz da subárvore.
+ */
+static NO* lista_construir_no(const PACIENTE_ID* ids, size_t ini, size_t fim, bool* ok){
+    if (ini >= fim || !*ok)
+        return NULL;
+
+    size_t meio = ini + (fim - ini) / 2;
+    NO* no = lista_cria_no(ids[meio]);
+    if (no == NULL){
+        *ok = false;
+        return NULL;
+    }
+
+    no->esq = heap_referencia(lista_construir_no(ids, ini, meio, ok));
+    no->dir = heap_referencia(lista_construir_no(ids, meio + 1, fim, ok));
+    no->altura = max(lista_altura_no(no_esq(no)), lista_altura_no(no_dir(no))) + 1;
+    return no;
+}
+
+/**
+ * @brief Libera apenas os nós de uma subárvore (os pacientes continuam vivos).
+ */
+static void lista_liberar_nos(NO* raiz){
+    if (raiz != NULL){
+        lista_liberar_nos(no_esq(raiz));
+        lista_liberar_nos(no_dir(raiz));
+        heap_liberar(raiz);
+    }
+}
+
+/**
+ * @brief Monta a árvore de uma vez a partir de pacientes em ordem crescente de CPF.
+ * @details Em vez de n inserções com rotações (O(n log n)), o elemento do meio
+ * vira a raiz e cada metade vira uma subárvore, recursivamente: O(n) e sem
+ * nenhuma rotação. A árvore resultante é perfeitamente balanceada, logo AVL.
+ * @param l Ponteiro para a lista (vazia, fora do modo sob demanda).
+ * @param ids Identificadores dos pacientes, já registrados.
+ * @param n Quantidade de pacientes.
+ * @return true se a árvore foi montada; false (lista intacta) se a lista não
+ * estava vazia, se os CPFs não estão em ordem estritamente crescente ou se
+ * faltou memória.
+ */
+bool lista_construir(LISTA* l, const PACIENTE_ID* ids, size_t n){
+    if (l == NULL || l->raiz != NULL || l->arquivo != NULL)
+        return false;
+
+    for (size_t i = 1; i < n; i++){
+        if (registro_cpf(ids[i - 1]) >= registro_cpf(ids[i]))
+            return false;
+    }
+
+    bool ok = true;
+    NO* raiz = lista_construir_no(ids, 0, n, &ok);
+    if (!ok){
+        lista_liberar_nos(raiz);
+        return false;
+    }
+
+    l->raiz = raiz;
+    for (size_t i = 0; i < n; i++)
+        bloom_inserir(l->filtro, registro_cpf(ids[i]));
+    return true;
+}
+
+/**
+ * @brief Auxiliar de lista_mesclar(): ids da árvore em ordem crescente de CPF.
+ */
+static void lista_coletar_ids(NO* raiz, PACIENTE_ID* ids, size_t* n){
+    if (raiz != NULL){
+        lista_coletar_ids(no_esq(raiz), ids, n);
+        ids[(*n)++] = raiz->id;
+        lista_coletar_ids(no_dir(raiz), ids, n);
+    }
+}
+
+/**
+ * @brief Acrescenta de uma vez pacientes em ordem crescente de CPF a uma lista já povoada.
+ * @details Os ids da árvore são intercalados com os novos e a árvore é
+ * remontada com lista_construir() em O(n + m), em vez de m inserções com
+ * rotações. A árvore antiga só é liberada depois que a nova está pronta.
+ * @param l Ponteiro para a lista (fora do modo sob demanda).
+ * @param ids Identificadores dos novos pacientes, já registrados e ausentes da lista.
+ * @param n Quantidade de novos pacientes.
+ * @return true se a árvore foi remontada; false (lista intacta) se algum CPF
+ * se repete, se os novos não estão em ordem ou se faltou memória.
+ */
+bool lista_mesclar(LISTA* l, const PACIENTE_ID* ids, size_t n){
+    if (l == NULL || l->arquivo != NULL)
+        return false;
+    if (l->raiz == NULL)
+        return lista_construir(l, ids, n);
+
+    // Todo nó da árvore ocupa uma posição do armazém
+    size_t maximo = (size_t)registro_quantidade();
+    PACIENTE_ID* antigos = (PACIENTE_ID*)malloc((maximo ? maximo : 1) * sizeof(PACIENTE_ID));
+    PACIENTE_ID* todos = (PACIENTE_ID*)malloc((maximo + n ? maximo + n : 1) * sizeof(PACIENTE_ID));
+    if (antigos == NULL || todos == NULL){
+        free(antigos);
+        free(todos);
+        return false;
+    }
+
+    size_t n_antigos = 0, total = 0, i = 0, j = 0;
+    lista_coletar_ids(l->raiz, antigos, &n_antigos);
+    while (i < n_antigos || j < n){
+        if (j == n || (i < n_antigos && registro_cpf(antigos[i]) < registro_cpf(ids[j])))
+            todos[total++] = antigos[i++];
+        else
+            todos[total++] = ids[j++];
+    }
+    free(antigos);
+
+    for (size_t k = 1; k < total; k++){
+        if (registro_cpf(todos[k - 1]) >= registro_cpf(todos[k])){
+            free(todos);
+            return false;
+        }
+    }
+
+    bool ok = true;
+    NO* raiz = lista_construir_no(todos, 0, total, &ok);
+    free(todos);
+    if (!ok){
+        lista_liberar_nos(raiz);
+        return false;
+    }
+
+    lista_liberar_nos(l->raiz);
+    l->raiz = raiz;
+    for (size_t k = 0; k < n; k++)
+        bloom_inserir(l->filtro, registro_cpf(ids[k]));
+    return true;
+}
+
+// --- Remoções sobre o arquivo ---
+
+/**
+ * @brief Procura um CPF no vetor ordenado de removidos.
+ * @param l Ponteiro para a lista.
+ * @param chave CPF empacotado.
+ * @param pos Retorno por referência da posição onde o CPF está (ou deveria estar).
+ * @return true se o CPF foi removido nesta execução.
+ */
+static bool lista_removido(LISTA* l, uint64_t chave, size_t* pos){
+    size_t ini = 0, fim = l->n_removidos;
+    while (ini < fim){
+        size_t meio = ini + (fim - ini) / 2;
+        if (l->removidos[meio] < chave)
+            ini = meio + 1;
+        else
+            fim = meio;
+    }
+    if (pos != NULL)
+        *pos = ini;
+    return ini < l->n_removidos && l->removidos[ini] == chave;
+}
+
+/**
+ * @brief Registra que um CPF presente no arquivo de dados foi removido.
+ * @details Sem o registro, o paciente voltaria a ser hidratado do arquivo.
+ * No modo completo não há arquivo para consultar: todo CPF removido é
+ * registrado, para que o SAVE incremental apague o registro (ver
+ * lista_removidos()).
+ * @param l Ponteiro para a lista.
+ * @param chave CPF empacotado.
+ */
+static void lista_marcar_removido(LISTA* l, uint64_t chave){
+    size_t pos;
+    const char* bytes;
+    uint32_t n;
+
+    if (lista_removido(l, chave, &pos) || (l->arquivo != NULL && !arquivo_buscar(l->arquivo, chave, &bytes, &n)))
+        return;
+
+    if (l->n_removidos == l->cap_removidos){
+        size_t nova = l->cap_removidos ? l->cap_removidos * 2 : 64;
+        uint64_t* p = realloc(l->removidos, nova * sizeof(uint64_t));
+        if (p == NULL)
+            return;
+        l->removidos = p;
+        l->cap_removidos = nova;
+    }
+    memmove(l->removidos + pos + 1, l->removidos + pos, (l->n_removidos - pos) * sizeof(uint64_t));
+    l->removidos[pos] = chave;
+    l->n_removidos++;
+}
+
+/**
+ * @brief CPFs removidos ainda não refletidos no arquivo de dados.
+ * @param l Ponteiro para a lista.
+ * @param n Retorno por referência da quantidade.
+ * @return const uint64_t* CPFs empacotados, em ordem crescente.
+ */
+const uint64_t* lista_removidos(LISTA* l, size_t* n){
+    *n = l != NULL ? l->n_removidos : 0;
+    return l != NULL ? l->removidos : NULL;
+}
+
+/**
+ * @brief Esquece os CPFs removidos depois de um SAVE no modo completo.
+ * @details No modo sob demanda eles continuam valendo: o arquivo mapeado
+ * ainda é o anterior ao SAVE.
+ * @param l Ponteiro para a lista.
+ */
+void lista_limpar_removidos(LISTA* l){
+    if (l != NULL && l->arquivo == NULL)
+        l->n_removidos = 0;
+}
+
 // --- Remoção ---
 
 /**
@@ -198,11 +465,11 @@ bool lista_inserir(LISTA* l, PACIENTE* p){
  * @param atual Nó sendo percorrido na busca do máximo.
  * @param raiz Nó original que será removido (onde os dados serão copiados).
  * @param ant Pai do nó 'atual'.
- * @param pac Ponteiro para armazenar o paciente removido (backup).
+ * @param pac Ponteiro para armazenar o identificador do paciente removido (backup).
  */
-void troca_max_esq(NO* atual, NO* raiz, NO* ant, PACIENTE** pac){
-    if (atual->dir != NULL){
-        troca_max_esq(atual->dir, raiz, atual, pac);
+void troca_max_esq(NO* atual, NO* raiz, NO* ant, PACIENTE_ID* pac){
+    if (no_dir(atual) != NULL){
+        troca_max_esq(no_dir(atual), raiz, atual, pac);
         return;
     }
 
@@ -212,63 +479,63 @@ void troca_max_esq(NO* atual, NO* raiz, NO* ant, PACIENTE** pac){
         ant->dir = atual->esq;
     
     if (pac != NULL)
-        *pac = raiz->pac;
+        *pac = raiz->id;
 
-    raiz->pac = atual->pac;
+    raiz->id = atual->id;
 
-    free(atual);
+    heap_liberar(atual);
     atual = NULL;
 }
 
 /**
  * @brief Remove um nó da árvore AVL recursivamente baseado na chave (CPF).
  * @param raiz Raiz da subárvore atual.
- * @param chave String contendo o CPF a ser removido.
- * @param pac Retorno por referência do ponteiro do paciente removido.
+ * @param chave CPF empacotado a ser removido.
+ * @param pac Retorno por referência do identificador do paciente removido.
  * @return NO* Nova raiz da subárvore após remoção e balanceamento.
  */
-NO* lista_remover_no(NO* raiz, char* chave, PACIENTE** pac){
+NO* lista_remover_no(NO* raiz, uint64_t chave, PACIENTE_ID* pac){
     NO* p;
     
     if (raiz == NULL) return NULL;
 
-    int cmp = strcmp(chave, paciente_obter_cpf(raiz->pac));
+    uint64_t atual = registro_cpf(raiz->id);
 
-    if (cmp == 0){
-        if (raiz->esq == NULL || raiz->dir == NULL){
+    if (chave == atual){
+        if (no_esq(raiz) == NULL || no_dir(raiz) == NULL){
             p = raiz;
 
             if (pac != NULL) {
-                *pac = p->pac;
+                *pac = p->id;
             }
 
-            if (raiz->esq == NULL)
-                raiz = raiz->dir;
+            if (no_esq(raiz) == NULL)
+                raiz = no_dir(raiz);
             else
-                raiz = raiz->esq;
+                raiz = no_esq(raiz);
             
-            free(p);
+            heap_liberar(p);
             p = NULL;
         } else {
-            troca_max_esq(raiz->esq, raiz, raiz, pac);
+            troca_max_esq(no_esq(raiz), raiz, raiz, pac);
         }
-    } else if (cmp < 0){
-        raiz->esq = lista_remover_no(raiz->esq, chave, pac);
-    } else if (cmp > 0){
-        raiz->dir = lista_remover_no(raiz->dir, chave, pac);
+    } else if (chave < atual){
+        raiz->esq = heap_referencia(lista_remover_no(no_esq(raiz), chave, pac));
+    } else {
+        raiz->dir = heap_referencia(lista_remover_no(no_dir(raiz), chave, pac));
     }
 
     if (raiz != NULL){
-        raiz->altura = max(lista_altura_no(raiz->esq), lista_altura_no(raiz->dir)) + 1;
-        int FB = lista_altura_no(raiz->esq) - lista_altura_no(raiz->dir);
+        raiz->altura = max(lista_altura_no(no_esq(raiz)), lista_altura_no(no_dir(raiz))) + 1;
+        int FB = lista_altura_no(no_esq(raiz)) - lista_altura_no(no_dir(raiz));
 
         if (FB == -2){
-            if (lista_altura_no(raiz->dir->esq) - lista_altura_no(raiz->dir->dir) <= 0)
+            if (lista_altura_no(no_esq(no_dir(raiz))) - lista_altura_no(no_dir(no_dir(raiz))) <= 0)
                 raiz = rodar_esquerda(raiz);
             else
                 raiz = rodar_direita_esquerda(raiz);
         } else if (FB == 2){
-            if (lista_altura_no(raiz->esq->esq) - lista_altura_no(raiz->esq->dir) >= 0)
+            if (lista_altura_no(no_esq(no_esq(raiz))) - lista_altura_no(no_dir(no_esq(raiz))) >= 0)
                 raiz = rodar_direita(raiz);
             else
                 raiz = rodar_esquerda_direita(raiz);
@@ -278,6 +545,24 @@ NO* lista_remover_no(NO* raiz, char* chave, PACIENTE** pac){
     return raiz;
 }
 
+/**
+ * @brief Tira do cache CLOCK um paciente que saiu da árvore.
+ * @details O identificador é liberado com o paciente e pode ser reaproveitado
+ * por outro: a posição dele é esvaziada para que o CLOCK não descarte o novo
+ * dono do identificador.
+ * @param l Ponteiro para a lista.
+ * @param id Identificador do paciente retirado.
+ */
+static void lista_cache_retirar(LISTA* l, PACIENTE_ID id){
+    registro_desligar_marcas(id, REGISTRO_EM_CACHE | REGISTRO_REFERENCIADO);
+    for (size_t i = 0; i < l->n_relogio; i++){
+        if (l->relogio[i] == id){
+            l->relogio[i] = PACIENTE_ID_INVALIDO;
+            break;
+        }
+    }
+}
+
 /**
  * @brief Remove um paciente específico da lista.
  * @param l Ponteiro para a lista.
@@ -286,10 +571,15 @@ NO* lista_remover_no(NO* raiz, char* chave, PACIENTE** pac){
  */
 PACIENTE* lista_remover(LISTA* l, PACIENTE* p){
     if (l != NULL && !(lista_vazia(l))){
-        PACIENTE* paciente_recuperado = NULL;
-        // Passa a string CPF direto
-        l->raiz = lista_remover_no(l->raiz, paciente_obter_cpf(p), &paciente_recuperado);
-        return paciente_recuperado;
+        PACIENTE_ID recuperado = PACIENTE_ID_INVALIDO;
+        uint64_t chave = registro_cpf(paciente_obter_id(p));
+        l->raiz = lista_remover_no(l->raiz, chave, &recuperado);
+        if (recuperado != PACIENTE_ID_INVALIDO){
+            // A posição no cache fica vazia e é reaproveitada pelo CLOCK
+            lista_cache_retirar(l, recuperado);
+            lista_marcar_removido(l, chave);
+        }
+        return registro_paciente(recuperado);
     }
     return NULL;
 }
@@ -298,24 +588,24 @@ PACIENTE* lista_remover(LISTA* l, PACIENTE* p){
  * @brief Remove o "último" paciente da lista (aquele com o maior CPF).
  * @note Esta função percorre até a extrema direita, mas chama a remoção 
  * a partir da raiz para garantir o rebalanceamento de toda a árvore.
+ * No modo sob demanda considera apenas os pacientes já em memória.
  * @param l Ponteiro para a lista.
  * @return PACIENTE* Ponteiro do paciente removido.
  */
 PACIENTE* lista_remover_ultimo(LISTA* l){
-    if (l != NULL && !(lista_vazia(l))){
-        PACIENTE* paciente_recuperado = NULL;
+    if (l != NULL && l->raiz != NULL){
+        PACIENTE_ID recuperado = PACIENTE_ID_INVALIDO;
         NO* atual = l->raiz;
         
-        while (atual->dir != NULL){
-            atual = atual->dir;
+        while (no_dir(atual) != NULL){
+            atual = no_dir(atual);
         }
-        
-        char cpf_ultimo[16]; // Buffer seguro para guardar o CPF
-        strcpy(cpf_ultimo, paciente_obter_cpf(atual->pac));
 
-        l->raiz = lista_remover_no(l->raiz, cpf_ultimo, &paciente_recuperado);
+        l->raiz = lista_remover_no(l->raiz, registro_cpf(atual->id), &recuperado);
+        if (recuperado != PACIENTE_ID_INVALIDO)
+            lista_cache_retirar(l, recuperado);
         
-        return paciente_recuperado;
+        return registro_paciente(recuperado);
     }
     return NULL;
 }
@@ -325,11 +615,13 @@ PACIENTE* lista_remover_ultimo(LISTA* l){
 /**
  * @brief Verifica se a lista está vazia.
  * @param l Ponteiro para a lista.
- * @return true Se a raiz for NULL.
+ * @return true Se a raiz for NULL (e, no modo sob demanda, todo o arquivo tiver sido removido).
  * @return false Caso contrário.
  */
 bool lista_vazia(LISTA* l){
     if (l != NULL){
+        if (l->arquivo != NULL && arquivo_registros(l->arquivo) > l->n_removidos)
+            return false;
         return l->raiz == NULL;
     }
     return true;
@@ -357,28 +649,223 @@ bool lista_cheia(LISTA* l){
 /**
  * @brief Busca recursiva interna de um nó pelo CPF.
  * @param raiz Raiz da subárvore.
- * @param cpf String do CPF a buscar.
+ * @param cpf CPF empacotado a buscar.
  * @param p Retorno por referência do paciente encontrado.
  * @return NO* O nó contendo o paciente ou NULL se não encontrado.
  */
-NO* lista_buscar_no(NO* raiz, char* cpf, PACIENTE** p){
+NO* lista_buscar_no(NO* raiz, uint64_t cpf, PACIENTE** p){
     if (raiz == NULL)
         return NULL;
     
-    int cmp = strcmp(cpf, paciente_obter_cpf(raiz->pac));
+    uint64_t atual = registro_cpf(raiz->id);
     
-    if (cmp == 0){
-        *p = raiz->pac;
+    if (cpf == atual){
+        *p = registro_paciente(raiz->id);
         return raiz;
     }
-    else if (cmp < 0)
-        return lista_buscar_no(raiz->esq, cpf, p);
+    else if (cpf < atual)
+        return lista_buscar_no(no_esq(raiz), cpf, p);
     else
-        return lista_buscar_no(raiz->dir, cpf, p);
+        return lista_buscar_no(no_dir(raiz), cpf, p);
+}
+
+// --- Modo sob demanda ---
+
+/**
+ * @brief Liga o modo sob demanda: os pacientes passam a vir do arquivo de dados.
+ * @details A lista assume o arquivo (fechado em lista_apagar()). Só o índice
+ * de blocos é consultado na abertura; os blocos são lidos no primeiro acesso
+ * a um de seus pacientes.
+ * @param l Ponteiro para a lista (vazia).
+ * @param arq Arquivo de dados da lista, aberto com índice válido.
+ * @param limite Quantidade máxima de pacientes hidratados mantidos em cache.
+ * @return true se o modo foi ligado.
+ */
+bool lista_vincular_arquivo(LISTA* l, ARQUIVO* arq, size_t limite){
+    if (l == NULL || arq == NULL || l->arquivo != NULL || l->raiz != NULL || limite == 0)
+        return false;
+
+    l->relogio = malloc(limite * sizeof(PACIENTE_ID));
+    if (l->relogio == NULL)
+        return false;
+
+    l->arquivo = arq;
+    l->limite = limite;
+    l->n_relogio = 0;
+    l->ponteiro = 0;
+    return true;
+}
+
+/**
+ * @brief Define o filtro de Bloom consultado antes de cada busca.
+ * @details A lista assume o filtro (liberado em lista_apagar()). O filtro
+ * precisa conter todos os CPFs já presentes; os inseridos depois são
+ * acrescentados por lista_inserir().
+ * @param l Ponteiro para a lista.
+ * @param filtro Filtro dos CPFs cadastrados.
+ */
+void lista_definir_filtro(LISTA* l, BLOOM* filtro){
+    if (l != NULL){
+        bloom_apagar(&l->filtro);
+        l->filtro = filtro;
+    }
+}
+
+/**
+ * @brief Guarda a raiz da árvore e o filtro no heap persistente.
+ * @details Chamada no encerramento, depois do último SAVE. A lista precisa
+ * estar no modo completo: no modo sob demanda a árvore não contém todos os
+ * pacientes.
+ * @param l Ponteiro para a lista.
+ * @return true se a raiz foi guardada.
+ */
+bool lista_persistir(LISTA* l){
+    LISTA_RAIZ* raiz = heap_raiz(HEAP_RAIZ_LISTA);
+    if (l == NULL || raiz == NULL || l->arquivo != NULL)
+        return false;
+
+    raiz->raiz = heap_referencia(l->raiz);
+    bloom_persistir(l->filtro);
+    return true;
+}
+
+/**
+ * @brief Retoma a árvore e o filtro guardados por lista_persistir().
+ * @param l Ponteiro para a lista (vazia).
+ * @return true se a lista foi retomada.
+ */
+bool lista_restaurar(LISTA* l){
+    LISTA_RAIZ* raiz = heap_raiz(HEAP_RAIZ_LISTA);
+    if (l == NULL || raiz == NULL || l->raiz != NULL || l->arquivo != NULL)
+        return false;
+
+    l->raiz = heap_ponteiro(raiz->raiz);
+    lista_definir_filtro(l, bloom_restaurar());
+    return true;
+}
+
+/**
+ * @brief Relê a raiz da árvore e o filtro guardados no heap.
+ * @details No heap compartilhado, outro processo pode ter alterado a árvore
+ * desde a última leitura. A lista precisa estar no modo completo.
+ * @param l Ponteiro para a lista.
+ * @return true se a lista foi relida.
+ */
+bool lista_sincronizar(LISTA* l){
+    LISTA_RAIZ* raiz = heap_raiz(HEAP_RAIZ_LISTA);
+    if (l == NULL || raiz == NULL || l->arquivo != NULL)
+        return false;
+
+    l->raiz = heap_ponteiro(raiz->raiz);
+    if (l->filtro == NULL)
+        lista_definir_filtro(l, bloom_restaurar());
+    else
+        bloom_sincronizar(l->filtro);
+    return true;
+}
+
+/**
+ * @brief Obtém o filtro de Bloom da lista.
+ * @param l Ponteiro para a lista.
+ * @return BLOOM* Filtro ou NULL se não houver.
+ */
+BLOOM* lista_filtro(LISTA* l){
+    return l != NULL ? l->filtro : NULL;
+}
+
+/**
+ * @brief Tira da memória um paciente hidratado e não alterado.
+ * @param l Ponteiro para a lista.
+ * @param id Identificador do paciente.
+ */
+static void lista_descartar(LISTA* l, PACIENTE_ID id){
+    PACIENTE_ID recuperado = PACIENTE_ID_INVALIDO;
+    l->raiz = lista_remover_no(l->raiz, registro_cpf(id), &recuperado);
+
+    PACIENTE* pac = registro_paciente(recuperado);
+    paciente_apagar(&pac);
+}
+
+/**
+ * @brief Coloca um paciente recém-hidratado no cache, substituindo outro pelo CLOCK.
+ * @details O ponteiro percorre as posições: pacientes referenciados desde a
+ * última passagem ganham mais uma volta, pacientes na fila são pulados e
+ * pacientes alterados deixam o cache (ficam na árvore até o encerramento).
+ * Posições esvaziadas pela remoção do paciente (ver lista_cache_retirar())
+ * são reaproveitadas direto; o paciente inserido nunca é descartado.
+ * @param l Ponteiro para a lista.
+ * @param id Identificador do paciente hidratado.
+ */
+static void lista_cache_inserir(LISTA* l, PACIENTE_ID id){
+    registro_ligar_marcas(id, REGISTRO_EM_CACHE | REGISTRO_REFERENCIADO);
+
+    if (l->n_relogio < l->limite){
+        l->relogio[l->n_relogio++] = id;
+        return;
+    }
+
+    // Duas voltas bastam: a primeira apaga as referências
+    for (size_t passo = 0; passo < 2 * l->limite; passo++){
+        size_t pos = l->ponteiro;
+        PACIENTE_ID atual = l->relogio[pos];
+        l->ponteiro = (pos + 1) % l->limite;
+        if (atual == PACIENTE_ID_INVALIDO || atual == id){
+            l->relogio[pos] = id;
+            return;
+        }
+
+        uint8_t marcas = registro_marcas(atual);
+        if (marcas & REGISTRO_EM_CACHE){
+            if (marcas & REGISTRO_ALTERADO){
+                registro_desligar_marcas(atual, REGISTRO_EM_CACHE | REGISTRO_REFERENCIADO);
+            } else if (registro_na_fila(atual)){
+                continue;
+            } else if (marcas & REGISTRO_REFERENCIADO){
+                registro_desligar_marcas(atual, REGISTRO_REFERENCIADO);
+                continue;
+            } else {
+                lista_descartar(l, atual);
+            }
+        }
+
+        l->relogio[pos] = id;
+        return;
+    }
+
+    // Todo o cache está na fila: o paciente fica na árvore fora do cache
+    registro_desligar_marcas(id, REGISTRO_EM_CACHE | REGISTRO_REFERENCIADO);
+}
+
+/**
+ * @brief Reconstrói um paciente do arquivo de dados e o insere na árvore.
+ * @param l Ponteiro para a lista (no modo sob demanda).
+ * @param chave CPF empacotado.
+ * @return PACIENTE* Paciente hidratado ou NULL se não estiver no arquivo.
+ */
+static PACIENTE* lista_hidratar(LISTA* l, uint64_t chave){
+    const char* bytes;
+    uint32_t n;
+
+    if (lista_removido(l, chave, NULL) || !arquivo_buscar(l->arquivo, chave, &bytes, &n))
+        return NULL;
+
+    PACIENTE* pac = paciente_de_bytes(bytes, n);
+    if (pac == NULL)
+        return NULL;
+
+    PACIENTE_ID id = paciente_obter_id(pac);
+    registro_desligar_marcas(id, REGISTRO_ALTERADO);
+    l->raiz = lista_inserir_no(l->raiz, id, chave);
+    lista_cache_inserir(l, id);
+    return pac;
 }
 
 /**
  * @brief Busca um paciente na lista pelo CPF.
+ * @note No modo sob demanda, um paciente ainda não usado é hidratado do
+ * arquivo e pode tirar da memória outro paciente não alterado: ponteiros
+ * obtidos em buscas anteriores só continuam válidos se o paciente estiver
+ * na fila ou tiver sido marcado como alterado.
  * @param l Ponteiro para a lista.
  * @param cpf String do CPF.
  * @return PACIENTE* Ponteiro para o paciente encontrado ou NULL.
@@ -386,8 +873,21 @@ NO* lista_buscar_no(NO* raiz, char* cpf, PACIENTE** p){
 PACIENTE* lista_buscar(LISTA* l, char* cpf){
     if (l != NULL){
         PACIENTE* paciente_buscado = NULL;
-        // Passa a string CPF direto
-        lista_buscar_no(l->raiz, cpf, &paciente_buscado);
+        uint64_t chave = (cpf != NULL && strlen(cpf) == 11) ? cpf_empacotar(cpf) : CPF_INVALIDO;
+        if (chave == CPF_INVALIDO || !bloom_talvez_contem(l->filtro, chave))
+            return NULL;
+
+        lista_buscar_no(l->raiz, chave, &paciente_buscado);
+        if (paciente_buscado != NULL){
+            PACIENTE_ID id = paciente_obter_id(paciente_buscado);
+            if (registro_marcas(id) & REGISTRO_EM_CACHE)
+                registro_ligar_marcas(id, REGISTRO_REFERENCIADO);
+        } else if (l->arquivo != NULL){
+            paciente_buscado = lista_hidratar(l, chave);
+        }
+
+        if (paciente_buscado == NULL)
+            bloom_registrar_falso_positivo(l->filtro);
         return paciente_buscado;
     }
     return NULL;
@@ -404,9 +904,9 @@ PACIENTE* lista_buscar(LISTA* l, char* cpf){
  */
 void lista_em_ordem(NO* raiz, AcaoPaciente acao, void* contexto){
     if (raiz != NULL){
-        lista_em_ordem(raiz->esq, acao, contexto);
-        acao(raiz->pac, contexto);
-        lista_em_ordem(raiz->dir, acao, contexto);
+        lista_em_ordem(no_esq(raiz), acao, contexto);
+        acao(registro_paciente(raiz->id), contexto);
+        lista_em_ordem(no_dir(raiz), acao, contexto);
     }
 }
 
@@ -418,35 +918,195 @@ void lista_em_ordem(NO* raiz, AcaoPaciente acao, void* contexto){
  */
 void lista_pre_ordem(NO* raiz, AcaoPaciente acao, void* contexto){
     if (raiz != NULL){
-        acao(raiz->pac, contexto); 
-        lista_pre_ordem(raiz->esq, acao, contexto); 
-        lista_pre_ordem(raiz->dir, acao, contexto);
+        acao(registro_paciente(raiz->id), contexto); 
+        lista_pre_ordem(no_esq(raiz), acao, contexto); 
+        lista_pre_ordem(no_dir(raiz), acao, contexto);
     }
 }
 
 /**
- * @brief Função de callback auxiliar para imprimir os dados de um paciente.
- * @param p O paciente atual.
- * @param contexto Não utilizado neste caso (NULL).
+ * @brief Auxiliar de lista_divisores(): CPFs dos nós acima de uma profundidade, em ordem.
  */
-void acao_imprimir_lista(PACIENTE* p, void* contexto){
-    char* estado;
-    if (paciente_esta_na_fila(p))
-        estado = "NA FILA DE ATENDIMENTO";
-    else
-        estado = "FORA DA FILA DE ATENDIMENTO";
-    
-    printf("NOME: %s\nCPF: %s\nESTADO: %s\n\n", paciente_obter_nome(p), paciente_obter_cpf(p), estado);  
+static void lista_divisores_aux(NO* raiz, int profundidade, uint64_t* chaves, size_t* n){
+    if (raiz != NULL && profundidade > 0){
+        lista_divisores_aux(no_esq(raiz), profundidade - 1, chaves, n);
+        chaves[(*n)++] = registro_cpf(raiz->id);
+        lista_divisores_aux(no_dir(raiz), profundidade - 1, chaves, n);
+    }
 }
 
 /**
- * @brief Exibe todos os pacientes da lista no terminal em ordem de CPF.
+ * @brief CPFs que dividem a árvore em subárvores independentes.
+ * @details Devolve, em ordem crescente, os CPFs dos nós dos primeiros níveis
+ * (no máximo max). Os intervalos entre divisores consecutivos cobrem
+ * subárvores disjuntas e, com a árvore balanceada, de tamanhos parecidos:
+ * cada um pode ser percorrido por uma thread com lista_percorrer_intervalo().
+ * @note Só considera a árvore (no modo sob demanda, os pacientes em memória).
  * @param l Ponteiro para a lista.
+ * @param chaves Destino dos CPFs empacotados.
+ * @param max Capacidade de chaves.
+ * @return Quantidade de divisores escritos.
  */
-void lista_mostrar(LISTA* l){
-    if (l != NULL){
-        printf("Lista de Pacientes (em ordem crescente de CPF):\n");
-        lista_em_ordem(l->raiz, acao_imprimir_lista, NULL);    
+size_t lista_divisores(LISTA* l, uint64_t* chaves, size_t max){
+    size_t n = 0;
+    if (l != NULL && chaves != NULL){
+        // Níveis completos que cabem em max: 2^profundidade - 1 nós
+        int profundidade = 0;
+        while (profundidade < 62 && ((size_t)2 << profundidade) - 1 <= max)
+            profundidade++;
+        lista_divisores_aux(l->raiz, profundidade, chaves, &n);
+    }
+    return n;
+}
+
+/**
+ * @brief Auxiliar de lista_percorrer_intervalo(): poda as subárvores fora do intervalo.
+ * @details Limite NULL = sem limite daquele lado. À esquerda de um nó do
+ * intervalo só falta conferir o início, e à direita só o fim; uma subárvore
+ * já sem limites é percorrida sem ler nenhum CPF.
+ */
+static void lista_em_ordem_intervalo(NO* raiz, const uint64_t* de, const uint64_t* ate, AcaoPaciente acao, void* contexto){
+    while (raiz != NULL){
+        if (de == NULL && ate == NULL){
+            lista_em_ordem(raiz, acao, contexto);
+            return;
+        }
+
+        uint64_t chave = registro_cpf(raiz->id);
+        if (de != NULL && chave < *de){
+            raiz = no_dir(raiz);
+        } else if (ate != NULL && chave >= *ate){
+            raiz = no_esq(raiz);
+        } else {
+            lista_em_ordem_intervalo(no_esq(raiz), de, NULL, acao, contexto);
+            acao(registro_paciente(raiz->id), contexto);
+            raiz = no_dir(raiz);
+            de = NULL;
+        }
+    }
+}
+
+/**
+ * @brief Percorre em ordem crescente os pacientes com CPF em [de, ate), sem alterar a árvore.
+ * @note Só lê a árvore: várias threads podem percorrer intervalos ao mesmo
+ * tempo. No modo sob demanda, os pacientes que só existem no arquivo não são
+ * visitados (ver lista_percorrer_registros()).
+ * @param l Ponteiro para a lista.
+ * @param de Primeiro CPF empacotado do intervalo.
+ * @param ate CPF empacotado logo após o intervalo.
+ * @param acao Função executada para cada paciente.
+ * @param contexto Parâmetro extra repassado à função.
+ */
+void lista_percorrer_intervalo(LISTA* l, uint64_t de, uint64_t ate, AcaoPaciente acao, void* contexto){
+    if (l != NULL && acao != NULL)
+        lista_em_ordem_intervalo(l->raiz, &de, &ate, acao, contexto);
+}
+
+/**
+ * @brief Percorre todos os pacientes em ordem crescente de CPF, sem alterar a árvore.
+ * @details No modo sob demanda, a árvore é intercalada com os blocos do
+ * arquivo: o paciente em memória prevalece sobre o do arquivo e os removidos
+ * são pulados. Os pacientes que só existem no arquivo são entregues como
+ * bytes (paciente NULL), direto do mapeamento.
+ * @param l Ponteiro para a lista.
+ * @param acao Função executada para cada registro.
+ * @param contexto Parâmetro extra repassado à função.
+ */
+void lista_percorrer_registros(LISTA* l, AcaoRegistro acao, void* contexto){
+    if (l == NULL || acao == NULL)
+        return;
+
+    // Cursor em ordem sobre a árvore, com pilha explícita
+    NO* pilha[LISTA_MAX_ALTURA];
+    int topo = 0;
+    NO* atual = l->raiz;
+
+    while (atual != NULL){
+        pilha[topo++] = atual;
+        atual = no_esq(atual);
+    }
+
+    // Área própria: a ação pode hidratar pacientes, o que usa a área do arquivo
+    char area[ARQUIVO_TAM_BLOCO];
+    uint64_t n_blocos = l->arquivo != NULL ? arquivo_blocos(l->arquivo) : 0;
+    for (uint64_t i = 0; i < n_blocos; i++){
+        const char* dados;
+        uint32_t tamanho, pos = 0;
+        if (!arquivo_bloco(l->arquivo, i, area, &dados, &tamanho))
+            continue;
+
+        uint64_t chave;
+        const char* bytes;
+        uint32_t n;
+        while (arquivo_proximo(dados, tamanho, &pos, &chave, &bytes, &n)){
+            bool em_memoria = false;
+
+            while (topo > 0 && registro_cpf(pilha[topo - 1]->id) <= chave){
+                NO* no = pilha[--topo];
+                em_memoria = em_memoria || registro_cpf(no->id) == chave;
+                acao(registro_paciente(no->id), registro_cpf(no->id), NULL, 0, contexto);
+
+                for (atual = no_dir(no); atual != NULL; atual = no_esq(atual))
+                    pilha[topo++] = atual;
+            }
+
+            if (!em_memoria && !lista_removido(l, chave, NULL))
+                acao(NULL, chave, bytes, n, contexto);
+        }
+    }
+
+    while (topo > 0){
+        NO* no = pilha[--topo];
+        acao(registro_paciente(no->id), registro_cpf(no->id), NULL, 0, contexto);
+
+        for (atual = no_dir(no); atual != NULL; atual = no_esq(atual))
+            pilha[topo++] = atual;
+    }
+}
+
+/**
+ * @brief Contexto de lista_percorrer() no modo sob demanda.
+ */
+typedef struct percurso_{
+    AcaoPaciente acao;
+    void* contexto;
+} PERCURSO;
+
+/**
+ * @brief Callback de lista_percorrer_registros(): entrega um paciente, hidratado só durante a chamada.
+ */
+static void lista_percorrer_aux(PACIENTE* p, uint64_t chave, const char* bytes, uint32_t tamanho, void* contexto){
+    (void)chave;
+    PERCURSO* percurso = (PERCURSO*)contexto;
+
+    if (p != NULL){
+        percurso->acao(p, percurso->contexto);
+        return;
+    }
+
+    PACIENTE* temporario = paciente_de_bytes(bytes, tamanho);
+    if (temporario != NULL){
+        percurso->acao(temporario, percurso->contexto);
+        paciente_apagar(&temporario);
+    }
+}
+
+/**
+ * @brief Percorre todos os pacientes em ordem crescente de CPF, sem alterar a árvore.
+ * @note No modo sob demanda, os pacientes que só existem no arquivo são
+ * reconstruídos para a chamada e apagados logo depois.
+ * @param l Ponteiro para a lista.
+ * @param acao Função executada para cada paciente.
+ * @param contexto Parâmetro extra repassado à função.
+ */
+void lista_percorrer(LISTA* l, AcaoPaciente acao, void* contexto){
+    if (l != NULL && acao != NULL){
+        if (l->arquivo == NULL){
+            lista_em_ordem(l->raiz, acao, contexto);
+        } else {
+            PERCURSO percurso = { acao, contexto };
+            lista_percorrer_registros(l, lista_percorrer_aux, &percurso);
+        }
     }
 }
 
@@ -456,10 +1116,11 @@ void lista_mostrar(LISTA* l){
  */
 void lista_apagar_aux(NO* raiz){
     if (raiz != NULL){
-        lista_apagar_aux(raiz->esq);
-        lista_apagar_aux(raiz->dir);
-        paciente_apagar(&raiz->pac); 
-        free(raiz);
+        lista_apagar_aux(no_esq(raiz));
+        lista_apagar_aux(no_dir(raiz));
+        PACIENTE* pac = registro_paciente(raiz->id);
+        paciente_apagar(&pac); 
+        heap_liberar(raiz);
     }
 }
 
@@ -470,6 +1131,10 @@ void lista_apagar_aux(NO* raiz){
 void lista_apagar(LISTA** l){
     if (*l != NULL){
         lista_apagar_aux((*l)->raiz);
+        arquivo_fechar(&(*l)->arquivo);
+        bloom_apagar(&(*l)->filtro);
+        free((*l)->removidos);
+        free((*l)->relogio);
         free(*l);
         *l = NULL;
     }
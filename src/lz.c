@@ -0,0 +1,204 @@
+/**
+ * @file lz.c
+ * @brief Compressão LZ77 de blocos pequenos, sem bibliotecas externas.
+ * @details Usada nos blocos dos arquivos de dados (ver arquivo.c). O formato
+ * segue a ideia do LZ4: uma sequência de trechos
+ *
+ *      [FICHA][LITERAIS...][DISTÂNCIA (uint16)][EXTENSÃO...]
+ *
+ * em que os 4 bits altos da FICHA são a quantidade de literais e os 4 baixos
+ * o comprimento da repetição menos LZ_MIN_REPETICAO. O valor 15 indica que
+ * o comprimento continua em bytes seguintes (somados até um byte < 255). O
+ * último trecho tem só literais e termina junto com a entrada.
+ *
+ * A compressão é gulosa, com uma tabela de hash de 4 bytes na pilha: não há
+ * estado global, então várias threads podem comprimir ao mesmo tempo. A
+ * descompressão confere todos os limites e recusa entradas malformadas.
+ */
+
+#include "../include/lz.h"
+
+#define LZ_MIN_REPETICAO 4  ///< Menor repetição codificada
+#define LZ_BITS_HASH 12     ///< Tabela de 4096 posições
+#define LZ_EXTENSAO 15      ///< Valor da ficha que continua o comprimento em bytes seguintes
+
+/**
+ * @brief Lê 4 bytes sem exigir alinhamento.
+ */
+static inline uint32_t lz_ler32(const char* p){
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+/**
+ * @brief Posição na tabela de hash para os 4 bytes em p.
+ */
+static inline uint32_t lz_hash(const char* p){
+    return (lz_ler32(p) * 2654435761u) >> (32 - LZ_BITS_HASH);
+}
+
+/**
+ * @brief Grava o restante de um comprimento que não coube na ficha.
+ * @return false se não houver espaço no destino.
+ */
+static bool lz_gravar_extensao(char** saida, const char* fim, uint32_t resto){
+    while (resto >= 255){
+        if (*saida >= fim) return false;
+        *(*saida)++ = (char)255;
+        resto -= 255;
+    }
+    if (*saida >= fim) return false;
+    *(*saida)++ = (char)resto;
+    return true;
+}
+
+/**
+ * @brief Grava um trecho: literais seguidos (opcionalmente) de uma repetição.
+ * @param saida Posição atual no destino; avança.
+ * @param fim Fim do destino.
+ * @param literais Início dos literais.
+ * @param n_literais Quantidade de literais.
+ * @param distancia Distância da repetição (0 = último trecho, sem repetição).
+ * @param comprimento Comprimento da repetição.
+ * @return false se não houver espaço no destino.
+ */
+static bool lz_gravar_trecho(char** saida, const char* fim, const char* literais, uint32_t n_literais,
+                             uint32_t distancia, uint32_t comprimento){
+    if (*saida >= fim) return false;
+
+    uint32_t resto = distancia ? comprimento - LZ_MIN_REPETICAO : 0;
+    char* ficha = (*saida)++;
+    *ficha = (char)(((n_literais < LZ_EXTENSAO ? n_literais : LZ_EXTENSAO) << 4) |
+                    (resto < LZ_EXTENSAO ? resto : LZ_EXTENSAO));
+
+    if (n_literais >= LZ_EXTENSAO && !lz_gravar_extensao(saida, fim, n_literais - LZ_EXTENSAO))
+        return false;
+    if ((size_t)(fim - *saida) < n_literais)
+        return false;
+    memcpy(*saida, literais, n_literais);
+    *saida += n_literais;
+
+    if (distancia == 0)
+        return true;
+
+    if (fim - *saida < 2) return false;
+    *(*saida)++ = (char)(distancia & 0xFF);
+    *(*saida)++ = (char)(distancia >> 8);
+    return resto < LZ_EXTENSAO || lz_gravar_extensao(saida, fim, resto - LZ_EXTENSAO);
+}
+
+/**
+ * @brief Comprime um trecho de memória.
+ * @param origem Bytes a comprimir.
+ * @param tamanho Quantidade de bytes (até LZ_MAX_ENTRADA).
+ * @param destino Onde os bytes comprimidos são gravados.
+ * @param capacidade Espaço disponível em destino.
+ * @return uint32_t Bytes comprimidos, ou 0 se não couberem na capacidade
+ * (o chamador grava os bytes sem compressão).
+ */
+uint32_t lz_comprimir(const char* origem, uint32_t tamanho, char* destino, uint32_t capacidade){
+    if (origem == NULL || destino == NULL || tamanho == 0 || tamanho > LZ_MAX_ENTRADA)
+        return 0;
+
+    uint16_t tabela[1 << LZ_BITS_HASH]; // posição + 1 (0 = vazia)
+    memset(tabela, 0, sizeof(tabela));
+
+    char* saida = destino;
+    const char* fim = destino + capacidade;
+    uint32_t ancora = 0, i = 0;
+
+    while (i + LZ_MIN_REPETICAO <= tamanho){
+        uint32_t h = lz_hash(origem + i);
+        uint32_t candidato = tabela[h];
+        tabela[h] = (uint16_t)(i + 1);
+
+        if (candidato == 0 || lz_ler32(origem + candidato - 1) != lz_ler32(origem + i)){
+            i++;
+            continue;
+        }
+
+        uint32_t inicio = candidato - 1;
+        uint32_t comprimento = LZ_MIN_REPETICAO;
+        while (i + comprimento < tamanho && origem[inicio + comprimento] == origem[i + comprimento])
+            comprimento++;
+
+        if (!lz_gravar_trecho(&saida, fim, origem + ancora, i - ancora, i - inicio, comprimento))
+            return 0;
+
+        i += comprimento;
+        ancora = i;
+    }
+
+    if (!lz_gravar_trecho(&saida, fim, origem + ancora, tamanho - ancora, 0, 0))
+        return 0;
+    return (uint32_t)(saida - destino);
+}
+
+/**
+ * @brief Lê um comprimento continuado em bytes seguintes.
+ * @return false se a entrada terminar antes.
+ */
+static bool lz_ler_extensao(const unsigned char** entrada, const unsigned char* fim, uint32_t* valor){
+    unsigned char b;
+    do {
+        if (*entrada >= fim) return false;
+        b = *(*entrada)++;
+        *valor += b;
+    } while (b == 255);
+    return true;
+}
+
+/**
+ * @brief Descomprime um trecho gravado por lz_comprimir().
+ * @param origem Bytes comprimidos.
+ * @param tamanho Quantidade de bytes comprimidos.
+ * @param destino Onde os bytes originais são gravados.
+ * @param esperado Tamanho original (capacidade de destino).
+ * @return true se a entrada é válida e produziu exatamente `esperado` bytes.
+ */
+bool lz_descomprimir(const char* origem, uint32_t tamanho, char* destino, uint32_t esperado){
+    if (origem == NULL || destino == NULL)
+        return false;
+
+    const unsigned char* entrada = (const unsigned char*)origem;
+    const unsigned char* fim = entrada + tamanho;
+    uint32_t saida = 0;
+
+    while (entrada < fim){
+        unsigned char ficha = *entrada++;
+
+        uint32_t n_literais = ficha >> 4;
+        if (n_literais == LZ_EXTENSAO && !lz_ler_extensao(&entrada, fim, &n_literais))
+            return false;
+        if ((size_t)(fim - entrada) < n_literais || esperado - saida < n_literais)
+            return false;
+        memcpy(destino + saida, entrada, n_literais);
+        entrada += n_literais;
+        saida += n_literais;
+
+        // Último trecho: só literais
+        if (entrada == fim)
+            break;
+
+        if (fim - entrada < 2) return false;
+        uint32_t distancia = entrada[0] | ((uint32_t)entrada[1] << 8);
+        entrada += 2;
+
+        uint32_t comprimento = ficha & 0x0F;
+        if (comprimento == LZ_EXTENSAO && !lz_ler_extensao(&entrada, fim, &comprimento))
+            return false;
+        comprimento += LZ_MIN_REPETICAO;
+
+        if (distancia == 0 || distancia > saida || esperado - saida < comprimento)
+            return false;
+
+        // Byte a byte: a repetição pode sobrepor o próprio trecho copiado
+        const char* de = destino + saida - distancia;
+        for (uint32_t k = 0; k < comprimento; k++)
+            destino[saida + k] = de[k];
+        saida += comprimento;
+    }
+
+    return saida == esperado;
+}
@@ -0,0 +1,137 @@
+/**
+ * @file mapa.c
+ * @brief Acesso somente-leitura a um arquivo inteiro através de `mmap()`.
+ * @details O conteúdo do arquivo fica disponível como um único bloco de memória,
+ * sem chamadas de leitura por registro. O kernel é avisado de que o acesso será
+ * sequencial (`MADV_SEQUENTIAL`), o que aumenta a leitura antecipada.
+ *
+ * No Windows o arquivo é lido de uma vez para um buffer alocado, mantendo a
+ * mesma interface.
+ */
+
+#include "../include/mapa.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @struct mapa_
+ * @brief Região de memória com o conteúdo do arquivo.
+ */
+struct mapa_ {
+    char* dados;      /**< Início do conteúdo (NULL para arquivo vazio). */
+    size_t tamanho;   /**< Tamanho do arquivo em bytes. */
+};
+
+/**
+ * @brief Mapeia um arquivo inteiro para leitura.
+ * @param caminho Caminho do arquivo.
+ * @return MAPA* Mapeamento ou NULL se o arquivo não existir/não puder ser lido.
+ */
+MAPA* mapa_abrir(const char* caminho){
+    MAPA* mapa = (MAPA*)malloc(sizeof(MAPA));
+    if (mapa == NULL)
+        return NULL;
+
+    mapa->dados = NULL;
+    mapa->tamanho = 0;
+
+#ifdef _WIN32
+    FILE* fp = fopen(caminho, "rb");
+    if (fp == NULL){
+        free(mapa);
+        return NULL;
+    }
+
+    fseek(fp, 0, SEEK_END);
+    long tamanho = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    if (tamanho > 0){
+        mapa->dados = (char*)malloc(tamanho);
+        if (mapa->dados == NULL || fread(mapa->dados, 1, tamanho, fp) != (size_t)tamanho){
+            free(mapa->dados);
+            free(mapa);
+            fclose(fp);
+            return NULL;
+        }
+        mapa->tamanho = (size_t)tamanho;
+    }
+    fclose(fp);
+#else
+    int fd = open(caminho, O_RDONLY);
+    if (fd < 0){
+        free(mapa);
+        return NULL;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0){
+        close(fd);
+        free(mapa);
+        return NULL;
+    }
+
+    if (info.st_size > 0){
+        void* regiao = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (regiao == MAP_FAILED){
+            close(fd);
+            free(mapa);
+            return NULL;
+        }
+        madvise(regiao, (size_t)info.st_size, MADV_SEQUENTIAL);
+        mapa->dados = (char*)regiao;
+        mapa->tamanho = (size_t)info.st_size;
+    }
+
+    // O mapeamento continua válido depois que o descritor é fechado
+    close(fd);
+#endif
+
+    return mapa;
+}
+
+/**
+ * @brief Início do conteúdo mapeado.
+ * @param mapa Mapeamento.
+ * @return const char* Ponteiro para o primeiro byte ou NULL se o arquivo estiver vazio.
+ */
+const char* mapa_dados(MAPA* mapa){
+    if (mapa != NULL){
+        return mapa->dados;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Tamanho do conteúdo mapeado.
+ * @param mapa Mapeamento.
+ * @return size_t Quantidade de bytes (0 se mapa for NULL).
+ */
+size_t mapa_tamanho(MAPA* mapa){
+    if (mapa != NULL){
+        return mapa->tamanho;
+    }
+    return 0;
+}
+
+/**
+ * @brief Desfaz o mapeamento e libera a estrutura.
+ * @param mapa Endereço do ponteiro do mapeamento (MAPA**).
+ */
+void mapa_fechar(MAPA** mapa){
+    if (mapa != NULL && *mapa != NULL){
+#ifdef _WIN32
+        free((*mapa)->dados);
+#else
+        if ((*mapa)->dados != NULL)
+            munmap((*mapa)->dados, (*mapa)->tamanho);
+#endif
+        free(*mapa);
+        *mapa = NULL;
+    }
+}
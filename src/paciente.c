@@ -1,61 +1,79 @@
 #include "../include/paciente.h"
 #include "../include/historico.h"
+#include "../include/catalogo.h"
+#include "../include/cpf.h"
+#include "../include/heap.h"
+#include "../include/registro.h"
 
 /**
- * @brief Estrutura que representa um paciente.
- * * Armazena os dados principais de um paciente, incluindo seu nome, CPF (usado como
- * chave única) e um ponteiro para seu histórico médico de procedimentos, além de um bool para checar se o 
- * paciente está ou não na fila de espera.
+ * @brief Estrutura que representa os dados "frios" de um paciente.
+ * * Armazena o nome, o CPF em texto e um ponteiro para o histórico médico de
+ * procedimentos. Os dados consultados com frequência (CPF empacotado, estado na
+ * fila, prioridade e chegada) ficam no armazém central (ver registro.c), no
+ * índice dado por `id`.
  */
 struct paciente_
 {
-    char *nome;
-    char *cpf;
-    bool fila;
-    HISTORICO *hist;
+    PACIENTE_ID id;
+    char cpf[12];
+    HEAP_REF nome; ///< Posição do nome (ver heap.h)
+    HEAP_REF hist; ///< Posição do histórico
 };
 
 /**
- * @brief Aloca e inicializa uma nova estrutura PACIENTE com os dados fornecidos.
- * * Esta função cria dinamicamente um novo paciente, alocando memória para a 
- * estrutura e para as strings de nome e CPF. Também cria um histórico médico vazio para o paciente.
- * * @param nome String contendo o nome do paciente.
- * @param cpf String contendo o CPF do paciente.
- * @return Ponteiro para a estrutura PACIENTE alocada ou NULL em caso de erro de alocação.
+ * @brief Nome do paciente.
  */
-PACIENTE *paciente_criar(char nome[], char cpf[])
+static inline char *paciente_nome(const PACIENTE *p)
 {
-    PACIENTE *p = (PACIENTE *)malloc(sizeof(PACIENTE));
-    if (p == NULL)
-        return NULL;
+    return (char *)heap_ponteiro(p->nome);
+}
 
-    // Inicializa as variaveis do TAD
-    p->nome = NULL;
-    p->cpf = NULL;
-    p->hist = NULL;
-    p->fila = false;
+/**
+ * @brief Histórico do paciente.
+ */
+static inline HISTORICO *paciente_historico(const PACIENTE *p)
+{
+    return (HISTORICO *)heap_ponteiro(p->hist);
+}
 
-    // Aloca memória para o nome e copia
-    p->nome = (char *)malloc(strlen(nome) + 1);
-    if (p->nome == NULL)
+/**
+ * @brief Monta um PACIENTE assumindo a posse de um nome já alocado.
+ * * O ponteiro do nome passa a pertencer ao paciente (nenhuma cópia é feita) e o
+ * paciente é registrado no armazém central. Em caso de erro, o nome é liberado
+ * junto com o que já tiver sido alocado.
+ * * @param nome Nome alocado com heap_alocar().
+ * @param cpf CPF com 11 dígitos.
+ * @param registrar false para deixar o registro para paciente_registrar().
+ * @return Ponteiro para a estrutura PACIENTE alocada ou NULL em caso de erro.
+ */
+static PACIENTE *paciente_montar(char *nome, const char *cpf, bool registrar)
+{
+    uint64_t cpf_empacotado = cpf_empacotar(cpf);
+
+    PACIENTE *p = (PACIENTE *)heap_alocar(sizeof(PACIENTE));
+    if (p == NULL || nome == NULL || cpf_empacotado == CPF_INVALIDO)
     {
-        paciente_apagar(&p);
+        heap_liberar(p);
+        heap_liberar(nome);
         return NULL;
     }
-    strcpy(p->nome, nome);
 
-    // Aloca memória para o CPF e copia
-    p->cpf = (char *)malloc(strlen(cpf) + 1);
-    if (p->cpf == NULL)
+    memcpy(p->cpf, cpf, 11);
+    p->cpf[11] = '\0';
+    p->nome = heap_referencia(nome);
+    p->id = PACIENTE_ID_INVALIDO;
+
+    // Cria o histórico
+    HISTORICO *hist = historico_criar();
+    p->hist = heap_referencia(hist);
+    if (hist == NULL)
     {
         paciente_apagar(&p);
         return NULL;
     }
-    strcpy(p->cpf, cpf);
 
-    // Cria o histórico
-    p->hist = historico_criar();
-    if (p->hist == NULL)
+    // Registra os campos quentes no armazém central
+    if (registrar && !paciente_registrar(p))
     {
         paciente_apagar(&p);
         return NULL;
@@ -64,9 +82,48 @@ PACIENTE *paciente_criar(char nome[], char cpf[])
     return p;
 }
 
+/**
+ * @brief Registra no armazém central um paciente criado sem registro.
+ * * Usada pelo LOAD paralelo: os pacientes são montados nas threads e
+ * registrados depois, em sequência, pela thread principal.
+ * * @param paciente Paciente ainda sem identificador.
+ * @return true se o paciente recebeu um identificador.
+ */
+bool paciente_registrar(PACIENTE *paciente)
+{
+    if (paciente == NULL || paciente->id != PACIENTE_ID_INVALIDO)
+        return false;
+
+    paciente->id = registro_alocar(paciente, cpf_empacotar(paciente->cpf));
+    return paciente->id != PACIENTE_ID_INVALIDO;
+}
+
+/**
+ * @brief Aloca e inicializa uma nova estrutura PACIENTE com os dados fornecidos.
+ * * Esta função cria dinamicamente um novo paciente, alocando memória para a 
+ * estrutura e para o nome. Também cria um histórico médico vazio para o paciente
+ * e o registra no armazém central.
+ * * @param nome String contendo o nome do paciente.
+ * @param cpf String contendo o CPF do paciente (11 dígitos).
+ * @return Ponteiro para a estrutura PACIENTE alocada ou NULL em caso de erro.
+ */
+PACIENTE *paciente_criar(char nome[], char cpf[])
+{
+    if (cpf == NULL || strlen(cpf) != 11)
+        return NULL;
+
+    // Aloca memória para o nome e copia
+    char *copia_nome = (char *)heap_alocar(strlen(nome) + 1);
+    if (copia_nome != NULL)
+        strcpy(copia_nome, nome);
+
+    return paciente_montar(copia_nome, cpf, true);
+}
+
 /**
  * @brief Libera toda a memória associada a um paciente.
- * * Desaloca a memória do histórico, do nome, do CPF e da própria estrutura do paciente.
+ * * Desaloca a memória do histórico, do nome e da própria estrutura do paciente,
+ * e devolve seu identificador ao armazém central.
  * Para segurança, o ponteiro original que aponta para o paciente é definido como NULL.
  * * @param paciente Ponteiro para o ponteiro da estrutura PACIENTE a ser apagada.
  * @return true se a liberação foi bem-sucedida, false caso contrário.
@@ -75,10 +132,11 @@ bool paciente_apagar(PACIENTE **paciente)
 {
     if (paciente != NULL && (*paciente) != NULL)
     {
-        historico_apagar(&((*paciente)->hist));
-        free((*paciente)->nome);
-        free((*paciente)->cpf); 
-        free(*paciente);
+        registro_liberar((*paciente)->id);
+        HISTORICO *hist = paciente_historico(*paciente);
+        historico_apagar(&hist);
+        heap_liberar(paciente_nome(*paciente));
+        heap_liberar(*paciente);
         *paciente = NULL;
         return true;
     }
@@ -86,6 +144,21 @@ bool paciente_apagar(PACIENTE **paciente)
     return false;
 }
 
+/**
+ * @brief Obtém o identificador de 32 bits do paciente no armazém central.
+ * * @param paciente Ponteiro para a estrutura PACIENTE.
+ * @return Identificador ou PACIENTE_ID_INVALIDO se o paciente for nulo.
+ */
+PACIENTE_ID paciente_obter_id(PACIENTE *paciente)
+{
+    if (paciente != NULL)
+    {
+        return paciente->id;
+    }
+
+    return PACIENTE_ID_INVALIDO;
+}
+
 /**
  * @brief Obtém o nome de um paciente.
  * * @param paciente Ponteiro para a estrutura PACIENTE.
@@ -95,7 +168,7 @@ char *paciente_obter_nome(PACIENTE *paciente)
 {
     if (paciente != NULL)
     {
-        return paciente->nome;
+        return paciente_nome(paciente);
     }
 
     return NULL;
@@ -123,9 +196,10 @@ char *paciente_obter_cpf(PACIENTE *paciente)
  */
 void paciente_definir_cpf(PACIENTE *paciente, char cpf[])
 {
-    if (paciente != NULL)
+    if (paciente != NULL && cpf_empacotar(cpf) != CPF_INVALIDO)
     {
-        strcpy(paciente->cpf, cpf);
+        memcpy(paciente->cpf, cpf, 11);
+        registro_definir_cpf(paciente->id, cpf_empacotar(cpf));
     }
 }
 
@@ -138,112 +212,245 @@ HISTORICO *paciente_obter_historico(PACIENTE *paciente)
 {
     if (paciente != NULL)
     {
-        return paciente->hist;
+        return paciente_historico(paciente);
     }
 
     return NULL;
 }
 
 /**
- * @brief Serializa os dados de um paciente em uma única string de bytes.
- * * Converte todos os dados do paciente (CPF, nome e procedimentos do histórico)
- * em um buffer contínuo de memória. O formato é:
- * [11 bytes CPF]\0[Nome]\0[Procedimento1]\0[Procedimento2]\0... e por ai vai
+ * @brief Marca o paciente como diferente do que está no arquivo de dados.
+ * * Deve ser chamada por quem altera o histórico. No carregamento sob demanda
+ * (ver lista.c), um paciente alterado fica na memória até o próximo SAVE.
+ * * @param paciente Ponteiro para a estrutura PACIENTE.
+ */
+void paciente_marcar_alterado(PACIENTE *paciente)
+{
+    if (paciente != NULL)
+    {
+        registro_ligar_marcas(paciente->id, REGISTRO_ALTERADO);
+    }
+}
+
+/**
+ * @brief Descreve a serialização de um paciente como segmentos (estilo iovec).
+ * * Nenhum byte é copiado: cada segmento aponta diretamente para a memória do
+ * paciente, e o histórico não é modificado. O formato resultante é:
+ * [11 bytes CPF]\0[Nome]\0[Código1][Código2]... e por ai vai
+ * * Cada código é um inteiro de 32 bits do catálogo de procedimentos (ver catalogo.c),
+ * do procedimento mais antigo para o mais recente. Se o histórico tiver
+ * descrições próprias (ver historico.c), os códigos são seguidos de
+ * [Textos][Rodapé]: o vetor de textos, de tamanho múltiplo de 4, e
+ * HISTORICO_TEXTO_PROPRIO | tamanho dos textos. A quantidade de códigos é
+ * deduzida do tamanho total do registro e do rodapé.
+ * * Os segmentos só são válidos enquanto o paciente não for alterado ou apagado.
  * * @param paciente Ponteiro para o paciente a ser serializado.
- * @param tamanho Ponteiro para um inteiro onde o tamanho total da string alocada será armazenado.
- * @return Ponteiro para a string alocada dinamicamente contendo os dados serializados ou NULL em caso de erro.
+ * @param segmentos Vetor com espaço para PACIENTE_MAX_SEGMENTOS segmentos.
+ * @param tamanho Ponteiro onde será armazenada a soma dos tamanhos dos segmentos.
+ * @return Quantidade de segmentos preenchidos ou 0 em caso de erro.
  */
-char *paciente_para_string(PACIENTE *paciente, int *tamanho)
+int paciente_serializar(PACIENTE *paciente, SEGMENTO segmentos[], int *tamanho)
 {
-    int tam_nome = strlen(paciente->nome);
-    int tam_historico = historico_tamanho(paciente->hist);
+    if (paciente == NULL || segmentos == NULL)
+        return 0;
 
-    HISTORICO *historico_aux = historico_criar();
-    if (historico_aux == NULL)
-        return NULL;
+    int n = 0;
+
+    // CPF (11 bytes) seguido do seu '\0'
+    segmentos[n].base = paciente->cpf;
+    segmentos[n].tamanho = 12;
+    n++;
 
-    // Calcula o tamanho total necessário para o buffer
-    int tamanho_total = 12 + tam_nome + 1; // 11 (CPF) + 1 ('\0') + tam_nome + 1 ('\0')
+    // Nome seguido do seu '\0'
+    segmentos[n].base = paciente_nome(paciente);
+    segmentos[n].tamanho = strlen(paciente_nome(paciente)) + 1;
+    n++;
 
-    // Itera sobre o histórico para somar o tamanho de cada procedimento
-    for (int i = 0; i < tam_historico; i++)
+    // Códigos do histórico, direto do vetor interno
+    HISTORICO *hist = paciente_historico(paciente);
+    int tam_historico = historico_tamanho(hist);
+    if (tam_historico > 0)
     {
-        char *procedimento = historico_remover(paciente->hist);
-        tamanho_total += strlen(procedimento) + 1; // +1 para o '\0'
-        historico_inserir(historico_aux, procedimento);
+        segmentos[n].base = historico_codigos(hist);
+        segmentos[n].tamanho = tam_historico * sizeof(uint32_t);
+        n++;
     }
 
-    char *str_paciente = calloc(tamanho_total, sizeof(char));
-
-    // Se a alocação falhar, volta o histórico original e retorna
-    if (str_paciente == NULL)
+    // Descrições próprias e o rodapé que as anuncia
+    uint32_t tam_textos;
+    const char *textos = historico_textos(hist, &tam_textos);
+    if (textos != NULL)
     {
-        for (int i = 0; i < tam_historico; i++)
-            historico_inserir(paciente->hist, historico_remover(historico_aux));
-        historico_apagar(&historico_aux);
-        return NULL;
+        segmentos[n].base = textos;
+        segmentos[n].tamanho = tam_textos;
+        n++;
+        segmentos[n].base = historico_rodape(hist);
+        segmentos[n].tamanho = sizeof(uint32_t);
+        n++;
     }
 
-    char *ponteiro_atual = str_paciente;
-
-    // Copia o CPF (11 bytes) e adiciona o separador '\0'
-    memcpy(ponteiro_atual, paciente->cpf, 11);
-    ponteiro_atual[11] = '\0';
-    ponteiro_atual += 12; // Avança o ponteiro 12 posições
+    int total = 0;
+    for (int i = 0; i < n; i++)
+        total += (int)segmentos[i].tamanho;
 
-    // Copia o nome e avança o ponteiro
-    int bytes_escritos = sprintf(ponteiro_atual, "%s", paciente->nome);
-    ponteiro_atual += bytes_escritos + 1;
+    if (tamanho != NULL)
+        *tamanho = total;
+    return n;
+}
 
-    // Esvazia a pilha auxiliar, escrevendo na string e restaurando a pilha original
-    for (int i = 0; i < tam_historico; i++)
-    {
-        char *procedimento = historico_remover(historico_aux);
+/**
+ * @brief Serializa os dados de um paciente em uma única string de bytes.
+ * * Junta em um buffer contínuo os segmentos descritos por `paciente_serializar`.
+ * * @param paciente Ponteiro para o paciente a ser serializado.
+ * @param tamanho Ponteiro para um inteiro onde o tamanho total da string alocada será armazenado.
+ * @return Ponteiro para a string alocada dinamicamente contendo os dados serializados ou NULL em caso de erro.
+ */
+char *paciente_para_string(PACIENTE *paciente, int *tamanho)
+{
+    SEGMENTO segmentos[PACIENTE_MAX_SEGMENTOS];
+    int tamanho_total;
+    int n = paciente_serializar(paciente, segmentos, &tamanho_total);
+    if (n == 0)
+        return NULL;
 
-        bytes_escritos = sprintf(ponteiro_atual, "%s", procedimento);
-        ponteiro_atual += bytes_escritos + 1;
+    char *str_paciente = malloc(tamanho_total);
+    if (str_paciente == NULL)
+        return NULL;
 
-        historico_inserir(paciente->hist, procedimento);
+    char *ponteiro_atual = str_paciente;
+    for (int i = 0; i < n; i++)
+    {
+        memcpy(ponteiro_atual, segmentos[i].base, segmentos[i].tamanho);
+        ponteiro_atual += segmentos[i].tamanho;
     }
 
-    historico_apagar(&historico_aux);
-
     *tamanho = tamanho_total;
     return str_paciente;
 }
 
 /**
- * @brief Deserializa uma string de bytes para uma nova estrutura PACIENTE.
- * * Função inversa de `paciente_para_string`. Lê um buffer de memória com o formato
- * específico e recria a estrutura PACIENTE correspondente.
- * * @param buffer A string de bytes contendo os dados serializados do paciente.
- * @return Ponteiro para a nova estrutura PACIENTE criada ou NULL em caso de erro.
+ * @brief Deserializa um registro de `tamanho` bytes para uma nova estrutura PACIENTE.
+ * * Função inversa de `paciente_serializar`. O buffer não precisa terminar em '\0':
+ * cada campo é validado contra o fim do registro antes de ser lido, e o registro
+ * é rejeitado se estiver truncado ou malformado:
+ *  - CPF com exatamente 11 dígitos seguidos de '\0';
+ *  - nome terminado em '\0' dentro do registro e com até PACIENTE_TAM_NOME bytes;
+ *  - se o último inteiro tiver HISTORICO_TEXTO_PROPRIO, textos de tamanho múltiplo de 4 antes dele;
+ *  - códigos em múltiplo de 4 bytes, no máximo HISTORICO_MAX, cada um existente no
+ *    catálogo ou apontando para um texto terminado em '\0' com até 99 caracteres.
+ * * O nome é copiado uma única vez do buffer para memória própria, cuja posse
+ * é transferida ao paciente (sem cópias para buffers intermediários).
+ * * @param dados Início do registro serializado.
+ * @param tamanho Quantidade de bytes do registro.
+ * @param registrar false para deixar o registro para paciente_registrar().
+ * @return Ponteiro para a nova estrutura PACIENTE criada ou NULL se o registro for inválido.
  */
-PACIENTE *paciente_de_string(char *buffer)
+static PACIENTE *paciente_decodificar(const char *dados, size_t tamanho, bool registrar)
 {
-    char cpf[12];
-    char nome[256];
+    if (dados == NULL || tamanho < 12 || dados[11] != '\0')
+        return NULL;
+
+    // CPF: 11 dígitos
+    for (int i = 0; i < 11; i++)
+    {
+        if (dados[i] < '0' || dados[i] > '9')
+            return NULL;
+    }
+
+    // Nome: procura o '\0' apenas dentro dos limites do registro
+    const char *nome = dados + 12;
+    size_t restante = tamanho - 12;
+    const char *fim_nome = memchr(nome, '\0', restante);
+    if (fim_nome == NULL || (size_t)(fim_nome - nome) > PACIENTE_TAM_NOME)
+        return NULL;
 
-    // Lê o CPF
-    strcpy(cpf, buffer);
-    buffer += strlen(buffer) + 1; // Pula o CPF e seu '\0'
+    size_t tam_nome = fim_nome - nome;
+    const char *codigos = fim_nome + 1;
+    restante -= tam_nome + 1;
 
-    // Lê o Nome
-    strcpy(nome, buffer);
-    buffer += strlen(nome) + 1; // Pula o Nome e seu '\0'
+    // Descrições próprias: o rodapé no fim do registro dá o tamanho dos textos
+    const char *textos = NULL;
+    uint32_t tam_textos = 0;
+    uint32_t rodape;
+    if (restante >= sizeof(uint32_t) &&
+        (memcpy(&rodape, codigos + restante - sizeof(uint32_t), sizeof(uint32_t)), rodape & HISTORICO_TEXTO_PROPRIO))
+    {
+        tam_textos = rodape & ~HISTORICO_TEXTO_PROPRIO;
+        if (tam_textos % sizeof(uint32_t) != 0 || tam_textos > restante - sizeof(uint32_t))
+            return NULL;
+        restante -= tam_textos + sizeof(uint32_t);
+        textos = codigos + restante;
+    }
 
-    PACIENTE *p = paciente_criar(nome, cpf);
+    // Histórico: códigos inteiros de 32 bits
+    if (restante % sizeof(uint32_t) != 0 || restante / sizeof(uint32_t) > HISTORICO_MAX)
+        return NULL;
 
-    // Lê cada procedimento do histórico até o final do buffer
-    while (buffer != NULL && *buffer != '\0')
+    int n_codigos = (int)(restante / sizeof(uint32_t));
+    for (int i = 0; i < n_codigos; i++)
     {
-        historico_inserir(p->hist, buffer);
-        buffer += strlen(buffer) + 1;
+        uint32_t codigo;
+        memcpy(&codigo, codigos + i * sizeof(uint32_t), sizeof(uint32_t));
+        uint32_t posicao = codigo & ~HISTORICO_TEXTO_PROPRIO;
+        if (codigo & HISTORICO_TEXTO_PROPRIO
+                ? posicao >= tam_textos || memchr(textos + posicao, '\0', tam_textos - posicao) == NULL ||
+                      strlen(textos + posicao) >= HISTORICO_TAM_TEXTO
+                : catalogo_texto(codigo) == NULL)
+            return NULL;
+    }
+
+    // Campos validados: copia direto do registro e transfere a posse ao paciente
+    char *novo_nome = (char *)heap_alocar(tam_nome + 1);
+    if (novo_nome != NULL)
+        memcpy(novo_nome, nome, tam_nome + 1);
+
+    PACIENTE *p = paciente_montar(novo_nome, dados, registrar);
+    if (p == NULL)
+        return NULL;
+
+    for (int i = 0; i < n_codigos; i++)
+    {
+        uint32_t codigo;
+        memcpy(&codigo, codigos + i * sizeof(uint32_t), sizeof(uint32_t));
+        bool ok = codigo & HISTORICO_TEXTO_PROPRIO
+                      ? historico_inserir_proprio(paciente_historico(p), textos + (codigo & ~HISTORICO_TEXTO_PROPRIO))
+                      : historico_inserir_codigo(paciente_historico(p), codigo);
+        if (!ok)
+        {
+            paciente_apagar(&p);
+            return NULL;
+        }
     }
 
     return p;
 }
 
+/**
+ * @brief Deserializa um registro e registra o paciente no armazém central.
+ * * Ver paciente_decodificar() para o formato e as validações.
+ * * @param dados Início do registro serializado.
+ * @param tamanho Quantidade de bytes do registro.
+ * @return Ponteiro para a nova estrutura PACIENTE criada ou NULL se o registro for inválido.
+ */
+PACIENTE *paciente_de_bytes(const char *dados, size_t tamanho)
+{
+    return paciente_decodificar(dados, tamanho, true);
+}
+
+/**
+ * @brief Deserializa um registro sem registrar o paciente.
+ * * Não toca no armazém central nem em nenhum estado global além de leituras
+ * do catálogo, então pode ser chamada por várias threads ao mesmo tempo. O
+ * paciente só pode ser usado depois de paciente_registrar().
+ * * @param dados Início do registro serializado.
+ * @param tamanho Quantidade de bytes do registro.
+ * @return Ponteiro para a nova estrutura PACIENTE criada ou NULL se o registro for inválido.
+ */
+PACIENTE *paciente_de_bytes_sem_registro(const char *dados, size_t tamanho)
+{
+    return paciente_decodificar(dados, tamanho, false);
+}
+
 /**
  * @brief Imprime o nome do paciente no console.
  * * @param paciente Ponteiro para a estrutura PACIENTE a ser impressa.
@@ -256,11 +463,11 @@ void paciente_imprimir(PACIENTE *paciente)
 
 /**
  * @brief Retorna se o paciente esta na fila de espera
- * * @param paciente Ponteiro para a estrutura PACIENTE a ser impressa.
+ * * @param paciente Ponteiro para a estrutura PACIENTE a ser consultada.
  */
 bool paciente_esta_na_fila(PACIENTE* paciente){
   if (paciente != NULL){
-    return paciente->fila == 1;
+    return registro_na_fila(paciente->id);
   }
 
   return false;
@@ -268,20 +475,22 @@ bool paciente_esta_na_fila(PACIENTE* paciente){
 
 /**
  * @brief Coloca o estado do paciente como na fila de espera
- * * @param paciente Ponteiro para a estrutura PACIENTE a ser impressa.
+ * * Registra também a prioridade e o horário de chegada no armazém central.
+ * * @param paciente Ponteiro para a estrutura PACIENTE.
+ * @param prioridade Prioridade (0 a 4) com que o paciente entrou na fila.
  */
-void paciente_ir_para_fila(PACIENTE* paciente){
+void paciente_ir_para_fila(PACIENTE* paciente, int prioridade){
   if (paciente != NULL){
-    paciente->fila = 1;
+    registro_entrar_fila(paciente->id, prioridade, (int64_t)time(NULL));
   }
 }
 
 /**
  * @brief Coloca o estado do paciente como fora da fila de espera
- * * @param paciente Ponteiro para a estrutura PACIENTE a ser impressa.
+ * * @param paciente Ponteiro para a estrutura PACIENTE.
  */
 void paciente_sair_da_fila(PACIENTE* paciente){
   if (paciente != NULL){
-    paciente->fila = 0;
+    registro_sair_fila(paciente->id);
   }
-}
\ No newline at end of file
+}
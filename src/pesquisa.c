@@ -0,0 +1,1099 @@
+/**
+ * @file pesquisa.c
+ * @brief Linguagem de consulta sobre os pacientes e executor em blocos paralelos.
+ * @details Uma consulta tem a forma
+ *
+ *     AÇÃO [onde CONDIÇÃO] [por CAMPO]
+ *
+ * - AÇÃO: `contar`, `listar`, ou `media`/`soma`/`minimo`/`maximo` seguido de um campo numérico
+ * - CONDIÇÃO: comparações `CAMPO OPERADOR VALOR` ligadas por `e`, `ou`,
+ *   `nao` e parênteses (`e` antes de `ou`); um campo numérico sozinho vale
+ *   "diferente de zero" (ex.: `onde fila`)
+ * - OPERADOR: `=`, `!=`, `<`, `<=`, `>`, `>=` e, para textos, `~` ("contém")
+ * - `por`: agrupa por `fila`, `prioridade` ou `procedimentos`
+ *
+ * Campos: `cpf`, `nome`, `fila` (0 ou 1), `prioridade` (1 a 5 na fila, 0
+ * fora), `espera` (minutos na fila), `procedimentos` (tamanho do histórico)
+ * e `procedimento` (algum procedimento do histórico igual a/que contém o
+ * texto). Exemplos: `contar onde fila por prioridade`,
+ * `listar onde procedimentos > 5`, `media espera por prioridade`.
+ *
+ * A consulta é compilada uma vez para uma árvore de condições. O texto de
+ * `procedimento` vira, na compilação, o conjunto de códigos do catálogo que
+ * o satisfazem, e a comparação com o histórico é feita entre inteiros.
+ *
+ * O executor varre os vetores do armazém central (ver registro.c) em lotes
+ * de PESQUISA_LOTE pacientes: cada condição produz um vetor de seleção do
+ * lote inteiro, em laços sem desvios sobre os campos quentes (estado na
+ * fila, prioridade, chegada); os campos frios (nome e histórico) só são
+ * lidos para os pacientes ainda selecionados. O armazém é dividido em
+ * trechos de PESQUISA_TRECHO posições, distribuídos entre as threads (ver
+ * tarefas.c); cada thread soma os próprios agregados e formata as linhas do
+ * próprio trecho em um buffer, e os buffers são escritos na ordem dos
+ * trechos, em poucas chamadas grandes, a cada rodada de threads. Cada rodada
+ * cria e junta as suas threads (tarefas_executar() não mantém threads entre
+ * as chamadas).
+ *
+ * No modo sob demanda, parte dos pacientes só existe no arquivo de dados: a
+ * varredura segue a ordem da LISTA (ver lista_percorrer_registros()), em uma
+ * thread, com os mesmos lotes.
+ */
+
+#include "../include/pesquisa.h"
+#include "../include/IO.h"
+#include "../include/catalogo.h"
+#include "../include/cpf.h"
+#include "../include/historico.h"
+#include "../include/paciente.h"
+#include "../include/registro.h"
+#include "../include/tarefas.h"
+#include <ctype.h>
+#include <string.h>
+#include <time.h>
+
+#define PESQUISA_LOTE 1024       ///< Pacientes avaliados de uma vez
+#define PESQUISA_TRECHO 65536    ///< Posições do armazém por tarefa
+#define PESQUISA_MAX_GRUPOS 16   ///< Valores distintos de um campo de agrupamento
+#define PESQUISA_DESPEJO 65536   ///< Bytes acumulados antes de escrever (modo sob demanda)
+
+/**
+ * @brief Campos disponíveis nas consultas.
+ */
+typedef enum {
+    CAMPO_CPF,
+    CAMPO_NOME,
+    CAMPO_FILA,
+    CAMPO_PRIORIDADE,
+    CAMPO_ESPERA,
+    CAMPO_PROCEDIMENTOS,
+    CAMPO_PROCEDIMENTO,
+    CAMPO_NENHUM = -1
+} CAMPO;
+
+/**
+ * @brief Nome e tipo de cada campo.
+ */
+static const struct {
+    const char* nome;   /**< Nome na consulta. */
+    bool numerico;      /**< Comparado como inteiro (false = texto). */
+    bool agrupavel;     /**< Pode ser usado em `por` (menos de PESQUISA_MAX_GRUPOS valores). */
+} campos[] = {
+    [CAMPO_CPF]           = { "cpf",           true,  false },
+    [CAMPO_NOME]          = { "nome",          false, false },
+    [CAMPO_FILA]          = { "fila",          true,  true  },
+    [CAMPO_PRIORIDADE]    = { "prioridade",    true,  true  },
+    [CAMPO_ESPERA]        = { "espera",        true,  false },
+    [CAMPO_PROCEDIMENTOS] = { "procedimentos", true,  true  },
+    [CAMPO_PROCEDIMENTO]  = { "procedimento",  false, false },
+};
+
+#define PESQUISA_CAMPOS ((int)(sizeof(campos) / sizeof(campos[0])))
+
+_Static_assert(HISTORICO_MAX < PESQUISA_MAX_GRUPOS, "procedimentos deve caber nos grupos");
+
+/**
+ * @brief Operadores de comparação.
+ */
+typedef enum { OP_IGUAL, OP_DIFERENTE, OP_MENOR, OP_MENOR_IGUAL, OP_MAIOR, OP_MAIOR_IGUAL, OP_CONTEM } OPERADOR;
+
+/**
+ * @brief Ações de uma consulta.
+ */
+typedef enum { ACAO_CONTAR, ACAO_LISTAR, ACAO_MEDIA, ACAO_SOMA, ACAO_MINIMO, ACAO_MAXIMO } ACAO;
+
+/**
+ * @brief Tipos de nó da árvore de condições.
+ */
+typedef enum {
+    NO_E,               ///< esq e dir
+    NO_OU,              ///< esq ou dir
+    NO_NAO,             ///< não esq
+    NO_NUMERO,          ///< campo numérico comparado com valor
+    NO_NOME,            ///< nome comparado com texto
+    NO_PROCEDIMENTO     ///< algum procedimento do histórico em codigos ou igual a texto (ou nenhum, com OP_DIFERENTE)
+} TIPO_NO;
+
+/**
+ * @brief Nó da árvore de condições.
+ */
+typedef struct pesquisa_no_ {
+    TIPO_NO tipo;
+    CAMPO campo;        /**< Campo comparado (NO_NUMERO). */
+    OPERADOR op;        /**< Operador da comparação. */
+    int64_t valor;      /**< Valor comparado (NO_NUMERO). */
+    char* texto;        /**< Texto comparado (NO_NOME, e descrições próprias em NO_PROCEDIMENTO). */
+    uint8_t* codigos;   /**< codigos[c] = 1 se o procedimento c satisfaz a condição (NO_PROCEDIMENTO). */
+    uint32_t n_codigos; /**< Tamanho de codigos (catálogo + 1). */
+    int esq;            /**< Primeiro operando (conectivos). */
+    int dir;            /**< Segundo operando (NO_E e NO_OU). */
+} PESQUISA_NO;
+
+/**
+ * @struct pesquisa_
+ * @brief Consulta compilada.
+ */
+struct pesquisa_ {
+    ACAO acao;                          /**< O que fazer com os pacientes selecionados. */
+    CAMPO agregado;                     /**< Campo de media/soma/minimo/maximo. */
+    CAMPO grupo;                        /**< Campo de `por` (CAMPO_NENHUM = sem grupos). */
+    int raiz;                           /**< Condição (-1 = todos os pacientes). */
+    PESQUISA_NO nos[PESQUISA_MAX_NOS];  /**< Condições e conectivos. */
+    int n_nos;                          /**< Nós usados. */
+};
+
+/* ---------------------------------------------------------------------- */
+/* Compilação                                                             */
+/* ---------------------------------------------------------------------- */
+
+/**
+ * @brief Tipos de símbolo da consulta.
+ */
+typedef enum { SIMB_FIM, SIMB_PALAVRA, SIMB_NUMERO, SIMB_TEXTO, SIMB_OPERADOR, SIMB_ABRE, SIMB_FECHA } TIPO_SIMBOLO;
+
+/**
+ * @brief Estado da leitura da consulta.
+ */
+typedef struct analisador_ {
+    const char* texto;                  /**< Consulta. */
+    size_t pos;                         /**< Posição do próximo símbolo. */
+    TIPO_SIMBOLO tipo;                  /**< Símbolo atual. */
+    char palavra[PESQUISA_MAX_TEXTO];   /**< Palavra (minúsculas) ou texto entre aspas. */
+    int64_t numero;                     /**< Valor de SIMB_NUMERO. */
+    OPERADOR op;                        /**< Valor de SIMB_OPERADOR. */
+    size_t coluna;                      /**< Posição (a partir de 1) do símbolo atual. */
+    char* erro;                         /**< Destino da mensagem de erro. */
+    size_t tam_erro;                    /**< Tamanho do destino. */
+    bool falhou;                        /**< Já houve um erro. */
+    PESQUISA* pesquisa;                 /**< Consulta em construção. */
+} ANALISADOR;
+
+/**
+ * @brief Registra o primeiro erro da compilação, com a posição do símbolo atual.
+ */
+static void analisador_erro(ANALISADOR* a, const char* mensagem){
+    if (!a->falhou && a->erro != NULL && a->tam_erro > 0)
+        snprintf(a->erro, a->tam_erro, "coluna %zu: %s", a->coluna, mensagem);
+    a->falhou = true;
+}
+
+/**
+ * @brief Lê o próximo símbolo.
+ */
+static void analisador_avancar(ANALISADOR* a){
+    const char* t = a->texto;
+    while (t[a->pos] == ' ' || t[a->pos] == '\t' || t[a->pos] == '\r' || t[a->pos] == '\n')
+        a->pos++;
+    a->coluna = a->pos + 1;
+
+    char c = t[a->pos];
+    if (c == '\0'){
+        a->tipo = SIMB_FIM;
+    } else if (c == '(' || c == ')'){
+        a->tipo = c == '(' ? SIMB_ABRE : SIMB_FECHA;
+        a->pos++;
+    } else if (c == '"'){
+        size_t n = 0;
+        a->pos++;
+        while (t[a->pos] != '\0' && t[a->pos] != '"'){
+            if (n + 1 < sizeof(a->palavra)) a->palavra[n++] = t[a->pos];
+            a->pos++;
+        }
+        a->palavra[n] = '\0';
+        if (t[a->pos] != '"'){
+            analisador_erro(a, "texto sem aspas de fechamento");
+            a->tipo = SIMB_FIM;
+            return;
+        }
+        a->pos++;
+        a->tipo = SIMB_TEXTO;
+    } else if (isdigit((unsigned char)c) || (c == '-' && isdigit((unsigned char)t[a->pos + 1]))){
+        char* fim;
+        long long valor = strtoll(t + a->pos, &fim, 10);
+        a->numero = (int64_t)valor;
+        a->pos = (size_t)(fim - t);
+        a->tipo = SIMB_NUMERO;
+    } else if (strchr("=!<>~", c) != NULL){
+        char d = t[a->pos + 1];
+        a->tipo = SIMB_OPERADOR;
+        a->pos++;
+        if (c == '=') a->op = OP_IGUAL;
+        else if (c == '~') a->op = OP_CONTEM;
+        else if (c == '!' && d == '='){ a->op = OP_DIFERENTE; a->pos++; }
+        else if (c == '<' && d == '>'){ a->op = OP_DIFERENTE; a->pos++; }
+        else if (c == '<' && d == '='){ a->op = OP_MENOR_IGUAL; a->pos++; }
+        else if (c == '>' && d == '='){ a->op = OP_MAIOR_IGUAL; a->pos++; }
+        else if (c == '<') a->op = OP_MENOR;
+        else if (c == '>') a->op = OP_MAIOR;
+        else {
+            analisador_erro(a, "operador inválido");
+            a->tipo = SIMB_FIM;
+        }
+    } else if (isalpha((unsigned char)c) || c == '_' || (unsigned char)c >= 0x80){
+        // Palavras aceitam letras acentuadas (bytes UTF-8): "média", "não"
+        size_t n = 0;
+        while (isalnum((unsigned char)t[a->pos]) || t[a->pos] == '_' || (unsigned char)t[a->pos] >= 0x80){
+            if (n + 1 < sizeof(a->palavra)) a->palavra[n++] = (char)tolower((unsigned char)t[a->pos]);
+            a->pos++;
+        }
+        a->palavra[n] = '\0';
+        a->tipo = SIMB_PALAVRA;
+    } else {
+        analisador_erro(a, "caractere inesperado");
+        a->tipo = SIMB_FIM;
+    }
+}
+
+/**
+ * @brief Verifica se o símbolo atual é uma das palavras (terminadas por NULL).
+ */
+static bool analisador_palavra(const ANALISADOR* a, const char* const palavras[]){
+    if (a->tipo != SIMB_PALAVRA) return false;
+    for (int i = 0; palavras[i] != NULL; i++)
+        if (strcmp(a->palavra, palavras[i]) == 0) return true;
+    return false;
+}
+
+static const char* const PALAVRAS_E[] = { "e", NULL };
+static const char* const PALAVRAS_OU[] = { "ou", NULL };
+static const char* const PALAVRAS_NAO[] = { "nao", "não", NULL };
+static const char* const PALAVRAS_ONDE[] = { "onde", NULL };
+static const char* const PALAVRAS_POR[] = { "por", NULL };
+
+/**
+ * @brief Lê um nome de campo.
+ * @return Campo ou CAMPO_NENHUM (com erro registrado).
+ */
+static CAMPO analisador_campo(ANALISADOR* a){
+    if (a->tipo == SIMB_PALAVRA)
+        for (int c = 0; c < PESQUISA_CAMPOS; c++)
+            if (strcmp(a->palavra, campos[c].nome) == 0){
+                analisador_avancar(a);
+                return (CAMPO)c;
+            }
+    analisador_erro(a, "campo esperado (cpf, nome, fila, prioridade, espera, procedimentos, procedimento)");
+    return CAMPO_NENHUM;
+}
+
+/**
+ * @brief Reserva um nó da árvore.
+ * @return Índice do nó ou -1 (com erro registrado).
+ */
+static int analisador_no(ANALISADOR* a, TIPO_NO tipo){
+    PESQUISA* p = a->pesquisa;
+    if (p->n_nos == PESQUISA_MAX_NOS){
+        analisador_erro(a, "consulta com condições demais");
+        return -1;
+    }
+    PESQUISA_NO* no = &p->nos[p->n_nos];
+    memset(no, 0, sizeof(*no));
+    no->tipo = tipo;
+    no->esq = no->dir = -1;
+    return p->n_nos++;
+}
+
+/**
+ * @brief Compila a condição sobre procedimentos para o conjunto de códigos do catálogo.
+ */
+static bool analisador_procedimentos(ANALISADOR* a, PESQUISA_NO* no, const char* texto){
+    no->n_codigos = catalogo_tamanho() + 1;
+    no->codigos = (uint8_t*)calloc(no->n_codigos, 1);
+    if (no->codigos == NULL){
+        analisador_erro(a, "memória insuficiente");
+        return false;
+    }
+    for (uint32_t c = 1; c < no->n_codigos; c++){
+        const char* descricao = catalogo_texto(c);
+        if (descricao != NULL)
+            no->codigos[c] = no->op == OP_CONTEM ? strstr(descricao, texto) != NULL : strcmp(descricao, texto) == 0;
+    }
+    return true;
+}
+
+static int analisador_expressao(ANALISADOR* a);
+
+/**
+ * @brief comparacao := campo [operador valor]
+ */
+static int analisador_comparacao(ANALISADOR* a){
+    CAMPO campo = analisador_campo(a);
+    if (campo == CAMPO_NENHUM) return -1;
+
+    // Campo numérico sozinho: diferente de zero
+    if (a->tipo != SIMB_OPERADOR){
+        if (!campos[campo].numerico){
+            analisador_erro(a, "operador esperado depois de um campo de texto");
+            return -1;
+        }
+        int i = analisador_no(a, NO_NUMERO);
+        if (i >= 0){
+            a->pesquisa->nos[i].campo = campo;
+            a->pesquisa->nos[i].op = OP_DIFERENTE;
+            a->pesquisa->nos[i].valor = 0;
+        }
+        return i;
+    }
+
+    OPERADOR op = a->op;
+    analisador_avancar(a);
+
+    if (campos[campo].numerico){
+        int64_t valor;
+        if (op == OP_CONTEM){
+            analisador_erro(a, "'~' só compara textos (nome, procedimento)");
+            return -1;
+        }
+        if (a->tipo == SIMB_NUMERO){
+            valor = a->numero;
+        } else if (campo == CAMPO_CPF && a->tipo == SIMB_TEXTO){
+            char cpf[CPF_DIGITOS + 1];
+            if (!cpf_normalizar(a->palavra, cpf)){
+                analisador_erro(a, "CPF inválido");
+                return -1;
+            }
+            valor = (int64_t)cpf_empacotar(cpf);
+        } else {
+            analisador_erro(a, "número esperado");
+            return -1;
+        }
+        analisador_avancar(a);
+
+        int i = analisador_no(a, NO_NUMERO);
+        if (i >= 0){
+            a->pesquisa->nos[i].campo = campo;
+            a->pesquisa->nos[i].op = op;
+            a->pesquisa->nos[i].valor = valor;
+        }
+        return i;
+    }
+
+    if (op != OP_IGUAL && op != OP_DIFERENTE && op != OP_CONTEM){
+        analisador_erro(a, "textos só aceitam '=', '!=' e '~'");
+        return -1;
+    }
+    if (a->tipo != SIMB_TEXTO){
+        analisador_erro(a, "texto entre aspas esperado");
+        return -1;
+    }
+
+    int i = analisador_no(a, campo == CAMPO_NOME ? NO_NOME : NO_PROCEDIMENTO);
+    if (i < 0) return -1;
+    PESQUISA_NO* no = &a->pesquisa->nos[i];
+    no->campo = campo;
+    no->op = op;
+    // O histórico guarda as descrições truncadas (ver historico_inserir());
+    // na igualdade com procedimentos o texto é truncado do mesmo jeito
+    if (campo != CAMPO_NOME && op != OP_CONTEM && strlen(a->palavra) >= HISTORICO_TAM_TEXTO)
+        a->palavra[HISTORICO_TAM_TEXTO - 1] = '\0';
+    no->texto = (char*)malloc(strlen(a->palavra) + 1);
+    if (no->texto == NULL){
+        analisador_erro(a, "memória insuficiente");
+        return -1;
+    }
+    strcpy(no->texto, a->palavra);
+    if (campo != CAMPO_NOME){
+        // "procedimento != x": nenhum procedimento igual a x; o conjunto é o de "= x"
+        if (op == OP_DIFERENTE) no->op = OP_IGUAL;
+        if (!analisador_procedimentos(a, no, a->palavra)) return -1;
+        no->op = op;
+    }
+    analisador_avancar(a);
+    return i;
+}
+
+/**
+ * @brief fator := 'nao' fator | '(' expressao ')' | comparacao
+ */
+static int analisador_fator(ANALISADOR* a){
+    if (analisador_palavra(a, PALAVRAS_NAO)){
+        analisador_avancar(a);
+        int operando = analisador_fator(a);
+        if (operando < 0) return -1;
+        int i = analisador_no(a, NO_NAO);
+        if (i >= 0) a->pesquisa->nos[i].esq = operando;
+        return i;
+    }
+    if (a->tipo == SIMB_ABRE){
+        analisador_avancar(a);
+        int i = analisador_expressao(a);
+        if (i < 0) return -1;
+        if (a->tipo != SIMB_FECHA){
+            analisador_erro(a, "')' esperado");
+            return -1;
+        }
+        analisador_avancar(a);
+        return i;
+    }
+    return analisador_comparacao(a);
+}
+
+/**
+ * @brief Lê operandos ligados por um conectivo, da esquerda para a direita.
+ */
+static int analisador_conectivo(ANALISADOR* a, const char* const palavras[], TIPO_NO tipo, int (*operando)(ANALISADOR*)){
+    int esq = operando(a);
+    while (esq >= 0 && analisador_palavra(a, palavras)){
+        analisador_avancar(a);
+        int dir = operando(a);
+        if (dir < 0) return -1;
+        int i = analisador_no(a, tipo);
+        if (i < 0) return -1;
+        a->pesquisa->nos[i].esq = esq;
+        a->pesquisa->nos[i].dir = dir;
+        esq = i;
+    }
+    return esq;
+}
+
+/**
+ * @brief termo := fator { 'e' fator }
+ */
+static int analisador_termo(ANALISADOR* a){
+    return analisador_conectivo(a, PALAVRAS_E, NO_E, analisador_fator);
+}
+
+/**
+ * @brief expressao := termo { 'ou' termo }
+ */
+static int analisador_expressao(ANALISADOR* a){
+    return analisador_conectivo(a, PALAVRAS_OU, NO_OU, analisador_termo);
+}
+
+/**
+ * @brief Compila uma consulta.
+ * @param texto Consulta (ver o início deste arquivo).
+ * @param erro Recebe a descrição do erro, se houver.
+ * @param tam_erro Tamanho de erro.
+ * @return PESQUISA* Consulta compilada ou NULL se o texto é inválido.
+ */
+PESQUISA* pesquisa_compilar(const char* texto, char* erro, size_t tam_erro){
+    if (erro != NULL && tam_erro > 0) erro[0] = '\0';
+    if (texto == NULL || strlen(texto) >= PESQUISA_MAX_TEXTO){
+        if (erro != NULL && tam_erro > 0) snprintf(erro, tam_erro, "consulta vazia ou longa demais");
+        return NULL;
+    }
+
+    PESQUISA* p = (PESQUISA*)calloc(1, sizeof(PESQUISA));
+    if (p == NULL) return NULL;
+    p->raiz = -1;
+    p->grupo = CAMPO_NENHUM;
+    p->agregado = CAMPO_NENHUM;
+
+    ANALISADOR a;
+    memset(&a, 0, sizeof(a));
+    a.texto = texto;
+    a.erro = erro;
+    a.tam_erro = tam_erro;
+    a.pesquisa = p;
+    analisador_avancar(&a);
+
+    static const char* const acoes[] = { "contar", "listar", "media", "soma", "minimo", "maximo" };
+    static const char* const acoes_acentuadas[] = { "", "", "média", "", "mínimo", "máximo" };
+    int acao = -1;
+    for (int i = 0; i < 6 && a.tipo == SIMB_PALAVRA; i++)
+        if (strcmp(a.palavra, acoes[i]) == 0 || strcmp(a.palavra, acoes_acentuadas[i]) == 0)
+            acao = i;
+    if (acao < 0){
+        analisador_erro(&a, "ação esperada (contar, listar, media, soma, minimo, maximo)");
+    } else {
+        p->acao = (ACAO)acao;
+        analisador_avancar(&a);
+        if (p->acao != ACAO_CONTAR && p->acao != ACAO_LISTAR){
+            p->agregado = analisador_campo(&a);
+            if (p->agregado != CAMPO_NENHUM && !campos[p->agregado].numerico)
+                analisador_erro(&a, "agregados só valem para campos numéricos");
+        }
+    }
+
+    if (!a.falhou && analisador_palavra(&a, PALAVRAS_ONDE)){
+        analisador_avancar(&a);
+        p->raiz = analisador_expressao(&a);
+    }
+
+    if (!a.falhou && analisador_palavra(&a, PALAVRAS_POR)){
+        analisador_avancar(&a);
+        if (p->acao == ACAO_LISTAR)
+            analisador_erro(&a, "'listar' não agrupa");
+        else if ((p->grupo = analisador_campo(&a)) != CAMPO_NENHUM && !campos[p->grupo].agrupavel)
+            analisador_erro(&a, "só é possível agrupar por fila, prioridade ou procedimentos");
+    }
+
+    if (!a.falhou && a.tipo != SIMB_FIM)
+        analisador_erro(&a, "fim da consulta esperado");
+
+    if (a.falhou){
+        pesquisa_apagar(&p);
+        return NULL;
+    }
+    return p;
+}
+
+/**
+ * @brief Libera uma consulta compilada.
+ * @param pesquisa Endereço do ponteiro da consulta.
+ */
+void pesquisa_apagar(PESQUISA** pesquisa){
+    if (pesquisa != NULL && *pesquisa != NULL){
+        for (int i = 0; i < (*pesquisa)->n_nos; i++){
+            free((*pesquisa)->nos[i].texto);
+            free((*pesquisa)->nos[i].codigos);
+        }
+        free(*pesquisa);
+        *pesquisa = NULL;
+    }
+}
+
+/**
+ * @brief Imprime a sintaxe das consultas com exemplos.
+ */
+void pesquisa_ajuda(void){
+    printf("Formato: AÇÃO [onde CONDIÇÃO] [por CAMPO]\n");
+    printf("  Ações: contar | listar | media/soma/minimo/maximo CAMPO\n");
+    printf("  Campos: cpf, nome, fila (0/1), prioridade (1-5; 0 fora da fila), espera (min),\n");
+    printf("          procedimentos (quantidade), procedimento (texto)\n");
+    printf("  Condições: = != < <= > >= ~ (contém), ligadas por e / ou / nao / ( )\n");
+    printf("Exemplos:\n");
+    printf("  contar onde fila por prioridade\n");
+    printf("  listar onde procedimentos > 5\n");
+    printf("  media espera por prioridade\n");
+    printf("  listar onde nome ~ \"Silva\" e nao fila\n");
+}
+
+/* ---------------------------------------------------------------------- */
+/* Execução                                                               */
+/* ---------------------------------------------------------------------- */
+
+/**
+ * @brief Texto acumulado para escrita em blocos.
+ */
+typedef struct pesquisa_buffer_ {
+    char* dados;
+    size_t tamanho;
+    size_t capacidade;
+} PESQUISA_BUFFER;
+
+/**
+ * @brief Garante espaço para mais n bytes.
+ */
+static bool buffer_reservar(PESQUISA_BUFFER* b, size_t n){
+    if (b->tamanho + n <= b->capacidade) return true;
+    size_t nova = b->capacidade ? b->capacidade : 4096;
+    while (nova < b->tamanho + n) nova *= 2;
+    char* p = (char*)realloc(b->dados, nova);
+    if (p == NULL) return false;
+    b->dados = p;
+    b->capacidade = nova;
+    return true;
+}
+
+static void buffer_texto(PESQUISA_BUFFER* b, const char* texto, size_t n){
+    if (buffer_reservar(b, n)){
+        memcpy(b->dados + b->tamanho, texto, n);
+        b->tamanho += n;
+    }
+}
+
+static void buffer_inteiro(PESQUISA_BUFFER* b, int64_t valor){
+    char digitos[24];
+    int n = 0;
+    uint64_t v = valor < 0 ? (uint64_t)0 - (uint64_t)valor : (uint64_t)valor;
+    do { digitos[sizeof(digitos) - 1 - n++] = (char)('0' + v % 10); v /= 10; } while (v > 0);
+    if (valor < 0) digitos[sizeof(digitos) - 1 - n++] = '-';
+    buffer_texto(b, digitos + sizeof(digitos) - n, (size_t)n);
+}
+
+#define BUFFER_LITERAL(b, literal) buffer_texto((b), (literal), sizeof(literal) - 1)
+
+/**
+ * @brief Escreve o buffer de uma vez e o esvazia.
+ */
+static void buffer_despejar(PESQUISA_BUFFER* b, FILE* saida){
+    if (b->tamanho > 0)
+        fwrite(b->dados, 1, b->tamanho, saida);
+    b->tamanho = 0;
+}
+
+/**
+ * @brief Lote de pacientes avaliado de uma vez.
+ * @details No modo completo, os vetores apontam direto para o armazém e o
+ * paciente da linha i tem o id base + i; no modo sob demanda, são cópias.
+ */
+typedef struct pesquisa_lote_ {
+    int n;                      /**< Pacientes no lote. */
+    const uint64_t* cpf;        /**< CPF empacotado (CPF_INVALIDO = posição livre). */
+    const uint8_t* na_fila;     /**< Estado na fila. */
+    const uint8_t* prioridade;  /**< Prioridade (0 a 4) da última entrada. */
+    const int64_t* chegada;     /**< Horário da última entrada. */
+    PACIENTE_ID base;           /**< Id do primeiro paciente (modo completo). */
+    PACIENTE* const* pacientes; /**< Pacientes do lote (modo sob demanda; NULL no completo). */
+} PESQUISA_LOTE_PACIENTES;
+
+/**
+ * @brief Estado de uma thread: áreas de avaliação, agregados e linhas formatadas.
+ */
+typedef struct pesquisa_trabalho_ {
+    uint8_t mascaras[PESQUISA_MAX_NOS][PESQUISA_LOTE];  /**< Seleção produzida por cada nó. */
+    uint8_t vivos[PESQUISA_LOTE];                       /**< Posições ocupadas do lote. */
+    int64_t valores[PESQUISA_LOTE];                     /**< Campo numérico do lote. */
+    int64_t grupos[PESQUISA_LOTE];                      /**< Campo de agrupamento do lote. */
+    uint64_t varridos;                                  /**< Pacientes percorridos. */
+    uint64_t quantidade[PESQUISA_MAX_GRUPOS];           /**< Selecionados por grupo. */
+    int64_t soma[PESQUISA_MAX_GRUPOS];                  /**< Soma do campo agregado por grupo. */
+    int64_t minimo[PESQUISA_MAX_GRUPOS];                /**< Menor valor por grupo. */
+    int64_t maximo[PESQUISA_MAX_GRUPOS];                /**< Maior valor por grupo. */
+    PESQUISA_BUFFER saida;                              /**< Linhas de `listar`. */
+} PESQUISA_TRABALHO;
+
+static PESQUISA_TRABALHO* trabalho_criar(void){
+    PESQUISA_TRABALHO* t = (PESQUISA_TRABALHO*)calloc(1, sizeof(PESQUISA_TRABALHO));
+    if (t != NULL)
+        for (int g = 0; g < PESQUISA_MAX_GRUPOS; g++){
+            t->minimo[g] = INT64_MAX;
+            t->maximo[g] = INT64_MIN;
+        }
+    return t;
+}
+
+static void trabalho_apagar(PESQUISA_TRABALHO** t){
+    if (*t != NULL){
+        free((*t)->saida.dados);
+        free(*t);
+        *t = NULL;
+    }
+}
+
+static inline PACIENTE* lote_paciente(const PESQUISA_LOTE_PACIENTES* lote, int i){
+    return lote->pacientes != NULL ? lote->pacientes[i] : registro_paciente(lote->base + (PACIENTE_ID)i);
+}
+
+/**
+ * @brief Calcula um campo numérico para o lote.
+ * @details Os campos quentes são calculados para o lote inteiro, sem desvios;
+ * `procedimentos` lê o histórico só das linhas em ativo.
+ */
+static void lote_valores(CAMPO campo, const PESQUISA_LOTE_PACIENTES* lote, const uint8_t* ativo,
+                         int64_t agora, int64_t* valores){
+    int n = lote->n;
+    switch (campo){
+    case CAMPO_CPF:
+        for (int i = 0; i < n; i++) valores[i] = (int64_t)lote->cpf[i];
+        break;
+    case CAMPO_FILA:
+        for (int i = 0; i < n; i++) valores[i] = lote->na_fila[i];
+        break;
+    case CAMPO_PRIORIDADE:
+        for (int i = 0; i < n; i++) valores[i] = (int64_t)lote->na_fila[i] * (lote->prioridade[i] + 1);
+        break;
+    case CAMPO_ESPERA:
+        for (int i = 0; i < n; i++){
+            int64_t espera = (agora - lote->chegada[i]) / 60;
+            valores[i] = (lote->na_fila[i] & (lote->chegada[i] > 0)) ? espera : 0;
+        }
+        break;
+    case CAMPO_PROCEDIMENTOS:
+        for (int i = 0; i < n; i++){
+            int tamanho = ativo[i] ? historico_tamanho(paciente_obter_historico(lote_paciente(lote, i))) : 0;
+            valores[i] = tamanho > 0 ? tamanho : 0;
+        }
+        break;
+    default:
+        memset(valores, 0, (size_t)n * sizeof(int64_t));
+        break;
+    }
+}
+
+/**
+ * @brief Compara o vetor de valores com uma constante, dentro de ativo.
+ */
+static void lote_comparar(OPERADOR op, const int64_t* v, int64_t k, const uint8_t* ativo, uint8_t* saida, int n){
+    switch (op){
+    case OP_IGUAL:        for (int i = 0; i < n; i++) saida[i] = ativo[i] & (v[i] == k); break;
+    case OP_DIFERENTE:    for (int i = 0; i < n; i++) saida[i] = ativo[i] & (v[i] != k); break;
+    case OP_MENOR:        for (int i = 0; i < n; i++) saida[i] = ativo[i] & (v[i] < k);  break;
+    case OP_MENOR_IGUAL:  for (int i = 0; i < n; i++) saida[i] = ativo[i] & (v[i] <= k); break;
+    case OP_MAIOR:        for (int i = 0; i < n; i++) saida[i] = ativo[i] & (v[i] > k);  break;
+    case OP_MAIOR_IGUAL:  for (int i = 0; i < n; i++) saida[i] = ativo[i] & (v[i] >= k); break;
+    default:              memset(saida, 0, (size_t)n); break;
+    }
+}
+
+/**
+ * @brief Avalia o nó no lote, só nas linhas em ativo.
+ * @return Vetor de seleção do nó (área do próprio nó ou de um operando).
+ */
+static const uint8_t* lote_avaliar(const PESQUISA* p, int indice, const PESQUISA_LOTE_PACIENTES* lote,
+                                   const uint8_t* ativo, PESQUISA_TRABALHO* t, int64_t agora){
+    const PESQUISA_NO* no = &p->nos[indice];
+    uint8_t* saida = t->mascaras[indice];
+    int n = lote->n;
+
+    switch (no->tipo){
+    case NO_E:
+        // O segundo operando só olha as linhas que passaram pelo primeiro
+        return lote_avaliar(p, no->dir, lote, lote_avaliar(p, no->esq, lote, ativo, t, agora), t, agora);
+
+    case NO_OU: {
+        const uint8_t* a = lote_avaliar(p, no->esq, lote, ativo, t, agora);
+        const uint8_t* b = lote_avaliar(p, no->dir, lote, ativo, t, agora);
+        for (int i = 0; i < n; i++) saida[i] = a[i] | b[i];
+        return saida;
+    }
+
+    case NO_NAO: {
+        const uint8_t* a = lote_avaliar(p, no->esq, lote, ativo, t, agora);
+        for (int i = 0; i < n; i++) saida[i] = ativo[i] & (a[i] ^ 1);
+        return saida;
+    }
+
+    case NO_NUMERO:
+        lote_valores(no->campo, lote, ativo, agora, t->valores);
+        lote_comparar(no->op, t->valores, no->valor, ativo, saida, n);
+        return saida;
+
+    case NO_NOME:
+        for (int i = 0; i < n; i++){
+            saida[i] = 0;
+            if (!ativo[i]) continue;
+            const char* nome = paciente_obter_nome(lote_paciente(lote, i));
+            if (nome == NULL) continue;
+            bool igual = no->op == OP_CONTEM ? strstr(nome, no->texto) != NULL : strcmp(nome, no->texto) == 0;
+            saida[i] = no->op == OP_DIFERENTE ? !igual : igual;
+        }
+        return saida;
+
+    case NO_PROCEDIMENTO:
+        for (int i = 0; i < n; i++){
+            saida[i] = 0;
+            if (!ativo[i]) continue;
+            HISTORICO* hist = paciente_obter_historico(lote_paciente(lote, i));
+            const uint32_t* codigos = historico_codigos(hist);
+            int tamanho = historico_tamanho(hist);
+            uint8_t algum = 0;
+            for (int j = 0; j < tamanho; j++){
+                if (codigos[j] & HISTORICO_TEXTO_PROPRIO){
+                    // Descrição própria do paciente, fora do catálogo: compara o texto
+                    const char* descricao = historico_descricao(hist, j);
+                    algum |= no->op == OP_CONTEM ? strstr(descricao, no->texto) != NULL : strcmp(descricao, no->texto) == 0;
+                } else {
+                    algum |= codigos[j] < no->n_codigos ? no->codigos[codigos[j]] : 0;
+                }
+            }
+            saida[i] = no->op == OP_DIFERENTE ? !algum : algum;
+        }
+        return saida;
+    }
+    return saida;
+}
+
+/**
+ * @brief Formata a linha de `listar` de um paciente.
+ */
+static void lote_formatar(const PESQUISA_LOTE_PACIENTES* lote, int i, int64_t agora, PESQUISA_BUFFER* b){
+    PACIENTE* pac = lote_paciente(lote, i);
+    char cpf[CPF_DIGITOS + 1];
+    cpf_desempacotar(lote->cpf[i], cpf);
+    const char* nome = paciente_obter_nome(pac);
+    int procedimentos = historico_tamanho(paciente_obter_historico(pac));
+
+    buffer_texto(b, cpf, CPF_DIGITOS);
+    BUFFER_LITERAL(b, " | ");
+    if (nome != NULL) buffer_texto(b, nome, strlen(nome));
+    if (lote->na_fila[i]){
+        BUFFER_LITERAL(b, " | fila: prioridade ");
+        buffer_inteiro(b, lote->prioridade[i] + 1);
+        if (lote->chegada[i] > 0){
+            BUFFER_LITERAL(b, ", ");
+            buffer_inteiro(b, (agora - lote->chegada[i]) / 60);
+            BUFFER_LITERAL(b, " min");
+        }
+    } else {
+        BUFFER_LITERAL(b, " | fora da fila");
+    }
+    BUFFER_LITERAL(b, " | procedimentos: ");
+    buffer_inteiro(b, procedimentos > 0 ? procedimentos : 0);
+    BUFFER_LITERAL(b, "\n");
+}
+
+/**
+ * @brief Filtra um lote e acumula o resultado no estado da thread.
+ */
+static void lote_processar(const PESQUISA* p, const PESQUISA_LOTE_PACIENTES* lote, PESQUISA_TRABALHO* t, int64_t agora){
+    int n = lote->n;
+    for (int i = 0; i < n; i++)
+        t->vivos[i] = lote->cpf[i] != CPF_INVALIDO;
+    t->varridos += n;
+
+    const uint8_t* selecao = p->raiz >= 0 ? lote_avaliar(p, p->raiz, lote, t->vivos, t, agora) : t->vivos;
+
+    if (p->acao == ACAO_LISTAR){
+        for (int i = 0; i < n; i++)
+            if (selecao[i]){
+                lote_formatar(lote, i, agora, &t->saida);
+                t->quantidade[0]++;
+            }
+        return;
+    }
+
+    if (p->grupo == CAMPO_NENHUM){
+        memset(t->grupos, 0, (size_t)n * sizeof(int64_t));
+    } else {
+        lote_valores(p->grupo, lote, selecao, agora, t->grupos);
+        for (int i = 0; i < n; i++)
+            t->grupos[i] = t->grupos[i] < PESQUISA_MAX_GRUPOS ? t->grupos[i] : PESQUISA_MAX_GRUPOS - 1;
+    }
+
+    if (p->acao == ACAO_CONTAR){
+        if (p->grupo == CAMPO_NENHUM){
+            uint64_t total = 0;
+            for (int i = 0; i < n; i++) total += selecao[i];
+            t->quantidade[0] += total;
+        } else {
+            for (int i = 0; i < n; i++) t->quantidade[t->grupos[i]] += selecao[i];
+        }
+        return;
+    }
+
+    lote_valores(p->agregado, lote, selecao, agora, t->valores);
+    for (int i = 0; i < n; i++){
+        if (!selecao[i]) continue;
+        int64_t g = t->grupos[i], v = t->valores[i];
+        t->quantidade[g]++;
+        t->soma[g] += v;
+        if (v < t->minimo[g]) t->minimo[g] = v;
+        if (v > t->maximo[g]) t->maximo[g] = v;
+    }
+}
+
+/**
+ * @brief Varredura paralela do armazém: uma rodada de trechos, um por thread.
+ */
+typedef struct pesquisa_rodada_ {
+    const PESQUISA* pesquisa;
+    PESQUISA_TRABALHO** trabalhos;  /**< Estado de cada thread. */
+    REGISTRO_VETORES vetores;       /**< Vetores do armazém. */
+    uint32_t primeiro;              /**< Primeiro trecho da rodada. */
+    int64_t agora;                  /**< Horário de referência da espera. */
+} PESQUISA_RODADA;
+
+/**
+ * @brief Tarefa de uma thread: avalia um trecho do armazém em lotes.
+ */
+static void pesquisa_trecho(void* contexto, int indice){
+    PESQUISA_RODADA* r = (PESQUISA_RODADA*)contexto;
+    uint64_t inicio = (uint64_t)(r->primeiro + (uint32_t)indice) * PESQUISA_TRECHO;
+    uint64_t fim = inicio + PESQUISA_TRECHO < r->vetores.limite ? inicio + PESQUISA_TRECHO : r->vetores.limite;
+
+    for (uint64_t base = inicio; base < fim; base += PESQUISA_LOTE){
+        PESQUISA_LOTE_PACIENTES lote;
+        lote.n = fim - base < PESQUISA_LOTE ? (int)(fim - base) : PESQUISA_LOTE;
+        lote.cpf = r->vetores.cpf + base;
+        lote.na_fila = r->vetores.na_fila + base;
+        lote.prioridade = r->vetores.prioridade + base;
+        lote.chegada = r->vetores.chegada + base;
+        lote.base = (PACIENTE_ID)base;
+        lote.pacientes = NULL;
+        lote_processar(r->pesquisa, &lote, r->trabalhos[indice], r->agora);
+    }
+}
+
+/**
+ * @brief Lote montado a partir da LISTA no modo sob demanda.
+ */
+typedef struct pesquisa_copia_ {
+    const PESQUISA* pesquisa;
+    PESQUISA_TRABALHO* trabalho;
+    FILE* saida;
+    int64_t agora;
+    int n;
+    uint64_t cpf[PESQUISA_LOTE];
+    uint8_t na_fila[PESQUISA_LOTE];
+    uint8_t prioridade[PESQUISA_LOTE];
+    int64_t chegada[PESQUISA_LOTE];
+    PACIENTE* pacientes[PESQUISA_LOTE];
+    bool temporario[PESQUISA_LOTE];     /**< Reconstruído do arquivo só para o lote. */
+} PESQUISA_COPIA;
+
+/**
+ * @brief Avalia o lote copiado e apaga os pacientes reconstruídos para ele.
+ */
+static void pesquisa_copia_processar(PESQUISA_COPIA* c){
+    PESQUISA_LOTE_PACIENTES lote = { c->n, c->cpf, c->na_fila, c->prioridade, c->chegada, 0, c->pacientes };
+    lote_processar(c->pesquisa, &lote, c->trabalho, c->agora);
+
+    for (int i = 0; i < c->n; i++)
+        if (c->temporario[i]) paciente_apagar(&c->pacientes[i]);
+    c->n = 0;
+
+    if (c->trabalho->saida.tamanho >= PESQUISA_DESPEJO)
+        buffer_despejar(&c->trabalho->saida, c->saida);
+}
+
+/**
+ * @brief Callback de lista_percorrer_registros(): copia o paciente para o lote.
+ */
+static void pesquisa_copiar(PACIENTE* p, uint64_t chave, const char* bytes, uint32_t tamanho, void* contexto){
+    PESQUISA_COPIA* c = (PESQUISA_COPIA*)contexto;
+    bool temporario = p == NULL;
+    if (temporario && (p = paciente_de_bytes_sem_registro(bytes, tamanho)) == NULL)
+        return;
+
+    // Só quem está em memória pode estar na fila
+    PACIENTE_ID id = paciente_obter_id(p);
+    int i = c->n++;
+    c->cpf[i] = chave;
+    c->na_fila[i] = !temporario && registro_na_fila(id);
+    c->prioridade[i] = temporario ? 0 : (uint8_t)registro_prioridade(id);
+    c->chegada[i] = temporario ? 0 : registro_chegada(id);
+    c->pacientes[i] = p;
+    c->temporario[i] = temporario;
+
+    if (c->n == PESQUISA_LOTE)
+        pesquisa_copia_processar(c);
+}
+
+/**
+ * @brief Nome de um grupo na saída.
+ */
+static void pesquisa_rotulo(CAMPO grupo, int g, char* rotulo, size_t tamanho){
+    if (grupo == CAMPO_PRIORIDADE && g == 0)
+        snprintf(rotulo, tamanho, "fora da fila");
+    else if (grupo == CAMPO_FILA)
+        snprintf(rotulo, tamanho, g ? "na fila" : "fora da fila");
+    else
+        snprintf(rotulo, tamanho, "%d", g);
+}
+
+/**
+ * @brief Executa a consulta e escreve o resultado.
+ *
+ * @param pesquisa Consulta compilada.
+ * @param lista Lista de pacientes (usada no modo sob demanda).
+ * @param saida Destino do resultado (ex.: stdout).
+ * @return false se faltou memória.
+ */
+bool pesquisa_executar(PESQUISA* pesquisa, LISTA* lista, FILE* saida){
+    if (pesquisa == NULL || saida == NULL) return false;
+
+#ifndef _WIN32
+    struct timespec inicio, fim;
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+#else
+    clock_t inicio = clock();
+#endif
+    int64_t agora = (int64_t)time(NULL);
+
+    PESQUISA_TRABALHO* trabalhos[TAREFAS_MAX] = { NULL };
+    int n_threads = 1;
+    bool ok = true;
+
+    if (pesquisa->acao == ACAO_LISTAR)
+        fprintf(saida, "CPF | Nome | Fila | Histórico\n");
+    fflush(saida);
+
+    if (IO_sob_demanda()){
+        // Pacientes fora da memória só são alcançados pela LISTA, em ordem
+        PESQUISA_COPIA* copia = (PESQUISA_COPIA*)calloc(1, sizeof(PESQUISA_COPIA));
+        ok = copia != NULL && (trabalhos[0] = trabalho_criar()) != NULL;
+        if (ok){
+            copia->pesquisa = pesquisa;
+            copia->trabalho = trabalhos[0];
+            copia->saida = saida;
+            copia->agora = agora;
+            lista_percorrer_registros(lista, pesquisa_copiar, copia);
+            if (copia->n > 0) pesquisa_copia_processar(copia);
+            buffer_despejar(&trabalhos[0]->saida, saida);
+        }
+        free(copia);
+    } else {
+        PESQUISA_RODADA rodada;
+        rodada.pesquisa = pesquisa;
+        rodada.trabalhos = trabalhos;
+        rodada.agora = agora;
+        registro_vetores(&rodada.vetores);
+
+        uint32_t trechos = (uint32_t)(((uint64_t)rodada.vetores.limite + PESQUISA_TRECHO - 1) / PESQUISA_TRECHO);
+        n_threads = tarefas_quantidade();
+        if ((uint32_t)n_threads > trechos) n_threads = trechos > 0 ? (int)trechos : 1;
+        for (int i = 0; i < n_threads && ok; i++)
+            ok = (trabalhos[i] = trabalho_criar()) != NULL;
+
+        // A cada rodada, as linhas de cada trecho são escritas na ordem dos trechos
+        for (uint32_t primeiro = 0; ok && primeiro < trechos; primeiro += (uint32_t)n_threads){
+            int n = trechos - primeiro < (uint32_t)n_threads ? (int)(trechos - primeiro) : n_threads;
+            rodada.primeiro = primeiro;
+            tarefas_executar(n, pesquisa_trecho, &rodada);
+            for (int i = 0; i < n; i++)
+                buffer_despejar(&trabalhos[i]->saida, saida);
+        }
+    }
+
+    if (!ok){
+        for (int i = 0; i < TAREFAS_MAX; i++) trabalho_apagar(&trabalhos[i]);
+        return false;
+    }
+
+    // Junta os agregados das threads
+    PESQUISA_TRABALHO* total = trabalhos[0];
+    for (int i = 1; i < n_threads; i++){
+        total->varridos += trabalhos[i]->varridos;
+        for (int g = 0; g < PESQUISA_MAX_GRUPOS; g++){
+            total->quantidade[g] += trabalhos[i]->quantidade[g];
+            total->soma[g] += trabalhos[i]->soma[g];
+            if (trabalhos[i]->minimo[g] < total->minimo[g]) total->minimo[g] = trabalhos[i]->minimo[g];
+            if (trabalhos[i]->maximo[g] > total->maximo[g]) total->maximo[g] = trabalhos[i]->maximo[g];
+        }
+    }
+
+    uint64_t selecionados = 0;
+    for (int g = 0; g < PESQUISA_MAX_GRUPOS; g++)
+        selecionados += total->quantidade[g];
+
+    if (pesquisa->acao != ACAO_LISTAR){
+        static const char* const nomes[] = { "quantidade", "", "media", "soma", "minimo", "maximo" };
+        char rotulo[32];
+        if (pesquisa->grupo != CAMPO_NENHUM)
+            fprintf(saida, "%-14s | ", campos[pesquisa->grupo].nome);
+        if (pesquisa->acao == ACAO_CONTAR)
+            fprintf(saida, "quantidade\n");
+        else
+            fprintf(saida, "%s(%s) | quantidade\n", nomes[pesquisa->acao], campos[pesquisa->agregado].nome);
+
+        for (int g = 0; g < PESQUISA_MAX_GRUPOS; g++){
+            // Sem grupos, tudo fica no grupo 0 (que sai mesmo vazio)
+            if (pesquisa->grupo == CAMPO_NENHUM ? g > 0 : total->quantidade[g] == 0) continue;
+            if (pesquisa->grupo != CAMPO_NENHUM){
+                pesquisa_rotulo(pesquisa->grupo, g, rotulo, sizeof(rotulo));
+                fprintf(saida, "%-14s | ", rotulo);
+            }
+            uint64_t q = total->quantidade[g];
+            switch (pesquisa->acao){
+            case ACAO_MEDIA:
+                if (q > 0) fprintf(saida, "%.2f | ", (double)total->soma[g] / (double)q);
+                else fprintf(saida, "- | ");
+                break;
+            case ACAO_SOMA:
+                fprintf(saida, "%lld | ", (long long)total->soma[g]);
+                break;
+            case ACAO_MINIMO:
+            case ACAO_MAXIMO:
+                if (q > 0) fprintf(saida, "%lld | ", (long long)(pesquisa->acao == ACAO_MINIMO ? total->minimo[g] : total->maximo[g]));
+                else fprintf(saida, "- | ");
+                break;
+            default:
+                break;
+            }
+            fprintf(saida, "%llu\n", (unsigned long long)q);
+        }
+    }
+
+#ifndef _WIN32
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+    double duracao_ms = (double)(fim.tv_sec - inicio.tv_sec) * 1e3 + (double)(fim.tv_nsec - inicio.tv_nsec) / 1e6;
+#else
+    double duracao_ms = (double)(clock() - inicio) * 1e3 / CLOCKS_PER_SEC;
+#endif
+    fprintf(saida, "%llu paciente(s) selecionado(s); %llu posição(ões) varrida(s) em %.1f ms (%d thread(s)).\n",
+            (unsigned long long)selecionados, (unsigned long long)total->varridos, duracao_ms, n_threads);
+
+    for (int i = 0; i < TAREFAS_MAX; i++) trabalho_apagar(&trabalhos[i]);
+    return true;
+}
@@ -0,0 +1,393 @@
+/**
+ * @file registro.c
+ * @brief Armazém central de pacientes em estrutura de vetores (SoA).
+ * @details Cada paciente recebe um identificador de 32 bits (PACIENTE_ID) que é
+ * o índice nos vetores abaixo. Os campos "quentes", consultados a todo momento
+ * pela LISTA e pela FILA (CPF empacotado, estado na fila, prioridade e horário
+ * de chegada), ficam em vetores densos e paralelos; os campos "frios" (nome e
+ * histórico) ficam na estrutura PACIENTE, alocada à parte.
+ *
+ * LISTA e FILA guardam apenas o identificador (4 bytes) em vez de um ponteiro
+ * (8 bytes), e varreduras como "quantos pacientes estão na fila" percorrem um
+ * único vetor contíguo de bytes.
+ *
+ * Identificadores liberados são reaproveitados por novos pacientes.
+ *
+ * Os vetores são alocados com heap_alocar() e os dados frios são guardados
+ * por posição (HEAP_REF): com o heap persistente (ver heap.c), o armazém é
+ * retomado por registro_restaurar() sem nenhuma cópia.
+ */
+
+#include "../include/registro.h"
+#include "../include/cpf.h"
+#include "../include/heap.h"
+
+/**
+ * @struct registro_
+ * @brief Vetores paralelos indexados por PACIENTE_ID.
+ */
+typedef struct registro_ {
+    uint64_t* cpf;        /**< CPF empacotado (CPF_INVALIDO marca posição livre). */
+    uint8_t* na_fila;     /**< 1 se o paciente está na fila de espera. */
+    uint8_t* prioridade;  /**< Prioridade (0 a 4) da última entrada na fila. */
+    int64_t* chegada;     /**< Horário (time_t) da última entrada na fila. */
+    uint8_t* marcas;      /**< Marcas REGISTRO_* (alteração e estado no cache). */
+    HEAP_REF* frio;       /**< Posição dos dados frios (nome e histórico). */
+    uint32_t quantidade;  /**< Posições já usadas alguma vez (maior id + 1). */
+    uint32_t capacidade;  /**< Posições alocadas em cada vetor. */
+    uint32_t ocupados;    /**< Pacientes vivos. */
+    uint32_t* livres;     /**< Pilha de ids liberados, para reaproveitamento. */
+    uint32_t n_livres;    /**< Quantidade de ids na pilha de livres. */
+} REGISTRO;
+
+static REGISTRO registro = { NULL, NULL, NULL, NULL, NULL, NULL, 0, 0, 0, NULL, 0 };
+
+/**
+ * @brief Armazém guardado no heap persistente (HEAP_RAIZ_REGISTRO).
+ */
+typedef struct registro_raiz_ {
+    HEAP_REF cpf;           ///< Posição do vetor de CPFs
+    HEAP_REF na_fila;       ///< Posição do vetor de estados na fila
+    HEAP_REF prioridade;    ///< Posição do vetor de prioridades
+    HEAP_REF chegada;       ///< Posição do vetor de horários de chegada
+    HEAP_REF marcas;        ///< Posição do vetor de marcas
+    HEAP_REF frio;          ///< Posição do vetor de dados frios
+    HEAP_REF livres;        ///< Posição da pilha de ids livres
+    uint32_t quantidade;    ///< Posições já usadas
+    uint32_t capacidade;    ///< Posições alocadas em cada vetor
+    uint32_t ocupados;      ///< Pacientes vivos
+    uint32_t n_livres;      ///< Ids na pilha de livres
+} REGISTRO_RAIZ;
+
+_Static_assert(sizeof(REGISTRO_RAIZ) <= HEAP_TAM_RAIZ, "raiz do armazém deve caber no cabeçalho do heap");
+
+/**
+ * @brief Aumenta a capacidade de todos os vetores.
+ * @param minima Capacidade mínima desejada (0 = apenas dobrar).
+ * @return true se todas as realocações funcionaram.
+ */
+static bool registro_crescer(uint32_t minima){
+    uint32_t nova = registro.capacidade ? registro.capacidade * 2 : 64;
+    if (nova < minima)
+        nova = minima;
+    void* p;
+
+    if ((p = heap_realocar(registro.cpf, nova * sizeof(uint64_t))) == NULL) return false;
+    registro.cpf = p;
+    if ((p = heap_realocar(registro.na_fila, nova * sizeof(uint8_t))) == NULL) return false;
+    registro.na_fila = p;
+    if ((p = heap_realocar(registro.prioridade, nova * sizeof(uint8_t))) == NULL) return false;
+    registro.prioridade = p;
+    if ((p = heap_realocar(registro.chegada, nova * sizeof(int64_t))) == NULL) return false;
+    registro.chegada = p;
+    if ((p = heap_realocar(registro.marcas, nova * sizeof(uint8_t))) == NULL) return false;
+    registro.marcas = p;
+    if ((p = heap_realocar(registro.frio, nova * sizeof(HEAP_REF))) == NULL) return false;
+    registro.frio = p;
+    if ((p = heap_realocar(registro.livres, nova * sizeof(uint32_t))) == NULL) return false;
+    registro.livres = p;
+
+    registro.capacidade = nova;
+    return true;
+}
+
+/**
+ * @brief Reserva um identificador para um paciente recém-criado.
+ * @note O paciente começa marcado como REGISTRO_ALTERADO: ainda não está no
+ * arquivo de dados. Quem o reconstrói do arquivo desliga a marca.
+ * @param paciente Dados frios do paciente.
+ * @param cpf CPF empacotado (ver cpf_empacotar()).
+ * @return PACIENTE_ID Identificador ou PACIENTE_ID_INVALIDO se faltar memória.
+ */
+PACIENTE_ID registro_alocar(PACIENTE* paciente, uint64_t cpf){
+    PACIENTE_ID id;
+
+    if (registro.n_livres > 0){
+        id = registro.livres[--registro.n_livres];
+    } else {
+        if (registro.quantidade == registro.capacidade && !registro_crescer(0))
+            return PACIENTE_ID_INVALIDO;
+        id = registro.quantidade++;
+    }
+
+    registro.cpf[id] = cpf;
+    registro.na_fila[id] = 0;
+    registro.prioridade[id] = 0;
+    registro.chegada[id] = 0;
+    registro.marcas[id] = REGISTRO_ALTERADO;
+    registro.frio[id] = heap_referencia(paciente);
+    registro.ocupados++;
+    return id;
+}
+
+/**
+ * @brief Garante espaço para mais `n` pacientes sem novas realocações.
+ * @details Usada antes de registrar muitos pacientes de uma vez (LOAD), para
+ * que os vetores cresçam uma única vez em vez de dobrar repetidamente.
+ * @param n Quantidade de pacientes que serão alocados.
+ * @return true se havia (ou foi reservado) espaço suficiente.
+ */
+bool registro_reservar(uint32_t n){
+    uint64_t necessaria = (uint64_t)registro.quantidade + n;
+    if (necessaria > PACIENTE_ID_INVALIDO)
+        return false;
+    if (necessaria <= registro.capacidade)
+        return true;
+    return registro_crescer((uint32_t)necessaria);
+}
+
+/**
+ * @brief Devolve um identificador ao armazém.
+ * @param id Identificador do paciente apagado.
+ */
+void registro_liberar(PACIENTE_ID id){
+    if (id < registro.quantidade && registro.frio[id] != 0){
+        registro.cpf[id] = CPF_INVALIDO;
+        registro.na_fila[id] = 0;
+        registro.marcas[id] = 0;
+        registro.frio[id] = 0;
+        registro.livres[registro.n_livres++] = id;
+        registro.ocupados--;
+    }
+}
+
+/**
+ * @brief Obtém os dados frios de um paciente.
+ * @param id Identificador.
+ * @return PACIENTE* Paciente ou NULL se o id estiver livre/for inválido.
+ */
+PACIENTE* registro_paciente(PACIENTE_ID id){
+    if (id < registro.quantidade){
+        return (PACIENTE*)heap_ponteiro(registro.frio[id]);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Obtém o CPF empacotado de um paciente.
+ * @param id Identificador.
+ * @return uint64_t CPF ou CPF_INVALIDO.
+ */
+uint64_t registro_cpf(PACIENTE_ID id){
+    if (id < registro.quantidade){
+        return registro.cpf[id];
+    }
+    return CPF_INVALIDO;
+}
+
+/**
+ * @brief Atualiza o CPF empacotado de um paciente.
+ * @param id Identificador.
+ * @param cpf Novo CPF empacotado.
+ */
+void registro_definir_cpf(PACIENTE_ID id, uint64_t cpf){
+    if (id < registro.quantidade){
+        registro.cpf[id] = cpf;
+    }
+}
+
+/**
+ * @brief Verifica se o paciente está na fila de espera.
+ * @param id Identificador.
+ * @return true se estiver na fila.
+ */
+bool registro_na_fila(PACIENTE_ID id){
+    if (id < registro.quantidade){
+        return registro.na_fila[id] != 0;
+    }
+    return false;
+}
+
+/**
+ * @brief Prioridade com que o paciente entrou (pela última vez) na fila.
+ * @param id Identificador.
+ * @return int Prioridade (0 a 4) ou -1 se o id for inválido.
+ */
+int registro_prioridade(PACIENTE_ID id){
+    if (id < registro.quantidade){
+        return registro.prioridade[id];
+    }
+    return -1;
+}
+
+/**
+ * @brief Horário em que o paciente entrou (pela última vez) na fila.
+ * @param id Identificador.
+ * @return int64_t Horário (time_t) ou 0 se nunca entrou.
+ */
+int64_t registro_chegada(PACIENTE_ID id){
+    if (id < registro.quantidade){
+        return registro.chegada[id];
+    }
+    return 0;
+}
+
+/**
+ * @brief Marca a entrada do paciente na fila.
+ * @param id Identificador.
+ * @param prioridade Prioridade (0 a 4).
+ * @param chegada Horário de chegada (time_t).
+ */
+void registro_entrar_fila(PACIENTE_ID id, int prioridade, int64_t chegada){
+    if (id < registro.quantidade){
+        registro.na_fila[id] = 1;
+        registro.prioridade[id] = (uint8_t)prioridade;
+        registro.chegada[id] = chegada;
+    }
+}
+
+/**
+ * @brief Marca a saída do paciente da fila (prioridade e chegada são mantidas).
+ * @param id Identificador.
+ */
+void registro_sair_fila(PACIENTE_ID id){
+    if (id < registro.quantidade){
+        registro.na_fila[id] = 0;
+    }
+}
+
+/**
+ * @brief Obtém as marcas REGISTRO_* de um paciente.
+ * @param id Identificador.
+ * @return uint8_t Marcas ou 0 se o id estiver livre/for inválido.
+ */
+uint8_t registro_marcas(PACIENTE_ID id){
+    if (id < registro.quantidade){
+        return registro.marcas[id];
+    }
+    return 0;
+}
+
+/**
+ * @brief Liga marcas REGISTRO_* de um paciente.
+ * @param id Identificador.
+ * @param marcas Marcas a ligar.
+ */
+void registro_ligar_marcas(PACIENTE_ID id, uint8_t marcas){
+    if (id < registro.quantidade && registro.frio[id] != 0){
+        registro.marcas[id] |= marcas;
+    }
+}
+
+/**
+ * @brief Desliga marcas REGISTRO_* de um paciente.
+ * @param id Identificador.
+ * @param marcas Marcas a desligar.
+ */
+void registro_desligar_marcas(PACIENTE_ID id, uint8_t marcas){
+    if (id < registro.quantidade){
+        registro.marcas[id] &= (uint8_t)~marcas;
+    }
+}
+
+/**
+ * @brief Quantidade de posições já usadas (ids válidos são menores que este valor).
+ * @return uint32_t Maior id + 1.
+ */
+uint32_t registro_limite(void){
+    return registro.quantidade;
+}
+
+/**
+ * @brief Quantidade de pacientes vivos no armazém.
+ * @return uint32_t Pacientes alocados e não liberados.
+ */
+uint32_t registro_quantidade(void){
+    return registro.ocupados;
+}
+
+/**
+ * @brief Conta os pacientes na fila varrendo o vetor denso de estados.
+ * @note O laço sobre bytes contíguos é vetorizado pelo compilador.
+ * @return uint32_t Quantidade de pacientes com estado "na fila".
+ */
+uint32_t registro_contar_na_fila(void){
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < registro.quantidade; i++)
+        total += registro.na_fila[i];
+    return total;
+}
+
+/**
+ * @brief Expõe os vetores quentes para varreduras em blocos, sem uma chamada por paciente.
+ * @param vetores Recebe os vetores e a quantidade de posições.
+ */
+void registro_vetores(REGISTRO_VETORES* vetores){
+    vetores->cpf = registro.cpf;
+    vetores->na_fila = registro.na_fila;
+    vetores->prioridade = registro.prioridade;
+    vetores->chegada = registro.chegada;
+    vetores->limite = registro.quantidade;
+}
+
+/**
+ * @brief Guarda a posição dos vetores e os contadores no heap persistente.
+ * @return true se havia heap ativo.
+ */
+bool registro_persistir(void){
+    REGISTRO_RAIZ* raiz = heap_raiz(HEAP_RAIZ_REGISTRO);
+    if (raiz == NULL)
+        return false;
+
+    raiz->cpf = heap_referencia(registro.cpf);
+    raiz->na_fila = heap_referencia(registro.na_fila);
+    raiz->prioridade = heap_referencia(registro.prioridade);
+    raiz->chegada = heap_referencia(registro.chegada);
+    raiz->marcas = heap_referencia(registro.marcas);
+    raiz->frio = heap_referencia(registro.frio);
+    raiz->livres = heap_referencia(registro.livres);
+    raiz->quantidade = registro.quantidade;
+    raiz->capacidade = registro.capacidade;
+    raiz->ocupados = registro.ocupados;
+    raiz->n_livres = registro.n_livres;
+    return true;
+}
+
+/**
+ * @brief Retoma o armazém guardado por registro_persistir().
+ * @note O armazém precisa estar vazio.
+ * @return true se o armazém foi retomado.
+ */
+bool registro_restaurar(void){
+    return registro.capacidade == 0 && registro_sincronizar();
+}
+
+/**
+ * @brief Relê a posição dos vetores e os contadores guardados no heap.
+ * @details No heap compartilhado, outro processo pode ter cadastrado
+ * pacientes (e realocado os vetores) desde a última leitura; os vetores
+ * anteriores já foram liberados por ele, então nada é liberado aqui.
+ * @return true se havia heap ativo.
+ */
+bool registro_sincronizar(void){
+    REGISTRO_RAIZ* raiz = heap_raiz(HEAP_RAIZ_REGISTRO);
+    if (raiz == NULL || raiz->quantidade > raiz->capacidade)
+        return false;
+
+    registro.cpf = heap_ponteiro(raiz->cpf);
+    registro.na_fila = heap_ponteiro(raiz->na_fila);
+    registro.prioridade = heap_ponteiro(raiz->prioridade);
+    registro.chegada = heap_ponteiro(raiz->chegada);
+    registro.marcas = heap_ponteiro(raiz->marcas);
+    registro.frio = heap_ponteiro(raiz->frio);
+    registro.livres = heap_ponteiro(raiz->livres);
+    registro.quantidade = raiz->quantidade;
+    registro.capacidade = raiz->capacidade;
+    registro.ocupados = raiz->ocupados;
+    registro.n_livres = raiz->n_livres;
+    return true;
+}
+
+/**
+ * @brief Libera os vetores do armazém (os pacientes devem ter sido apagados antes).
+ */
+void registro_apagar(void){
+    heap_liberar(registro.cpf);
+    heap_liberar(registro.na_fila);
+    heap_liberar(registro.prioridade);
+    heap_liberar(registro.chegada);
+    heap_liberar(registro.marcas);
+    heap_liberar(registro.frio);
+    heap_liberar(registro.livres);
+    memset(&registro, 0, sizeof(REGISTRO));
+}
@@ -0,0 +1,392 @@
+/**
+ * @file relatorio.c
+ * @brief Relatório de todos os pacientes, em ordem de CPF, em texto, CSV, JSON ou JSON Lines.
+ * @details A árvore da LISTA é dividida pelos CPFs dos nós dos primeiros
+ * níveis (ver lista_divisores()) em intervalos que cobrem subárvores
+ * disjuntas. Cada intervalo é percorrido e formatado por uma thread (ver
+ * tarefas.c) no próprio buffer, sem printf: os campos são copiados direto,
+ * com o espaço de cada paciente reservado de uma vez. A cada rodada de
+ * threads, os buffers são escritos na ordem dos intervalos, cada um em uma
+ * única chamada a write(), então a saída é a mesma de um percurso em ordem.
+ *
+ * A quantidade de intervalos acompanha o tamanho do armazém (cerca de
+ * RELATORIO_TRECHO pacientes por intervalo), o que limita a memória dos
+ * buffers a poucas rodadas de threads em vez do relatório inteiro.
+ *
+ * No modo sob demanda, parte dos pacientes só existe no arquivo de dados: o
+ * relatório segue lista_percorrer_registros(), em uma thread, e escreve a
+ * cada RELATORIO_DESPEJO bytes.
+ */
+
+#include "../include/relatorio.h"
+#include "../include/IO.h"
+#include "../include/cpf.h"
+#include "../include/paciente.h"
+#include "../include/registro.h"
+#include "../include/tarefas.h"
+#include <string.h>
+#include <time.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+#define RELATORIO_TRECHO 32768          ///< Pacientes desejados por intervalo da árvore
+#define RELATORIO_MAX_PARTES 4096       ///< Maior quantidade de intervalos
+#define RELATORIO_DESPEJO (1 << 20)     ///< Bytes acumulados antes de escrever (modo sob demanda)
+
+/**
+ * @brief Texto formatado por uma thread.
+ */
+typedef struct relatorio_buffer_ {
+    char* dados;
+    size_t tamanho;
+    size_t capacidade;
+    uint64_t pacientes;     /**< Pacientes formatados no buffer. */
+    bool falhou;            /**< Faltou memória em algum paciente. */
+} RELATORIO_BUFFER;
+
+/**
+ * @brief Garante espaço para mais n bytes.
+ */
+static bool relatorio_reservar(RELATORIO_BUFFER* b, size_t n){
+    if (b->tamanho + n <= b->capacidade) return true;
+    size_t nova = b->capacidade ? b->capacidade : 65536;
+    while (nova < b->tamanho + n) nova *= 2;
+    char* p = (char*)realloc(b->dados, nova);
+    if (p == NULL){
+        b->falhou = true;
+        return false;
+    }
+    b->dados = p;
+    b->capacidade = nova;
+    return true;
+}
+
+/**
+ * @brief Copia n bytes para o fim do buffer (espaço já reservado).
+ */
+static inline char* relatorio_copiar(char* destino, const char* texto, size_t n){
+    memcpy(destino, texto, n);
+    return destino + n;
+}
+
+#define RELATORIO_LITERAL(destino, literal) relatorio_copiar((destino), (literal), sizeof(literal) - 1)
+
+/**
+ * @brief Copia o nome entre aspas duplas, com as aspas internas dobradas (CSV).
+ * @details Os trechos sem aspas são copiados de uma vez.
+ */
+static char* relatorio_csv(char* d, const char* nome, size_t tam_nome){
+    *d++ = '"';
+    const char* aspas;
+    while ((aspas = memchr(nome, '"', tam_nome)) != NULL){
+        size_t n = (size_t)(aspas - nome) + 1;
+        d = relatorio_copiar(d, nome, n);
+        *d++ = '"';
+        nome += n;
+        tam_nome -= n;
+    }
+    d = relatorio_copiar(d, nome, tam_nome);
+    *d++ = '"';
+    return d;
+}
+
+/**
+ * @brief Copia o nome como string JSON (aspas, barra e controles escapados).
+ * @details Os trechos sem nada a escapar são copiados de uma vez.
+ */
+static char* relatorio_json(char* d, const char* nome, size_t tam_nome){
+    static const char hexa[] = "0123456789abcdef";
+    *d++ = '"';
+    size_t inicio = 0;
+    for (size_t i = 0; i < tam_nome; i++){
+        unsigned char c = (unsigned char)nome[i];
+        if (c != '"' && c != '\\' && c >= 0x20) continue;
+
+        d = relatorio_copiar(d, nome + inicio, i - inicio);
+        inicio = i + 1;
+        if (c < 0x20){
+            d = RELATORIO_LITERAL(d, "\\u00");
+            *d++ = hexa[c >> 4];
+            *d++ = hexa[c & 0xF];
+        } else {
+            *d++ = '\\';
+            *d++ = (char)c;
+        }
+    }
+    d = relatorio_copiar(d, nome + inicio, tam_nome - inicio);
+    *d++ = '"';
+    return d;
+}
+
+/**
+ * @brief Formata um paciente no fim do buffer.
+ * @details No JSON, todo objeto vem precedido de ",\n"; a vírgula do primeiro
+ * do relatório é pulada na escrita (ver relatorio_despejar()).
+ */
+static void relatorio_formatar(RELATORIO_BUFFER* b, RELATORIO_FORMATO formato, PACIENTE* p){
+    const char* nome = paciente_obter_nome(p);
+    const char* cpf = paciente_obter_cpf(p);
+    if (nome == NULL) nome = "";
+    if (cpf == NULL) cpf = "";
+    size_t tam_nome = strlen(nome), tam_cpf = strlen(cpf);
+    bool na_fila = paciente_esta_na_fila(p);
+
+    // Pior caso: cada byte do nome vira \u00XX no JSON, mais os rótulos
+    if (!relatorio_reservar(b, tam_nome * 6 + tam_cpf + 96)) return;
+    char* d = b->dados + b->tamanho;
+
+    switch (formato){
+    case RELATORIO_TEXTO:
+        d = RELATORIO_LITERAL(d, "NOME: ");
+        d = relatorio_copiar(d, nome, tam_nome);
+        d = RELATORIO_LITERAL(d, "\nCPF: ");
+        d = relatorio_copiar(d, cpf, tam_cpf);
+        if (na_fila) d = RELATORIO_LITERAL(d, "\nESTADO: NA FILA DE ATENDIMENTO\n\n");
+        else d = RELATORIO_LITERAL(d, "\nESTADO: FORA DA FILA DE ATENDIMENTO\n\n");
+        break;
+    case RELATORIO_CSV:
+        d = relatorio_copiar(d, cpf, tam_cpf);
+        *d++ = ',';
+        d = relatorio_csv(d, nome, tam_nome);
+        d = na_fila ? RELATORIO_LITERAL(d, ",1\n") : RELATORIO_LITERAL(d, ",0\n");
+        break;
+    case RELATORIO_JSON:
+    case RELATORIO_JSONL:
+        d = formato == RELATORIO_JSON ? RELATORIO_LITERAL(d, ",\n{\"cpf\":\"") : RELATORIO_LITERAL(d, "{\"cpf\":\"");
+        d = relatorio_copiar(d, cpf, tam_cpf);
+        d = RELATORIO_LITERAL(d, "\",\"nome\":");
+        d = relatorio_json(d, nome, tam_nome);
+        d = na_fila ? RELATORIO_LITERAL(d, ",\"na_fila\":true}") : RELATORIO_LITERAL(d, ",\"na_fila\":false}");
+        if (formato == RELATORIO_JSONL) *d++ = '\n';
+        break;
+    }
+
+    b->tamanho = (size_t)(d - b->dados);
+    b->pacientes++;
+}
+
+/**
+ * @brief Estado da escrita: destino, formato e bytes já escritos.
+ */
+typedef struct relatorio_escrita_ {
+    FILE* saida;
+    RELATORIO_FORMATO formato;
+    bool primeiro;          /**< Nenhum paciente escrito ainda (vírgula do JSON). */
+    bool ok;                /**< Todas as escritas completas. */
+    uint64_t bytes;         /**< Bytes escritos. */
+} RELATORIO_ESCRITA;
+
+/**
+ * @brief Escreve n bytes no destino, sem passar pelo buffer do FILE.
+ */
+static void relatorio_escrever(RELATORIO_ESCRITA* e, const char* dados, size_t n){
+    if (!e->ok || n == 0) return;
+#ifdef _WIN32
+    e->ok = fwrite(dados, 1, n, e->saida) == n;
+#else
+    int fd = fileno(e->saida);
+    size_t restante = n;
+    while (restante > 0){
+        ssize_t escritos = write(fd, dados, restante);
+        if (escritos < 0 && errno == EINTR) continue;
+        if (escritos <= 0){
+            e->ok = false;
+            return;
+        }
+        dados += escritos;
+        restante -= (size_t)escritos;
+    }
+#endif
+    e->bytes += n;
+}
+
+/**
+ * @brief Escreve e esvazia um buffer, tirando a vírgula do primeiro objeto JSON.
+ */
+static void relatorio_despejar(RELATORIO_ESCRITA* e, RELATORIO_BUFFER* b){
+    size_t inicio = 0;
+    if (e->formato == RELATORIO_JSON && e->primeiro && b->tamanho > 0)
+        inicio = 1;
+    if (b->tamanho > inicio){
+        relatorio_escrever(e, b->dados + inicio, b->tamanho - inicio);
+        e->primeiro = false;
+    }
+    b->tamanho = 0;
+}
+
+/**
+ * @brief Contexto de uma thread: buffer e formato.
+ */
+typedef struct relatorio_trabalho_ {
+    RELATORIO_BUFFER buffer;
+    RELATORIO_FORMATO formato;
+} RELATORIO_TRABALHO;
+
+/**
+ * @brief Callback dos percursos: formata o paciente no buffer da thread.
+ */
+static void relatorio_acao(PACIENTE* p, void* contexto){
+    RELATORIO_TRABALHO* t = (RELATORIO_TRABALHO*)contexto;
+    if (p != NULL)
+        relatorio_formatar(&t->buffer, t->formato, p);
+}
+
+/**
+ * @brief Uma rodada de threads: cada uma formata um intervalo da árvore.
+ */
+typedef struct relatorio_rodada_ {
+    LISTA* lista;
+    const uint64_t* divisores;      /**< CPFs que separam os intervalos. */
+    int n_divisores;                /**< Quantidade de divisores (intervalos - 1). */
+    int primeira;                   /**< Primeiro intervalo da rodada. */
+    RELATORIO_TRABALHO* trabalhos;  /**< Um por thread. */
+} RELATORIO_RODADA;
+
+/**
+ * @brief Tarefa de uma thread: percorre o intervalo primeira + indice.
+ */
+static void relatorio_parte(void* contexto, int indice){
+    RELATORIO_RODADA* r = (RELATORIO_RODADA*)contexto;
+    int parte = r->primeira + indice;
+    uint64_t de = parte == 0 ? 0 : r->divisores[parte - 1];
+    uint64_t ate = parte == r->n_divisores ? CPF_INVALIDO : r->divisores[parte];
+    lista_percorrer_intervalo(r->lista, de, ate, relatorio_acao, &r->trabalhos[indice]);
+}
+
+/**
+ * @brief Contexto do relatório no modo sob demanda.
+ */
+typedef struct relatorio_sequencial_ {
+    RELATORIO_TRABALHO trabalho;
+    RELATORIO_ESCRITA* escrita;
+} RELATORIO_SEQUENCIAL;
+
+/**
+ * @brief Callback de lista_percorrer_registros(): formata e escreve a cada RELATORIO_DESPEJO bytes.
+ */
+static void relatorio_registro(PACIENTE* p, uint64_t chave, const char* bytes, uint32_t tamanho, void* contexto){
+    (void)chave;
+    RELATORIO_SEQUENCIAL* s = (RELATORIO_SEQUENCIAL*)contexto;
+
+    if (p != NULL){
+        relatorio_formatar(&s->trabalho.buffer, s->trabalho.formato, p);
+    } else if ((p = paciente_de_bytes_sem_registro(bytes, tamanho)) != NULL){
+        relatorio_formatar(&s->trabalho.buffer, s->trabalho.formato, p);
+        paciente_apagar(&p);
+    }
+
+    if (s->trabalho.buffer.tamanho >= RELATORIO_DESPEJO)
+        relatorio_despejar(s->escrita, &s->trabalho.buffer);
+}
+
+/**
+ * @brief Escreve todos os pacientes em ordem crescente de CPF.
+ *
+ * @param lista Lista de pacientes.
+ * @param formato Texto, CSV, JSON ou JSON Lines.
+ * @param saida Destino (ex.: stdout ou um arquivo aberto para escrita).
+ * @param medida Onde guardar as medições (pode ser NULL).
+ * @return false se faltou memória ou a escrita falhou.
+ */
+bool relatorio_pacientes(LISTA* lista, RELATORIO_FORMATO formato, FILE* saida, RELATORIO_MEDIDA* medida){
+    if (lista == NULL || saida == NULL) return false;
+
+#ifndef _WIN32
+    struct timespec inicio, fim;
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+#else
+    clock_t inicio = clock();
+#endif
+
+    // O que já estava no buffer do FILE sai antes das escritas diretas
+    fflush(saida);
+    RELATORIO_ESCRITA escrita = { saida, formato, true, true, 0 };
+    uint64_t pacientes = 0;
+    int partes = 1, n_threads = 1;
+    bool memoria = true;
+
+    static const char* const cabecalhos[] = {
+        [RELATORIO_TEXTO] = "Lista de Pacientes (em ordem crescente de CPF):\n",
+        [RELATORIO_CSV]   = "cpf,nome,na_fila\n",
+        [RELATORIO_JSON]  = "[",
+        [RELATORIO_JSONL] = "",
+    };
+    relatorio_escrever(&escrita, cabecalhos[formato], strlen(cabecalhos[formato]));
+
+    if (IO_sob_demanda()){
+        // Pacientes fora da memória só são alcançados pela LISTA, em ordem
+        RELATORIO_SEQUENCIAL s;
+        memset(&s, 0, sizeof(s));
+        s.trabalho.formato = formato;
+        s.escrita = &escrita;
+        lista_percorrer_registros(lista, relatorio_registro, &s);
+        relatorio_despejar(&escrita, &s.trabalho.buffer);
+        pacientes = s.trabalho.buffer.pacientes;
+        memoria = !s.trabalho.buffer.falhou;
+        free(s.trabalho.buffer.dados);
+    } else {
+        // Cerca de RELATORIO_TRECHO pacientes por intervalo, e ao menos um por thread
+        REGISTRO_VETORES vetores;
+        registro_vetores(&vetores);
+        n_threads = tarefas_quantidade();
+        size_t desejadas = vetores.limite / RELATORIO_TRECHO;
+        if (desejadas < (size_t)n_threads) desejadas = (size_t)n_threads;
+        if (desejadas > RELATORIO_MAX_PARTES) desejadas = RELATORIO_MAX_PARTES;
+
+        uint64_t* divisores = (uint64_t*)malloc(RELATORIO_MAX_PARTES * sizeof(uint64_t));
+        RELATORIO_TRABALHO* trabalhos = (RELATORIO_TRABALHO*)calloc(TAREFAS_MAX, sizeof(RELATORIO_TRABALHO));
+        memoria = divisores != NULL && trabalhos != NULL;
+
+        if (memoria){
+            RELATORIO_RODADA rodada;
+            rodada.lista = lista;
+            rodada.divisores = divisores;
+            rodada.n_divisores = (int)lista_divisores(lista, divisores, desejadas - 1);
+            rodada.trabalhos = trabalhos;
+            partes = rodada.n_divisores + 1;
+            if (n_threads > partes) n_threads = partes;
+            for (int i = 0; i < n_threads; i++)
+                trabalhos[i].formato = formato;
+
+            // A cada rodada, os intervalos são escritos na ordem da árvore
+            for (int primeira = 0; primeira < partes && escrita.ok && memoria; primeira += n_threads){
+                int n = partes - primeira < n_threads ? partes - primeira : n_threads;
+                rodada.primeira = primeira;
+                tarefas_executar(n, relatorio_parte, &rodada);
+                for (int i = 0; i < n; i++){
+                    memoria = memoria && !trabalhos[i].buffer.falhou;
+                    relatorio_despejar(&escrita, &trabalhos[i].buffer);
+                }
+            }
+
+            for (int i = 0; i < n_threads; i++){
+                pacientes += trabalhos[i].buffer.pacientes;
+                free(trabalhos[i].buffer.dados);
+            }
+        }
+        free(divisores);
+        free(trabalhos);
+    }
+
+    if (formato == RELATORIO_JSON)
+        relatorio_escrever(&escrita, "\n]\n", 3);
+
+#ifndef _WIN32
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+    double duracao_ms = (double)(fim.tv_sec - inicio.tv_sec) * 1e3 + (double)(fim.tv_nsec - inicio.tv_nsec) / 1e6;
+#else
+    double duracao_ms = (double)(clock() - inicio) * 1e3 / CLOCKS_PER_SEC;
+#endif
+
+    if (medida != NULL){
+        medida->pacientes = pacientes;
+        medida->bytes = escrita.bytes;
+        medida->partes = partes;
+        medida->threads = n_threads;
+        medida->duracao_ms = duracao_ms;
+    }
+    return memoria && escrita.ok;
+}
@@ -0,0 +1,185 @@
+/**
+ * @file replica.c
+ * @brief Réplica somente leitura do processo principal, no mesmo computador.
+ * @details Com PS_REPLICA=1, o programa não atende a triagem: ele carrega os
+ * arquivos do último SAVE e acompanha o log de operações (data/wal.bin) que o
+ * processo principal vai anexando, aplicando os registros novos sobre a sua
+ * própria LISTA e FILA (ver wal_acompanhar()). Assim buscas, listagens e o
+ * painel da fila de espera podem ser servidos por outros processos sem
+ * disputar o processo da triagem.
+ *
+ * A réplica é atualizada antes de cada consulta, então toda resposta inclui
+ * as operações já confirmadas no log até aquele instante; o custo é o de
+ * aplicar só os registros novos.
+ *
+ * Um SAVE ou snapshot do processo principal substitui os arquivos de dados e
+ * trunca ou rotaciona o log. O arquivo da fila é renomeado por último em
+ * todo SAVE (ver SAVE()), então uma mudança nele indica que há um SAVE novo
+ * em disco: a réplica descarta as estruturas e recarrega os arquivos e o log.
+ * O mesmo acontece se o log foi truncado sem que a réplica o tenha visto.
+ *
+ * A recarga pode acontecer logo após a troca dos arquivos, antes de o
+ * processo principal truncar o log: o log lido ainda tem os registros que os
+ * arquivos novos já contêm. O LOAD registra a sequência gravada em cada
+ * arquivo (ver wal_definir_pontos()), e wal_acompanhar() pula os registros
+ * até ela, então nenhuma operação é aplicada duas vezes (por exemplo, um
+ * procedimento repetido no histórico). Com o heap compartilhado os arquivos
+ * não guardam a sequência (ver SAVE()) e essa proteção não existe.
+ *
+ * A réplica nunca grava: não usa o heap persistente (que pertence ao
+ * processo principal), não faz snapshots, não escreve no log e não salva ao
+ * sair. A lista é sempre carregada por inteiro, pois o arquivo mapeado no
+ * modo sob demanda pode ser alterado pelo processo principal.
+ */
+
+#include "../include/replica.h"
+#include "../include/IO.h"
+#include "../include/catalogo.h"
+#include "../include/registro.h"
+#include "../include/wal.h"
+#include <string.h>
+#include <sys/stat.h>
+
+#define REPLICA_ARQUIVO_MARCO "data/fila_itens.bin" ///< Último arquivo substituído pelo SAVE (ver IO.c)
+
+/**
+ * @brief Identificação do arquivo de dados gravado pelo último SAVE visto.
+ */
+typedef struct replica_marco_ {
+    bool existe;
+    uint64_t dispositivo;
+    uint64_t inode;
+    int64_t tamanho;
+    int64_t segundos;       /**< Modificação do arquivo. */
+    int64_t nanossegundos;  /**< Fração da modificação, onde disponível. */
+} REPLICA_MARCO;
+
+/**
+ * @struct replica_
+ * @brief Estado da réplica.
+ */
+typedef struct replica_ {
+    bool ativa;
+    bool recarregar;        /**< O log mudou durante a carga: recarregar na próxima atualização. */
+    REPLICA_MARCO marco;    /**< SAVE em que as estruturas foram carregadas. */
+    uint64_t aplicadas;     /**< Registros do log aplicados desde o início. */
+    int recargas;           /**< Vezes em que os arquivos foram recarregados depois do início. */
+} REPLICA;
+
+static REPLICA replica;
+
+/**
+ * @brief Lê a identificação atual do arquivo de dados usado como marco.
+ */
+static void replica_marcar(REPLICA_MARCO* marco){
+    struct stat info;
+    memset(marco, 0, sizeof(REPLICA_MARCO));
+    if (stat(REPLICA_ARQUIVO_MARCO, &info) != 0)
+        return;
+
+    marco->existe = true;
+    marco->dispositivo = (uint64_t)info.st_dev;
+    marco->inode = (uint64_t)info.st_ino;
+    marco->tamanho = (int64_t)info.st_size;
+    marco->segundos = (int64_t)info.st_mtime;
+#ifdef __linux__
+    marco->nanossegundos = (int64_t)info.st_mtim.tv_nsec;
+#endif
+}
+
+/**
+ * @brief Compara duas identificações do arquivo de marco.
+ * @return true se são do mesmo arquivo, sem modificação entre elas.
+ */
+static bool replica_mesmo_marco(const REPLICA_MARCO* a, const REPLICA_MARCO* b){
+    return a->existe == b->existe && a->dispositivo == b->dispositivo && a->inode == b->inode &&
+           a->tamanho == b->tamanho && a->segundos == b->segundos && a->nanossegundos == b->nanossegundos;
+}
+
+/**
+ * @brief Lê a variável de ambiente PS_REPLICA.
+ * @return true se o programa deve funcionar como réplica.
+ */
+bool replica_configurar(void){
+    const char* valor = getenv(REPLICA_VARIAVEL);
+    replica.ativa = valor != NULL && strcmp(valor, "1") == 0;
+    return replica.ativa;
+}
+
+/**
+ * @brief Indica se o programa está funcionando como réplica.
+ */
+bool replica_ativa(void){
+    return replica.ativa;
+}
+
+/**
+ * @brief Carrega a LISTA e a FILA do último SAVE e aplica o log atual.
+ * @details O marco é lido antes do LOAD: um SAVE concluído durante a carga
+ * faz a próxima atualização recarregar de novo. Os registros do log que os
+ * arquivos já contêm são pulados pelas sequências lidas no LOAD.
+ * @param lista Ponteiro para o ponteiro da LISTA já criada
+ * @param fila  Ponteiro para o ponteiro da FILA já criada
+ * @return true se o LOAD carregou os arquivos com sucesso
+ */
+bool replica_carregar(LISTA** lista, FILA** fila){
+    replica_marcar(&replica.marco);
+    wal_parar_acompanhamento();
+
+    bool ok = LOAD(lista, fila);
+    int aplicadas = wal_acompanhar(WAL_ARQUIVO, *lista, *fila);
+    replica.recarregar = aplicadas < 0;
+    if (aplicadas > 0)
+        replica.aplicadas += (uint64_t)aplicadas;
+    return ok;
+}
+
+/**
+ * @brief Traz a réplica até o estado atual do processo principal.
+ * @details Aplica os registros novos do log. Se houve um SAVE desde a
+ * última carga, ou se o log foi truncado, as estruturas são apagadas e
+ * recriadas, e os arquivos e o log são carregados de novo.
+ * @param lista Ponteiro para o ponteiro da LISTA da réplica
+ * @param fila  Ponteiro para o ponteiro da FILA da réplica
+ * @return int Registros do log aplicados, ou -1 se as estruturas foram recarregadas
+ */
+int replica_atualizar(LISTA** lista, FILA** fila){
+    if (!replica.ativa || !lista || !(*lista) || !fila || !(*fila))
+        return 0;
+
+    REPLICA_MARCO atual;
+    replica_marcar(&atual);
+
+    if (!replica.recarregar && replica_mesmo_marco(&atual, &replica.marco)){
+        int aplicadas = wal_acompanhar(WAL_ARQUIVO, *lista, *fila);
+        if (aplicadas >= 0){
+            replica.aplicadas += (uint64_t)aplicadas;
+            return aplicadas;
+        }
+    }
+
+    lista_apagar(lista);
+    fila_apagar(fila);
+    registro_apagar();
+    catalogo_apagar();
+
+    *lista = lista_criar();
+    *fila = fila_criar();
+    replica.recargas++;
+    replica_carregar(lista, fila);
+    return -1;
+}
+
+/**
+ * @brief Quantidade de registros do log aplicados pela réplica.
+ */
+uint64_t replica_aplicadas(void){
+    return replica.aplicadas;
+}
+
+/**
+ * @brief Quantidade de recargas dos arquivos causadas por SAVEs do processo principal.
+ */
+int replica_recargas(void){
+    return replica.recargas;
+}
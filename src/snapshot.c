@@ -0,0 +1,229 @@
+/**
+ * @file snapshot.c
+ * @brief Snapshots periódicos em segundo plano usando `fork()`.
+ * @details A cada PS_SNAPSHOT_INTERVALO segundos o processo é duplicado com
+ * `fork()`. O filho enxerga uma cópia congelada (copy-on-write) da LISTA e da
+ * FILA e executa o SAVE, que grava arquivos temporários e os renomeia para
+ * data/. O pai volta imediatamente ao atendimento; a única pausa é a rotação
+ * do log e o próprio `fork()`.
+ *
+ * O log de operações é rotacionado no momento do `fork()`: os registros
+ * anteriores ficam cobertos pelo snapshot, e o próprio filho descarta o log
+ * rotacionado logo depois de renomear os arquivos, sem esperar o pai
+ * recolhê-lo. Se o filho falhar, eles continuam no log rotacionado e são
+ * reaplicados na próxima inicialização. Uma queda entre a troca dos arquivos
+ * e o descarte também não os aplica duas vezes: os arquivos gravados guardam
+ * a sequência do último registro que cobrem (ver wal_definir_pontos()).
+ *
+ * O intervalo é verificado entre as operações do menu. No Windows, onde não
+ * há `fork()`, os snapshots em segundo plano ficam desativados.
+ *
+ * Com o heap persistente (ver heap.c) eles também ficam desativados: o heap
+ * é mapeado com `MAP_SHARED`, então o filho não teria uma cópia congelada e
+ * o SAVE dele limparia as marcas de alteração do pai.
+ */
+
+#include "../include/snapshot.h"
+#include "../include/IO.h"
+#include "../include/heap.h"
+#include "../include/wal.h"
+#include <time.h>
+
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @struct snapshot_
+ * @brief Estado do snapshot em segundo plano.
+ */
+typedef struct snapshot_ {
+    int intervalo;                  /**< Segundos entre snapshots (0 = desativado). */
+    time_t ultimo_inicio;           /**< Início do último snapshot (ou da configuração). */
+#ifndef _WIN32
+    pid_t filho;                    /**< Processo gravando o snapshot (0 se nenhum). */
+    int leitura;                    /**< Pipe pelo qual o filho informa a duração. */
+#endif
+    double pausa_us;                /**< Pausa do pai no snapshot em andamento. */
+    bool tem_relatorio;             /**< Algum snapshot já terminou. */
+    SNAPSHOT_RELATORIO relatorio;   /**< Medições do último snapshot concluído. */
+} SNAPSHOT;
+
+static SNAPSHOT snapshot;
+
+/**
+ * @brief Diferença entre dois instantes, em microssegundos.
+ */
+static double snapshot_decorrido_us(const struct timespec* inicio, const struct timespec* fim){
+    return (double)(fim->tv_sec - inicio->tv_sec) * 1e6 + (double)(fim->tv_nsec - inicio->tv_nsec) / 1e3;
+}
+
+/**
+ * @brief Lê o intervalo da variável de ambiente PS_SNAPSHOT_INTERVALO.
+ * @note Com o heap persistente ativo, os snapshots ficam desativados.
+ */
+void snapshot_configurar(void){
+    snapshot.intervalo = 0;
+    snapshot.ultimo_inicio = time(NULL);
+
+#ifndef _WIN32
+    const char* intervalo = getenv(SNAPSHOT_VARIAVEL_INTERVALO);
+    if (intervalo != NULL && !heap_ativo()){
+        char* fim;
+        long valor = strtol(intervalo, &fim, 10);
+        if (fim != intervalo && *fim == '\0' && valor > 0 && valor <= 86400)
+            snapshot.intervalo = (int)valor;
+    }
+#endif
+}
+
+/**
+ * @brief Indica se há um snapshot sendo gravado em segundo plano.
+ * @return true se o processo filho ainda não foi recolhido.
+ */
+bool snapshot_ativo(void){
+#ifndef _WIN32
+    return snapshot.filho > 0;
+#else
+    return false;
+#endif
+}
+
+#ifndef _WIN32
+/**
+ * @brief Recolhe o processo filho e registra o resultado do snapshot.
+ * @param bloquear true para esperar o filho terminar.
+ * @return true se o filho terminou.
+ */
+static bool snapshot_recolher(bool bloquear){
+    int estado;
+    pid_t pid = waitpid(snapshot.filho, &estado, bloquear ? 0 : WNOHANG);
+    if (pid == 0)
+        return false;
+
+    double duracao_ms = 0;
+    bool informou = pid == snapshot.filho &&
+                    read(snapshot.leitura, &duracao_ms, sizeof(double)) == (ssize_t)sizeof(double);
+    close(snapshot.leitura);
+
+    snapshot.relatorio.sucesso = informou && WIFEXITED(estado) && WEXITSTATUS(estado) == 0;
+    snapshot.relatorio.duracao_ms = duracao_ms;
+    snapshot.relatorio.pausa_us = snapshot.pausa_us;
+    snapshot.tem_relatorio = true;
+    snapshot.filho = 0;
+
+    // Normalmente o filho já descartou o log rotacionado; sobra se ele não
+    // conseguiu guardá-lo no arquivo morto
+    if (snapshot.relatorio.sucesso)
+        wal_descartar_antigo();
+    return true;
+}
+#endif
+
+/**
+ * @brief Inicia um snapshot em segundo plano.
+ * @param lista LISTA atual.
+ * @param fila FILA atual.
+ * @return true se o processo filho foi criado.
+ */
+bool snapshot_iniciar(LISTA* lista, FILA* fila){
+#ifdef _WIN32
+    (void)lista;
+    (void)fila;
+    return false;
+#else
+    if (snapshot.filho > 0 || lista == NULL || fila == NULL)
+        return false;
+
+    int canal[2];
+    if (pipe(canal) != 0)
+        return false;
+
+    struct timespec inicio, fim;
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+
+    if (!wal_rotacionar()){
+        close(canal[0]);
+        close(canal[1]);
+        return false;
+    }
+
+    pid_t pid = fork();
+    if (pid == 0){
+        // Filho: grava a cópia congelada e informa a duração
+        close(canal[0]);
+        struct timespec a, b;
+        clock_gettime(CLOCK_MONOTONIC, &a);
+        bool ok = SAVE(&lista, &fila);
+        // Os registros rotacionados já estão nos arquivos publicados
+        if (ok)
+            wal_descartar_antigo();
+        clock_gettime(CLOCK_MONOTONIC, &b);
+
+        double duracao_ms = snapshot_decorrido_us(&a, &b) / 1e3;
+        if (write(canal[1], &duracao_ms, sizeof(double)) != (ssize_t)sizeof(double))
+            ok = false;
+        _exit(ok ? 0 : 1);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+    close(canal[1]);
+    snapshot.ultimo_inicio = time(NULL);
+
+    if (pid < 0){
+        close(canal[0]);
+        return false;
+    }
+
+    snapshot.filho = pid;
+    snapshot.leitura = canal[0];
+    snapshot.pausa_us = snapshot_decorrido_us(&inicio, &fim);
+    return true;
+#endif
+}
+
+/**
+ * @brief Recolhe um snapshot que tenha terminado e inicia outro se o intervalo passou.
+ * @param lista LISTA atual.
+ * @param fila FILA atual.
+ * @return true se um snapshot terminou nesta chamada.
+ */
+bool snapshot_verificar(LISTA* lista, FILA* fila){
+#ifdef _WIN32
+    (void)lista;
+    (void)fila;
+    return false;
+#else
+    if (snapshot.filho > 0)
+        return snapshot_recolher(false);
+
+    if (snapshot.intervalo > 0 && time(NULL) - snapshot.ultimo_inicio >= snapshot.intervalo)
+        snapshot_iniciar(lista, fila);
+    return false;
+#endif
+}
+
+/**
+ * @brief Espera o snapshot em andamento terminar (antes de um SAVE em primeiro plano).
+ */
+void snapshot_aguardar(void){
+#ifndef _WIN32
+    if (snapshot.filho > 0)
+        snapshot_recolher(true);
+#endif
+}
+
+/**
+ * @brief Obtém as medições do último snapshot concluído.
+ * @param relatorio Onde as medições são copiadas.
+ * @return true se algum snapshot já terminou.
+ */
+bool snapshot_ultimo(SNAPSHOT_RELATORIO* relatorio){
+    if (!snapshot.tem_relatorio || relatorio == NULL)
+        return false;
+
+    *relatorio = snapshot.relatorio;
+    return true;
+}
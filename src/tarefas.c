@@ -0,0 +1,122 @@
+/**
+ * @file tarefas.c
+ * @brief Execução de uma mesma função em várias threads (LOAD e SAVE paralelos).
+ * @details tarefas_executar() cria n - 1 threads, executa o índice 0 na
+ * própria thread chamadora e espera todas terminarem. Se uma thread não puder
+ * ser criada, o índice correspondente é executado na chamadora, de modo que
+ * todos os índices sempre rodam.
+ *
+ * Não há um conjunto de threads mantido entre as chamadas: cada chamada cria
+ * e junta as suas. Os chamadores compensam isso dando a cada índice trabalho
+ * grande (milhares de registros ou blocos), e o custo da criação aparece nas
+ * medições de bench/threads.c.
+ *
+ * Usa pthreads; no Windows, `CreateThread()`.
+ */
+
+#include "../include/tarefas.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Argumentos de uma thread.
+ */
+typedef struct tarefa_thread_ {
+    TAREFA tarefa;
+    void* contexto;
+    int indice;
+} TAREFA_THREAD;
+
+/**
+ * @brief Quantidade de threads: PS_THREADS ou a quantidade de processadores.
+ * @return int Entre 1 e TAREFAS_MAX.
+ */
+int tarefas_quantidade(void){
+    long n = 0;
+
+    const char* valor = getenv(TAREFAS_VARIAVEL);
+    if (valor != NULL){
+        char* fim;
+        n = strtol(valor, &fim, 10);
+        if (fim == valor || *fim != '\0')
+            n = 0;
+    }
+
+    if (n <= 0){
+#ifdef _WIN32
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        n = (long)info.dwNumberOfProcessors;
+#else
+        n = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    }
+
+    if (n < 1) n = 1;
+    if (n > TAREFAS_MAX) n = TAREFAS_MAX;
+    return (int)n;
+}
+
+#ifdef _WIN32
+static DWORD WINAPI tarefas_iniciar(LPVOID argumento){
+    TAREFA_THREAD* t = (TAREFA_THREAD*)argumento;
+    t->tarefa(t->contexto, t->indice);
+    return 0;
+}
+#else
+static void* tarefas_iniciar(void* argumento){
+    TAREFA_THREAD* t = (TAREFA_THREAD*)argumento;
+    t->tarefa(t->contexto, t->indice);
+    return NULL;
+}
+#endif
+
+/**
+ * @brief Executa tarefa(contexto, i) para i de 0 a n - 1, em paralelo.
+ * @param n Quantidade de índices (limitada a TAREFAS_MAX).
+ * @param tarefa Função executada.
+ * @param contexto Parâmetro repassado à função.
+ */
+void tarefas_executar(int n, TAREFA tarefa, void* contexto){
+    if (n > TAREFAS_MAX) n = TAREFAS_MAX;
+    if (n < 1 || tarefa == NULL)
+        return;
+
+    TAREFA_THREAD argumentos[TAREFAS_MAX];
+    bool criada[TAREFAS_MAX];
+#ifdef _WIN32
+    HANDLE threads[TAREFAS_MAX];
+#else
+    pthread_t threads[TAREFAS_MAX];
+#endif
+
+    for (int i = 1; i < n; i++){
+        argumentos[i] = (TAREFA_THREAD){ tarefa, contexto, i };
+#ifdef _WIN32
+        threads[i] = CreateThread(NULL, 0, tarefas_iniciar, &argumentos[i], 0, NULL);
+        criada[i] = threads[i] != NULL;
+#else
+        criada[i] = pthread_create(&threads[i], NULL, tarefas_iniciar, &argumentos[i]) == 0;
+#endif
+    }
+
+    tarefa(contexto, 0);
+
+    for (int i = 1; i < n; i++){
+        if (!criada[i]){
+            tarefa(contexto, i);
+            continue;
+        }
+#ifdef _WIN32
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+#else
+        pthread_join(threads[i], NULL);
+#endif
+    }
+}
@@ -0,0 +1,1059 @@
+/**
+ * @file wal.c
+ * @brief Log de escrita antecipada (write-ahead log) das operações do sistema.
+ * @details Cada alteração feita pelo operador (cadastro, remoção, entrada e
+ * saída da fila, inclusão e remoção no histórico) é anexada ao fim de
+ * data/wal.bin como um registro binário curto. Ao iniciar, o log é reaplicado
+ * sobre o último SAVE, de modo que uma queda do programa ou de energia não
+ * perde o turno inteiro.
+ *
+ * Formato de cada registro:
+ *
+ *      - tamanho do corpo (uint32)
+ *      - verificação FNV-1a do corpo (uint32)
+ *      - corpo: sequência (uint64), instante (int64), tipo (uint8),
+ *        prioridade (uint8), CPF (11 bytes) e texto opcional (nome ou procedimento)
+ *
+ * Os cadastros de uma importação em massa (ver importacao.c) vão em
+ * registros WAL_IMPORTACAO, sem CPF no corpo: o texto é uma sequência de
+ * cadastros [CPF (11 bytes)][tamanho do nome (uint8)][nome], até o registro
+ * ocupar WAL_TAM_BUFFER bytes (o que cabe no buffer de escrita e na leitura
+ * de uma réplica). Isso evita a parte fixa de um registro por paciente.
+ *
+ * Os registros de uma mesma operação do menu são acumulados em memória e
+ * confirmados juntos por wal_confirmar() com uma única escrita (commit em
+ * grupo). O `fsync()` é feito a cada PS_WAL_LOTE operações confirmadas
+ * (padrão 1; 0 deixa a sincronização a cargo do sistema operacional).
+ *
+ * Um registro incompleto ou com verificação inválida no fim do arquivo (escrita
+ * interrompida) encerra a reaplicação e é descartado.
+ *
+ * As sequências crescem também entre execuções: cada arquivo de dados guarda
+ * a sequência do último registro que o SAVE já cobre (o ponto, ver
+ * arquivo_definir_ponto()), informada pelo LOAD com wal_definir_pontos(), e o
+ * log aberto continua a partir do maior ponto e da maior sequência
+ * reaplicada. Na reaplicação, os registros até o ponto do arquivo que eles
+ * alteram (a lista ou a fila) são pulados: nem todas as operações podem ser
+ * aplicadas duas vezes (inclusão no histórico, saída da fila).
+ *
+ * Para snapshots em segundo plano, o log pode ser rotacionado: os registros
+ * já cobertos pelo snapshot em andamento passam para `<log>.old`, que é
+ * apagado quando o snapshot termina e reaplicado antes do log atual caso ele
+ * falhe.
+ *
+ * Um processo réplica (ver replica.c) acompanha o log de outro processo só
+ * lendo, com wal_acompanhar(): cada chamada aplica os registros anexados
+ * desde a anterior.
+ *
+ * Com um arquivo morto definido (ver wal_definir_arquivo_morto()), os
+ * registros válidos são anexados a ele antes de o log ser truncado ou de o
+ * log rotacionado ser apagado: o arquivo morto guarda todas as operações, na
+ * ordem em que foram aplicadas, e é reaplicado até um instante qualquer por
+ * wal_reaplicar_ate() (ver auditoria.c).
+ */
+
+#include "../include/wal.h"
+#include "../include/historico.h"
+#include "../include/mapa.h"
+#include "../include/paciente.h"
+#include "../include/registro.h"
+#include <sys/stat.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define WAL_TAM_BUFFER 65536  ///< Bytes acumulados antes de uma escrita forçada
+#define WAL_TAM_PREFIXO 8     ///< tamanho + verificação
+#define WAL_TAM_FIXO 29       ///< Parte fixa do corpo: sequência, instante, tipo, prioridade e CPF
+#define WAL_MAX_TEXTO 255     ///< Maior texto gravado em um registro
+#define WAL_TAM_CPF 11
+#define WAL_TAM_INICIO 16     ///< Prefixo e sequência do primeiro registro: identificam o conteúdo do log
+#define WAL_MAX_IMPORTACAO (WAL_TAM_BUFFER - WAL_TAM_PREFIXO - WAL_TAM_FIXO) ///< Maior texto de um registro WAL_IMPORTACAO
+
+/**
+ * @brief Tipos de operação registrados no log.
+ */
+typedef enum {
+    WAL_CADASTRO = 1,
+    WAL_REMOCAO = 2,
+    WAL_ENTRADA_FILA = 3,
+    WAL_SAIDA_FILA = 4,
+    WAL_HISTORICO_INSERIR = 5,
+    WAL_HISTORICO_REMOVER = 6,
+    WAL_IMPORTACAO = 7           ///< Vários cadastros de uma importação em massa
+} WAL_TIPO;
+
+/**
+ * @struct wal_
+ * @brief Estado do log aberto.
+ */
+typedef struct wal_ {
+#ifdef _WIN32
+    FILE* fp;
+#else
+    int fd;
+#endif
+    char* caminho;               /**< Caminho do arquivo de log. */
+    char* caminho_antigo;        /**< Caminho do log rotacionado (caminho + ".old"). */
+    char* arquivo_morto;         /**< Recebe os registros antes de serem descartados (NULL = não guardar). */
+    bool aberto;
+    bool erro;                   /**< Alguma escrita falhou desde a abertura. */
+    uint64_t sequencia;          /**< Número do último registro gerado. */
+    int lote;                    /**< Operações confirmadas por fsync (0 = nunca). */
+    int nao_sincronizadas;       /**< Operações escritas desde o último fsync. */
+    size_t n_pendente;           /**< Bytes aguardando wal_confirmar(). */
+    char pendente[WAL_TAM_BUFFER];
+} WAL;
+
+static WAL wal;
+
+/**
+ * @brief Último registro coberto por cada arquivo de dados carregado.
+ * @details Fica fora de WAL: o LOAD o informa antes de o log ser aberto.
+ */
+typedef struct wal_pontos_ {
+    uint64_t lista;              /**< Cadastros, remoções e históricos. */
+    uint64_t fila;               /**< Entradas e saídas da fila. */
+} WAL_PONTOS;
+
+static WAL_PONTOS pontos;
+
+/**
+ * @brief Identificação de um arquivo de log lido por uma réplica.
+ */
+typedef struct wal_identidade_ {
+    bool existe;
+    uint64_t dispositivo;
+    uint64_t inode;
+    uint64_t tamanho;
+} WAL_IDENTIDADE;
+
+/**
+ * @struct wal_leitor_
+ * @brief Posição de um processo réplica que acompanha o log de outro processo.
+ */
+typedef struct wal_leitor_ {
+    bool aberto;
+    WAL_IDENTIDADE atual;        /**< Log acompanhado (existe = já foi lido). */
+    WAL_IDENTIDADE antigo;       /**< Log rotacionado, como estava na última leitura. */
+    size_t posicao;              /**< Bytes do log atual já aplicados. */
+    bool tem_inicio;
+    char inicio[WAL_TAM_INICIO]; /**< Início do primeiro registro aplicado do log atual. */
+    uint64_t sequencia;          /**< Maior sequência aplicada. */
+    char area[WAL_TAM_BUFFER];
+} WAL_LEITOR;
+
+static WAL_LEITOR leitor;
+
+/**
+ * @brief Verificação FNV-1a de 32 bits de um trecho de memória.
+ * @param dados Início do trecho.
+ * @param tamanho Quantidade de bytes.
+ * @return uint32_t Valor da verificação.
+ */
+static uint32_t wal_verificacao(const char* dados, size_t tamanho){
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < tamanho; i++){
+        h ^= (unsigned char)dados[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/**
+ * @brief Escreve bytes no fim do arquivo, tratando escritas parciais.
+ * @return true se todos os bytes foram escritos.
+ */
+static bool wal_escrever(const char* dados, size_t tamanho){
+#ifdef _WIN32
+    return fwrite(dados, 1, tamanho, wal.fp) == tamanho && fflush(wal.fp) == 0;
+#else
+    while (tamanho > 0){
+        ssize_t escritos = write(wal.fd, dados, tamanho);
+        if (escritos < 0)
+            return false;
+        dados += escritos;
+        tamanho -= (size_t)escritos;
+    }
+    return true;
+#endif
+}
+
+/**
+ * @brief Força os dados escritos até o disco.
+ * @return true se a sincronização funcionou.
+ */
+static bool wal_sincronizar(void){
+#ifdef _WIN32
+    return _commit(_fileno(wal.fp)) == 0;
+#elif defined(__linux__)
+    return fdatasync(wal.fd) == 0;
+#else
+    return fsync(wal.fd) == 0;
+#endif
+}
+
+/**
+ * @brief Corta o arquivo de log no tamanho indicado.
+ * @return true se o arquivo foi truncado.
+ */
+static bool wal_cortar(size_t tamanho){
+#ifdef _WIN32
+    return _chsize(_fileno(wal.fp), (long)tamanho) == 0;
+#else
+    return ftruncate(wal.fd, (off_t)tamanho) == 0;
+#endif
+}
+
+/**
+ * @brief Abre (ou cria) o log para anexar registros.
+ * @details Lê da variável de ambiente PS_WAL_LOTE quantas operações são
+ * confirmadas por `fsync()`.
+ * @param caminho Caminho do arquivo de log.
+ * @return true se o log foi aberto.
+ */
+bool wal_abrir(const char* caminho){
+    if (wal.aberto || caminho == NULL)
+        return false;
+
+#ifdef _WIN32
+    wal.fp = fopen(caminho, "ab");
+    if (wal.fp == NULL)
+        return false;
+#else
+    wal.fd = open(caminho, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (wal.fd < 0)
+        return false;
+#endif
+
+    wal.caminho = malloc(strlen(caminho) + 1);
+    wal.caminho_antigo = malloc(strlen(caminho) + strlen(WAL_SUFIXO_ANTIGO) + 1);
+    if (wal.caminho != NULL)
+        strcpy(wal.caminho, caminho);
+    if (wal.caminho_antigo != NULL){
+        strcpy(wal.caminho_antigo, caminho);
+        strcat(wal.caminho_antigo, WAL_SUFIXO_ANTIGO);
+    }
+
+    wal.lote = 1;
+    const char* lote = getenv(WAL_VARIAVEL_LOTE);
+    if (lote != NULL){
+        char* fim;
+        long valor = strtol(lote, &fim, 10);
+        if (fim != lote && *fim == '\0' && valor >= 0 && valor <= 1000000)
+            wal.lote = (int)valor;
+    }
+
+    wal.aberto = true;
+    wal.erro = false;
+    wal.sequencia = pontos.lista > pontos.fila ? pontos.lista : pontos.fila;
+    wal.nao_sincronizadas = 0;
+    wal.n_pendente = 0;
+    return true;
+}
+
+/**
+ * @brief Informa o último registro do log coberto por cada arquivo de dados carregado.
+ * @details Chamada pelo LOAD (ver arquivo_ponto()). As próximas sequências
+ * continuam depois do maior ponto, e wal_reaplicar() e wal_acompanhar() pulam
+ * os registros já cobertos.
+ * @param lista Ponto do arquivo da lista (0 = nenhum).
+ * @param fila Ponto do arquivo da fila (0 = nenhum).
+ */
+void wal_definir_pontos(uint64_t lista, uint64_t fila){
+    pontos.lista = lista;
+    pontos.fila = fila;
+    if (wal.sequencia < lista)
+        wal.sequencia = lista;
+    if (wal.sequencia < fila)
+        wal.sequencia = fila;
+}
+
+/**
+ * @brief Sequência do último registro gerado ou reaplicado.
+ * @details Gravada pelo SAVE como o ponto dos arquivos de dados: todos os
+ * registros até ela já estão aplicados nas estruturas salvas.
+ * @return uint64_t Sequência (com o log fechado, o maior ponto informado).
+ */
+uint64_t wal_sequencia(void){
+    if (wal.aberto)
+        return wal.sequencia;
+    return pontos.lista > pontos.fila ? pontos.lista : pontos.fila;
+}
+
+/**
+ * @brief Preenche a parte fixa e a verificação de um registro já escrito em r.
+ * @param tam_texto Bytes do texto, já copiados a partir de r + WAL_TAM_PREFIXO + WAL_TAM_FIXO.
+ * @return size_t Tamanho total do registro.
+ */
+static size_t wal_fechar_registro(char* r, WAL_TIPO tipo, const char* cpf, int prioridade, int64_t instante,
+                                  size_t tam_texto){
+    uint32_t corpo = WAL_TAM_FIXO + (uint32_t)tam_texto;
+    uint64_t sequencia = ++wal.sequencia;
+    uint8_t tipo_byte = (uint8_t)tipo;
+    uint8_t prioridade_byte = (uint8_t)prioridade;
+
+    memcpy(r, &corpo, 4);
+    memcpy(r + 8, &sequencia, 8);
+    memcpy(r + 16, &instante, 8);
+    memcpy(r + 24, &tipo_byte, 1);
+    memcpy(r + 25, &prioridade_byte, 1);
+    memset(r + 26, 0, WAL_TAM_CPF);
+    if (cpf != NULL)
+        memcpy(r + 26, cpf, strnlen(cpf, WAL_TAM_CPF));
+
+    uint32_t verificacao = wal_verificacao(r + WAL_TAM_PREFIXO, corpo);
+    memcpy(r + 4, &verificacao, 4);
+    return WAL_TAM_PREFIXO + corpo;
+}
+
+/**
+ * @brief Abre espaço no buffer do grupo atual para um registro de até total bytes.
+ * @details Um grupo maior que o buffer escreve o que já foi acumulado (sem fsync).
+ */
+static void wal_reservar(size_t total){
+    if (wal.n_pendente + total > WAL_TAM_BUFFER){
+        if (!wal_escrever(wal.pendente, wal.n_pendente))
+            wal.erro = true;
+        wal.n_pendente = 0;
+    }
+}
+
+/**
+ * @brief Acumula um registro no buffer do grupo atual.
+ * @param tipo Operação.
+ * @param cpf CPF do paciente (11 dígitos).
+ * @param prioridade Prioridade (apenas para entrada na fila).
+ * @param instante Horário da operação (time_t).
+ * @param texto Nome ou procedimento, pode ser NULL.
+ */
+static void wal_anexar(WAL_TIPO tipo, const char* cpf, int prioridade, int64_t instante, const char* texto){
+    if (!wal.aberto || cpf == NULL)
+        return;
+
+    size_t tam_texto = texto != NULL ? strlen(texto) : 0;
+    if (tam_texto > WAL_MAX_TEXTO)
+        tam_texto = WAL_MAX_TEXTO;
+
+    wal_reservar(WAL_TAM_PREFIXO + WAL_TAM_FIXO + tam_texto);
+
+    char* r = wal.pendente + wal.n_pendente;
+    if (tam_texto > 0)
+        memcpy(r + WAL_TAM_PREFIXO + WAL_TAM_FIXO, texto, tam_texto);
+    wal.n_pendente += wal_fechar_registro(r, tipo, cpf, prioridade, instante, tam_texto);
+}
+
+/**
+ * @brief Registra o cadastro de um novo paciente.
+ * @param cpf CPF do paciente.
+ * @param nome Nome do paciente.
+ */
+void wal_registrar_cadastro(const char* cpf, const char* nome){
+    wal_anexar(WAL_CADASTRO, cpf, 0, (int64_t)time(NULL), nome);
+}
+
+/**
+ * @brief Registra os cadastros de uma importação em massa, em registros WAL_IMPORTACAO.
+ * @details Cada registro leva quantos cadastros couberem em WAL_TAM_BUFFER
+ * bytes; a reaplicação os cadastra na ordem dada, como wal_registrar_cadastro().
+ * @param cpfs CPFs dos pacientes (11 dígitos cada).
+ * @param nomes Nomes dos pacientes.
+ * @param n Quantidade de cadastros.
+ */
+void wal_registrar_importacao(const char* const* cpfs, const char* const* nomes, size_t n){
+    if (!wal.aberto || cpfs == NULL || nomes == NULL)
+        return;
+
+    int64_t instante = (int64_t)time(NULL);
+    size_t i = 0;
+    while (i < n){
+        wal_reservar(WAL_TAM_BUFFER);
+        char* r = wal.pendente + wal.n_pendente;
+        char* texto = r + WAL_TAM_PREFIXO + WAL_TAM_FIXO;
+        size_t tam_texto = 0;
+
+        for (; i < n; i++){
+            size_t tam_nome = strlen(nomes[i]);
+            if (tam_nome > UINT8_MAX)
+                tam_nome = UINT8_MAX;
+            if (tam_texto + WAL_TAM_CPF + 1 + tam_nome > WAL_MAX_IMPORTACAO)
+                break;
+            memset(texto + tam_texto, 0, WAL_TAM_CPF);
+            memcpy(texto + tam_texto, cpfs[i], strnlen(cpfs[i], WAL_TAM_CPF));
+            texto[tam_texto + WAL_TAM_CPF] = (char)(uint8_t)tam_nome;
+            memcpy(texto + tam_texto + WAL_TAM_CPF + 1, nomes[i], tam_nome);
+            tam_texto += WAL_TAM_CPF + 1 + tam_nome;
+        }
+        wal.n_pendente += wal_fechar_registro(r, WAL_IMPORTACAO, NULL, 0, instante, tam_texto);
+    }
+}
+
+/**
+ * @brief Registra a remoção de um paciente do sistema.
+ * @param cpf CPF do paciente.
+ */
+void wal_registrar_remocao(const char* cpf){
+    wal_anexar(WAL_REMOCAO, cpf, 0, (int64_t)time(NULL), NULL);
+}
+
+/**
+ * @brief Registra a entrada de um paciente na fila.
+ * @param cpf CPF do paciente.
+ * @param prioridade Prioridade (0 a 4).
+ * @param chegada Horário de chegada registrado no armazém.
+ */
+void wal_registrar_entrada_fila(const char* cpf, int prioridade, int64_t chegada){
+    wal_anexar(WAL_ENTRADA_FILA, cpf, prioridade, chegada, NULL);
+}
+
+/**
+ * @brief Registra a saída (atendimento) do primeiro paciente da fila.
+ * @param cpf CPF do paciente atendido.
+ */
+void wal_registrar_saida_fila(const char* cpf){
+    wal_anexar(WAL_SAIDA_FILA, cpf, 0, (int64_t)time(NULL), NULL);
+}
+
+/**
+ * @brief Registra um procedimento incluído no histórico.
+ * @param cpf CPF do paciente.
+ * @param procedimento Descrição do procedimento.
+ */
+void wal_registrar_historico_inserir(const char* cpf, const char* procedimento){
+    wal_anexar(WAL_HISTORICO_INSERIR, cpf, 0, (int64_t)time(NULL), procedimento);
+}
+
+/**
+ * @brief Registra a remoção do último procedimento do histórico.
+ * @param cpf CPF do paciente.
+ */
+void wal_registrar_historico_remover(const char* cpf){
+    wal_anexar(WAL_HISTORICO_REMOVER, cpf, 0, (int64_t)time(NULL), NULL);
+}
+
+/**
+ * @brief Confirma o grupo de registros acumulado desde a última confirmação.
+ * @details Os registros são escritos com uma única chamada e, a cada
+ * PS_WAL_LOTE confirmações, sincronizados com o disco.
+ * @return true se não houve erro de escrita.
+ */
+bool wal_confirmar(void){
+    if (!wal.aberto)
+        return false;
+    if (wal.n_pendente == 0)
+        return !wal.erro;
+
+    if (!wal_escrever(wal.pendente, wal.n_pendente))
+        wal.erro = true;
+    wal.n_pendente = 0;
+    wal.nao_sincronizadas++;
+
+    if (wal.lote > 0 && wal.nao_sincronizadas >= wal.lote){
+        if (!wal_sincronizar())
+            wal.erro = true;
+        wal.nao_sincronizadas = 0;
+    }
+    return !wal.erro;
+}
+
+/**
+ * @brief Aplica um registro do log sobre a LISTA e a FILA.
+ * @details As operações conferem o estado (paciente já cadastrado, já na
+ * fila, ...) e ignoram os que não as admitem. Isso não as torna idempotentes:
+ * a inclusão e a remoção no histórico e a saída da fila valem de novo a cada
+ * aplicação. Um registro já presente no SAVE é pulado antes, pela sequência
+ * (ver wal_aplicar_registro()).
+ */
+static void wal_aplicar(WAL_TIPO tipo, char* cpf, int prioridade, int64_t instante, char* texto,
+                        LISTA* lista, FILA* fila){
+    PACIENTE* pac = lista_buscar(lista, cpf);
+
+    switch (tipo){
+    case WAL_CADASTRO:
+        if (pac == NULL){
+            pac = paciente_criar(texto, cpf);
+            if (pac != NULL && !lista_inserir(lista, pac))
+                paciente_apagar(&pac);
+        }
+        break;
+
+    case WAL_REMOCAO:
+        if (pac != NULL && !paciente_esta_na_fila(pac)){
+            PACIENTE* removido = lista_remover(lista, pac);
+            paciente_apagar(&removido);
+        }
+        break;
+
+    case WAL_ENTRADA_FILA:
+        if (pac != NULL && !paciente_esta_na_fila(pac) && fila_inserir(fila, pac, prioridade))
+            registro_entrar_fila(paciente_obter_id(pac), prioridade, instante);
+        break;
+
+    case WAL_SAIDA_FILA:
+    {
+        PACIENTE* frente = fila_frente(fila);
+        if (frente != NULL && strcmp(paciente_obter_cpf(frente), cpf) == 0)
+            fila_remover(fila);
+        break;
+    }
+
+    case WAL_HISTORICO_INSERIR:
+        if (pac != NULL)
+        {
+            historico_inserir(paciente_obter_historico(pac), texto);
+            paciente_marcar_alterado(pac);
+        }
+        break;
+
+    case WAL_HISTORICO_REMOVER:
+        if (pac != NULL)
+        {
+            historico_remover(paciente_obter_historico(pac));
+            paciente_marcar_alterado(pac);
+        }
+        break;
+
+    case WAL_IMPORTACAO:
+        break; // Cadastro a cadastro, por wal_aplicar_importacao()
+    }
+}
+
+/**
+ * @brief Aplica os cadastros de um registro WAL_IMPORTACAO, na ordem gravada.
+ * @param texto Cadastros [CPF][tamanho do nome][nome] do registro.
+ * @param tamanho Bytes do texto.
+ * @return uint64_t Quantidade de cadastros lidos (um cadastro truncado encerra a leitura).
+ */
+static uint64_t wal_aplicar_importacao(const char* texto, size_t tamanho, LISTA* lista, FILA* fila){
+    uint64_t aplicados = 0;
+    size_t pos = 0;
+    while (pos + WAL_TAM_CPF + 1 <= tamanho){
+        char cpf[WAL_TAM_CPF + 1];
+        char nome[UINT8_MAX + 1];
+        size_t tam_nome = (uint8_t)texto[pos + WAL_TAM_CPF];
+        if (pos + WAL_TAM_CPF + 1 + tam_nome > tamanho)
+            break;
+
+        memcpy(cpf, texto + pos, WAL_TAM_CPF);
+        cpf[WAL_TAM_CPF] = '\0';
+        memcpy(nome, texto + pos + WAL_TAM_CPF + 1, tam_nome);
+        nome[tam_nome] = '\0';
+        wal_aplicar(WAL_CADASTRO, cpf, 0, 0, nome, lista, fila);
+        aplicados++;
+        pos += WAL_TAM_CPF + 1 + tam_nome;
+    }
+    return aplicados;
+}
+
+/**
+ * @brief Confere o registro no início de um trecho do log.
+ * @param r Início do registro.
+ * @param disponivel Bytes do trecho a partir de r.
+ * @return size_t Tamanho do registro, ou 0 se ele estiver incompleto ou com
+ * verificação inválida.
+ */
+static size_t wal_conferir_registro(const char* r, size_t disponivel){
+    if (disponivel < WAL_TAM_PREFIXO)
+        return 0;
+
+    uint32_t corpo, verificacao;
+    memcpy(&corpo, r, 4);
+    memcpy(&verificacao, r + 4, 4);
+
+    if (corpo < WAL_TAM_FIXO || corpo > disponivel - WAL_TAM_PREFIXO)
+        return 0;
+    size_t maximo = (uint8_t)r[24] == WAL_IMPORTACAO ? WAL_MAX_IMPORTACAO : WAL_MAX_TEXTO;
+    if (corpo > WAL_TAM_FIXO + maximo || wal_verificacao(r + WAL_TAM_PREFIXO, corpo) != verificacao)
+        return 0;
+    return WAL_TAM_PREFIXO + corpo;
+}
+
+/**
+ * @brief Confere e aplica o registro no início de um trecho do log.
+ * @details Um registro com sequência até o ponto do arquivo que ele altera já
+ * está nos dados carregados: é consumido sem ser aplicado.
+ * @param r Início do registro.
+ * @param disponivel Bytes do trecho a partir de r.
+ * @param ate Registros com instante posterior não são aplicados.
+ * @param cobertos Pontos dos arquivos carregados (NULL = aplicar todos).
+ * @param lista LISTA a atualizar.
+ * @param fila FILA a atualizar.
+ * @param sequencia_maxima Maior sequência vista até aqui; atualizada.
+ * @param aplicados Contador de registros aplicados; incrementado.
+ * @return size_t Tamanho do registro consumido, ou 0 se ele estiver
+ * incompleto, com verificação inválida ou depois de `ate`.
+ */
+static size_t wal_aplicar_registro(const char* r, size_t disponivel, int64_t ate, const WAL_PONTOS* cobertos,
+                                   LISTA* lista, FILA* fila, uint64_t* sequencia_maxima, uint64_t* aplicados){
+    size_t tamanho = wal_conferir_registro(r, disponivel);
+    if (tamanho == 0)
+        return 0;
+
+    uint64_t sequencia;
+    int64_t instante;
+    memcpy(&instante, r + 16, 8);
+    if (instante > ate)
+        return 0;
+
+    char cpf[WAL_TAM_CPF + 1];
+    char texto[WAL_MAX_TEXTO + 1];
+    size_t tam_texto = tamanho - WAL_TAM_PREFIXO - WAL_TAM_FIXO;
+    memcpy(&sequencia, r + 8, 8);
+
+    uint8_t prioridade = (uint8_t)r[25];
+    WAL_TIPO tipo = (WAL_TIPO)(uint8_t)r[24];
+    bool da_fila = tipo == WAL_ENTRADA_FILA || tipo == WAL_SAIDA_FILA;
+    if (cobertos == NULL || sequencia > (da_fila ? cobertos->fila : cobertos->lista)){
+        if (tipo == WAL_IMPORTACAO){
+            *aplicados += wal_aplicar_importacao(r + WAL_TAM_PREFIXO + WAL_TAM_FIXO, tam_texto, lista, fila);
+        } else {
+            memcpy(cpf, r + 26, WAL_TAM_CPF);
+            cpf[WAL_TAM_CPF] = '\0';
+            memcpy(texto, r + 37, tam_texto);
+            texto[tam_texto] = '\0';
+            wal_aplicar(tipo, cpf, prioridade, instante, texto, lista, fila);
+            (*aplicados)++;
+        }
+    }
+
+    if (sequencia > *sequencia_maxima)
+        *sequencia_maxima = sequencia;
+    return tamanho;
+}
+
+/**
+ * @brief Reaplica os registros válidos de um arquivo de log.
+ * @param caminho Arquivo de log.
+ * @param lista LISTA já carregada.
+ * @param fila FILA já carregada.
+ * @param valido Recebe quantos bytes iniciais do arquivo são registros válidos.
+ * @param tamanho_total Recebe o tamanho do arquivo.
+ * @return int Quantidade de registros reaplicados.
+ */
+static int wal_reaplicar_arquivo(const char* caminho, LISTA* lista, FILA* fila,
+                                 size_t* valido, size_t* tamanho_total){
+    *valido = 0;
+    *tamanho_total = 0;
+
+    MAPA* mapa = mapa_abrir(caminho);
+    if (mapa == NULL)
+        return 0;
+
+    const char* dados = mapa_dados(mapa);
+    size_t tamanho = mapa_tamanho(mapa);
+    size_t pos = 0, consumido;
+    uint64_t aplicados = 0;
+
+    while ((consumido = wal_aplicar_registro(dados + pos, tamanho - pos, INT64_MAX, &pontos, lista, fila,
+                                             &wal.sequencia, &aplicados)) > 0)
+        pos += consumido;
+
+    mapa_fechar(&mapa);
+    *valido = pos;
+    *tamanho_total = tamanho;
+    return (int)aplicados;
+}
+
+/**
+ * @brief Reaplica o log aberto sobre as estruturas carregadas pelo LOAD.
+ * @details Um log rotacionado deixado por um snapshot que não terminou é
+ * reaplicado antes do log atual. Os registros já cobertos pelos arquivos
+ * carregados (ver wal_definir_pontos()) são pulados. Cada arquivo é percorrido mapeado em memória
+ * até o primeiro registro incompleto ou corrompido; esse final é cortado do
+ * log atual para que os próximos registros sejam anexados após o último válido.
+ * @param lista LISTA já carregada.
+ * @param fila FILA já carregada.
+ * @return int Quantidade de registros reaplicados (sem os pulados), ou -1 se o log não estiver aberto.
+ */
+int wal_reaplicar(LISTA* lista, FILA* fila){
+    if (!wal.aberto || wal.caminho == NULL || wal.caminho_antigo == NULL || lista == NULL || fila == NULL)
+        return -1;
+
+    size_t valido, tamanho;
+    int aplicados = wal_reaplicar_arquivo(wal.caminho_antigo, lista, fila, &valido, &tamanho);
+    aplicados += wal_reaplicar_arquivo(wal.caminho, lista, fila, &valido, &tamanho);
+
+    /* Descarta o final interrompido */
+    if (valido < tamanho && !wal_cortar(valido))
+        wal.erro = true;
+
+    return aplicados;
+}
+
+/**
+ * @brief Reaplica, em ordem, os registros de um trecho de log em memória até um instante.
+ * @details Usada para reconstruir um estado passado a partir de um ponto de
+ * restauração (ver auditoria.c). Os registros são aplicados direto do trecho
+ * (em geral, o arquivo morto mapeado), sem cópia; a aplicação para no
+ * primeiro registro inválido ou posterior a `ate`. Nenhum registro é pulado
+ * pela sequência: o trecho deve começar logo depois do ponto de restauração.
+ * @param dados Início do trecho (deve começar em um registro).
+ * @param tamanho Bytes do trecho.
+ * @param ate Último instante (time_t) a aplicar.
+ * @param lista LISTA a atualizar.
+ * @param fila FILA a atualizar.
+ * @param consumido Recebe quantos bytes do trecho foram aplicados (pode ser NULL).
+ * @return uint64_t Quantidade de registros aplicados.
+ */
+uint64_t wal_reaplicar_ate(const char* dados, size_t tamanho, int64_t ate, LISTA* lista, FILA* fila,
+                           size_t* consumido){
+    uint64_t aplicados = 0, sequencia = 0;
+    size_t pos = 0, n;
+
+    if (dados != NULL && lista != NULL && fila != NULL){
+        while ((n = wal_aplicar_registro(dados + pos, tamanho - pos, ate, NULL, lista, fila, &sequencia, &aplicados)) > 0)
+            pos += n;
+    }
+
+    if (consumido != NULL)
+        *consumido = pos;
+    return aplicados;
+}
+
+/**
+ * @brief Aplica os registros completos de um log a partir da posição do leitor.
+ * @details Um registro incompleto ou com verificação inválida no fim pode
+ * estar sendo escrito pelo processo principal: a leitura para nele e é
+ * retomada na próxima chamada.
+ * Os registros já cobertos pelos arquivos que a réplica carregou (o log
+ * ainda não truncado depois de um SAVE) são pulados.
+ * @param fp Log aberto para leitura.
+ * @return int Quantidade de registros aplicados.
+ */
+static int wal_ler_trecho(FILE* fp, LISTA* lista, FILA* fila){
+    uint64_t aplicados = 0;
+
+    while (fseek(fp, (long)leitor.posicao, SEEK_SET) == 0){
+        size_t lidos = fread(leitor.area, 1, WAL_TAM_BUFFER, fp);
+        size_t pos = 0, consumido;
+
+        while ((consumido = wal_aplicar_registro(leitor.area + pos, lidos - pos, INT64_MAX, &pontos, lista, fila,
+                                                 &leitor.sequencia, &aplicados)) > 0){
+            if (leitor.posicao == 0 && pos == 0){
+                memcpy(leitor.inicio, leitor.area, WAL_TAM_INICIO);
+                leitor.tem_inicio = true;
+            }
+            pos += consumido;
+        }
+
+        leitor.posicao += pos;
+        if (pos == 0 || lidos < WAL_TAM_BUFFER)
+            break;
+    }
+    return (int)aplicados;
+}
+
+/**
+ * @brief Confere se o log ainda começa pelo mesmo registro lido antes.
+ * @details Depois de um SAVE o processo principal trunca o log e volta a
+ * escrever do início; se isso acontecer entre duas leituras, o tamanho pode
+ * já ter passado da posição do leitor, mas o primeiro registro é outro.
+ */
+static bool wal_mesmo_inicio(FILE* fp){
+    char inicio[WAL_TAM_INICIO];
+    return !leitor.tem_inicio ||
+           (fseek(fp, 0, SEEK_SET) == 0 && fread(inicio, 1, WAL_TAM_INICIO, fp) == WAL_TAM_INICIO &&
+            memcmp(inicio, leitor.inicio, WAL_TAM_INICIO) == 0);
+}
+
+/**
+ * @brief Lê a identificação de um arquivo aberto.
+ */
+static void wal_identificar(FILE* fp, WAL_IDENTIDADE* id){
+    struct stat info;
+    memset(id, 0, sizeof(WAL_IDENTIDADE));
+    if (fp == NULL || fstat(fileno(fp), &info) != 0)
+        return;
+
+    id->existe = true;
+    id->dispositivo = (uint64_t)info.st_dev;
+    id->inode = (uint64_t)info.st_ino;
+    id->tamanho = (uint64_t)info.st_size;
+}
+
+/**
+ * @brief Indica se duas identificações são do mesmo arquivo.
+ */
+static bool wal_mesmo_arquivo(const WAL_IDENTIDADE* a, const WAL_IDENTIDADE* b){
+    return a->existe && b->existe && a->dispositivo == b->dispositivo && a->inode == b->inode;
+}
+
+/**
+ * @brief Aplica sobre a LISTA e a FILA de uma réplica os registros que o
+ * processo principal anexou ao log desde a última chamada.
+ * @details O log é só lido, nunca cortado nem aberto para escrita. Na
+ * primeira chamada, um log rotacionado é aplicado antes do log atual, como em
+ * wal_reaplicar(). Uma rotação feita por um snapshot (o log passa a ser
+ * `<log>.old` e outro é criado) é reconhecida pelo inode: o restante do log
+ * rotacionado é aplicado e a leitura continua no novo desde o início.
+ *
+ * Se o log foi truncado ou reescrito (SAVE no processo principal), ou se
+ * registros foram anexados ao log rotacionado (rotação com um snapshot
+ * anterior que falhou), os registros que faltam não estão mais onde a
+ * réplica os procuraria: ela precisa recarregar os arquivos de dados e
+ * chamar esta função de novo, que recomeça do início. Como na reaplicação,
+ * os registros até o ponto de cada arquivo carregado são pulados: o log
+ * relido logo após um SAVE pode ainda não ter sido truncado.
+ * @param caminho Caminho do log do processo principal.
+ * @param lista LISTA da réplica.
+ * @param fila FILA da réplica.
+ * @return int Quantidade de registros aplicados, ou -1 se a réplica deve ser recarregada.
+ */
+int wal_acompanhar(const char* caminho, LISTA* lista, FILA* fila){
+    if (caminho == NULL || lista == NULL || fila == NULL)
+        return -1;
+
+    char caminho_antigo[FILENAME_MAX];
+    if (snprintf(caminho_antigo, sizeof(caminho_antigo), "%s%s", caminho, WAL_SUFIXO_ANTIGO) >= (int)sizeof(caminho_antigo))
+        return -1;
+
+    int aplicados = 0;
+    FILE* antigo = fopen(caminho_antigo, "rb");
+    WAL_IDENTIDADE id_antigo;
+    wal_identificar(antigo, &id_antigo);
+
+    if (!leitor.aberto){
+        wal_parar_acompanhamento();
+        leitor.aberto = true;
+        leitor.sequencia = 0;
+        if (antigo != NULL)
+            aplicados += wal_ler_trecho(antigo, lista, fila);
+        leitor.posicao = 0;
+        leitor.tem_inicio = false;
+    }
+#ifndef _WIN32
+    /* No Windows o log nunca é renomeado (ver wal_rotacionar()) e não há inode */
+    else if (wal_mesmo_arquivo(&id_antigo, &leitor.atual)){
+        /* Rotacionado: termina o log acompanhado, agora com o nome antigo */
+        aplicados += wal_ler_trecho(antigo, lista, fila);
+        memset(&leitor.atual, 0, sizeof(WAL_IDENTIDADE));
+        leitor.posicao = 0;
+        leitor.tem_inicio = false;
+    }
+#endif
+    else if (id_antigo.existe && (!wal_mesmo_arquivo(&id_antigo, &leitor.antigo) ||
+                                  id_antigo.tamanho != leitor.antigo.tamanho)){
+        /* Registros que a réplica não leu foram parar no log rotacionado */
+        fclose(antigo);
+        wal_parar_acompanhamento();
+        return -1;
+    }
+
+    if (antigo != NULL){
+        wal_identificar(antigo, &leitor.antigo);
+        fclose(antigo);
+    } else {
+        memset(&leitor.antigo, 0, sizeof(WAL_IDENTIDADE));
+    }
+
+    FILE* fp = fopen(caminho, "rb");
+    if (fp == NULL)
+        return aplicados; // Ainda não criado, ou no meio de uma rotação
+
+    WAL_IDENTIDADE id;
+    wal_identificar(fp, &id);
+
+    /* Outro log no lugar sem passar pelo nome antigo: não dá para saber o que se perdeu */
+    bool truncado = !id.existe || (leitor.atual.existe && !wal_mesmo_arquivo(&id, &leitor.atual)) ||
+                    id.tamanho < leitor.posicao || !wal_mesmo_inicio(fp);
+    if (!truncado){
+        leitor.atual = id;
+        aplicados += wal_ler_trecho(fp, lista, fila);
+    }
+    fclose(fp);
+
+    if (truncado){
+        wal_parar_acompanhamento();
+        return -1;
+    }
+    return aplicados;
+}
+
+/**
+ * @brief Esquece a posição da réplica no log: a próxima chamada de
+ * wal_acompanhar() recomeça do início.
+ */
+void wal_parar_acompanhamento(void){
+    leitor.aberto = false;
+    memset(&leitor.atual, 0, sizeof(WAL_IDENTIDADE));
+    memset(&leitor.antigo, 0, sizeof(WAL_IDENTIDADE));
+    leitor.posicao = 0;
+    leitor.tem_inicio = false;
+}
+
+/**
+ * @brief Define o arquivo que acumula os registros descartados do log.
+ * @details A partir daqui, wal_truncar() e wal_descartar_antigo() anexam os
+ * registros válidos a ele antes de descartá-los.
+ * @param caminho Arquivo morto (NULL deixa de guardar).
+ * @return true se o caminho foi registrado.
+ */
+bool wal_definir_arquivo_morto(const char* caminho){
+    free(wal.arquivo_morto);
+    wal.arquivo_morto = NULL;
+    if (caminho == NULL)
+        return true;
+
+    wal.arquivo_morto = malloc(strlen(caminho) + 1);
+    if (wal.arquivo_morto == NULL)
+        return false;
+    strcpy(wal.arquivo_morto, caminho);
+    return true;
+}
+
+/**
+ * @brief Anexa os registros válidos de um log ao arquivo morto, se houver um.
+ * @param caminho Log a guardar (ausente ou vazio não é erro).
+ * @return true se os registros ficaram no arquivo morto (e sincronizados).
+ */
+static bool wal_arquivar(const char* caminho){
+    if (wal.arquivo_morto == NULL || caminho == NULL)
+        return true;
+
+    MAPA* mapa = mapa_abrir(caminho);
+    if (mapa == NULL)
+        return true;
+
+    const char* dados = mapa_dados(mapa);
+    size_t tamanho = mapa_tamanho(mapa);
+    size_t valido = 0, n;
+    while ((n = wal_conferir_registro(dados + valido, tamanho - valido)) > 0)
+        valido += n;
+
+    bool ok = true;
+    if (valido > 0){
+        FILE* destino = fopen(wal.arquivo_morto, "ab");
+        ok = destino != NULL && fwrite(dados, 1, valido, destino) == valido;
+        if (destino != NULL){
+            ok = fflush(destino) == 0 && ok;
+#ifdef _WIN32
+            ok = ok && _commit(_fileno(destino)) == 0;
+#else
+            ok = ok && fsync(fileno(destino)) == 0;
+#endif
+            ok = fclose(destino) == 0 && ok;
+        }
+    }
+
+    mapa_fechar(&mapa);
+    return ok;
+}
+
+/**
+ * @brief Move os registros atuais para o log rotacionado e recomeça o log vazio.
+ * @details Usado no início de um snapshot em segundo plano: o que está no
+ * log rotacionado passa a ser coberto pelo snapshot. Se um snapshot anterior
+ * falhou e o log rotacionado ainda existe, os registros atuais são anexados a ele.
+ * @return true se a rotação foi feita.
+ */
+bool wal_rotacionar(void){
+    if (!wal.aberto || wal.caminho_antigo == NULL)
+        return false;
+
+    wal_confirmar();
+    if (wal.nao_sincronizadas > 0 && wal_sincronizar())
+        wal.nao_sincronizadas = 0;
+
+    FILE* antigo = fopen(wal.caminho_antigo, "rb");
+#ifndef _WIN32
+    if (antigo == NULL){
+        /* Caso comum: basta renomear e abrir um log novo */
+        if (rename(wal.caminho, wal.caminho_antigo) != 0)
+            return false;
+        int fd = open(wal.caminho, O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (fd < 0){
+            wal.erro = true;
+            return false;
+        }
+        close(wal.fd);
+        wal.fd = fd;
+        return true;
+    }
+#endif
+    if (antigo != NULL)
+        fclose(antigo);
+
+    /* Anexa o log atual ao rotacionado e esvazia o atual */
+    MAPA* mapa = mapa_abrir(wal.caminho);
+    FILE* destino = fopen(wal.caminho_antigo, "ab");
+    bool ok = mapa != NULL && destino != NULL;
+
+    if (ok && mapa_tamanho(mapa) > 0)
+        ok = fwrite(mapa_dados(mapa), 1, mapa_tamanho(mapa), destino) == mapa_tamanho(mapa);
+    if (destino != NULL){
+        ok = fflush(destino) == 0 && ok;
+#ifdef _WIN32
+        ok = ok && _commit(_fileno(destino)) == 0;
+#else
+        ok = ok && fsync(fileno(destino)) == 0;
+#endif
+        ok = fclose(destino) == 0 && ok;
+    }
+    mapa_fechar(&mapa);
+
+    return ok && wal_cortar(0);
+}
+
+/**
+ * @brief Apaga o log rotacionado depois que o snapshot que o cobre terminou.
+ * @details Com arquivo morto, o log rotacionado só é apagado depois de
+ * guardado nele; se não der, fica para a próxima tentativa.
+ */
+void wal_descartar_antigo(void){
+    if (wal.caminho_antigo != NULL && wal_arquivar(wal.caminho_antigo))
+        remove(wal.caminho_antigo);
+}
+
+/**
+ * @brief Esvazia o log depois que um SAVE completo foi gravado.
+ * @details Registros ainda não confirmados e o log rotacionado também são
+ * descartados, pois seu efeito já está no SAVE. Com arquivo morto, o log
+ * rotacionado e depois o atual são guardados nele antes; se não der, o log
+ * não é truncado (será guardado no próximo SAVE).
+ * @return true se o arquivo foi truncado e sincronizado.
+ */
+bool wal_truncar(void){
+    if (!wal.aberto)
+        return false;
+
+    wal.n_pendente = 0;
+    wal.nao_sincronizadas = 0;
+    wal_descartar_antigo();
+    if (wal.caminho_antigo != NULL && wal.arquivo_morto != NULL){
+        FILE* antigo = fopen(wal.caminho_antigo, "rb");
+        if (antigo != NULL){
+            fclose(antigo);
+            return false;
+        }
+    }
+    if (!wal_arquivar(wal.caminho))
+        return false;
+    return wal_cortar(0) && wal_sincronizar();
+}
+
+/**
+ * @brief Confirma o que estiver pendente, sincroniza e fecha o log.
+ */
+void wal_fechar(void){
+    if (!wal.aberto)
+        return;
+
+    wal_confirmar();
+    if (wal.nao_sincronizadas > 0)
+        wal_sincronizar();
+
+#ifdef _WIN32
+    fclose(wal.fp);
+#else
+    close(wal.fd);
+#endif
+    free(wal.caminho);
+    free(wal.caminho_antigo);
+    free(wal.arquivo_morto);
+    memset(&wal, 0, sizeof(WAL));
+}